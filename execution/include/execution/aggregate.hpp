@@ -0,0 +1,93 @@
+#pragma once
+#include "execution/vector.hpp"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// One aggregate over an input column ordinal; `column` is unset for COUNT(*).
+struct AggregateSpec {
+    AggregateFunc func;
+    std::optional<size_t> column;
+};
+
+// Result type of an aggregate over `input`: COUNT is INT, AVG is REAL, and SUM, MIN
+// and MAX have their argument's type. Throws CompileError if SUM, AVG, MIN or MAX is
+// applied to anything but an INT or REAL column.
+DataType::Kind aggregate_type(const AggregateSpec& spec, const std::vector<ColumnDef>& input);
+
+/**
+ * Running aggregates per group of rows with equal key columns; NULL keys are equal to
+ * each other. SQL semantics: aggregates skip NULL arguments, COUNT of nothing is 0 and
+ * every other aggregate of nothing is NULL. INT sums wrap around on overflow.
+ *
+ * Groups are numbered in the order they first appear, and their keys and aggregate
+ * states are kept in flat arrays indexed by that number. The hash table is an array of
+ * 64-bit slots, each packing the upper half of a group's hash with its number, probed
+ * linearly and kept at most half full, so a probe usually costs one cache line and
+ * only reads a group's keys when the stored hash bits match.
+ *
+ * add() processes a chunk column by column: it hashes every active row one key column
+ * at a time, maps the rows to groups (prefetching slots a few rows ahead), then runs
+ * one tight loop per aggregate, dispatching on its type once per chunk. Without key
+ * columns there is exactly one group and each loop reduces into a local accumulator.
+ *
+ * Not thread-safe: parallel plans give each thread a table and merge() them.
+ */
+class AggregateTable {
+public:
+    // `keys` and the aggregates' columns are ordinals into `input`.
+    AggregateTable(const std::vector<ColumnDef>& input, std::vector<size_t> keys,
+                   std::vector<AggregateSpec> aggregates);
+
+    AggregateTable(const AggregateTable&) = delete;
+    AggregateTable& operator=(const AggregateTable&) = delete;
+
+    // Folds the active rows of `chunk`, which has the input's schema, into the groups.
+    void add(const DataChunk& chunk);
+    // Folds every group of `other`, built with the same input, keys and aggregates.
+    void merge(const AggregateTable& other);
+
+    size_t group_count() const { return hashes_.size(); }
+    // Key columns, then one column per aggregate.
+    const std::vector<ColumnDef>& schema() const { return schema_; }
+    // Fills `chunk` with up to VECTOR_SIZE groups starting at group `first`.
+    void emit(size_t first, DataChunk& chunk) const;
+
+private:
+    struct KeyPart {
+        uint64_t bits;              // INT, REAL (with -0.0 as 0.0) or BOOL value
+        std::string_view text;      // TEXT value, in strings_ once stored in keys_
+        bool null;
+    };
+
+    // COUNT uses `count` only. SUM, MIN and MAX keep their value in `i` or `f` by the
+    // argument's type, AVG its sum in `f`; `count` is the number of non-NULL arguments.
+    struct State {
+        long long count;
+        long long i;
+        double f;
+    };
+
+    std::vector<size_t> keys_;
+    std::vector<AggregateSpec> aggregates_;
+    std::vector<DataType::Kind> key_types_;
+    std::vector<DataType::Kind> arg_types_;     // Int for COUNT(*)
+    std::vector<ColumnDef> schema_;
+
+    std::vector<uint64_t> slots_;       // 0 = empty, else hash >> 32 << 32 | (group + 1)
+    std::vector<uint64_t> hashes_;      // per group
+    std::vector<KeyPart> key_parts_;    // keys_.size() per group
+    std::vector<State> states_;         // aggregates_.size() per group
+    StringHeap strings_;                // TEXT keys
+
+    // Per-chunk scratch, indexed by position in the chunk's selection.
+    std::vector<uint64_t> row_hashes_;
+    std::vector<KeyPart> row_keys_;     // keys_.size() per row
+    std::vector<uint32_t> row_groups_;
+
+    uint32_t find_or_add(uint64_t hash, const KeyPart* key);
+    bool same_key(const KeyPart* a, const KeyPart* b) const;
+    void grow();
+    void update(size_t a, const DataChunk& chunk, const uint32_t* groups);
+};
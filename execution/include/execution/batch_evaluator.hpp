@@ -0,0 +1,38 @@
+#pragma once
+#include "execution/bytecode.hpp"
+#include "execution/vector.hpp"
+#include <cstdint>
+#include <vector>
+
+// Runs a Program over a whole DataChunk one instruction at a time: each opcode is
+// dispatched once per batch and applied to every active row in a tight loop. Column
+// loads alias the chunk's vectors instead of copying them. AND/OR are evaluated on both
+// sides (every opcode is total, so this only costs work, never correctness); callers
+// that want short-circuiting split a predicate into conjuncts and narrow the selection
+// between them, as Filter does.
+class BatchEvaluator {
+public:
+    explicit BatchEvaluator(const Program& program);
+
+    // Keeps the entries of `sel` whose row satisfies the predicate (NULL does not), in
+    // order.
+    void select(const DataChunk& chunk, std::vector<uint16_t>& sel);
+
+private:
+    struct VecReg {
+        const long long* i = nullptr;   // INT, and BOOL as 0/1
+        const double* f = nullptr;
+        const std::string_view* s = nullptr;
+        const uint8_t* null = nullptr;
+        std::vector<long long> own_i;
+        std::vector<double> own_f;
+        std::vector<std::string_view> own_s;
+        std::vector<uint8_t> own_null;
+    };
+
+    const Program& p_;
+    std::vector<VecReg> regs_;
+    std::vector<Reg> consts_;
+
+    void run(const DataChunk& chunk, const uint16_t* sel, size_t n);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include "parser/ast.hpp"
+#include "storage/bloom_filter.hpp"
+#include "storage/tuple.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Decides from a heap file's BloomFilterMap which pages a scan can skip. Every WHERE
+ * conjunct that tests an INT, REAL or TEXT column for equality with a literal (either
+ * way round) becomes a key; a page whose group filter lacks any key has no matching
+ * rows. Ranges are left to ZoneFilter and everything else to the filter above the scan.
+ *
+ * may_match() reads the group's filter page once and probes each key's block with the
+ * running CPU's SIMD kernel, before the data page itself is fetched. It only reads the
+ * map, so one probe serves the workers of a ParallelScan.
+ */
+class BloomFilterProbe {
+public:
+    // `conjuncts` are those of a normalized WHERE clause over `layout`.
+    BloomFilterProbe(BloomFilterMap& blooms, const ExprArena& arena, const std::vector<ExprId>& conjuncts,
+                     const TupleLayout& layout);
+
+    // False if no conjunct gives a key, so every page would pass.
+    bool useful() const { return !keys_.empty(); }
+    // False if data page `page_id` cannot hold a row satisfying the conjuncts.
+    bool may_match(uint64_t page_id) const;
+
+private:
+    BloomFilterMap& blooms_;
+    std::vector<size_t> offsets_;       // per key: byte offset of its block in the filters
+    std::vector<uint64_t> keys_;        // hashes
+};
@@ -0,0 +1,203 @@
+#pragma once
+#include "parser/ast.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CompileError : public std::runtime_error {
+    CompileError(std::string msg) : std::runtime_error(std::move(msg)) {}
+};
+
+// Register-based bytecode for scalar expressions. Every opcode is specialized for the
+// operand type the compiler inferred from the table's ColumnDefs, so evaluation never
+// inspects a type tag or visits a variant.
+enum class OpCode : uint8_t {
+    // dst <- row[arg] / consts[arg]
+    LoadColInt, LoadColReal, LoadColText, LoadColBool,
+    LoadConst, LoadNull,
+    IntToReal,                                               // dst <- (double) a
+
+    CmpIntEq, CmpIntNeq, CmpIntLt, CmpIntLte, CmpIntGt, CmpIntGte,
+    CmpRealEq, CmpRealNeq, CmpRealLt, CmpRealLte, CmpRealGt, CmpRealGte,
+    CmpTextEq, CmpTextNeq, CmpTextLt, CmpTextLte, CmpTextGt, CmpTextGte,
+
+    AddInt, SubInt, MulInt, DivInt,
+    AddReal, SubReal, MulReal, DivReal,
+    NegInt, NegReal, Not,
+
+    // AND: if a is FALSE then dst <- FALSE and jump to arg; otherwise fall through to rhs.
+    AndShort,
+    // OR: if a is TRUE then dst <- TRUE and jump to arg.
+    OrShort,
+    And3, Or3,                                               // dst <- a AND/OR b (three-valued)
+};
+
+struct Instr {
+    OpCode op;
+    uint16_t dst;
+    uint16_t a;
+    uint16_t b;
+    uint32_t arg; // column ordinal, constant index or jump target
+};
+
+// One virtual register. Bools are stored in `i` as 0/1; `s` views row or program memory.
+struct Reg {
+    long long i;
+    double f;
+    std::string_view s;
+    bool null;
+};
+
+struct Program {
+    // Text constants are stored as spans of `strings` rather than views, so that a Program
+    // stays valid when copied or moved; Evaluator resolves them to views once.
+    struct TextConst { uint32_t index; uint32_t offset; uint32_t length; };
+
+    std::vector<Instr> code;
+    std::vector<Reg> consts;
+    std::vector<TextConst> text_consts;
+    std::string strings;            // backing storage for Text constants
+    uint16_t num_regs = 0;
+    uint16_t result = 0;            // register holding the value of the expression
+    DataType::Kind result_type = DataType::Bool;
+    bool result_is_null_literal = false; // expression is the bare NULL literal
+};
+
+// Compiles `root` with column names resolved against `columns` (column i is row[i]).
+// Throws CompileError for unknown columns, type mismatches, Custom column types and
+// unbound placeholders.
+Program compile_expr(const ExprArena& arena, ExprId root, const std::vector<ColumnDef>& columns);
+
+// Like compile_expr, but the expression must be boolean (or NULL).
+Program compile_predicate(const ExprArena& arena, ExprId root, const std::vector<ColumnDef>& columns);
+
+
+// Row accessor over an array of Values in column order, for Evaluator.
+struct ValueRow {
+    const Value* values;
+
+    bool is_null(size_t col) const { return values[col].kind == Value::Null; }
+    long long get_int(size_t col) const { return values[col].i; }
+    double get_real(size_t col) const {
+        return values[col].kind == Value::Int ? static_cast<double>(values[col].i) : values[col].f;
+    }
+    std::string_view get_text(size_t col) const { return values[col].s; }
+    bool get_bool(size_t col) const { return values[col].b; }
+};
+
+// Runs a Program over rows; `program` must outlive the Evaluator. Row is any accessor with is_null/get_int/get_real/get_text/get_bool
+// taking a column ordinal (see ValueRow). Registers are reused across calls, so one Evaluator
+// per thread evaluates without allocating. Integer overflow and division by zero yield NULL.
+class Evaluator {
+public:
+    explicit Evaluator(const Program& program)
+        : p_(program), regs_(program.num_regs), consts_(program.consts) {
+        for (const auto& t : program.text_consts) {
+            consts_[t.index].s = std::string_view(program.strings).substr(t.offset, t.length);
+        }
+    }
+
+    template<typename Row>
+    const Reg& run(const Row& row) {
+        const Instr* code = p_.code.data();
+        const size_t n = p_.code.size();
+        Reg* r = regs_.data();
+        for (size_t pc = 0; pc < n; ++pc) {
+            const Instr& in = code[pc];
+            Reg& d = r[in.dst];
+            const Reg& a = r[in.a];
+            const Reg& b = r[in.b];
+            switch (in.op) {
+                case OpCode::LoadColInt:  d.null = row.is_null(in.arg); if (!d.null) d.i = row.get_int(in.arg); break;
+                case OpCode::LoadColReal: d.null = row.is_null(in.arg); if (!d.null) d.f = row.get_real(in.arg); break;
+                case OpCode::LoadColText: d.null = row.is_null(in.arg); if (!d.null) d.s = row.get_text(in.arg); break;
+                case OpCode::LoadColBool: d.null = row.is_null(in.arg); if (!d.null) d.i = row.get_bool(in.arg); break;
+                case OpCode::LoadConst:   d = consts_[in.arg]; break;
+                case OpCode::LoadNull:    d.null = true; break;
+                case OpCode::IntToReal:   d.null = a.null; d.f = static_cast<double>(a.i); break;
+
+#define SIMPLEDB_CMP(OP, FIELD, EXPR) \
+                case OpCode::OP: d.null = a.null || b.null; d.i = (a.FIELD EXPR b.FIELD); break;
+                SIMPLEDB_CMP(CmpIntEq, i, ==)  SIMPLEDB_CMP(CmpIntNeq, i, !=)
+                SIMPLEDB_CMP(CmpIntLt, i, <)   SIMPLEDB_CMP(CmpIntLte, i, <=)
+                SIMPLEDB_CMP(CmpIntGt, i, >)   SIMPLEDB_CMP(CmpIntGte, i, >=)
+                SIMPLEDB_CMP(CmpRealEq, f, ==) SIMPLEDB_CMP(CmpRealNeq, f, !=)
+                SIMPLEDB_CMP(CmpRealLt, f, <)  SIMPLEDB_CMP(CmpRealLte, f, <=)
+                SIMPLEDB_CMP(CmpRealGt, f, >)  SIMPLEDB_CMP(CmpRealGte, f, >=)
+#undef SIMPLEDB_CMP
+                // A NULL register's view may point into an earlier row, so never read it.
+#define SIMPLEDB_CMP_TEXT(OP, EXPR) \
+                case OpCode::OP: d.null = a.null || b.null; if (!d.null) d.i = (a.s EXPR b.s); break;
+                SIMPLEDB_CMP_TEXT(CmpTextEq, ==) SIMPLEDB_CMP_TEXT(CmpTextNeq, !=)
+                SIMPLEDB_CMP_TEXT(CmpTextLt, <)  SIMPLEDB_CMP_TEXT(CmpTextLte, <=)
+                SIMPLEDB_CMP_TEXT(CmpTextGt, >)  SIMPLEDB_CMP_TEXT(CmpTextGte, >=)
+#undef SIMPLEDB_CMP_TEXT
+
+                case OpCode::AddInt: d.null = a.null || b.null || __builtin_add_overflow(a.i, b.i, &d.i); break;
+                case OpCode::SubInt: d.null = a.null || b.null || __builtin_sub_overflow(a.i, b.i, &d.i); break;
+                case OpCode::MulInt: d.null = a.null || b.null || __builtin_mul_overflow(a.i, b.i, &d.i); break;
+                case OpCode::DivInt:
+                    d.null = a.null || b.null || b.i == 0 || (b.i == -1 && a.i == INT64_MIN);
+                    if (!d.null) d.i = a.i / b.i;
+                    break;
+                case OpCode::AddReal: d.null = a.null || b.null; d.f = a.f + b.f; break;
+                case OpCode::SubReal: d.null = a.null || b.null; d.f = a.f - b.f; break;
+                case OpCode::MulReal: d.null = a.null || b.null; d.f = a.f * b.f; break;
+                case OpCode::DivReal:
+                    d.null = a.null || b.null || b.f == 0.0;
+                    if (!d.null) d.f = a.f / b.f;
+                    break;
+                case OpCode::NegInt: d.null = a.null || a.i == INT64_MIN; if (!d.null) d.i = -a.i; break;
+                case OpCode::NegReal: d.null = a.null; d.f = -a.f; break;
+                case OpCode::Not: d.null = a.null; d.i = !a.i; break;
+
+                case OpCode::AndShort:
+                    if (!a.null && !a.i) { d.null = false; d.i = 0; pc = in.arg - 1; }
+                    break;
+                case OpCode::OrShort:
+                    if (!a.null && a.i) { d.null = false; d.i = 1; pc = in.arg - 1; }
+                    break;
+                case OpCode::And3:
+                    // a is TRUE or NULL here (FALSE jumped): FALSE if b is FALSE, else NULL unless both TRUE.
+                    if (!b.null && !b.i) { d.null = false; d.i = 0; }
+                    else { d.null = a.null || b.null; d.i = 1; }
+                    break;
+                case OpCode::Or3:
+                    if (!b.null && b.i) { d.null = false; d.i = 1; }
+                    else { d.null = a.null || b.null; d.i = 0; }
+                    break;
+            }
+        }
+        return r[p_.result];
+    }
+
+    // Predicate result with NULL treated as not matching, as in WHERE.
+    template<typename Row>
+    bool matches(const Row& row) {
+        const Reg& res = run(row);
+        return !res.null && res.i != 0;
+    }
+
+    // Expression result materialized as a Value of the program's result type.
+    template<typename Row>
+    Value evaluate(const Row& row) {
+        const Reg& res = run(row);
+        Value v;
+        if (res.null || p_.result_is_null_literal) { v.kind = Value::Null; return v; }
+        switch (p_.result_type) {
+            case DataType::Int:  v.kind = Value::Int; v.i = res.i; break;
+            case DataType::Real: v.kind = Value::Float; v.f = res.f; break;
+            case DataType::Text: v.kind = Value::String; v.s = std::string(res.s); break;
+            case DataType::Bool: v.kind = Value::Bool; v.b = res.i != 0; break;
+            case DataType::Custom: v.kind = Value::Null; break;
+        }
+        return v;
+    }
+
+private:
+    const Program& p_;
+    std::vector<Reg> regs_;
+    std::vector<Reg> consts_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "execution/batch_evaluator.hpp"
+#include "execution/bytecode.hpp"
+#include "execution/simd.hpp"
+#include "execution/vector.hpp"
+#include <cstdint>
+#include <vector>
+
+// One WHERE conjunct evaluated over a DataChunk. Conjuncts that are AND/OR trees of
+// comparisons between INT, REAL or BOOL columns and constants (or same-typed columns),
+// or bare BOOL columns, run as SIMD kernels over whole column vectors, producing one
+// bitmap per comparison that is masked by the NULL flags and combined word-wise.
+// Everything else runs through a BatchEvaluator.
+//
+// Holds a Program that its evaluator refers to, so it is neither copied nor moved.
+class ChunkPredicate {
+public:
+    // Compiles `root`; throws CompileError like compile_predicate.
+    ChunkPredicate(const ExprArena& arena, ExprId root, const std::vector<ColumnDef>& columns);
+
+    ChunkPredicate(const ChunkPredicate&) = delete;
+    ChunkPredicate& operator=(const ChunkPredicate&) = delete;
+
+    // Keeps the entries of `sel` whose row satisfies the predicate, in order.
+    void select(const DataChunk& chunk, std::vector<uint16_t>& sel);
+
+    const Program& program() const { return program_; }
+    bool uses_kernels() const { return !nodes_.empty(); }
+
+private:
+    // Comparison leaves and AND/OR nodes in post-order; the root is last.
+    struct Node {
+        enum Kind : uint8_t { CmpConst, CmpColumn, And, Or } kind;
+        CmpOp op;
+        DataType::Kind type;
+        uint32_t lhs, rhs;      // column ordinals; unused by And/Or, which combine the two bitmaps below them
+        long long i;            // INT or BOOL constant
+        double f;               // REAL constant
+    };
+
+    Program program_;
+    BatchEvaluator evaluator_;
+    std::vector<Node> nodes_;
+    std::vector<uint64_t> stack_;   // nodes_.size() bitmaps of BITMAP_WORDS words
+    const SimdKernels& kernels_;
+
+    bool build(const ExprArena& arena, ExprId id, const std::vector<ColumnDef>& columns);
+    bool build_leaf(const ExprArena& arena, ExprId id, const std::vector<ColumnDef>& columns);
+    void compare(const DataChunk& chunk, const Node& node, uint64_t* out) const;
+};
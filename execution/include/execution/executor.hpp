@@ -0,0 +1,58 @@
+#pragma once
+#include "execution/operators.hpp"
+#include "parser/ast.hpp"
+#include <memory>
+#include <vector>
+
+// Builds scan -> filter -> projection -> limit for a SELECT over `heap`, whose records
+// are encoded with `layout`. The WHERE clause is split into its conjuncts, each compiled
+// separately so Filter can apply them in order. Only the columns the query references
+// are decoded. Throws CompileError for unknown columns and ill-typed predicates.
+// When the heap keeps a zone map, a scan of the whole table skips the pages a
+// ZoneFilter over the conjuncts rules out.
+//
+// A query with aggregates or GROUP BY gets a HashAggregate after the filter; its
+// non-aggregate items must be GROUP BY columns, and LIMIT applies to the groups.
+//
+// The statement should be bound and normalized (see rewrite.hpp); heap and layout must
+// outlive the returned operator.
+std::unique_ptr<Operator> plan_select(const Statement& stmt, HeapFile& heap, const TupleLayout& layout);
+
+// An index on column `column` (an ordinal of the table's layout); exactly one of
+// `tree` and `hash` is set.
+struct TableIndex {
+    size_t column;
+    BPlusTree* tree = nullptr;
+    HashIndex* hash = nullptr;
+};
+
+// Like plan_select above, but a conjunct comparing an indexed column with an integer
+// literal (=, <, <=, >, >=) turns the scan into an IndexScan over the implied key
+// range. Hash indexes serve equality only; equality is preferred over ranges, and a
+// hash index over a B+tree for it. Every conjunct is still applied by the Filter, so
+// the index only narrows which records are read.
+//
+// With threads > 1, a plan that does not use an index scans and filters the table
+// with a ParallelScan of that many workers; rows then come out in no particular order.
+// Aggregation then runs on the workers, each into its own partial table.
+std::unique_ptr<Operator> plan_select(const Statement& stmt, HeapFile& heap, const TupleLayout& layout,
+                                      const std::vector<TableIndex>& indexes, size_t threads = 1);
+
+// Like plan_select above over the heap of `table`, but every scan reads the versions
+// `txn` sees rather than the newest ones, committed or not. Index entries may point at
+// versions txn does not see; those are skipped. txn must stay active while the
+// operator runs.
+std::unique_ptr<Operator> plan_select(const Statement& stmt, MvccHeap& table, const Transaction& txn,
+                                      const TupleLayout& layout, const std::vector<TableIndex>& indexes = {},
+                                      size_t threads = 1);
+
+// Builds the index described by a CREATE INDEX statement into the empty `index` from
+// the non-NULL values of the column in `heap`; a B+tree is bulk loaded from the sorted
+// entries. Only INT columns can be indexed; throws std::invalid_argument for unknown
+// or non-INT columns, or an index of the wrong method. Keeping the index current under
+// later writes is up to the caller.
+void create_index(const Statement& stmt, HeapFile& heap, const TupleLayout& layout, BPlusTree& index);
+void create_index(const Statement& stmt, HeapFile& heap, const TupleLayout& layout, HashIndex& index);
+
+// Drains `op` into rows of Values.
+std::vector<std::vector<Value>> collect_rows(Operator& op);
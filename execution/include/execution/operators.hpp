@@ -0,0 +1,258 @@
+#pragma once
+#include "execution/aggregate.hpp"
+#include "execution/chunk_predicate.hpp"
+#include "execution/vector.hpp"
+#include "storage/btree.hpp"
+#include "storage/hash_index.hpp"
+#include "storage/heap_file.hpp"
+#include "storage/mvcc.hpp"
+#include "storage/tuple.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// A pull-based operator producing batches. next() refills `chunk` and returns false
+// once the operator is exhausted; chunks it returns are never empty.
+class Operator {
+public:
+    virtual ~Operator() = default;
+    virtual bool next(DataChunk& chunk) = 0;
+    // Columns of the chunks this operator produces.
+    virtual const std::vector<ColumnDef>& schema() const = 0;
+};
+
+// Reads a heap file into chunks of the table's full schema, materializing only the
+// columns in `read` (column ordinals of `layout`). Files of PAX pages are read column
+// by column, straight from each page's minipages. A page filter, if set, is asked about
+// each page before it is fetched, and pages it rules out are never read. With a
+// snapshot set, each page's rows are instead the versions a transaction sees, copied
+// out by MvccHeap::scan_page.
+class SeqScan : public Operator {
+public:
+    // False if data page `page_id` cannot hold a row the query wants. Called from the
+    // threads of a ParallelScan concurrently.
+    using PageFilter = std::function<bool(uint64_t page_id)>;
+
+    SeqScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read);
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return layout_.columns(); }
+
+    // Restarts the scan over data pages [first_page, last_page] only. Without a call the
+    // whole file is read, including pages appended while scanning.
+    void reset(uint64_t first_page, uint64_t last_page);
+    void set_page_filter(PageFilter filter) { filter_ = std::move(filter); }
+    // Reads the versions txn sees through `mvcc`, which must be over this scan's heap.
+    // txn must stay active while the scan runs.
+    void set_snapshot(MvccHeap& mvcc, const Transaction& txn);
+    // Pages the filter ruled out so far.
+    uint64_t pages_skipped() const { return skipped_; }
+
+private:
+    HeapFile& heap_;
+    const TupleLayout& layout_;
+    std::vector<size_t> read_;
+    PageFilter filter_;
+    uint64_t skipped_ = 0;
+    uint64_t page_ = 1;
+    uint64_t last_page_ = UINT64_MAX;
+    uint16_t slot_ = 0;
+    std::vector<uint16_t> rows_;    // PAX rows copied by the current read_pax_rows call
+
+    MvccHeap* mvcc_ = nullptr;
+    const Transaction* txn_ = nullptr;
+    bool loaded_ = false;               // page_'s visible rows are in visible_
+    std::vector<uint8_t> visible_;      // those rows' records, back to back
+    std::vector<size_t> visible_rows_;  // where each starts in visible_; slot_ indexes this
+
+    uint16_t read_pax_rows(const PaxPage& page, uint16_t from, DataChunk& chunk);
+    bool next_visible(DataChunk& chunk);
+    // True if the filter rules out page_, which has not been started.
+    bool skip_page();
+};
+
+// Reads the records whose key in `index` lies in [lo, hi], or equals `key` in a hash
+// index, producing chunks like SeqScan's. The matching RIDs are collected on the first
+// call and sorted, so each heap page is fetched once per batch that needs it and rows
+// come out in heap order. With a snapshot set, each RID is read with MvccHeap::get.
+class IndexScan : public Operator {
+public:
+    IndexScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read,
+              BPlusTree& index, int64_t lo, int64_t hi);
+    IndexScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read,
+              HashIndex& index, int64_t key);
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return layout_.columns(); }
+
+    // As SeqScan::set_snapshot.
+    void set_snapshot(MvccHeap& mvcc, const Transaction& txn);
+
+private:
+    HeapFile& heap_;
+    const TupleLayout& layout_;
+    std::vector<size_t> read_;
+    MvccHeap* mvcc_ = nullptr;
+    const Transaction* txn_ = nullptr;
+    BPlusTree* tree_ = nullptr;
+    HashIndex* hash_ = nullptr;
+    int64_t lo_;
+    int64_t hi_;
+    bool probed_ = false;
+    std::vector<RID> rids_;
+    size_t pos_ = 0;
+    std::vector<uint8_t> record_;
+};
+
+/**
+ * Scans a heap file on a fixed set of worker threads, each running its own SeqScan
+ * and its own copy of the filter predicates. The pages present when the first chunk is
+ * requested are cut into morsels of MORSEL_PAGES pages and dealt out in contiguous runs
+ * to per-worker deques. A worker takes morsels from the front of its own deque and,
+ * once that is empty, steals from the back of the others', so a worker held up by slow
+ * pages is relieved by idle ones.
+ *
+ * Chunks that still have rows after filtering are handed to the consumer through a
+ * queue of at most QUEUE_CHUNKS per worker; a full queue parks the workers, so a LIMIT
+ * above stops the scan after a bounded amount of extra work, and destroying the
+ * operator cancels it. Rows come out in no particular order. An exception thrown on a
+ * worker is rethrown from next().
+ */
+class ParallelScan : public Operator {
+public:
+    static constexpr uint64_t MORSEL_PAGES = 16;
+    static constexpr size_t QUEUE_CHUNKS = 2;
+
+    using PredicateFactory = std::function<std::vector<std::unique_ptr<ChunkPredicate>>()>;
+
+    // Calls make_predicates once per worker.
+    ParallelScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read,
+                 const PredicateFactory& make_predicates, size_t workers);
+    ~ParallelScan() override;
+
+    ParallelScan(const ParallelScan&) = delete;
+    ParallelScan& operator=(const ParallelScan&) = delete;
+
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return layout_.columns(); }
+
+    // Gives every worker's SeqScan the filter; call before the first next() or drain().
+    void set_page_filter(const SeqScan::PageFilter& filter);
+    // Gives every worker's SeqScan the snapshot, likewise.
+    void set_snapshot(MvccHeap& mvcc, const Transaction& txn);
+
+    using ChunkConsumer = std::function<void(size_t worker, const DataChunk& chunk)>;
+
+    // Runs the whole scan with worker w passing each chunk that still has rows after
+    // filtering to consume(w, chunk) on its own thread instead of queueing it, and
+    // returns once all workers are done. The chunk is only valid during the call.
+    // Rethrows an exception thrown on a worker or by consume. Use instead of next().
+    void drain(const ChunkConsumer& consume);
+    size_t worker_count() const { return workers_.size(); }
+
+private:
+    struct Morsel {
+        uint64_t first_page;
+        uint64_t last_page;
+    };
+
+    struct Worker {
+        std::mutex mutex;               // guards morsels, which thieves take from too
+        std::deque<Morsel> morsels;
+        std::unique_ptr<SeqScan> scan;
+        std::vector<std::unique_ptr<ChunkPredicate>> predicates;
+        std::thread thread;
+    };
+
+    HeapFile& heap_;
+    const TupleLayout& layout_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    bool started_ = false;
+    const ChunkConsumer* consume_ = nullptr;    // set by drain() before the workers start
+
+    std::mutex mutex_;                  // guards everything below
+    std::condition_variable ready_;     // a chunk was queued or a worker finished
+    std::condition_variable space_;     // a chunk was taken or the scan was cancelled
+    std::deque<DataChunk> results_;
+    std::vector<DataChunk> spare_;      // buffers handed back by the consumer for reuse
+    size_t running_ = 0;
+    bool cancelled_ = false;
+    std::exception_ptr error_;
+
+    void start();
+    void run(Worker& worker, size_t index);
+    std::optional<Morsel> take(size_t index);
+};
+
+/**
+ * Groups its input by the `keys` columns and computes `aggregates` per group with an
+ * AggregateTable, producing the key columns followed by one column per aggregate. The
+ * first next() consumes the whole input; groups then come out in the order they were
+ * first seen. Without keys there is exactly one row, even for empty input.
+ *
+ * Over a ParallelScan, every worker folds its own chunks into a table of its own on its
+ * thread, and the partial tables are merged once the scan is done, so rows never pass
+ * through the scan's queue. Groups then come out in no particular order.
+ */
+class HashAggregate : public Operator {
+public:
+    HashAggregate(std::unique_ptr<Operator> child, std::vector<size_t> keys, std::vector<AggregateSpec> aggregates);
+    HashAggregate(std::unique_ptr<ParallelScan> scan, std::vector<size_t> keys, std::vector<AggregateSpec> aggregates);
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return table_.schema(); }
+
+private:
+    std::unique_ptr<Operator> child_;
+    ParallelScan* scan_ = nullptr;      // child_, when aggregating on its workers
+    std::vector<size_t> keys_;
+    std::vector<AggregateSpec> aggregates_;
+    AggregateTable table_;
+    bool built_ = false;
+    size_t emitted_ = 0;                // groups returned so far
+
+    void build();
+};
+
+// Narrows the selection to rows matching every predicate, applying them in order so
+// later predicates only see rows the earlier ones kept.
+class Filter : public Operator {
+public:
+    Filter(std::unique_ptr<Operator> child, std::vector<std::unique_ptr<ChunkPredicate>> predicates);
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return child_->schema(); }
+
+private:
+    std::unique_ptr<Operator> child_;
+    std::vector<std::unique_ptr<ChunkPredicate>> predicates_;
+};
+
+// Rearranges columns without copying them: output column k is input column columns[k].
+class Projection : public Operator {
+public:
+    Projection(std::unique_ptr<Operator> child, std::vector<size_t> columns);
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return schema_; }
+
+private:
+    std::unique_ptr<Operator> child_;
+    std::vector<size_t> columns_;
+    std::vector<ColumnDef> schema_;
+    DataChunk input_;
+};
+
+// Passes through the first `limit` rows and stops pulling from its child after that.
+class Limit : public Operator {
+public:
+    Limit(std::unique_ptr<Operator> child, unsigned long long limit);
+    bool next(DataChunk& chunk) override;
+    const std::vector<ColumnDef>& schema() const override { return child_->schema(); }
+
+private:
+    std::unique_ptr<Operator> child_;
+    unsigned long long remaining_;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include "execution/vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Comparison kernels over contiguous column arrays that produce bitmaps: bit i of
+// out[i / 64] is set when a[i] OP rhs, with rhs the constant `c` (the *_const tables)
+// or b[i] (the *_column tables). Words cover rows [0, n); bits past n in the last word
+// are zero. Kernels are indexed by CmpOp.
+//
+// Several instruction sets are compiled into the binary and simd_kernels() picks the
+// widest one the CPU supports (AVX-512, AVX2, SSE4.2, then portable scalar code).
+enum class CmpOp : uint8_t { Eq, Neq, Lt, Lte, Gt, Gte };
+
+constexpr size_t BITMAP_WORDS = (VECTOR_SIZE + 63) / 64;
+
+template<typename T>
+using CmpKernel = void (*)(const T* a, const T* b, T c, size_t n, uint64_t* out);
+
+// Whether every bit of a key's hash is set in one 256-bit BloomFilterMap block.
+using BloomKernel = bool (*)(const uint8_t* block, uint64_t hash);
+
+struct SimdKernels {
+    const char* isa;
+    CmpKernel<long long> int_const[6], int_column[6];
+    CmpKernel<double> real_const[6], real_column[6];
+    // Byte kernels compare BOOL vectors (0/1) and turn NULL flags into bitmaps.
+    CmpKernel<uint8_t> byte_const[6], byte_column[6];
+    BloomKernel bloom_contains;
+};
+
+// Best kernels for the running CPU; chosen on first use.
+const SimdKernels& simd_kernels();
+
+// Every kernel set this CPU can run, widest last (always starts with scalar).
+std::vector<const SimdKernels*> supported_simd_kernels();
+
+inline size_t bitmap_words(size_t n) { return (n + 63) / 64; }
+
+inline void bitmap_and(uint64_t* dst, const uint64_t* src, size_t words) {
+    for (size_t w = 0; w < words; ++w) dst[w] &= src[w];
+}
+
+inline void bitmap_or(uint64_t* dst, const uint64_t* src, size_t words) {
+    for (size_t w = 0; w < words; ++w) dst[w] |= src[w];
+}
+
+inline void bitmap_andnot(uint64_t* dst, const uint64_t* src, size_t words) {
+    for (size_t w = 0; w < words; ++w) dst[w] &= ~src[w];
+}
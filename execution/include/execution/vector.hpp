@@ -0,0 +1,75 @@
+#pragma once
+#include "parser/ast.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Rows per batch flowing between operators.
+constexpr size_t VECTOR_SIZE = 1024;
+
+// Values of one column for a batch of rows, stored contiguously by type. Only the
+// array matching `type` is used, and it always holds VECTOR_SIZE entries so kernels
+// can index it by row without bounds checks. NULL rows hold 0 / "" in the value array.
+struct ColumnVector {
+    DataType::Kind type = DataType::Int;
+    std::vector<long long> ints;            // INT
+    std::vector<double> reals;              // REAL
+    std::vector<uint8_t> bools;             // BOOL, 0/1
+    std::vector<std::string_view> texts;    // TEXT, views into the chunk's StringHeap
+    std::vector<uint8_t> nulls;             // 1 = NULL
+
+    void init(DataType::Kind kind);
+};
+
+// Append-only storage for the TEXT values of a batch. Memory is allocated in blocks
+// that never move, so views handed out stay valid until clear().
+class StringHeap {
+public:
+    std::string_view add(std::string_view s);
+    void clear();
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_ = 0;      // block currently written
+    size_t used_ = 0;       // bytes used in blocks_[block_]
+    std::vector<std::unique_ptr<char[]>> oversized_;
+};
+
+/**
+ * A batch of up to VECTOR_SIZE rows in columnar form. `count` rows were produced by
+ * the scan; `sel` lists, in ascending order, the ones still active after filtering,
+ * so operators drop rows by shrinking `sel` instead of moving data. Columns a query
+ * never reads may be left unmaterialized (`materialized[c]` is false).
+ *
+ * A chunk's contents are valid until it is passed to the producing operator again.
+ */
+struct DataChunk {
+    std::vector<ColumnVector> columns;
+    std::vector<bool> materialized;
+    size_t count = 0;
+    std::vector<uint16_t> sel;
+    StringHeap strings;
+
+    size_t size() const { return sel.size(); }
+    // Sets up columns of the given types (keeping allocations when they already match).
+    void init(const std::vector<ColumnDef>& schema);
+    // Marks rows [0, count) active.
+    void select_all();
+    // Row `row` of column `col` as a Value.
+    Value value(size_t col, size_t row) const;
+};
+
+// Row accessor over one row of a chunk, for the scalar Evaluator.
+struct ChunkRow {
+    const DataChunk* chunk;
+    size_t row;
+
+    bool is_null(size_t col) const { return chunk->columns[col].nulls[row]; }
+    long long get_int(size_t col) const { return chunk->columns[col].ints[row]; }
+    double get_real(size_t col) const { return chunk->columns[col].reals[row]; }
+    std::string_view get_text(size_t col) const { return chunk->columns[col].texts[row]; }
+    bool get_bool(size_t col) const { return chunk->columns[col].bools[row]; }
+};
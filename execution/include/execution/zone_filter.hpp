@@ -0,0 +1,46 @@
+#pragma once
+#include "parser/ast.hpp"
+#include "storage/tuple.hpp"
+#include "storage/zone_map.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Decides from a heap file's ZoneMap which pages a scan can skip. The WHERE conjuncts
+ * that compare an INT, REAL or BOOL column with a literal (=, <, <=, >, >=, either way
+ * round) or are a bare BOOL column confine that column to a range. A page whose zone
+ * for such a column lies outside its range, or holds no non-NULL values, has no
+ * matching rows, since a comparison with NULL is never true. Other conjuncts are left
+ * to the filter above the scan.
+ *
+ * may_match() only reads the map, so one filter serves the workers of a ParallelScan.
+ */
+class ZoneFilter {
+public:
+    // `conjuncts` are those of a normalized WHERE clause over `layout`.
+    ZoneFilter(ZoneMap& zones, const ExprArena& arena, const std::vector<ExprId>& conjuncts,
+               const TupleLayout& layout);
+
+    // False if no conjunct confines a column, so every page would pass.
+    bool useful() const { return never_ || !ranges_.empty(); }
+    // False if data page `page_id` cannot hold a row satisfying the conjuncts.
+    bool may_match(uint64_t page_id) const;
+
+private:
+    // Inclusive range of one column: lo/hi for INT and BOOL, rlo/rhi for REAL.
+    struct Range {
+        size_t column;
+        DataType::Kind type;
+        int64_t lo;
+        int64_t hi;
+        double rlo;
+        double rhi;
+    };
+
+    ZoneMap& zones_;
+    std::vector<Range> ranges_;
+    bool never_ = false;        // some range is empty: no page can match
+
+    Range& range(size_t column, DataType::Kind type);
+    void constrain(const ExprArena& arena, ExprId conjunct, const TupleLayout& layout);
+};
@@ -0,0 +1,341 @@
+#include "execution/aggregate.hpp"
+#include "execution/bytecode.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+
+namespace {
+
+constexpr size_t INITIAL_SLOTS = 1024;
+constexpr size_t PREFETCH_DISTANCE = 8;
+constexpr uint64_t HASH_SEED = 0x9e3779b97f4a7c15ULL;
+constexpr uint64_t NULL_BITS = 0x5bd1e9955bd1e995ULL;
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+const char* func_name(AggregateFunc func) {
+    switch (func) {
+        case AggregateFunc::Count: return "count";
+        case AggregateFunc::Sum: return "sum";
+        case AggregateFunc::Min: return "min";
+        case AggregateFunc::Max: return "max";
+        case AggregateFunc::Avg: return "avg";
+    }
+    return "?";
+}
+
+template<typename T>
+T& value_of(long long& i, double& f) {
+    if constexpr (std::is_same_v<T, double>) return f;
+    else return i;
+}
+
+/*
+* Applies fn(state, value) to the non-NULL argument of every selected row, counting
+* them. Without `groups` all rows go to the single state, accumulated in a local so the
+* loop stays in registers.
+*/
+template<typename State, typename T, typename Fn>
+void fold(const T* values, const uint8_t* nulls, const std::vector<uint16_t>& sel, const uint32_t* groups,
+          State* states, size_t stride, Fn fn) {
+    size_t n = sel.size();
+    if (!groups) {
+        State acc = *states;
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t r = sel[i];
+            if (nulls[r]) continue;
+            fn(acc, values[r]);
+            acc.count++;
+        }
+        *states = acc;
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        uint16_t r = sel[i];
+        if (nulls[r]) continue;
+        State& s = states[size_t(groups[i]) * stride];
+        fn(s, values[r]);
+        s.count++;
+    }
+}
+
+// Sums, minima and maxima of one argument type.
+template<typename State, typename T>
+void fold_typed(AggregateFunc func, const T* values, const uint8_t* nulls, const std::vector<uint16_t>& sel,
+                const uint32_t* groups, State* states, size_t stride) {
+    switch (func) {
+        case AggregateFunc::Count:
+            fold(values, nulls, sel, groups, states, stride, [](State&, T) {});
+            break;
+        case AggregateFunc::Sum:
+            fold(values, nulls, sel, groups, states, stride, [](State& s, T v) {
+                if constexpr (std::is_same_v<T, double>) {
+                    s.f += v;
+                } else {
+                    s.i = static_cast<long long>(static_cast<unsigned long long>(s.i) + static_cast<unsigned long long>(v));
+                }
+            });
+            break;
+        case AggregateFunc::Min:
+            fold(values, nulls, sel, groups, states, stride, [](State& s, T v) {
+                T& m = value_of<T>(s.i, s.f);
+                if (s.count == 0 || v < m) m = v;
+            });
+            break;
+        case AggregateFunc::Max:
+            fold(values, nulls, sel, groups, states, stride, [](State& s, T v) {
+                T& m = value_of<T>(s.i, s.f);
+                if (s.count == 0 || v > m) m = v;
+            });
+            break;
+        case AggregateFunc::Avg:
+            fold(values, nulls, sel, groups, states, stride, [](State& s, T v) { s.f += static_cast<double>(v); });
+            break;
+    }
+}
+
+}
+
+
+DataType::Kind aggregate_type(const AggregateSpec& spec, const std::vector<ColumnDef>& input) {
+    if (spec.func == AggregateFunc::Count) return DataType::Int;
+    DataType::Kind arg = input[*spec.column].data_type.kind;
+    if (arg != DataType::Int && arg != DataType::Real) {
+        throw CompileError(std::string(func_name(spec.func)) + "(" + input[*spec.column].name +
+                           ") needs an INT or REAL column");
+    }
+    return spec.func == AggregateFunc::Avg ? DataType::Real : arg;
+}
+
+
+AggregateTable::AggregateTable(const std::vector<ColumnDef>& input, std::vector<size_t> keys,
+                               std::vector<AggregateSpec> aggregates)
+    : keys_(std::move(keys)), aggregates_(std::move(aggregates)), slots_(INITIAL_SLOTS, 0) {
+    for (size_t k : keys_) {
+        key_types_.push_back(input[k].data_type.kind);
+        schema_.push_back(input[k]);
+    }
+    for (const AggregateSpec& spec : aggregates_) {
+        arg_types_.push_back(spec.column ? input[*spec.column].data_type.kind : DataType::Int);
+        std::string name = func_name(spec.func);
+        name += "(" + (spec.column ? input[*spec.column].name : std::string("*")) + ")";
+        schema_.push_back(ColumnDef{std::move(name), DataType{aggregate_type(spec, input), ""}});
+    }
+    row_hashes_.resize(VECTOR_SIZE);
+    row_keys_.resize(VECTOR_SIZE * keys_.size());
+    row_groups_.resize(VECTOR_SIZE);
+    // An aggregate over no rows still has its one (empty) group.
+    if (keys_.empty()) find_or_add(HASH_SEED, nullptr);
+}
+
+bool AggregateTable::same_key(const KeyPart* a, const KeyPart* b) const {
+    for (size_t k = 0; k < keys_.size(); ++k) {
+        if (a[k].null != b[k].null) return false;
+        if (a[k].null) continue;
+        if (key_types_[k] == DataType::Text ? a[k].text != b[k].text : a[k].bits != b[k].bits) return false;
+    }
+    return true;
+}
+
+uint32_t AggregateTable::find_or_add(uint64_t hash, const KeyPart* key) {
+    uint64_t tag = hash >> 32 << 32;
+    size_t mask = slots_.size() - 1;
+    size_t s = hash & mask;
+    for (; slots_[s] != 0; s = (s + 1) & mask) {
+        uint64_t slot = slots_[s];
+        auto g = static_cast<uint32_t>(slot - 1);
+        if ((slot & ~uint64_t(UINT32_MAX)) == tag && same_key(&key_parts_[size_t(g) * keys_.size()], key)) {
+            return g;
+        }
+    }
+
+    auto g = static_cast<uint32_t>(hashes_.size());
+    hashes_.push_back(hash);
+    for (size_t k = 0; k < keys_.size(); ++k) {
+        KeyPart part = key[k];
+        if (key_types_[k] == DataType::Text && !part.null) part.text = strings_.add(part.text);
+        key_parts_.push_back(part);
+    }
+    states_.resize(states_.size() + aggregates_.size(), State{0, 0, 0.0});
+
+    slots_[s] = tag | (uint64_t(g) + 1);
+    if (hashes_.size() * 2 > slots_.size()) grow();
+    return g;
+}
+
+// Doubles the slot array and reinserts every group from its stored hash.
+void AggregateTable::grow() {
+    slots_.assign(slots_.size() * 2, 0);
+    size_t mask = slots_.size() - 1;
+    for (size_t g = 0; g < hashes_.size(); ++g) {
+        size_t s = hashes_[g] & mask;
+        while (slots_[s] != 0) s = (s + 1) & mask;
+        slots_[s] = (hashes_[g] >> 32 << 32) | (uint64_t(g) + 1);
+    }
+}
+
+void AggregateTable::add(const DataChunk& chunk) {
+    size_t n = chunk.sel.size();
+    if (n == 0) return;
+    const std::vector<uint16_t>& sel = chunk.sel;
+    const uint32_t* groups = nullptr;
+
+    if (!keys_.empty()) {
+        size_t width = keys_.size();
+        for (size_t i = 0; i < n; ++i) row_hashes_[i] = HASH_SEED;
+        for (size_t k = 0; k < width; ++k) {
+            const ColumnVector& col = chunk.columns[keys_[k]];
+            for (size_t i = 0; i < n; ++i) {
+                uint16_t r = sel[i];
+                KeyPart& part = row_keys_[i * width + k];
+                part.null = col.nulls[r];
+                part.bits = 0;
+                part.text = std::string_view();
+                uint64_t h;
+                if (part.null) {
+                    h = NULL_BITS;
+                } else {
+                    switch (col.type) {
+                        case DataType::Int: part.bits = static_cast<uint64_t>(col.ints[r]); break;
+                        case DataType::Real: {
+                            double v = col.reals[r] == 0.0 ? 0.0 : col.reals[r];
+                            std::memcpy(&part.bits, &v, sizeof(v));
+                            break;
+                        }
+                        case DataType::Bool: part.bits = col.bools[r]; break;
+                        case DataType::Text: part.text = col.texts[r]; break;
+                        case DataType::Custom: break;
+                    }
+                    h = col.type == DataType::Text ? std::hash<std::string_view>()(part.text) : part.bits;
+                }
+                row_hashes_[i] = mix(row_hashes_[i] + h + HASH_SEED);
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            if (i + PREFETCH_DISTANCE < n) {
+                __builtin_prefetch(&slots_[row_hashes_[i + PREFETCH_DISTANCE] & (slots_.size() - 1)]);
+            }
+            row_groups_[i] = find_or_add(row_hashes_[i], &row_keys_[i * width]);
+        }
+        groups = row_groups_.data();
+    }
+
+    for (size_t a = 0; a < aggregates_.size(); ++a) update(a, chunk, groups);
+}
+
+void AggregateTable::update(size_t a, const DataChunk& chunk, const uint32_t* groups) {
+    const AggregateSpec& spec = aggregates_[a];
+    State* states = states_.data() + a;
+    size_t stride = aggregates_.size();
+    if (!spec.column) {
+        // COUNT(*): every selected row counts.
+        if (!groups) {
+            states->count += static_cast<long long>(chunk.sel.size());
+        } else {
+            for (size_t i = 0; i < chunk.sel.size(); ++i) states[size_t(groups[i]) * stride].count++;
+        }
+        return;
+    }
+    const ColumnVector& col = chunk.columns[*spec.column];
+    const uint8_t* nulls = col.nulls.data();
+    switch (col.type) {
+        case DataType::Int:
+            fold_typed(spec.func, col.ints.data(), nulls, chunk.sel, groups, states, stride);
+            break;
+        case DataType::Real:
+            fold_typed(spec.func, col.reals.data(), nulls, chunk.sel, groups, states, stride);
+            break;
+        // Only COUNT takes a BOOL or TEXT argument.
+        case DataType::Bool:
+            fold(col.bools.data(), nulls, chunk.sel, groups, states, stride, [](State&, uint8_t) {});
+            break;
+        case DataType::Text:
+            fold(col.texts.data(), nulls, chunk.sel, groups, states, stride, [](State&, std::string_view) {});
+            break;
+        case DataType::Custom: break;
+    }
+}
+
+void AggregateTable::merge(const AggregateTable& other) {
+    size_t stride = aggregates_.size();
+    for (size_t og = 0; og < other.group_count(); ++og) {
+        uint32_t g = find_or_add(other.hashes_[og], other.key_parts_.data() + og * keys_.size());
+        for (size_t a = 0; a < stride; ++a) {
+            State& s = states_[size_t(g) * stride + a];
+            const State& o = other.states_[og * stride + a];
+            if (o.count == 0) continue;
+            bool real = arg_types_[a] == DataType::Real;
+            switch (aggregates_[a].func) {
+                case AggregateFunc::Count: break;
+                case AggregateFunc::Sum:
+                    if (real) s.f += o.f;
+                    else s.i = static_cast<long long>(static_cast<unsigned long long>(s.i) + static_cast<unsigned long long>(o.i));
+                    break;
+                case AggregateFunc::Min:
+                    if (real && (s.count == 0 || o.f < s.f)) s.f = o.f;
+                    if (!real && (s.count == 0 || o.i < s.i)) s.i = o.i;
+                    break;
+                case AggregateFunc::Max:
+                    if (real && (s.count == 0 || o.f > s.f)) s.f = o.f;
+                    if (!real && (s.count == 0 || o.i > s.i)) s.i = o.i;
+                    break;
+                case AggregateFunc::Avg: s.f += o.f; break;
+            }
+            s.count += o.count;
+        }
+    }
+}
+
+void AggregateTable::emit(size_t first, DataChunk& chunk) const {
+    chunk.init(schema_);
+    chunk.materialized.assign(schema_.size(), true);
+    size_t n = std::min(VECTOR_SIZE, group_count() - std::min(first, group_count()));
+    size_t width = keys_.size();
+    for (size_t k = 0; k < width; ++k) {
+        ColumnVector& col = chunk.columns[k];
+        for (size_t r = 0; r < n; ++r) {
+            const KeyPart& part = key_parts_[(first + r) * width + k];
+            col.nulls[r] = part.null;
+            switch (col.type) {
+                case DataType::Int: col.ints[r] = static_cast<long long>(part.bits); break;
+                case DataType::Real: std::memcpy(&col.reals[r], &part.bits, sizeof(double)); break;
+                case DataType::Bool: col.bools[r] = static_cast<uint8_t>(part.bits); break;
+                case DataType::Text: col.texts[r] = part.null ? std::string_view() : chunk.strings.add(part.text); break;
+                case DataType::Custom: break;
+            }
+        }
+    }
+    for (size_t a = 0; a < aggregates_.size(); ++a) {
+        ColumnVector& col = chunk.columns[width + a];
+        AggregateFunc func = aggregates_[a].func;
+        for (size_t r = 0; r < n; ++r) {
+            const State& s = states_[(first + r) * aggregates_.size() + a];
+            if (func == AggregateFunc::Count) {
+                // A reused chunk keeps its old null flags, so this one is written too.
+                col.nulls[r] = 0;
+                col.ints[r] = s.count;
+                continue;
+            }
+            col.nulls[r] = s.count == 0;
+            if (func == AggregateFunc::Avg) {
+                col.reals[r] = s.count == 0 ? 0.0 : s.f / static_cast<double>(s.count);
+            } else if (col.type == DataType::Real) {
+                col.reals[r] = s.count == 0 ? 0.0 : s.f;
+            } else {
+                col.ints[r] = s.count == 0 ? 0 : s.i;
+            }
+        }
+    }
+    chunk.count = n;
+    chunk.select_all();
+}
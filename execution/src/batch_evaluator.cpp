@@ -0,0 +1,181 @@
+#include "execution/batch_evaluator.hpp"
+
+BatchEvaluator::BatchEvaluator(const Program& program)
+    : p_(program), regs_(program.num_regs), consts_(program.consts) {
+    for (const auto& t : program.text_consts) {
+        consts_[t.index].s = std::string_view(program.strings).substr(t.offset, t.length);
+    }
+    for (auto& r : regs_) {
+        r.own_i.resize(VECTOR_SIZE);
+        r.own_f.resize(VECTOR_SIZE);
+        r.own_s.resize(VECTOR_SIZE);
+        r.own_null.resize(VECTOR_SIZE);
+    }
+}
+
+void BatchEvaluator::run(const DataChunk& chunk, const uint16_t* sel, size_t n) {
+    for (const Instr& in : p_.code) {
+        VecReg& d = regs_[in.dst];
+        const VecReg& a = regs_[in.a];
+        const VecReg& b = regs_[in.b];
+        long long* di = d.own_i.data();
+        double* df = d.own_f.data();
+        uint8_t* dn = d.own_null.data();
+
+        switch (in.op) {
+            case OpCode::LoadColInt: {
+                const ColumnVector& col = chunk.columns[in.arg];
+                d.i = col.ints.data(); d.null = col.nulls.data();
+                continue;
+            }
+            case OpCode::LoadColReal: {
+                const ColumnVector& col = chunk.columns[in.arg];
+                d.f = col.reals.data(); d.null = col.nulls.data();
+                continue;
+            }
+            case OpCode::LoadColText: {
+                const ColumnVector& col = chunk.columns[in.arg];
+                d.s = col.texts.data(); d.null = col.nulls.data();
+                continue;
+            }
+            case OpCode::LoadColBool: {
+                const ColumnVector& col = chunk.columns[in.arg];
+                for (size_t k = 0; k < n; ++k) di[sel[k]] = col.bools[sel[k]];
+                d.i = di; d.null = col.nulls.data();
+                continue;
+            }
+            case OpCode::LoadConst: {
+                const Reg& c = consts_[in.arg];
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    di[r] = c.i; df[r] = c.f; d.own_s[r] = c.s; dn[r] = c.null;
+                }
+                d.s = d.own_s.data();
+                break;
+            }
+            case OpCode::LoadNull:
+                for (size_t k = 0; k < n; ++k) { di[sel[k]] = 0; d.own_s[sel[k]] = {}; dn[sel[k]] = 1; }
+                d.s = d.own_s.data();
+                break;
+            case OpCode::IntToReal:
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    dn[r] = a.null[r]; df[r] = static_cast<double>(a.i[r]);
+                }
+                break;
+
+#define SIMPLEDB_VCMP(OP, FIELD, EXPR) \
+            case OpCode::OP: \
+                for (size_t k = 0; k < n; ++k) { \
+                    uint16_t r = sel[k]; \
+                    dn[r] = a.null[r] | b.null[r]; di[r] = (a.FIELD[r] EXPR b.FIELD[r]); \
+                } \
+                break;
+            SIMPLEDB_VCMP(CmpIntEq, i, ==)  SIMPLEDB_VCMP(CmpIntNeq, i, !=)
+            SIMPLEDB_VCMP(CmpIntLt, i, <)   SIMPLEDB_VCMP(CmpIntLte, i, <=)
+            SIMPLEDB_VCMP(CmpIntGt, i, >)   SIMPLEDB_VCMP(CmpIntGte, i, >=)
+            SIMPLEDB_VCMP(CmpRealEq, f, ==) SIMPLEDB_VCMP(CmpRealNeq, f, !=)
+            SIMPLEDB_VCMP(CmpRealLt, f, <)  SIMPLEDB_VCMP(CmpRealLte, f, <=)
+            SIMPLEDB_VCMP(CmpRealGt, f, >)  SIMPLEDB_VCMP(CmpRealGte, f, >=)
+            // NULL text rows hold empty views, so comparing them is safe.
+            SIMPLEDB_VCMP(CmpTextEq, s, ==) SIMPLEDB_VCMP(CmpTextNeq, s, !=)
+            SIMPLEDB_VCMP(CmpTextLt, s, <)  SIMPLEDB_VCMP(CmpTextLte, s, <=)
+            SIMPLEDB_VCMP(CmpTextGt, s, >)  SIMPLEDB_VCMP(CmpTextGte, s, >=)
+#undef SIMPLEDB_VCMP
+
+#define SIMPLEDB_VARITH_INT(OP, BUILTIN) \
+            case OpCode::OP: \
+                for (size_t k = 0; k < n; ++k) { \
+                    uint16_t r = sel[k]; \
+                    dn[r] = a.null[r] | b.null[r] | BUILTIN(a.i[r], b.i[r], &di[r]); \
+                } \
+                break;
+            SIMPLEDB_VARITH_INT(AddInt, __builtin_add_overflow)
+            SIMPLEDB_VARITH_INT(SubInt, __builtin_sub_overflow)
+            SIMPLEDB_VARITH_INT(MulInt, __builtin_mul_overflow)
+#undef SIMPLEDB_VARITH_INT
+            case OpCode::DivInt:
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    long long x = a.i[r], y = b.i[r];
+                    bool null = a.null[r] || b.null[r] || y == 0 || (y == -1 && x == INT64_MIN);
+                    dn[r] = null;
+                    di[r] = null ? 0 : x / y;
+                }
+                break;
+
+#define SIMPLEDB_VARITH_REAL(OP, EXPR) \
+            case OpCode::OP: \
+                for (size_t k = 0; k < n; ++k) { \
+                    uint16_t r = sel[k]; \
+                    dn[r] = a.null[r] | b.null[r]; df[r] = a.f[r] EXPR b.f[r]; \
+                } \
+                break;
+            SIMPLEDB_VARITH_REAL(AddReal, +)
+            SIMPLEDB_VARITH_REAL(SubReal, -)
+            SIMPLEDB_VARITH_REAL(MulReal, *)
+#undef SIMPLEDB_VARITH_REAL
+            case OpCode::DivReal:
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    bool null = a.null[r] || b.null[r] || b.f[r] == 0.0;
+                    dn[r] = null;
+                    df[r] = null ? 0.0 : a.f[r] / b.f[r];
+                }
+                break;
+            case OpCode::NegInt:
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    bool null = a.null[r] || a.i[r] == INT64_MIN;
+                    dn[r] = null;
+                    di[r] = null ? 0 : -a.i[r];
+                }
+                break;
+            case OpCode::NegReal:
+                for (size_t k = 0; k < n; ++k) { uint16_t r = sel[k]; dn[r] = a.null[r]; df[r] = -a.f[r]; }
+                break;
+            case OpCode::Not:
+                for (size_t k = 0; k < n; ++k) { uint16_t r = sel[k]; dn[r] = a.null[r]; di[r] = !a.i[r]; }
+                break;
+
+            case OpCode::AndShort:
+            case OpCode::OrShort:
+                continue;
+            case OpCode::And3:
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    bool a_false = !a.null[r] && !a.i[r];
+                    bool b_false = !b.null[r] && !b.i[r];
+                    di[r] = !(a_false || b_false);
+                    dn[r] = !a_false && !b_false && (a.null[r] || b.null[r]);
+                }
+                break;
+            case OpCode::Or3:
+                for (size_t k = 0; k < n; ++k) {
+                    uint16_t r = sel[k];
+                    bool a_true = !a.null[r] && a.i[r];
+                    bool b_true = !b.null[r] && b.i[r];
+                    di[r] = a_true || b_true;
+                    dn[r] = !a_true && !b_true && (a.null[r] || b.null[r]);
+                }
+                break;
+        }
+        d.i = di; d.f = df; d.null = dn;
+    }
+}
+
+void BatchEvaluator::select(const DataChunk& chunk, std::vector<uint16_t>& sel) {
+    if (p_.result_is_null_literal) {
+        sel.clear();
+        return;
+    }
+    run(chunk, sel.data(), sel.size());
+    const VecReg& res = regs_[p_.result];
+    size_t kept = 0;
+    for (size_t k = 0; k < sel.size(); ++k) {
+        uint16_t r = sel[k];
+        sel[kept] = r;
+        kept += !res.null[r] & (res.i[r] != 0);
+    }
+    sel.resize(kept);
+}
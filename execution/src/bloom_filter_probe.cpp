@@ -0,0 +1,44 @@
+#include "execution/bloom_filter_probe.hpp"
+#include "execution/simd.hpp"
+
+
+BloomFilterProbe::BloomFilterProbe(BloomFilterMap& blooms, const ExprArena& arena,
+                                   const std::vector<ExprId>& conjuncts, const TupleLayout& layout)
+    : blooms_(blooms) {
+    for (ExprId conjunct : conjuncts) {
+        const Expr& e = arena[conjunct];
+        if (e.kind != Expr::BinaryOp || e.binary_op() != Expr::Binary::Eq) continue;
+        ExprId col_id = e.lhs(), lit_id = e.rhs();
+        if (arena[col_id].kind != Expr::Column) std::swap(col_id, lit_id);
+        const Expr& lit = arena[lit_id];
+        if (arena[col_id].kind != Expr::Column || lit.kind != Expr::Literal) continue;
+        auto col = layout.column_index(arena.column_name(col_id));
+        if (!col || blooms_.filter_of(*col) < 0) continue;
+
+        uint64_t hash;
+        DataType::Kind type = layout.type(*col);
+        if (type == DataType::Int && lit.literal_kind == Value::Int) {
+            hash = BloomFilterMap::hash_int(lit.i);
+        } else if (type == DataType::Real && lit.literal_kind == Value::Int) {
+            hash = BloomFilterMap::hash_real(static_cast<double>(lit.i));
+        } else if (type == DataType::Real && lit.literal_kind == Value::Float) {
+            hash = BloomFilterMap::hash_real(lit.f);
+        } else if (type == DataType::Text && lit.literal_kind == Value::String) {
+            hash = BloomFilterMap::hash_text(arena.str(lit.str));
+        } else {
+            continue;
+        }
+        size_t block = blooms_.filter_of(*col) * blooms_.blocks() + BloomFilterMap::block_of(hash, blooms_.blocks());
+        offsets_.push_back(block * BloomFilterMap::BLOCK_BYTES);
+        keys_.push_back(hash);
+    }
+}
+
+bool BloomFilterProbe::may_match(uint64_t page_id) const {
+    BloomKernel contains = simd_kernels().bloom_contains;
+    bool match = true;
+    blooms_.read(page_id, [&](const uint8_t* filters) {
+        for (size_t k = 0; k < keys_.size() && match; ++k) match = contains(filters + offsets_[k], keys_[k]);
+    });
+    return match;
+}
@@ -0,0 +1,208 @@
+#include "execution/bytecode.hpp"
+#include <limits>
+
+namespace {
+
+// Static type of a compiled subexpression. NullLit is the bare NULL literal, which
+// adopts whatever type its context requires.
+enum class Ty { Int, Real, Text, Bool, NullLit };
+
+const char* ty_name(Ty t) {
+    switch (t) {
+        case Ty::Int: return "INT";
+        case Ty::Real: return "REAL";
+        case Ty::Text: return "TEXT";
+        case Ty::Bool: return "BOOL";
+        case Ty::NullLit: return "NULL";
+    }
+    return "?";
+}
+
+struct Operand {
+    uint16_t reg;
+    Ty ty;
+};
+
+class Compiler {
+public:
+    Compiler(const ExprArena& arena, const std::vector<ColumnDef>& columns)
+        : a(arena), columns(columns) {}
+
+    Program finish(ExprId root) {
+        Operand res = compile(root);
+        prog.result = res.reg;
+        prog.result_is_null_literal = res.ty == Ty::NullLit;
+        switch (res.ty) {
+            case Ty::Int: prog.result_type = DataType::Int; break;
+            case Ty::Real: prog.result_type = DataType::Real; break;
+            case Ty::Text: prog.result_type = DataType::Text; break;
+            case Ty::Bool:
+            case Ty::NullLit: prog.result_type = DataType::Bool; break;
+        }
+        return std::move(prog);
+    }
+
+private:
+    const ExprArena& a;
+    const std::vector<ColumnDef>& columns;
+    Program prog;
+
+    uint16_t new_reg() {
+        if (prog.num_regs == std::numeric_limits<uint16_t>::max()) throw CompileError("expression too large");
+        return prog.num_regs++;
+    }
+
+    uint32_t here() const { return static_cast<uint32_t>(prog.code.size()); }
+
+    uint16_t emit(OpCode op, uint16_t x = 0, uint16_t y = 0, uint32_t arg = 0) {
+        uint16_t dst = new_reg();
+        prog.code.push_back(Instr{op, dst, x, y, arg});
+        return dst;
+    }
+
+    uint16_t emit_const(Reg value, std::string_view text = {}, bool is_text = false) {
+        uint32_t idx = static_cast<uint32_t>(prog.consts.size());
+        prog.consts.push_back(value);
+        if (is_text) {
+            prog.text_consts.push_back({idx, static_cast<uint32_t>(prog.strings.size()), static_cast<uint32_t>(text.size())});
+            prog.strings.append(text);
+        }
+        return emit(OpCode::LoadConst, 0, 0, idx);
+    }
+
+    Operand compile(ExprId id) {
+        const Expr& e = a[id];
+        switch (e.kind) {
+            case Expr::Literal: return compile_literal(e);
+            case Expr::Column: return compile_column(id);
+            case Expr::Param: throw CompileError("cannot evaluate an unbound parameter");
+            case Expr::UnaryOp: return compile_unary(e);
+            case Expr::BinaryOp: return compile_binary(e);
+        }
+        throw CompileError("unknown expression kind");
+    }
+
+    Operand compile_literal(const Expr& e) {
+        Reg r{};
+        switch (e.literal_kind) {
+            case Value::Null: return {emit(OpCode::LoadNull), Ty::NullLit};
+            case Value::Bool: r.i = e.b; return {emit_const(r), Ty::Bool};
+            case Value::Int: r.i = e.i; return {emit_const(r), Ty::Int};
+            case Value::Float: r.f = e.f; return {emit_const(r), Ty::Real};
+            case Value::String: return {emit_const(r, a.str(e.str), true), Ty::Text};
+        }
+        throw CompileError("unknown literal kind");
+    }
+
+    Operand compile_column(ExprId id) {
+        std::string_view name = a.column_name(id);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].name != name) continue;
+            uint32_t col = static_cast<uint32_t>(i);
+            switch (columns[i].data_type.kind) {
+                case DataType::Int: return {emit(OpCode::LoadColInt, 0, 0, col), Ty::Int};
+                case DataType::Real: return {emit(OpCode::LoadColReal, 0, 0, col), Ty::Real};
+                case DataType::Text: return {emit(OpCode::LoadColText, 0, 0, col), Ty::Text};
+                case DataType::Bool: return {emit(OpCode::LoadColBool, 0, 0, col), Ty::Bool};
+                case DataType::Custom:
+                    throw CompileError("column '" + std::string(name) + "' has unsupported type " + columns[i].data_type.custom);
+            }
+        }
+        throw CompileError("unknown column '" + std::string(name) + "'");
+    }
+
+    Operand compile_unary(const Expr& e) {
+        Operand x = compile(e.lhs());
+        if (x.ty == Ty::NullLit) return x;
+        if (e.unary_op() == Expr::Unary::Not) {
+            if (x.ty != Ty::Bool) throw CompileError(std::string("NOT expects BOOL, got ") + ty_name(x.ty));
+            return {emit(OpCode::Not, x.reg), Ty::Bool};
+        }
+        if (x.ty == Ty::Int) return {emit(OpCode::NegInt, x.reg), Ty::Int};
+        if (x.ty == Ty::Real) return {emit(OpCode::NegReal, x.reg), Ty::Real};
+        throw CompileError(std::string("unary minus expects a number, got ") + ty_name(x.ty));
+    }
+
+    Operand compile_logical(const Expr& e) {
+        bool is_and = e.binary_op() == Expr::Binary::And;
+        Operand l = compile(e.lhs());
+        check_bool(l);
+        uint16_t dst = new_reg();
+        size_t short_at = prog.code.size();
+        prog.code.push_back(Instr{is_and ? OpCode::AndShort : OpCode::OrShort, dst, l.reg, 0, 0});
+        Operand r = compile(e.rhs());
+        check_bool(r);
+        prog.code.push_back(Instr{is_and ? OpCode::And3 : OpCode::Or3, dst, l.reg, r.reg, 0});
+        prog.code[short_at].arg = here();
+        return {dst, Ty::Bool};
+    }
+
+    void check_bool(Operand x) {
+        if (x.ty == Ty::NullLit) return;
+        if (x.ty != Ty::Bool) throw CompileError(std::string("AND/OR expect BOOL, got ") + ty_name(x.ty));
+    }
+
+    // Brings a numeric operand to REAL if the other side is REAL.
+    uint16_t widen(Operand x, Ty target) {
+        if (x.ty == Ty::Int && target == Ty::Real) return emit(OpCode::IntToReal, x.reg);
+        return x.reg;
+    }
+
+    Operand compile_binary(const Expr& e) {
+        auto op = e.binary_op();
+        if (op == Expr::Binary::And || op == Expr::Binary::Or) return compile_logical(e);
+
+        Operand l = compile(e.lhs());
+        Operand r = compile(e.rhs());
+        bool is_cmp = op >= Expr::Binary::Eq && op <= Expr::Binary::Gte;
+        if (l.ty == Ty::NullLit || r.ty == Ty::NullLit) {
+            // NULL takes the other side's type, which must still suit the operator.
+            Ty other = l.ty == Ty::NullLit ? r.ty : l.ty;
+            if (!is_cmp && other != Ty::Int && other != Ty::Real && other != Ty::NullLit) {
+                throw CompileError(std::string("arithmetic expects numbers, got ") + ty_name(other));
+            }
+            return {emit(OpCode::LoadNull), is_cmp ? Ty::Bool : other};
+        }
+
+        bool numeric = (l.ty == Ty::Int || l.ty == Ty::Real) && (r.ty == Ty::Int || r.ty == Ty::Real);
+        Ty common;
+        if (numeric) common = (l.ty == Ty::Real || r.ty == Ty::Real) ? Ty::Real : Ty::Int;
+        else if (l.ty == r.ty) common = l.ty;
+        else throw CompileError(std::string("cannot combine ") + ty_name(l.ty) + " and " + ty_name(r.ty));
+
+        uint16_t x = widen(l, common);
+        uint16_t y = widen(r, common);
+
+        if (is_cmp) {
+            int k = op - Expr::Binary::Eq; // Eq, Neq, Lt, Lte, Gt, Gte
+            OpCode base;
+            switch (common) {
+                case Ty::Int:
+                case Ty::Bool: base = OpCode::CmpIntEq; break; // bools are 0/1 in Reg::i
+                case Ty::Real: base = OpCode::CmpRealEq; break;
+                case Ty::Text: base = OpCode::CmpTextEq; break;
+                default: throw CompileError("invalid comparison");
+            }
+            return {emit(static_cast<OpCode>(static_cast<int>(base) + k), x, y), Ty::Bool};
+        }
+
+        int k = op - Expr::Binary::Add; // Add, Sub, Mul, Div
+        if (common == Ty::Int) return {emit(static_cast<OpCode>(static_cast<int>(OpCode::AddInt) + k), x, y), Ty::Int};
+        if (common == Ty::Real) return {emit(static_cast<OpCode>(static_cast<int>(OpCode::AddReal) + k), x, y), Ty::Real};
+        throw CompileError(std::string("arithmetic expects numbers, got ") + ty_name(common));
+    }
+};
+
+} // namespace
+
+Program compile_expr(const ExprArena& arena, ExprId root, const std::vector<ColumnDef>& columns) {
+    return Compiler(arena, columns).finish(root);
+}
+
+Program compile_predicate(const ExprArena& arena, ExprId root, const std::vector<ColumnDef>& columns) {
+    Program p = compile_expr(arena, root, columns);
+    if (p.result_type != DataType::Bool) {
+        throw CompileError("WHERE expression must be boolean");
+    }
+    return p;
+}
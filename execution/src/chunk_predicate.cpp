@@ -0,0 +1,190 @@
+#include "execution/chunk_predicate.hpp"
+#include <optional>
+
+namespace {
+
+std::optional<size_t> column_ordinal(const ExprArena& arena, ExprId id, const std::vector<ColumnDef>& columns) {
+    if (arena[id].kind != Expr::Column) return std::nullopt;
+    std::string_view name = arena.column_name(id);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].name == name) return i;
+    }
+    return std::nullopt;
+}
+
+CmpOp mirror(CmpOp op) {
+    switch (op) {
+        case CmpOp::Lt: return CmpOp::Gt;
+        case CmpOp::Lte: return CmpOp::Gte;
+        case CmpOp::Gt: return CmpOp::Lt;
+        case CmpOp::Gte: return CmpOp::Lte;
+        default: return op;
+    }
+}
+
+bool vectorizable(DataType::Kind kind) {
+    return kind == DataType::Int || kind == DataType::Real || kind == DataType::Bool;
+}
+
+}
+
+ChunkPredicate::ChunkPredicate(const ExprArena& arena, ExprId root, const std::vector<ColumnDef>& columns)
+    : program_(compile_predicate(arena, root, columns)), evaluator_(program_), kernels_(simd_kernels()) {
+    if (!build(arena, root, columns)) {
+        nodes_.clear();
+        return;
+    }
+    stack_.assign(nodes_.size() * BITMAP_WORDS, 0);
+}
+
+bool ChunkPredicate::build(const ExprArena& arena, ExprId id, const std::vector<ColumnDef>& columns) {
+    const Expr& e = arena[id];
+    if (e.kind == Expr::BinaryOp &&
+        (e.binary_op() == Expr::Binary::And || e.binary_op() == Expr::Binary::Or)) {
+        if (!build(arena, e.lhs(), columns) || !build(arena, e.rhs(), columns)) return false;
+        Node n{};
+        n.kind = e.binary_op() == Expr::Binary::And ? Node::And : Node::Or;
+        nodes_.push_back(n);
+        return true;
+    }
+    return build_leaf(arena, id, columns);
+}
+
+bool ChunkPredicate::build_leaf(const ExprArena& arena, ExprId id, const std::vector<ColumnDef>& columns) {
+    const Expr& e = arena[id];
+    Node n{};
+    if (e.kind == Expr::Column) {
+        /*
+        * A bare BOOL column: WHERE active  =>  active = TRUE.
+        */
+        auto col = column_ordinal(arena, id, columns);
+        if (!col || columns[*col].data_type.kind != DataType::Bool) return false;
+        n.kind = Node::CmpConst;
+        n.op = CmpOp::Eq;
+        n.type = DataType::Bool;
+        n.lhs = static_cast<uint32_t>(*col);
+        n.i = 1;
+        nodes_.push_back(n);
+        return true;
+    }
+    if (e.kind != Expr::BinaryOp || e.binary_op() < Expr::Binary::Eq || e.binary_op() > Expr::Binary::Gte) {
+        return false;
+    }
+
+    n.op = static_cast<CmpOp>(e.binary_op() - Expr::Binary::Eq);
+    ExprId l = e.lhs(), r = e.rhs();
+    auto lcol = column_ordinal(arena, l, columns);
+    auto rcol = column_ordinal(arena, r, columns);
+    if (!lcol && rcol) {
+        std::swap(l, r);
+        std::swap(lcol, rcol);
+        n.op = mirror(n.op);
+    }
+    if (!lcol) return false;
+    n.type = columns[*lcol].data_type.kind;
+    n.lhs = static_cast<uint32_t>(*lcol);
+    if (!vectorizable(n.type)) return false;
+
+    if (rcol) {
+        if (columns[*rcol].data_type.kind != n.type) return false;
+        n.kind = Node::CmpColumn;
+        n.rhs = static_cast<uint32_t>(*rcol);
+        nodes_.push_back(n);
+        return true;
+    }
+
+    const Expr& lit = arena[r];
+    if (lit.kind != Expr::Literal) return false;
+    n.kind = Node::CmpConst;
+    switch (n.type) {
+        case DataType::Int:
+            // INT column against a REAL constant compares as REAL; leave that to bytecode.
+            if (lit.literal_kind != Value::Int) return false;
+            n.i = lit.i;
+            break;
+        case DataType::Real:
+            if (lit.literal_kind == Value::Int) n.f = static_cast<double>(lit.i);
+            else if (lit.literal_kind == Value::Float) n.f = lit.f;
+            else return false;
+            break;
+        case DataType::Bool:
+            if (lit.literal_kind != Value::Bool) return false;
+            n.i = lit.b;
+            break;
+        default:
+            return false;
+    }
+    nodes_.push_back(n);
+    return true;
+}
+
+void ChunkPredicate::compare(const DataChunk& chunk, const Node& node, uint64_t* out) const {
+    const ColumnVector& a = chunk.columns[node.lhs];
+    size_t n = chunk.count;
+    int op = static_cast<int>(node.op);
+    uint64_t nulls[BITMAP_WORDS];
+    size_t words = bitmap_words(n);
+
+    if (node.kind == Node::CmpConst) {
+        switch (node.type) {
+            case DataType::Int: kernels_.int_const[op](a.ints.data(), nullptr, node.i, n, out); break;
+            case DataType::Real: kernels_.real_const[op](a.reals.data(), nullptr, node.f, n, out); break;
+            default: kernels_.byte_const[op](a.bools.data(), nullptr, static_cast<uint8_t>(node.i), n, out); break;
+        }
+    } else {
+        const ColumnVector& b = chunk.columns[node.rhs];
+        switch (node.type) {
+            case DataType::Int: kernels_.int_column[op](a.ints.data(), b.ints.data(), 0, n, out); break;
+            case DataType::Real: kernels_.real_column[op](a.reals.data(), b.reals.data(), 0, n, out); break;
+            default: kernels_.byte_column[op](a.bools.data(), b.bools.data(), 0, n, out); break;
+        }
+        kernels_.byte_const[static_cast<int>(CmpOp::Neq)](b.nulls.data(), nullptr, 0, n, nulls);
+        bitmap_andnot(out, nulls, words);
+    }
+    kernels_.byte_const[static_cast<int>(CmpOp::Neq)](a.nulls.data(), nullptr, 0, n, nulls);
+    bitmap_andnot(out, nulls, words);
+}
+
+void ChunkPredicate::select(const DataChunk& chunk, std::vector<uint16_t>& sel) {
+    if (nodes_.empty()) {
+        evaluator_.select(chunk, sel);
+        return;
+    }
+
+    /*
+    * Only TRUE rows survive a WHERE clause, so one bitmap per node is enough: a row is
+    * TRUE under AND when both sides are TRUE and under OR when either is, and a
+    * comparison involving NULL is never TRUE.
+    */
+    size_t words = bitmap_words(chunk.count);
+    size_t top = 0;
+    for (const Node& node : nodes_) {
+        if (node.kind == Node::And || node.kind == Node::Or) {
+            uint64_t* rhs = &stack_[--top * BITMAP_WORDS];
+            uint64_t* lhs = &stack_[(top - 1) * BITMAP_WORDS];
+            if (node.kind == Node::And) bitmap_and(lhs, rhs, words);
+            else bitmap_or(lhs, rhs, words);
+        } else {
+            compare(chunk, node, &stack_[top++ * BITMAP_WORDS]);
+        }
+    }
+    const uint64_t* bits = stack_.data();
+
+    if (sel.size() == chunk.count) {
+        // Every row is active (sel is the identity), so rebuild it from the set bits.
+        sel.clear();
+        for (size_t w = 0; w < words; ++w) {
+            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                sel.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            }
+        }
+        return;
+    }
+    size_t kept = 0;
+    for (size_t k = 0; k < sel.size(); ++k) {
+        uint16_t r = sel[k];
+        sel[kept] = r;
+        kept += (bits[r >> 6] >> (r & 63)) & 1;
+    }
+    sel.resize(kept);
+}
@@ -0,0 +1,329 @@
+#include "execution/executor.hpp"
+#include "execution/bloom_filter_probe.hpp"
+#include "execution/zone_filter.hpp"
+#include "parser/rewrite.hpp"
+#include <algorithm>
+#include <climits>
+#include <optional>
+#include <stdexcept>
+
+
+namespace {
+
+// Inclusive key range implied by the conjuncts on one column.
+struct KeyRange {
+    int64_t lo = INT64_MIN;
+    int64_t hi = INT64_MAX;
+    bool point = false;
+    bool empty = false;
+
+    void intersect(Expr::Binary::Op op, int64_t v) {
+        switch (op) {
+            case Expr::Binary::Eq: lo = std::max(lo, v); hi = std::min(hi, v); point = true; break;
+            case Expr::Binary::Lt:
+                if (v == INT64_MIN) empty = true;
+                else hi = std::min(hi, v - 1);
+                break;
+            case Expr::Binary::Lte: hi = std::min(hi, v); break;
+            case Expr::Binary::Gt:
+                if (v == INT64_MAX) empty = true;
+                else lo = std::max(lo, v + 1);
+                break;
+            case Expr::Binary::Gte: lo = std::max(lo, v); break;
+            default: return;
+        }
+        if (lo > hi) empty = true;
+    }
+};
+
+Expr::Binary::Op mirror(Expr::Binary::Op op) {
+    switch (op) {
+        case Expr::Binary::Lt: return Expr::Binary::Gt;
+        case Expr::Binary::Lte: return Expr::Binary::Gte;
+        case Expr::Binary::Gt: return Expr::Binary::Lt;
+        case Expr::Binary::Gte: return Expr::Binary::Lte;
+        default: return op;
+    }
+}
+
+// Recognizes `column op int-literal` and `int-literal op column`, returning the
+// column's ordinal with the comparison oriented as column-on-the-left.
+std::optional<size_t> sargable(const ExprArena& arena, ExprId id, const TupleLayout& layout,
+                               Expr::Binary::Op& op, int64_t& value) {
+    const Expr& e = arena[id];
+    if (e.kind != Expr::BinaryOp) return std::nullopt;
+    op = e.binary_op();
+    if (op != Expr::Binary::Eq && op != Expr::Binary::Lt && op != Expr::Binary::Lte &&
+        op != Expr::Binary::Gt && op != Expr::Binary::Gte) {
+        return std::nullopt;
+    }
+    ExprId col = e.lhs(), lit = e.rhs();
+    if (arena[col].kind != Expr::Column) {
+        std::swap(col, lit);
+        op = mirror(op);
+    }
+    if (arena[col].kind != Expr::Column || arena[lit].kind != Expr::Literal ||
+        arena[lit].literal_kind != Value::Int) {
+        return std::nullopt;
+    }
+    auto idx = layout.column_index(arena.column_name(col));
+    if (!idx || layout.type(*idx) != DataType::Int) return std::nullopt;
+    value = arena[lit].i;
+    return idx;
+}
+
+/*
+* Resolves the SELECT list of a query with aggregates or GROUP BY. The GROUP BY columns
+* become the keys and aggregate items the aggregates; `output` maps each item to a
+* column of the HashAggregate's result. Plain columns must be grouped by.
+*/
+void resolve_aggregation(const Statement::SelectData& select, const TupleLayout& layout, std::vector<size_t>& keys,
+                         std::vector<AggregateSpec>& aggregates, std::vector<size_t>& output) {
+    auto column = [&](const std::string& name) {
+        auto idx = layout.column_index(name);
+        if (!idx) throw CompileError("unknown column '" + name + "'");
+        return *idx;
+    };
+    for (const auto& name : select.group_by) keys.push_back(column(name));
+    for (const auto& item : select.columns) {
+        if (item.kind == SelectItem::Wildcard) {
+            throw CompileError("SELECT * cannot be combined with aggregates or GROUP BY");
+        }
+        if (item.kind == SelectItem::Column) {
+            auto key = std::find(keys.begin(), keys.end(), column(item.column));
+            if (key == keys.end()) {
+                throw CompileError("column '" + item.column + "' must appear in GROUP BY or be aggregated");
+            }
+            output.push_back(key - keys.begin());
+            continue;
+        }
+        AggregateSpec spec{item.func, std::nullopt};
+        if (!item.column.empty()) spec.column = column(item.column);
+        aggregate_type(spec, layout.columns());
+        output.push_back(keys.size() + aggregates.size());
+        aggregates.push_back(spec);
+    }
+}
+
+}
+
+
+namespace {
+
+// Every plan_select; with `mvcc` set, each scan reads the versions `txn` sees.
+std::unique_ptr<Operator> plan(const Statement& stmt, HeapFile& heap, const TupleLayout& layout,
+                               const std::vector<TableIndex>& indexes, size_t threads,
+                               MvccHeap* mvcc, const Transaction* txn) {
+    if (stmt.kind != Statement::Select) {
+        throw std::invalid_argument("plan_select expects a SELECT statement");
+    }
+    const auto& select = std::get<Statement::SelectData>(stmt.data);
+
+    bool aggregate = !select.group_by.empty() ||
+                     std::any_of(select.columns.begin(), select.columns.end(),
+                                 [](const SelectItem& item) { return item.kind == SelectItem::Aggregate; });
+    std::vector<size_t> output;
+    std::vector<size_t> keys;
+    std::vector<AggregateSpec> aggregates;
+    std::vector<size_t> read;
+    if (aggregate) {
+        resolve_aggregation(select, layout, keys, aggregates, output);
+        read = keys;
+        for (const AggregateSpec& spec : aggregates) {
+            if (spec.column) read.push_back(*spec.column);
+        }
+    } else {
+        for (const auto& item : select.columns) {
+            if (item.kind == SelectItem::Wildcard) {
+                for (size_t c = 0; c < layout.column_count(); ++c) output.push_back(c);
+                continue;
+            }
+            auto idx = layout.column_index(item.column);
+            if (!idx) throw CompileError("unknown column '" + item.column + "'");
+            output.push_back(*idx);
+        }
+        read = output;
+    }
+
+    std::vector<ExprId> where;
+    if (select.selection) where = conjuncts(stmt.exprs, *select.selection);
+    std::vector<std::unique_ptr<ChunkPredicate>> predicates;
+    std::vector<std::optional<KeyRange>> ranges(indexes.size());
+    for (ExprId conjunct : where) {
+        predicates.push_back(std::make_unique<ChunkPredicate>(stmt.exprs, conjunct, layout.columns()));
+
+        Expr::Binary::Op op;
+        int64_t value;
+        auto col = sargable(stmt.exprs, conjunct, layout, op, value);
+        if (!col) continue;
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            if (indexes[i].column != *col) continue;
+            if (indexes[i].hash && op != Expr::Binary::Eq) continue;
+            if (!ranges[i]) ranges[i].emplace();
+            ranges[i]->intersect(op, value);
+        }
+    }
+    // Prefer a contradiction (no rows at all), then equality through a hash index,
+    // then through a B+tree, then any range.
+    auto rank = [&](size_t i) {
+        const KeyRange& r = *ranges[i];
+        return r.empty ? 3 : !r.point ? 0 : indexes[i].hash ? 2 : 1;
+    };
+    std::optional<size_t> best;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (ranges[i] && (!best || rank(i) > rank(*best))) best = i;
+    }
+
+    for (const auto& p : predicates) {
+        for (const Instr& in : p->program().code) {
+            bool load = in.op == OpCode::LoadColInt || in.op == OpCode::LoadColReal ||
+                        in.op == OpCode::LoadColText || in.op == OpCode::LoadColBool;
+            if (load) read.push_back(in.arg);
+        }
+    }
+    std::sort(read.begin(), read.end());
+    read.erase(std::unique(read.begin(), read.end()), read.end());
+
+    // Pages the zone map or the Bloom filters rule out are skipped by whichever scan
+    // reads the whole table.
+    std::shared_ptr<ZoneFilter> zone_filter;
+    std::shared_ptr<BloomFilterProbe> bloom_probe;
+    if (ZoneMap* zones = heap.zone_map()) {
+        zone_filter = std::make_shared<ZoneFilter>(*zones, stmt.exprs, where, layout);
+        if (!zone_filter->useful()) zone_filter.reset();
+    }
+    if (BloomFilterMap* blooms = heap.bloom_filters()) {
+        bloom_probe = std::make_shared<BloomFilterProbe>(*blooms, stmt.exprs, where, layout);
+        if (!bloom_probe->useful()) bloom_probe.reset();
+    }
+    SeqScan::PageFilter page_filter;
+    if (zone_filter || bloom_probe) {
+        page_filter = [zone_filter, bloom_probe](uint64_t page_id) {
+            return (!zone_filter || zone_filter->may_match(page_id)) &&
+                   (!bloom_probe || bloom_probe->may_match(page_id));
+        };
+    }
+
+    std::unique_ptr<Operator> op;
+    if (best) {
+        const TableIndex& index = indexes[*best];
+        const KeyRange& range = *ranges[*best];
+        if (range.empty) {
+            // Contradictory bounds: a zero limit never pulls from the scan.
+            op = std::make_unique<Limit>(std::make_unique<SeqScan>(heap, layout, std::move(read)), 0);
+        } else {
+            auto scan = index.hash
+                ? std::make_unique<IndexScan>(heap, layout, std::move(read), *index.hash, range.lo)
+                : std::make_unique<IndexScan>(heap, layout, std::move(read), *index.tree, range.lo, range.hi);
+            if (mvcc) scan->set_snapshot(*mvcc, *txn);
+            op = std::move(scan);
+        }
+    } else if (threads > 1) {
+        // Each worker filters its own chunks with its own compiled copy of the conjuncts.
+        auto make_predicates = [&] {
+            std::vector<std::unique_ptr<ChunkPredicate>> copy;
+            for (ExprId conjunct : where) {
+                copy.push_back(std::make_unique<ChunkPredicate>(stmt.exprs, conjunct, layout.columns()));
+            }
+            return copy;
+        };
+        auto scan = std::make_unique<ParallelScan>(heap, layout, std::move(read), make_predicates, threads);
+        if (page_filter) scan->set_page_filter(page_filter);
+        if (mvcc) scan->set_snapshot(*mvcc, *txn);
+        predicates.clear();
+        if (aggregate) {
+            // Workers aggregate what they scan; only the partial results are merged.
+            op = std::make_unique<HashAggregate>(std::move(scan), std::move(keys), std::move(aggregates));
+            aggregate = false;
+        } else {
+            op = std::move(scan);
+        }
+    } else {
+        auto scan = std::make_unique<SeqScan>(heap, layout, std::move(read));
+        if (page_filter) scan->set_page_filter(std::move(page_filter));
+        if (mvcc) scan->set_snapshot(*mvcc, *txn);
+        op = std::move(scan);
+    }
+    if (!predicates.empty()) {
+        op = std::make_unique<Filter>(std::move(op), std::move(predicates));
+    }
+    if (aggregate) {
+        op = std::make_unique<HashAggregate>(std::move(op), std::move(keys), std::move(aggregates));
+    }
+    op = std::make_unique<Projection>(std::move(op), std::move(output));
+    if (select.limit) {
+        op = std::make_unique<Limit>(std::move(op), *select.limit);
+    }
+    return op;
+}
+
+}
+
+
+std::unique_ptr<Operator> plan_select(const Statement& stmt, HeapFile& heap, const TupleLayout& layout) {
+    return plan_select(stmt, heap, layout, {});
+}
+
+std::unique_ptr<Operator> plan_select(const Statement& stmt, HeapFile& heap, const TupleLayout& layout,
+                                      const std::vector<TableIndex>& indexes, size_t threads) {
+    return plan(stmt, heap, layout, indexes, threads, nullptr, nullptr);
+}
+
+std::unique_ptr<Operator> plan_select(const Statement& stmt, MvccHeap& table, const Transaction& txn,
+                                      const TupleLayout& layout, const std::vector<TableIndex>& indexes,
+                                      size_t threads) {
+    return plan(stmt, table.heap(), layout, indexes, threads, &table, &txn);
+}
+
+std::vector<std::vector<Value>> collect_rows(Operator& op) {
+    std::vector<std::vector<Value>> rows;
+    DataChunk chunk;
+    size_t width = op.schema().size();
+    while (op.next(chunk)) {
+        for (uint16_t r : chunk.sel) {
+            std::vector<Value> row;
+            row.reserve(width);
+            for (size_t c = 0; c < width; ++c) row.push_back(chunk.value(c, r));
+            rows.push_back(std::move(row));
+        }
+    }
+    return rows;
+}
+
+namespace {
+
+std::vector<IndexEntry> index_entries(const Statement& stmt, HeapFile& heap, const TupleLayout& layout,
+                                      IndexMethod method) {
+    if (stmt.kind != Statement::CreateIndex) {
+        throw std::invalid_argument("create_index expects a CREATE INDEX statement");
+    }
+    const auto& d = std::get<Statement::CreateIndexData>(stmt.data);
+    if (d.method != method) {
+        throw std::invalid_argument("index '" + d.name + "' is built with a different access method");
+    }
+    auto col = layout.column_index(d.column);
+    if (!col) throw std::invalid_argument("unknown column '" + d.column + "'");
+    if (layout.type(*col) != DataType::Int) {
+        throw std::invalid_argument("column '" + d.column + "' is not INT; only INT columns can be indexed");
+    }
+
+    std::vector<IndexEntry> entries;
+    heap.scan([&](RID rid, TupleRef t) {
+        if (!layout.is_null(t.data, *col)) entries.push_back(IndexEntry{layout.get_int(t.data, *col), rid});
+    });
+    return entries;
+}
+
+}
+
+void create_index(const Statement& stmt, HeapFile& heap, const TupleLayout& layout, BPlusTree& index) {
+    auto entries = index_entries(stmt, heap, layout, IndexMethod::BTree);
+    std::sort(entries.begin(), entries.end());
+    index.bulk_load(entries);
+}
+
+void create_index(const Statement& stmt, HeapFile& heap, const TupleLayout& layout, HashIndex& index) {
+    for (const IndexEntry& e : index_entries(stmt, heap, layout, IndexMethod::Hash)) {
+        index.insert(e.key, e.rid);
+    }
+}
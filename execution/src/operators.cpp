@@ -0,0 +1,482 @@
+#include "execution/operators.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+
+namespace {
+
+// Decodes the `read` columns of one record into the next row of the chunk.
+void append_row(const TupleLayout& layout, const std::vector<size_t>& read, const uint8_t* tuple, DataChunk& chunk) {
+    size_t row = chunk.count++;
+    for (size_t c : read) {
+        ColumnVector& col = chunk.columns[c];
+        bool null = layout.is_null(tuple, c);
+        col.nulls[row] = null;
+        switch (col.type) {
+            case DataType::Int: col.ints[row] = null ? 0 : layout.get_int(tuple, c); break;
+            case DataType::Real: col.reals[row] = null ? 0.0 : layout.get_real(tuple, c); break;
+            case DataType::Bool: col.bools[row] = null ? 0 : layout.get_bool(tuple, c); break;
+            case DataType::Text:
+                col.texts[row] = null ? std::string_view() : chunk.strings.add(layout.get_text(tuple, c));
+                break;
+            case DataType::Custom: break;
+        }
+    }
+}
+
+void init_scan_chunk(const TupleLayout& layout, const std::vector<size_t>& read, DataChunk& chunk) {
+    chunk.init(layout.columns());
+    for (size_t c = 0; c < chunk.materialized.size(); ++c) chunk.materialized[c] = false;
+    for (size_t c : read) chunk.materialized[c] = true;
+}
+
+}
+
+
+SeqScan::SeqScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read)
+    : heap_(heap), layout_(layout), read_(std::move(read)) {}
+
+void SeqScan::reset(uint64_t first_page, uint64_t last_page) {
+    page_ = first_page;
+    last_page_ = last_page;
+    slot_ = 0;
+    loaded_ = false;
+}
+
+void SeqScan::set_snapshot(MvccHeap& mvcc, const Transaction& txn) {
+    if (&mvcc.heap() != &heap_) {
+        throw std::invalid_argument("SeqScan snapshot is over another heap");
+    }
+    mvcc_ = &mvcc;
+    txn_ = &txn;
+}
+
+/*
+* Copies live rows of a PAX page, starting at row `from`, into the chunk until it is
+* full. With no deleted rows the range is contiguous and each fixed-width minipage is
+* copied with one memcpy; otherwise live rows are gathered one by one. Returns the row
+* to resume from.
+*/
+uint16_t SeqScan::read_pax_rows(const PaxPage& page, uint16_t from, DataChunk& chunk) {
+    uint16_t rows = page.row_count();
+    size_t base = chunk.count;
+    bool contiguous = page.live_count() == rows;
+
+    uint16_t end = from;
+    rows_.clear();
+    if (contiguous) {
+        end = static_cast<uint16_t>(std::min<size_t>(rows, from + (VECTOR_SIZE - base)));
+        for (uint16_t r = from; r < end; ++r) rows_.push_back(r);
+    } else {
+        while (end < rows && base + rows_.size() < VECTOR_SIZE) {
+            if (page.is_live(end)) rows_.push_back(end);
+            end++;
+        }
+    }
+
+    for (size_t c : read_) {
+        ColumnVector& col = chunk.columns[c];
+        const uint8_t* nulls = page.nulls(c);
+        for (size_t i = 0; i < rows_.size(); ++i) {
+            uint16_t r = rows_[i];
+            col.nulls[base + i] = (nulls[r >> 3] >> (r & 7)) & 1;
+        }
+
+        size_t width = TupleLayout::field_width(col.type);
+        uint8_t* dst = nullptr;
+        switch (col.type) {
+            case DataType::Int: dst = reinterpret_cast<uint8_t*>(col.ints.data() + base); break;
+            case DataType::Real: dst = reinterpret_cast<uint8_t*>(col.reals.data() + base); break;
+            case DataType::Bool: dst = col.bools.data() + base; break;
+            case DataType::Text:
+                for (size_t i = 0; i < rows_.size(); ++i) {
+                    col.texts[base + i] = col.nulls[base + i]
+                        ? std::string_view() : chunk.strings.add(page.get_text(rows_[i], c));
+                }
+                continue;
+            case DataType::Custom: continue;
+        }
+        const uint8_t* src = page.values(c);
+        if (contiguous) {
+            std::memcpy(dst, src + size_t(from) * width, rows_.size() * width);
+        } else {
+            for (size_t i = 0; i < rows_.size(); ++i) {
+                std::memcpy(dst + i * width, src + size_t(rows_[i]) * width, width);
+            }
+        }
+    }
+    chunk.count += rows_.size();
+    return end;
+}
+
+bool SeqScan::skip_page() {
+    if (slot_ != 0 || !filter_ || filter_(page_)) return false;
+    skipped_++;
+    return true;
+}
+
+bool SeqScan::next(DataChunk& chunk) {
+    init_scan_chunk(layout_, read_, chunk);
+    if (mvcc_) return next_visible(chunk);
+
+    uint64_t pages = std::min(heap_.page_count(), last_page_);
+    if (const PaxGeometry* geo = heap_.pax()) {
+        while (chunk.count < VECTOR_SIZE && page_ <= pages) {
+            if (skip_page()) {
+                page_++;
+                pages = std::min(heap_.page_count(), last_page_);
+                continue;
+            }
+            bool done = false;
+            heap_.read_page(page_, [&](const uint8_t* data) {
+                PaxPage page(const_cast<uint8_t*>(data), *geo);
+                slot_ = read_pax_rows(page, slot_, chunk);
+                done = slot_ >= page.row_count();
+            });
+            if (done) {
+                page_++;
+                slot_ = 0;
+                pages = std::min(heap_.page_count(), last_page_);
+            }
+        }
+        chunk.select_all();
+        return chunk.count > 0;
+    }
+
+    while (chunk.count < VECTOR_SIZE && page_ <= pages) {
+        if (skip_page()) {
+            page_++;
+            pages = std::min(heap_.page_count(), last_page_);
+            continue;
+        }
+        slot_ = heap_.scan_page_from(page_, slot_, [&](RID, TupleRef t) {
+            append_row(layout_, read_, t.data, chunk);
+            return chunk.count < VECTOR_SIZE;
+        });
+        if (chunk.count < VECTOR_SIZE) {
+            /*
+            * The page was read to the end; re-reading page_count picks up pages appended
+            * since the scan started.
+            */
+            page_++;
+            slot_ = 0;
+            pages = std::min(heap_.page_count(), last_page_);
+        }
+    }
+    chunk.select_all();
+    return chunk.count > 0;
+}
+
+
+/*
+* The page's visible rows are copied out in one scan_page call, which holds the page
+* latch only while it resolves them, and chunks are filled from the copy.
+*/
+bool SeqScan::next_visible(DataChunk& chunk) {
+    uint64_t pages = std::min(heap_.page_count(), last_page_);
+    while (chunk.count < VECTOR_SIZE) {
+        if (!loaded_) {
+            if (page_ > pages) break;
+            if (skip_page()) {
+                page_++;
+                pages = std::min(heap_.page_count(), last_page_);
+                continue;
+            }
+            visible_.clear();
+            visible_rows_.clear();
+            mvcc_->scan_page(*txn_, page_, [&](RID, TupleRef t) {
+                visible_rows_.push_back(visible_.size());
+                visible_.insert(visible_.end(), t.data, t.data + t.size);
+            });
+            loaded_ = true;
+        }
+        while (chunk.count < VECTOR_SIZE && slot_ < visible_rows_.size()) {
+            append_row(layout_, read_, visible_.data() + visible_rows_[slot_++], chunk);
+        }
+        if (slot_ == visible_rows_.size()) {
+            page_++;
+            slot_ = 0;
+            loaded_ = false;
+            pages = std::min(heap_.page_count(), last_page_);
+        }
+    }
+    chunk.select_all();
+    return chunk.count > 0;
+}
+
+
+IndexScan::IndexScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read,
+                     BPlusTree& index, int64_t lo, int64_t hi)
+    : heap_(heap), layout_(layout), read_(std::move(read)), tree_(&index), lo_(lo), hi_(hi) {}
+
+IndexScan::IndexScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read,
+                     HashIndex& index, int64_t key)
+    : heap_(heap), layout_(layout), read_(std::move(read)), hash_(&index), lo_(key), hi_(key) {}
+
+void IndexScan::set_snapshot(MvccHeap& mvcc, const Transaction& txn) {
+    if (&mvcc.heap() != &heap_) {
+        throw std::invalid_argument("IndexScan snapshot is over another heap");
+    }
+    mvcc_ = &mvcc;
+    txn_ = &txn;
+}
+
+bool IndexScan::next(DataChunk& chunk) {
+    if (!probed_) {
+        if (hash_) {
+            rids_ = hash_->find(lo_);
+        } else {
+            tree_->scan(lo_, hi_, [&](const IndexEntry& e) {
+                rids_.push_back(e.rid);
+                return true;
+            });
+        }
+        std::sort(rids_.begin(), rids_.end());
+        probed_ = true;
+    }
+
+    init_scan_chunk(layout_, read_, chunk);
+    while (chunk.count < VECTOR_SIZE && pos_ < rids_.size()) {
+        // Entries whose record was deleted since they were indexed are skipped, and so
+        // are those of versions the snapshot does not see.
+        RID rid = rids_[pos_++];
+        if (mvcc_ ? mvcc_->get(*txn_, rid, record_) : heap_.get(rid, record_)) {
+            append_row(layout_, read_, record_.data(), chunk);
+        }
+    }
+    chunk.select_all();
+    return chunk.count > 0;
+}
+
+
+ParallelScan::ParallelScan(HeapFile& heap, const TupleLayout& layout, std::vector<size_t> read,
+                           const PredicateFactory& make_predicates, size_t workers)
+    : heap_(heap), layout_(layout) {
+    for (size_t w = 0; w < std::max<size_t>(workers, 1); ++w) {
+        auto worker = std::make_unique<Worker>();
+        worker->scan = std::make_unique<SeqScan>(heap, layout, read);
+        worker->predicates = make_predicates();
+        workers_.push_back(std::move(worker));
+    }
+}
+
+ParallelScan::~ParallelScan() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+    }
+    space_.notify_all();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+void ParallelScan::start() {
+    started_ = true;
+    uint64_t pages = heap_.page_count();
+    uint64_t morsels = (pages + MORSEL_PAGES - 1) / MORSEL_PAGES;
+    /*
+    * Worker w gets the w-th contiguous run of morsels, so without stealing each worker
+    * reads neighbouring pages in order.
+    */
+    size_t n = workers_.size();
+    for (uint64_t m = 0; m < morsels; ++m) {
+        uint64_t first = 1 + m * MORSEL_PAGES;
+        workers_[m * n / morsels]->morsels.push_back(Morsel{first, std::min(pages, first + MORSEL_PAGES - 1)});
+    }
+    size_t active = static_cast<size_t>(std::min<uint64_t>(n, morsels));
+    running_ = active;
+    for (size_t w = 0; w < active; ++w) {
+        workers_[w]->thread = std::thread([this, w] { run(*workers_[w], w); });
+    }
+}
+
+std::optional<ParallelScan::Morsel> ParallelScan::take(size_t index) {
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.morsels.empty()) {
+            Morsel m = own.morsels.front();
+            own.morsels.pop_front();
+            return m;
+        }
+    }
+    for (size_t k = 1; k < workers_.size(); ++k) {
+        Worker& victim = *workers_[(index + k) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.morsels.empty()) {
+            Morsel m = victim.morsels.back();
+            victim.morsels.pop_back();
+            return m;
+        }
+    }
+    return std::nullopt;
+}
+
+void ParallelScan::run(Worker& worker, size_t index) {
+    size_t capacity = QUEUE_CHUNKS * workers_.size();
+    try {
+        DataChunk chunk;
+        while (auto morsel = take(index)) {
+            worker.scan->reset(morsel->first_page, morsel->last_page);
+            while (worker.scan->next(chunk)) {
+                for (auto& pred : worker.predicates) {
+                    if (chunk.sel.empty()) break;
+                    pred->select(chunk, chunk.sel);
+                }
+                if (chunk.sel.empty()) continue;
+                if (consume_) {
+                    (*consume_)(index, chunk);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_.wait(lock, [&] { return cancelled_ || results_.size() < capacity; });
+                if (cancelled_) break;
+                results_.push_back(std::move(chunk));
+                chunk = DataChunk();
+                if (!spare_.empty()) {
+                    chunk = std::move(spare_.back());
+                    spare_.pop_back();
+                }
+                ready_.notify_one();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cancelled_) break;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) error_ = std::current_exception();
+        cancelled_ = true;
+        space_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_--;
+    ready_.notify_all();
+}
+
+bool ParallelScan::next(DataChunk& chunk) {
+    if (!started_) start();
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [&] { return error_ || !results_.empty() || running_ == 0; });
+    if (error_) std::rethrow_exception(error_);
+    if (results_.empty()) return false;
+    // The caller is done with the previous chunk, so its buffers go back to the workers.
+    if (spare_.size() < QUEUE_CHUNKS * workers_.size()) spare_.push_back(std::move(chunk));
+    chunk = std::move(results_.front());
+    results_.pop_front();
+    space_.notify_one();
+    return true;
+}
+
+void ParallelScan::set_page_filter(const SeqScan::PageFilter& filter) {
+    for (auto& w : workers_) w->scan->set_page_filter(filter);
+}
+
+void ParallelScan::set_snapshot(MvccHeap& mvcc, const Transaction& txn) {
+    for (auto& w : workers_) w->scan->set_snapshot(mvcc, txn);
+}
+
+void ParallelScan::drain(const ChunkConsumer& consume) {
+    consume_ = &consume;
+    start();
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [&] { return running_ == 0; });
+    if (error_) std::rethrow_exception(error_);
+}
+
+
+HashAggregate::HashAggregate(std::unique_ptr<Operator> child, std::vector<size_t> keys,
+                             std::vector<AggregateSpec> aggregates)
+    : child_(std::move(child)), keys_(std::move(keys)), aggregates_(std::move(aggregates)),
+      table_(child_->schema(), keys_, aggregates_) {}
+
+HashAggregate::HashAggregate(std::unique_ptr<ParallelScan> scan, std::vector<size_t> keys,
+                             std::vector<AggregateSpec> aggregates)
+    : HashAggregate(std::unique_ptr<Operator>(scan.release()), std::move(keys), std::move(aggregates)) {
+    scan_ = static_cast<ParallelScan*>(child_.get());
+}
+
+void HashAggregate::build() {
+    built_ = true;
+    if (!scan_) {
+        DataChunk chunk;
+        while (child_->next(chunk)) table_.add(chunk);
+        return;
+    }
+    std::vector<std::unique_ptr<AggregateTable>> partials;
+    for (size_t w = 0; w < scan_->worker_count(); ++w) {
+        partials.push_back(std::make_unique<AggregateTable>(child_->schema(), keys_, aggregates_));
+    }
+    scan_->drain([&](size_t worker, const DataChunk& chunk) { partials[worker]->add(chunk); });
+    for (const auto& partial : partials) table_.merge(*partial);
+}
+
+bool HashAggregate::next(DataChunk& chunk) {
+    if (!built_) build();
+    if (emitted_ >= table_.group_count()) return false;
+    table_.emit(emitted_, chunk);
+    emitted_ += chunk.count;
+    return true;
+}
+
+
+Filter::Filter(std::unique_ptr<Operator> child, std::vector<std::unique_ptr<ChunkPredicate>> predicates)
+    : child_(std::move(child)), predicates_(std::move(predicates)) {}
+
+bool Filter::next(DataChunk& chunk) {
+    while (child_->next(chunk)) {
+        for (auto& pred : predicates_) {
+            if (chunk.sel.empty()) break;
+            pred->select(chunk, chunk.sel);
+        }
+        if (!chunk.sel.empty()) return true;
+    }
+    return false;
+}
+
+
+Projection::Projection(std::unique_ptr<Operator> child, std::vector<size_t> columns)
+    : child_(std::move(child)), columns_(std::move(columns)) {
+    const auto& in = child_->schema();
+    for (size_t c : columns_) schema_.push_back(in[c]);
+}
+
+bool Projection::next(DataChunk& chunk) {
+    if (!child_->next(input_)) return false;
+
+    chunk.columns.resize(columns_.size());
+    chunk.materialized.assign(columns_.size(), true);
+    std::vector<size_t> first(input_.columns.size(), SIZE_MAX);
+    for (size_t k = 0; k < columns_.size(); ++k) {
+        size_t src = columns_[k];
+        if (first[src] != SIZE_MAX) {
+            chunk.columns[k] = chunk.columns[first[src]];
+        } else {
+            // Swapping hands the previous output buffers back to the child for reuse.
+            std::swap(chunk.columns[k], input_.columns[src]);
+            first[src] = k;
+        }
+    }
+    /*
+    * Text views still point into input_.strings, which stays untouched until the
+    * next call.
+    */
+    chunk.count = input_.count;
+    chunk.sel.swap(input_.sel);
+    return true;
+}
+
+
+Limit::Limit(std::unique_ptr<Operator> child, unsigned long long limit)
+    : child_(std::move(child)), remaining_(limit) {}
+
+bool Limit::next(DataChunk& chunk) {
+    if (remaining_ == 0 || !child_->next(chunk)) return false;
+    if (chunk.sel.size() > remaining_) chunk.sel.resize(remaining_);
+    remaining_ -= chunk.sel.size();
+    return true;
+}
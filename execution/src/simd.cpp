@@ -0,0 +1,357 @@
+#include "execution/simd.hpp"
+#include "storage/bloom_filter.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMPLEDB_X86 1
+#endif
+
+namespace {
+
+template<CmpOp OP, typename T>
+inline bool cmp(T x, T y) {
+    if constexpr (OP == CmpOp::Eq) return x == y;
+    else if constexpr (OP == CmpOp::Neq) return x != y;
+    else if constexpr (OP == CmpOp::Lt) return x < y;
+    else if constexpr (OP == CmpOp::Lte) return x <= y;
+    else if constexpr (OP == CmpOp::Gt) return x > y;
+    else return x >= y;
+}
+
+// Portable kernel, also used by the vector kernels for a trailing partial word.
+template<CmpOp OP, bool CONST, typename T>
+void scalar_cmp(const T* a, const T* b, T c, size_t n, uint64_t* out) {
+    for (size_t w = 0; w * 64 < n; ++w) {
+        size_t base = w * 64;
+        size_t m = n - base < 64 ? n - base : 64;
+        uint64_t word = 0;
+        for (size_t j = 0; j < m; ++j) {
+            word |= uint64_t(cmp<OP>(a[base + j], CONST ? c : b[base + j])) << j;
+        }
+        out[w] = word;
+    }
+}
+
+template<bool CONST, typename T>
+void scalar_tail(const T* a, const T* b, T c, size_t n, size_t full, uint64_t* out,
+                 void (*kernel)(const T*, const T*, T, size_t, uint64_t*)) {
+    if (full * 64 < n) {
+        kernel(a + full * 64, CONST ? b : b + full * 64, c, n - full * 64, out + full);
+    }
+}
+
+// Integer and byte SIMD compares only offer == and signed >; the other operators
+// swap operands and/or invert the result.
+constexpr bool swaps(CmpOp op) { return op == CmpOp::Lt || op == CmpOp::Gte; }
+constexpr bool inverts(CmpOp op) { return op == CmpOp::Neq || op == CmpOp::Lte || op == CmpOp::Gte; }
+constexpr bool is_eq(CmpOp op) { return op == CmpOp::Eq || op == CmpOp::Neq; }
+
+#ifdef SIMPLEDB_X86
+
+// ---- SSE4.2 ----
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("sse4.2")))
+void sse_int(const long long* a, const long long* b, long long c, size_t n, uint64_t* out) {
+    const __m128i vc = _mm_set1_epi64x(c);
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 2) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + w * 64 + j));
+            __m128i y = CONST ? vc : _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + w * 64 + j));
+            __m128i m;
+            if constexpr (is_eq(OP)) m = _mm_cmpeq_epi64(x, y);
+            else if constexpr (swaps(OP)) m = _mm_cmpgt_epi64(y, x);
+            else m = _mm_cmpgt_epi64(x, y);
+            word |= uint64_t(_mm_movemask_pd(_mm_castsi128_pd(m))) << j;
+        }
+        out[w] = inverts(OP) ? ~word : word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, long long>);
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("sse4.2")))
+void sse_real(const double* a, const double* b, double c, size_t n, uint64_t* out) {
+    const __m128d vc = _mm_set1_pd(c);
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 2) {
+            __m128d x = _mm_loadu_pd(a + w * 64 + j);
+            __m128d y = CONST ? vc : _mm_loadu_pd(b + w * 64 + j);
+            __m128d m;
+            if constexpr (OP == CmpOp::Eq) m = _mm_cmpeq_pd(x, y);
+            else if constexpr (OP == CmpOp::Neq) m = _mm_cmpneq_pd(x, y);
+            else if constexpr (OP == CmpOp::Lt) m = _mm_cmplt_pd(x, y);
+            else if constexpr (OP == CmpOp::Lte) m = _mm_cmple_pd(x, y);
+            else if constexpr (OP == CmpOp::Gt) m = _mm_cmpgt_pd(x, y);
+            else m = _mm_cmpge_pd(x, y);
+            word |= uint64_t(_mm_movemask_pd(m)) << j;
+        }
+        out[w] = word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, double>);
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("sse4.2")))
+void sse_byte(const uint8_t* a, const uint8_t* b, uint8_t c, size_t n, uint64_t* out) {
+    const __m128i vc = _mm_set1_epi8(static_cast<char>(c));
+    // Flip the sign bit so the signed byte compare orders unsigned values.
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + w * 64 + j));
+            __m128i y = CONST ? vc : _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + w * 64 + j));
+            __m128i m;
+            if constexpr (is_eq(OP)) {
+                m = _mm_cmpeq_epi8(x, y);
+            } else {
+                x = _mm_xor_si128(x, bias);
+                y = _mm_xor_si128(y, bias);
+                m = swaps(OP) ? _mm_cmpgt_epi8(y, x) : _mm_cmpgt_epi8(x, y);
+            }
+            word |= uint64_t(uint32_t(_mm_movemask_epi8(m))) << j;
+        }
+        out[w] = inverts(OP) ? ~word : word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, uint8_t>);
+}
+
+// Variable shifts arrive with AVX2, so 1 << s is built as the float 2^s: its exponent
+// field is s + 127. 2^31 converts to 0x80000000, which is also 1 << 31.
+__attribute__((target("sse4.2")))
+inline __m128i sse_bloom_mask(__m128i x, const uint32_t* salt) {
+    __m128i s = _mm_srli_epi32(_mm_mullo_epi32(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(salt))), 27);
+    __m128i exponent = _mm_slli_epi32(_mm_add_epi32(s, _mm_set1_epi32(127)), 23);
+    return _mm_cvttps_epi32(_mm_castsi128_ps(exponent));
+}
+
+__attribute__((target("sse4.2")))
+bool sse_bloom(const uint8_t* block, uint64_t hash) {
+    const __m128i x = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(hash)));
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+    return _mm_testc_si128(lo, sse_bloom_mask(x, BloomFilterMap::SALT)) &&
+           _mm_testc_si128(hi, sse_bloom_mask(x, BloomFilterMap::SALT + 4));
+}
+
+// ---- AVX2 ----
+
+// Also the AVX-512 kernel: a block is one 256-bit register.
+__attribute__((target("avx2")))
+bool avx2_bloom(const uint8_t* block, uint64_t hash) {
+    const __m256i salt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(BloomFilterMap::SALT));
+    __m256i x = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(hash)));
+    __m256i s = _mm256_srli_epi32(_mm256_mullo_epi32(x, salt), 27);
+    __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), s);
+    return _mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), mask);
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("avx2")))
+void avx2_int(const long long* a, const long long* b, long long c, size_t n, uint64_t* out) {
+    const __m256i vc = _mm256_set1_epi64x(c);
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + w * 64 + j));
+            __m256i y = CONST ? vc : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + w * 64 + j));
+            __m256i m;
+            if constexpr (is_eq(OP)) m = _mm256_cmpeq_epi64(x, y);
+            else if constexpr (swaps(OP)) m = _mm256_cmpgt_epi64(y, x);
+            else m = _mm256_cmpgt_epi64(x, y);
+            word |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(m))) << j;
+        }
+        out[w] = inverts(OP) ? ~word : word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, long long>);
+}
+
+template<CmpOp OP>
+constexpr int avx_predicate() {
+    if constexpr (OP == CmpOp::Eq) return _CMP_EQ_OQ;
+    else if constexpr (OP == CmpOp::Neq) return _CMP_NEQ_UQ;
+    else if constexpr (OP == CmpOp::Lt) return _CMP_LT_OQ;
+    else if constexpr (OP == CmpOp::Lte) return _CMP_LE_OQ;
+    else if constexpr (OP == CmpOp::Gt) return _CMP_GT_OQ;
+    else return _CMP_GE_OQ;
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("avx2")))
+void avx2_real(const double* a, const double* b, double c, size_t n, uint64_t* out) {
+    constexpr int PRED = avx_predicate<OP>();
+    const __m256d vc = _mm256_set1_pd(c);
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 4) {
+            __m256d x = _mm256_loadu_pd(a + w * 64 + j);
+            __m256d y = CONST ? vc : _mm256_loadu_pd(b + w * 64 + j);
+            word |= uint64_t(_mm256_movemask_pd(_mm256_cmp_pd(x, y, PRED))) << j;
+        }
+        out[w] = word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, double>);
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("avx2")))
+void avx2_byte(const uint8_t* a, const uint8_t* b, uint8_t c, size_t n, uint64_t* out) {
+    const __m256i vc = _mm256_set1_epi8(static_cast<char>(c));
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + w * 64 + j));
+            __m256i y = CONST ? vc : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + w * 64 + j));
+            __m256i m;
+            if constexpr (is_eq(OP)) {
+                m = _mm256_cmpeq_epi8(x, y);
+            } else {
+                x = _mm256_xor_si256(x, bias);
+                y = _mm256_xor_si256(y, bias);
+                m = swaps(OP) ? _mm256_cmpgt_epi8(y, x) : _mm256_cmpgt_epi8(x, y);
+            }
+            word |= uint64_t(uint32_t(_mm256_movemask_epi8(m))) << j;
+        }
+        out[w] = inverts(OP) ? ~word : word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, uint8_t>);
+}
+
+// ---- AVX-512 (F + BW) ----
+
+template<CmpOp OP>
+constexpr int avx512_int_predicate() {
+    if constexpr (OP == CmpOp::Eq) return _MM_CMPINT_EQ;
+    else if constexpr (OP == CmpOp::Neq) return _MM_CMPINT_NE;
+    else if constexpr (OP == CmpOp::Lt) return _MM_CMPINT_LT;
+    else if constexpr (OP == CmpOp::Lte) return _MM_CMPINT_LE;
+    else if constexpr (OP == CmpOp::Gt) return _MM_CMPINT_NLE;
+    else return _MM_CMPINT_NLT;
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("avx512f")))
+void avx512_int(const long long* a, const long long* b, long long c, size_t n, uint64_t* out) {
+    constexpr int PRED = avx512_int_predicate<OP>();
+    const __m512i vc = _mm512_set1_epi64(c);
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 8) {
+            __m512i x = _mm512_loadu_si512(a + w * 64 + j);
+            __m512i y = CONST ? vc : _mm512_loadu_si512(b + w * 64 + j);
+            word |= uint64_t(_mm512_cmp_epi64_mask(x, y, PRED)) << j;
+        }
+        out[w] = word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, long long>);
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("avx512f")))
+void avx512_real(const double* a, const double* b, double c, size_t n, uint64_t* out) {
+    constexpr int PRED = avx_predicate<OP>();
+    const __m512d vc = _mm512_set1_pd(c);
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 8) {
+            __m512d x = _mm512_loadu_pd(a + w * 64 + j);
+            __m512d y = CONST ? vc : _mm512_loadu_pd(b + w * 64 + j);
+            word |= uint64_t(_mm512_cmp_pd_mask(x, y, PRED)) << j;
+        }
+        out[w] = word;
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, double>);
+}
+
+template<CmpOp OP, bool CONST>
+__attribute__((target("avx512f,avx512bw")))
+void avx512_byte(const uint8_t* a, const uint8_t* b, uint8_t c, size_t n, uint64_t* out) {
+    constexpr int PRED = avx512_int_predicate<OP>();
+    const __m512i vc = _mm512_set1_epi8(static_cast<char>(c));
+    size_t full = n / 64;
+    for (size_t w = 0; w < full; ++w) {
+        __m512i x = _mm512_loadu_si512(a + w * 64);
+        __m512i y = CONST ? vc : _mm512_loadu_si512(b + w * 64);
+        out[w] = _mm512_cmp_epu8_mask(x, y, PRED);
+    }
+    scalar_tail<CONST>(a, b, c, n, full, out, &scalar_cmp<OP, CONST, uint8_t>);
+}
+
+#endif // SIMPLEDB_X86
+
+} // namespace
+
+#define SIMPLEDB_KERNELS(FN, CONST) \
+    { &FN<CmpOp::Eq, CONST>, &FN<CmpOp::Neq, CONST>, &FN<CmpOp::Lt, CONST>, \
+      &FN<CmpOp::Lte, CONST>, &FN<CmpOp::Gt, CONST>, &FN<CmpOp::Gte, CONST> }
+
+#define SIMPLEDB_SCALAR(T, CONST) \
+    { &scalar_cmp<CmpOp::Eq, CONST, T>, &scalar_cmp<CmpOp::Neq, CONST, T>, \
+      &scalar_cmp<CmpOp::Lt, CONST, T>, &scalar_cmp<CmpOp::Lte, CONST, T>, \
+      &scalar_cmp<CmpOp::Gt, CONST, T>, &scalar_cmp<CmpOp::Gte, CONST, T> }
+
+static const SimdKernels SCALAR_KERNELS = {
+    "scalar",
+    SIMPLEDB_SCALAR(long long, true), SIMPLEDB_SCALAR(long long, false),
+    SIMPLEDB_SCALAR(double, true), SIMPLEDB_SCALAR(double, false),
+    SIMPLEDB_SCALAR(uint8_t, true), SIMPLEDB_SCALAR(uint8_t, false),
+    &BloomFilterMap::block_contains,
+};
+
+#ifdef SIMPLEDB_X86
+static const SimdKernels SSE42_KERNELS = {
+    "sse4.2",
+    SIMPLEDB_KERNELS(sse_int, true), SIMPLEDB_KERNELS(sse_int, false),
+    SIMPLEDB_KERNELS(sse_real, true), SIMPLEDB_KERNELS(sse_real, false),
+    SIMPLEDB_KERNELS(sse_byte, true), SIMPLEDB_KERNELS(sse_byte, false),
+    &sse_bloom,
+};
+
+static const SimdKernels AVX2_KERNELS = {
+    "avx2",
+    SIMPLEDB_KERNELS(avx2_int, true), SIMPLEDB_KERNELS(avx2_int, false),
+    SIMPLEDB_KERNELS(avx2_real, true), SIMPLEDB_KERNELS(avx2_real, false),
+    SIMPLEDB_KERNELS(avx2_byte, true), SIMPLEDB_KERNELS(avx2_byte, false),
+    &avx2_bloom,
+};
+
+static const SimdKernels AVX512_KERNELS = {
+    "avx512",
+    SIMPLEDB_KERNELS(avx512_int, true), SIMPLEDB_KERNELS(avx512_int, false),
+    SIMPLEDB_KERNELS(avx512_real, true), SIMPLEDB_KERNELS(avx512_real, false),
+    SIMPLEDB_KERNELS(avx512_byte, true), SIMPLEDB_KERNELS(avx512_byte, false),
+    &avx2_bloom,
+};
+#endif
+
+#undef SIMPLEDB_KERNELS
+#undef SIMPLEDB_SCALAR
+
+
+std::vector<const SimdKernels*> supported_simd_kernels() {
+    std::vector<const SimdKernels*> out{&SCALAR_KERNELS};
+#ifdef SIMPLEDB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) out.push_back(&SSE42_KERNELS);
+    if (__builtin_cpu_supports("avx2")) out.push_back(&AVX2_KERNELS);
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) out.push_back(&AVX512_KERNELS);
+#endif
+    return out;
+}
+
+const SimdKernels& simd_kernels() {
+    static const SimdKernels* best = supported_simd_kernels().back();
+    return *best;
+}
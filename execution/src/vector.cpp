@@ -0,0 +1,75 @@
+#include "execution/vector.hpp"
+
+void ColumnVector::init(DataType::Kind kind) {
+    type = kind;
+    nulls.assign(VECTOR_SIZE, 0);
+    switch (kind) {
+        case DataType::Int: ints.resize(VECTOR_SIZE); break;
+        case DataType::Real: reals.resize(VECTOR_SIZE); break;
+        case DataType::Bool: bools.resize(VECTOR_SIZE); break;
+        case DataType::Text: texts.resize(VECTOR_SIZE); break;
+        case DataType::Custom: break;
+    }
+}
+
+std::string_view StringHeap::add(std::string_view s) {
+    if (s.size() > BLOCK_SIZE / 4) {
+        oversized_.emplace_back(new char[s.size()]);
+        std::memcpy(oversized_.back().get(), s.data(), s.size());
+        return std::string_view(oversized_.back().get(), s.size());
+    }
+    if (blocks_.empty() || used_ + s.size() > BLOCK_SIZE) {
+        if (!blocks_.empty()) block_++;
+        if (block_ == blocks_.size()) blocks_.emplace_back(new char[BLOCK_SIZE]);
+        used_ = 0;
+    }
+    char* dst = blocks_[block_].get() + used_;
+    std::memcpy(dst, s.data(), s.size());
+    used_ += s.size();
+    return std::string_view(dst, s.size());
+}
+
+void StringHeap::clear() {
+    block_ = 0;
+    used_ = 0;
+    oversized_.clear();
+}
+
+void DataChunk::init(const std::vector<ColumnDef>& schema) {
+    if (columns.size() != schema.size()) {
+        columns.assign(schema.size(), ColumnVector{});
+        materialized.assign(schema.size(), false);
+    }
+    for (size_t c = 0; c < schema.size(); ++c) {
+        if (columns[c].nulls.empty() || columns[c].type != schema[c].data_type.kind) {
+            columns[c].init(schema[c].data_type.kind);
+        }
+    }
+    count = 0;
+    sel.clear();
+    strings.clear();
+}
+
+void DataChunk::select_all() {
+    sel.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        sel[i] = static_cast<uint16_t>(i);
+    }
+}
+
+Value DataChunk::value(size_t col, size_t row) const {
+    const ColumnVector& v = columns[col];
+    Value out;
+    if (v.nulls[row]) {
+        out.kind = Value::Null;
+        return out;
+    }
+    switch (v.type) {
+        case DataType::Int: out.kind = Value::Int; out.i = v.ints[row]; break;
+        case DataType::Real: out.kind = Value::Float; out.f = v.reals[row]; break;
+        case DataType::Bool: out.kind = Value::Bool; out.b = v.bools[row] != 0; break;
+        case DataType::Text: out.kind = Value::String; out.s = std::string(v.texts[row]); break;
+        case DataType::Custom: out.kind = Value::Null; break;
+    }
+    return out;
+}
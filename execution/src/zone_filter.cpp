@@ -0,0 +1,108 @@
+#include "execution/zone_filter.hpp"
+#include <algorithm>
+#include <climits>
+#include <limits>
+
+
+namespace {
+
+Expr::Binary::Op mirror(Expr::Binary::Op op) {
+    switch (op) {
+        case Expr::Binary::Lt: return Expr::Binary::Gt;
+        case Expr::Binary::Lte: return Expr::Binary::Gte;
+        case Expr::Binary::Gt: return Expr::Binary::Lt;
+        case Expr::Binary::Gte: return Expr::Binary::Lte;
+        default: return op;
+    }
+}
+
+}
+
+
+ZoneFilter::ZoneFilter(ZoneMap& zones, const ExprArena& arena, const std::vector<ExprId>& conjuncts,
+                       const TupleLayout& layout)
+    : zones_(zones) {
+    for (ExprId conjunct : conjuncts) constrain(arena, conjunct, layout);
+    for (const Range& r : ranges_) never_ |= r.lo > r.hi || r.rlo > r.rhi;
+}
+
+ZoneFilter::Range& ZoneFilter::range(size_t column, DataType::Kind type) {
+    for (Range& r : ranges_) {
+        if (r.column == column) return r;
+    }
+    double inf = std::numeric_limits<double>::infinity();
+    return ranges_.emplace_back(Range{column, type, INT64_MIN, INT64_MAX, -inf, inf});
+}
+
+void ZoneFilter::constrain(const ExprArena& arena, ExprId conjunct, const TupleLayout& layout) {
+    const Expr& e = arena[conjunct];
+    if (e.kind == Expr::Column) {
+        auto col = layout.column_index(arena.column_name(conjunct));
+        if (col && layout.type(*col) == DataType::Bool) {
+            Range& r = range(*col, DataType::Bool);
+            r.lo = std::max<int64_t>(r.lo, 1);
+        }
+        return;
+    }
+    if (e.kind != Expr::BinaryOp) return;
+    Expr::Binary::Op op = e.binary_op();
+    if (op != Expr::Binary::Eq && op != Expr::Binary::Lt && op != Expr::Binary::Lte &&
+        op != Expr::Binary::Gt && op != Expr::Binary::Gte) {
+        return;
+    }
+    ExprId col_id = e.lhs(), lit_id = e.rhs();
+    if (arena[col_id].kind != Expr::Column) {
+        std::swap(col_id, lit_id);
+        op = mirror(op);
+    }
+    const Expr& lit = arena[lit_id];
+    if (arena[col_id].kind != Expr::Column || lit.kind != Expr::Literal) return;
+    auto col = layout.column_index(arena.column_name(col_id));
+    if (!col) return;
+    DataType::Kind type = layout.type(*col);
+
+    if (type == DataType::Int && lit.literal_kind == Value::Int) {
+        Range& r = range(*col, type);
+        long long v = lit.i;
+        switch (op) {
+            case Expr::Binary::Eq: r.lo = std::max<int64_t>(r.lo, v); r.hi = std::min<int64_t>(r.hi, v); break;
+            case Expr::Binary::Lt:
+                if (v == INT64_MIN) never_ = true;
+                else r.hi = std::min<int64_t>(r.hi, v - 1);
+                break;
+            case Expr::Binary::Lte: r.hi = std::min<int64_t>(r.hi, v); break;
+            case Expr::Binary::Gt:
+                if (v == INT64_MAX) never_ = true;
+                else r.lo = std::max<int64_t>(r.lo, v + 1);
+                break;
+            case Expr::Binary::Gte: r.lo = std::max<int64_t>(r.lo, v); break;
+            default: break;
+        }
+    } else if (type == DataType::Real && (lit.literal_kind == Value::Int || lit.literal_kind == Value::Float)) {
+        // Strict bounds are kept inclusive: the range only has to contain every match.
+        Range& r = range(*col, type);
+        double v = lit.literal_kind == Value::Int ? static_cast<double>(lit.i) : lit.f;
+        if (op == Expr::Binary::Eq || op == Expr::Binary::Gt || op == Expr::Binary::Gte) r.rlo = std::max(r.rlo, v);
+        if (op == Expr::Binary::Eq || op == Expr::Binary::Lt || op == Expr::Binary::Lte) r.rhi = std::min(r.rhi, v);
+    } else if (type == DataType::Bool && lit.literal_kind == Value::Bool && op == Expr::Binary::Eq) {
+        Range& r = range(*col, type);
+        r.lo = std::max<int64_t>(r.lo, lit.b);
+        r.hi = std::min<int64_t>(r.hi, lit.b);
+    }
+}
+
+bool ZoneFilter::may_match(uint64_t page_id) const {
+    if (never_) return false;
+    std::vector<ZoneMap::Zone> zones;
+    zones_.read(page_id, zones);
+    for (const Range& r : ranges_) {
+        const ZoneMap::Zone& z = zones[r.column];
+        if (!z.has_values) return false;
+        if (r.type == DataType::Real) {
+            if (z.max_real() < r.rlo || z.min_real() > r.rhi) return false;
+        } else if (z.max < r.lo || z.min > r.hi) {
+            return false;
+        }
+    }
+    return true;
+}
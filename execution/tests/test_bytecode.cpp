@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "execution/bytecode.hpp"
+#include "parser/parser.hpp"
+
+static std::vector<ColumnDef> schema() {
+    return {
+        {"id", {DataType::Int, ""}},
+        {"score", {DataType::Real, ""}},
+        {"name", {DataType::Text, ""}},
+        {"active", {DataType::Bool, ""}},
+    };
+}
+
+static Value int_v(long long i) { Value v; v.kind = Value::Int; v.i = i; return v; }
+static Value real_v(double f) { Value v; v.kind = Value::Float; v.f = f; return v; }
+static Value text_v(std::string s) { Value v; v.kind = Value::String; v.s = std::move(s); return v; }
+static Value bool_v(bool b) { Value v; v.kind = Value::Bool; v.b = b; return v; }
+static Value null_v() { Value v; v.kind = Value::Null; return v; }
+
+// Compiles the WHERE clause of "SELECT * FROM t WHERE <where>" against schema().
+struct CompiledWhere {
+    Statement stmt;
+    Program program;
+
+    explicit CompiledWhere(const std::string& where)
+        : stmt(parse("SELECT * FROM t WHERE " + where)),
+          program(compile_predicate(stmt.exprs, *std::get<Statement::SelectData>(stmt.data).selection, schema())) {}
+
+    bool matches(const std::vector<Value>& row) const {
+        Evaluator ev(program);
+        return ev.matches(ValueRow{row.data()});
+    }
+};
+
+
+TEST(BytecodeTest, TypedComparisons) {
+    std::vector<Value> row = {int_v(7), real_v(2.5), text_v("bob"), bool_v(true)};
+    EXPECT_TRUE(CompiledWhere("id = 7").matches(row));
+    EXPECT_FALSE(CompiledWhere("id != 7").matches(row));
+    EXPECT_TRUE(CompiledWhere("id >= 7 AND id < 8").matches(row));
+    EXPECT_TRUE(CompiledWhere("score > 2").matches(row));       // int constant widened to REAL
+    EXPECT_TRUE(CompiledWhere("id < score * 4").matches(row));  // int column widened to REAL
+    EXPECT_TRUE(CompiledWhere("name = 'bob'").matches(row));
+    EXPECT_TRUE(CompiledWhere("name < 'carl'").matches(row));
+    EXPECT_TRUE(CompiledWhere("active").matches(row));
+    EXPECT_TRUE(CompiledWhere("active = TRUE").matches(row));
+    EXPECT_FALSE(CompiledWhere("NOT active").matches(row));
+}
+
+TEST(BytecodeTest, Arithmetic) {
+    std::vector<Value> row = {int_v(10), real_v(1.5), text_v(""), bool_v(false)};
+    EXPECT_TRUE(CompiledWhere("id + 5 = 15").matches(row));
+    EXPECT_TRUE(CompiledWhere("id / 3 = 3").matches(row));
+    EXPECT_TRUE(CompiledWhere("-id = 0 - 10").matches(row));
+    EXPECT_TRUE(CompiledWhere("score * 2 = 3.0").matches(row));
+    // Division by zero and overflow evaluate to NULL, which never matches.
+    EXPECT_FALSE(CompiledWhere("id / 0 = 0").matches(row));
+    EXPECT_FALSE(CompiledWhere("NOT (id / 0 = 0)").matches(row));
+    EXPECT_FALSE(CompiledWhere("id * 9223372036854775807 > 0").matches(row));
+}
+
+TEST(BytecodeTest, ThreeValuedLogicWithShortCircuit) {
+    std::vector<Value> row = {null_v(), real_v(1.0), null_v(), bool_v(true)};
+    EXPECT_FALSE(CompiledWhere("id = 1").matches(row));
+    EXPECT_FALSE(CompiledWhere("NOT (id = 1)").matches(row));
+    EXPECT_TRUE(CompiledWhere("id = 1 OR active").matches(row));  // NULL OR TRUE
+    EXPECT_FALSE(CompiledWhere("id = 1 AND active").matches(row)); // NULL AND TRUE
+    EXPECT_TRUE(CompiledWhere("NOT (id = 1 AND NOT active)").matches(row)); // NOT (NULL AND FALSE)
+    EXPECT_FALSE(CompiledWhere("name = 'x' OR score > 5").matches(row));
+    EXPECT_FALSE(CompiledWhere("active AND NULL").matches(row));
+    EXPECT_TRUE(CompiledWhere("active OR NULL").matches(row));
+}
+
+TEST(BytecodeTest, EvaluatorIsReusableAcrossRows) {
+    CompiledWhere w("score > 1.5 AND name != 'skip'");
+    Evaluator ev(w.program);
+    std::vector<std::vector<Value>> rows = {
+        {int_v(1), real_v(2.0), text_v("keep"), bool_v(true)},
+        {int_v(2), real_v(1.0), text_v("keep"), bool_v(true)},
+        {int_v(3), real_v(3.0), text_v("skip"), bool_v(true)},
+        {int_v(4), real_v(9.0), null_v(), bool_v(true)},
+        {int_v(5), real_v(4.0), text_v("ok"), bool_v(false)},
+    };
+    std::vector<long long> hits;
+    for (const auto& r : rows) {
+        if (ev.matches(ValueRow{r.data()})) hits.push_back(r[0].i);
+    }
+    EXPECT_EQ(hits, (std::vector<long long>{1, 5}));
+}
+
+TEST(BytecodeTest, EvaluateValue) {
+    Statement s = parse("UPDATE t SET score = score * 2 + id, name = name WHERE TRUE");
+    const auto& d = std::get<Statement::UpdateData>(s.data);
+    Program p = compile_expr(s.exprs, d.assignments[0].second, schema());
+    EXPECT_EQ(p.result_type, DataType::Real);
+    std::vector<Value> row = {int_v(1), real_v(2.25), text_v("n"), bool_v(true)};
+    Evaluator ev(p);
+    Value v = ev.evaluate(ValueRow{row.data()});
+    EXPECT_EQ(v.kind, Value::Float);
+    EXPECT_DOUBLE_EQ(v.f, 5.5);
+
+    Program q = compile_expr(s.exprs, d.assignments[1].second, schema());
+    EXPECT_EQ(Evaluator(q).evaluate(ValueRow{row.data()}).s, "n");
+}
+
+TEST(BytecodeTest, CompileErrors) {
+    EXPECT_THROW(CompiledWhere("missing = 1"), CompileError);
+    EXPECT_THROW(CompiledWhere("name = 1"), CompileError);
+    EXPECT_THROW(CompiledWhere("id AND active"), CompileError);
+    EXPECT_THROW(CompiledWhere("id + 1"), CompileError);
+    EXPECT_THROW(CompiledWhere("name + 'x' = 'y'"), CompileError);
+    EXPECT_THROW(CompiledWhere("NULL + 'x' = 'y'"), CompileError);
+    EXPECT_THROW(CompiledWhere("NULL * active"), CompileError);
+    EXPECT_THROW(CompiledWhere("name - NULL = 'y'"), CompileError);
+    EXPECT_NO_THROW(CompiledWhere("NULL + id = 1"));
+    EXPECT_NO_THROW(CompiledWhere("name = NULL"));
+    EXPECT_THROW(CompiledWhere("id = ?"), CompileError);
+
+    std::vector<ColumnDef> custom = {{"c", {DataType::Custom, "uuid"}}};
+    Statement s = parse("SELECT * FROM t WHERE c = 1");
+    EXPECT_THROW(compile_predicate(s.exprs, *std::get<Statement::SelectData>(s.data).selection, custom), CompileError);
+}
@@ -0,0 +1,565 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "execution/batch_evaluator.hpp"
+#include "execution/bloom_filter_probe.hpp"
+#include "execution/executor.hpp"
+#include "execution/zone_filter.hpp"
+#include "parser/parser.hpp"
+#include "parser/rewrite.hpp"
+
+static std::vector<ColumnDef> schema() {
+    return {
+        {"id", {DataType::Int, ""}},
+        {"score", {DataType::Real, ""}},
+        {"name", {DataType::Text, ""}},
+        {"active", {DataType::Bool, ""}},
+    };
+}
+
+// Row i: id = i, score = i / 4 (NULL every 7th row), name = "n<i % 10>", active = even.
+static std::vector<Value> make_row(long long i) {
+    std::vector<Value> row(4);
+    row[0].kind = Value::Int; row[0].i = i;
+    if (i % 7 == 0) {
+        row[1].kind = Value::Null;
+    } else {
+        row[1].kind = Value::Float; row[1].f = i / 4.0;
+    }
+    row[2].kind = Value::String; row[2].s = "n" + std::to_string(i % 10);
+    row[3].kind = Value::Bool; row[3].b = i % 2 == 0;
+    return row;
+}
+
+class ExecutorTest : public ::testing::Test {
+protected:
+    static constexpr long long ROWS = 5000;
+    std::string path;
+    BufferPoolManager bpm{64};
+    TupleLayout layout{schema()};
+    std::unique_ptr<HeapFile> heap;
+
+    void SetUp() override {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() /
+                ("exec_" + std::string(name) + "_" + std::to_string(::getpid()) + ".tbl")).string();
+        std::filesystem::remove(path);
+        heap = std::make_unique<HeapFile>(path, TableLayout::Row, layout, bpm);
+        std::vector<std::vector<uint8_t>> batch;
+        for (long long i = 0; i < ROWS; ++i) batch.push_back(layout.encode(make_row(i)));
+        heap->insert_batch(batch);
+    }
+
+    void TearDown() override {
+        heap.reset();
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".fsm");
+        std::filesystem::remove(path + ".zm");
+        std::filesystem::remove(path + ".bf");
+    }
+
+    std::vector<std::vector<Value>> run(const std::string& sql) {
+        Statement stmt = parse(sql);
+        normalize(stmt);
+        auto op = plan_select(stmt, *heap, layout);
+        return collect_rows(*op);
+    }
+
+    // Reference answer: ids of rows matching `where`, evaluated row by row.
+    std::vector<long long> expected_ids(const std::string& where) {
+        Statement stmt = parse("SELECT * FROM t WHERE " + where);
+        Program p = compile_predicate(stmt.exprs, *std::get<Statement::SelectData>(stmt.data).selection, schema());
+        Evaluator ev(p);
+        std::vector<long long> ids;
+        for (long long i = 0; i < ROWS; ++i) {
+            auto row = make_row(i);
+            if (ev.matches(ValueRow{row.data()})) ids.push_back(i);
+        }
+        return ids;
+    }
+};
+
+static std::vector<long long> ids_of(const std::vector<std::vector<Value>>& rows) {
+    std::vector<long long> ids;
+    for (const auto& r : rows) ids.push_back(r[0].i);
+    return ids;
+}
+
+
+TEST_F(ExecutorTest, ScanReturnsEveryRowInOrder) {
+    auto rows = run("SELECT * FROM t");
+    ASSERT_EQ(rows.size(), size_t(ROWS));
+    for (long long i = 0; i < ROWS; i += 997) {
+        auto want = make_row(i);
+        EXPECT_EQ(rows[i][0].i, i);
+        EXPECT_EQ(rows[i][1].kind, want[1].kind);
+        EXPECT_EQ(rows[i][2].s, want[2].s);
+        EXPECT_EQ(rows[i][3].b, want[3].b);
+    }
+}
+
+TEST_F(ExecutorTest, FilterMatchesRowAtATimeEvaluation) {
+    for (const std::string where : {
+             "id < 100",
+             "score > 500.5 AND active",
+             "name = 'n3' OR id < 20",
+             "score * 2 >= id / 2 AND name != 'n0'",
+             "active OR score > 10",
+             "id - 10 = 4990",
+         }) {
+        SCOPED_TRACE(where);
+        EXPECT_EQ(ids_of(run("SELECT id FROM t WHERE " + where)), expected_ids(where));
+    }
+}
+
+TEST_F(ExecutorTest, ThreeValuedLogicOverNullColumns) {
+    // score is NULL for multiples of 7: "score > 1 OR active" is NULL there unless active.
+    EXPECT_EQ(ids_of(run("SELECT id FROM t WHERE score > 1 OR active")),
+              expected_ids("score > 1 OR active"));
+    EXPECT_EQ(ids_of(run("SELECT id FROM t WHERE NOT (score < 100 AND active)")),
+              expected_ids("NOT (score < 100 AND active)"));
+}
+
+TEST_F(ExecutorTest, ProjectionReordersAndRepeatsColumns) {
+    auto rows = run("SELECT name, id, name FROM t WHERE id >= 4998");
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0][0].s, "n8");
+    EXPECT_EQ(rows[0][1].i, 4998);
+    EXPECT_EQ(rows[0][2].s, "n8");
+    EXPECT_EQ(rows[1][0].s, "n9");
+}
+
+class CountingOperator : public Operator {
+public:
+    CountingOperator(std::unique_ptr<Operator> child, int& calls) : child_(std::move(child)), calls_(calls) {}
+    bool next(DataChunk& chunk) override { calls_++; return child_->next(chunk); }
+    const std::vector<ColumnDef>& schema() const override { return child_->schema(); }
+private:
+    std::unique_ptr<Operator> child_;
+    int& calls_;
+};
+
+TEST_F(ExecutorTest, LimitStopsPullingOnceSatisfied) {
+    int calls = 0;
+    Limit limit(std::make_unique<CountingOperator>(
+                    std::make_unique<SeqScan>(*heap, layout, std::vector<size_t>{0}), calls),
+                1500);
+    size_t rows = 0;
+    DataChunk chunk;
+    while (limit.next(chunk)) rows += chunk.size();
+    EXPECT_EQ(rows, 1500u);
+    EXPECT_EQ(calls, 2);
+
+    auto limited = run("SELECT id FROM t WHERE active LIMIT 3");
+    EXPECT_EQ(ids_of(limited), (std::vector<long long>{0, 2, 4}));
+    EXPECT_TRUE(run("SELECT id FROM t LIMIT 0").empty());
+}
+
+TEST_F(ExecutorTest, UnknownColumnsAreRejected) {
+    EXPECT_THROW(run("SELECT nope FROM t"), CompileError);
+    EXPECT_THROW(run("SELECT id FROM t WHERE nope = 1"), CompileError);
+}
+
+TEST_F(ExecutorTest, PaxTableScansMatchRowTable) {
+    std::string pax_path = path + ".pax";
+    std::filesystem::remove(pax_path);
+    {
+        HeapFile pax(pax_path, TableLayout::Pax, layout, bpm);
+        std::vector<std::vector<uint8_t>> batch;
+        for (long long i = 0; i < ROWS; ++i) batch.push_back(layout.encode(make_row(i)));
+        auto pax_rids = pax.insert_batch(batch);
+        std::vector<RID> row_rids;
+        heap->scan([&](RID rid, TupleRef) { row_rids.push_back(rid); });
+
+        // Deletions on the first pages force the row-by-row gather path there.
+        for (long long i = 0; i < 300; i += 3) {
+            pax.remove(pax_rids[i]);
+            heap->remove(row_rids[i]);
+        }
+
+        for (const std::string sql : {
+                 "SELECT * FROM t",
+                 "SELECT id, name FROM t WHERE score > 500.5 AND active",
+                 "SELECT id, score FROM t WHERE name = 'n3' OR id < 20",
+             }) {
+            SCOPED_TRACE(sql);
+            Statement stmt = parse(sql);
+            normalize(stmt);
+            auto got = collect_rows(*plan_select(stmt, pax, layout));
+            auto want = run(sql);
+            ASSERT_EQ(got.size(), want.size());
+            for (size_t r = 0; r < got.size(); ++r) {
+                ASSERT_EQ(got[r].size(), want[r].size());
+                EXPECT_EQ(got[r][0].i, want[r][0].i);
+                for (size_t c = 1; c < got[r].size(); ++c) {
+                    EXPECT_EQ(got[r][c].kind, want[r][c].kind);
+                    EXPECT_EQ(got[r][c].s, want[r][c].s);
+                    EXPECT_EQ(got[r][c].f, want[r][c].f);
+                    EXPECT_EQ(got[r][c].b, want[r][c].b);
+                }
+            }
+        }
+    }
+    std::filesystem::remove(pax_path);
+    std::filesystem::remove(pax_path + ".fsm");
+    std::filesystem::remove(pax_path + ".zm");
+    std::filesystem::remove(pax_path + ".bf");
+}
+
+TEST_F(ExecutorTest, IndexScanMatchesFullScan) {
+    std::string index_path = path + ".idx";
+    std::filesystem::remove(index_path);
+    {
+        BPlusTree tree(index_path, bpm);
+        create_index(parse("CREATE INDEX t_id ON t (id)"), *heap, layout, tree);
+        EXPECT_THROW(create_index(parse("CREATE INDEX t_name ON t (name)"), *heap, layout, tree),
+                     std::invalid_argument);
+        EXPECT_THROW(create_index(parse("CREATE INDEX t_x ON t (nope)"), *heap, layout, tree),
+                     std::invalid_argument);
+        std::vector<TableIndex> indexes{{0, &tree}};
+
+        // A record deleted after indexing leaves a stale entry the scan must skip.
+        heap->remove(tree.find(42).at(0));
+
+        for (const std::string where : {
+                 "id = 4321",
+                 "id = 42",
+                 "id >= 100 AND id < 200 AND active",
+                 "3000 < id AND name = 'n7'",
+                 "id > 10 AND id < 5",
+                 "id <= 3 OR id = 4999",
+             }) {
+            SCOPED_TRACE(where);
+            Statement stmt = parse("SELECT id FROM t WHERE " + where);
+            normalize(stmt);
+            auto got = ids_of(collect_rows(*plan_select(stmt, *heap, layout, indexes)));
+            auto want = expected_ids(where);
+            want.erase(std::remove(want.begin(), want.end(), 42), want.end());
+            EXPECT_EQ(got, want);
+        }
+    }
+    std::filesystem::remove(index_path);
+}
+
+TEST_F(ExecutorTest, HashIndexServesEqualityLookups) {
+    std::string index_path = path + ".hash";
+    std::filesystem::remove(index_path);
+    {
+        HashIndex hash(index_path, bpm);
+        EXPECT_THROW(create_index(parse("CREATE INDEX t_id ON t (id)"), *heap, layout, hash),
+                     std::invalid_argument);
+        create_index(parse("CREATE INDEX t_id ON t USING HASH (id)"), *heap, layout, hash);
+        std::vector<TableIndex> indexes{{0, nullptr, &hash}};
+
+        for (const std::string where : {
+                 "id = 4321",
+                 "17 = id AND active = FALSE",
+                 "id = 3 AND id = 4",
+                 "id < 10",
+                 "id = 5 OR id = 6",
+             }) {
+            SCOPED_TRACE(where);
+            Statement stmt = parse("SELECT id FROM t WHERE " + where);
+            normalize(stmt);
+            EXPECT_EQ(ids_of(collect_rows(*plan_select(stmt, *heap, layout, indexes))), expected_ids(where));
+        }
+    }
+    std::filesystem::remove(index_path);
+}
+
+TEST_F(ExecutorTest, SnapshotPlansReadOnlyVisibleVersions) {
+    TransactionManager txns;
+    MvccHeap table(*heap, txns);
+    auto rid_of = [&](long long id) {
+        RID found{0, 0};
+        heap->scan([&](RID rid, TupleRef t) {
+            if (layout.get_int(t.data, 0) == id) found = rid;
+        });
+        return found;
+    };
+
+    auto reader = txns.begin();
+    auto writer = txns.begin();
+    table.insert(*writer, layout.encode(make_row(100000)));
+    ASSERT_TRUE(table.remove(*writer, rid_of(42)));
+    ASSERT_TRUE(table.update(*writer, rid_of(43), layout.encode(make_row(200000))));
+
+    std::string index_path = path + ".hash";
+    std::filesystem::remove(index_path);
+    HashIndex hash(index_path, bpm);
+    // Indexes every record in the heap, including versions some snapshots do not see.
+    create_index(parse("CREATE INDEX t_id ON t USING HASH (id)"), *heap, layout, hash);
+    std::vector<TableIndex> indexes{{0, nullptr, &hash}};
+
+    auto query = [&](const std::string& where, const Transaction* txn, size_t threads = 1) {
+        Statement stmt = parse("SELECT id FROM t WHERE " + where);
+        normalize(stmt);
+        auto op = txn ? plan_select(stmt, table, *txn, layout, indexes, threads)
+                      : plan_select(stmt, *heap, layout, indexes, threads);
+        auto ids = ids_of(collect_rows(*op));
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    const std::vector<long long> before{40, 41, 42, 43, 44};
+    const std::vector<long long> after{40, 41, 44, 100000, 200000};
+    const std::string range = "(id >= 40 AND id < 45) OR id >= 100000";
+
+    // The plain heap shows every version, committed or not.
+    EXPECT_EQ(query(range, nullptr), (std::vector<long long>{40, 41, 42, 43, 44, 100000, 200000}));
+    for (size_t threads : {1, 4}) {
+        SCOPED_TRACE(threads);
+        EXPECT_EQ(query(range, reader.get(), threads), before);
+        EXPECT_EQ(query(range, writer.get(), threads), after);
+    }
+    EXPECT_EQ(query("id = 42", reader.get()), std::vector<long long>{42});
+    EXPECT_TRUE(query("id = 42", writer.get()).empty());
+    EXPECT_TRUE(query("id = 100000", reader.get()).empty());
+    EXPECT_EQ(query("id = 100000", writer.get()), std::vector<long long>{100000});
+
+    txns.commit(*writer);
+    EXPECT_EQ(query(range, reader.get()), before);
+    auto later = txns.begin();
+    EXPECT_EQ(query(range, later.get()), after);
+    std::filesystem::remove(index_path);
+}
+
+TEST_F(ExecutorTest, ParallelScanMatchesSerialScan) {
+    // Enough extra pages that every worker gets several morsels.
+    std::vector<std::vector<uint8_t>> batch;
+    for (long long i = ROWS; i < 12 * ROWS; ++i) batch.push_back(layout.encode(make_row(i)));
+    heap->insert_batch(batch);
+    ASSERT_GT(heap->page_count(), 8 * ParallelScan::MORSEL_PAGES);
+
+    for (const std::string sql : {
+             "SELECT id FROM t",
+             "SELECT id, name FROM t WHERE score > 500.5 AND active",
+             "SELECT id FROM t WHERE name = 'n3' OR id < 20",
+             "SELECT id FROM t WHERE id = 123456",
+         }) {
+        SCOPED_TRACE(sql);
+        Statement stmt = parse(sql);
+        normalize(stmt);
+        auto got = ids_of(collect_rows(*plan_select(stmt, *heap, layout, {}, 4)));
+        auto want = ids_of(run(sql));
+        std::sort(got.begin(), got.end());
+        EXPECT_EQ(got, want);
+    }
+
+    Statement stmt = parse("SELECT id, active FROM t WHERE active LIMIT 10");
+    normalize(stmt);
+    auto rows = collect_rows(*plan_select(stmt, *heap, layout, {}, 4));
+    ASSERT_EQ(rows.size(), 10u);
+    for (const auto& r : rows) EXPECT_TRUE(r[1].b);
+}
+
+TEST_F(ExecutorTest, GroupByMatchesRowAtATimeRollup) {
+    struct Group { long long rows = 0, scores = 0, sum_id = 0, max_id = 0; double min_score = 0, sum_score = 0; };
+    std::map<std::string, Group> want;
+    for (long long i = 100; i < ROWS; ++i) {
+        auto row = make_row(i);
+        Group& g = want[row[2].s];
+        g.rows++;
+        g.sum_id += i;
+        g.max_id = std::max(g.max_id, i);
+        if (row[1].kind == Value::Null) continue;
+        g.min_score = g.scores == 0 ? row[1].f : std::min(g.min_score, row[1].f);
+        g.sum_score += row[1].f;
+        g.scores++;
+    }
+
+    const std::string sql = "SELECT COUNT(*), name, COUNT(score), SUM(id), MIN(score), MAX(id), AVG(score) "
+                            "FROM t WHERE id >= 100 GROUP BY name";
+    for (size_t threads : {1, 4}) {
+        SCOPED_TRACE(threads);
+        Statement stmt = parse(sql);
+        normalize(stmt);
+        auto op = plan_select(stmt, *heap, layout, {}, threads);
+        EXPECT_EQ(op->schema()[0].name, "count(*)");
+        EXPECT_EQ(op->schema()[6].data_type.kind, DataType::Real);
+        auto rows = collect_rows(*op);
+        ASSERT_EQ(rows.size(), want.size());
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a[1].s < b[1].s; });
+        auto it = want.begin();
+        for (const auto& r : rows) {
+            EXPECT_EQ(r[1].s, it->first);
+            const Group& g = (it++)->second;
+            EXPECT_EQ(r[0].i, g.rows);
+            EXPECT_EQ(r[2].i, g.scores);
+            EXPECT_EQ(r[3].i, g.sum_id);
+            EXPECT_DOUBLE_EQ(r[4].f, g.min_score);
+            EXPECT_EQ(r[5].i, g.max_id);
+            EXPECT_DOUBLE_EQ(r[6].f, g.sum_score / g.scores);
+        }
+    }
+}
+
+TEST_F(ExecutorTest, AggregatesOverEmptyInputAndNullKeys) {
+    // Without GROUP BY there is always one row; COUNT is 0 and the rest NULL.
+    auto rows = run("SELECT COUNT(*), SUM(id), MAX(score) FROM t WHERE id < 0");
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0].i, 0);
+    EXPECT_EQ(rows[0][1].kind, Value::Null);
+    EXPECT_EQ(rows[0][2].kind, Value::Null);
+    EXPECT_TRUE(run("SELECT name FROM t WHERE id < 0 GROUP BY name").empty());
+
+    // score is NULL for ids 0, 7, 14, 21 and 28, which form a single group.
+    rows = run("SELECT score, COUNT(*), COUNT(score) FROM t WHERE id < 30 GROUP BY score");
+    EXPECT_EQ(rows.size(), 26u);
+    auto null_group = std::find_if(rows.begin(), rows.end(), [](const auto& r) { return r[0].kind == Value::Null; });
+    ASSERT_NE(null_group, rows.end());
+    EXPECT_EQ((*null_group)[1].i, 5);
+    EXPECT_EQ((*null_group)[2].i, 0);
+
+    // COUNT overwrites NULL flags left in a reused chunk's INT column.
+    AggregateTable table(layout.columns(), {}, {AggregateSpec{AggregateFunc::Count, std::nullopt}});
+    DataChunk chunk;
+    chunk.init(table.schema());
+    std::fill(chunk.columns[0].nulls.begin(), chunk.columns[0].nulls.end(), 1);
+    table.emit(0, chunk);
+    ASSERT_EQ(chunk.count, 1u);
+    EXPECT_EQ(chunk.value(0, 0).kind, Value::Int);
+    EXPECT_EQ(chunk.value(0, 0).i, 0);
+}
+
+TEST_F(ExecutorTest, ManyGroupsAcrossThreads) {
+    // One group per row: the table grows several times, and LIMIT applies to groups.
+    for (size_t threads : {1, 3}) {
+        SCOPED_TRACE(threads);
+        Statement stmt = parse("SELECT id, COUNT(*), SUM(id) FROM t GROUP BY id, active");
+        normalize(stmt);
+        auto rows = collect_rows(*plan_select(stmt, *heap, layout, {}, threads));
+        ASSERT_EQ(rows.size(), size_t(ROWS));
+        std::vector<long long> ids = ids_of(rows);
+        std::sort(ids.begin(), ids.end());
+        for (long long i = 0; i < ROWS; ++i) EXPECT_EQ(ids[i], i);
+        for (const auto& r : rows) {
+            EXPECT_EQ(r[1].i, 1);
+            EXPECT_EQ(r[2].i, r[0].i);
+        }
+    }
+    EXPECT_EQ(run("SELECT id FROM t GROUP BY id LIMIT 10").size(), 10u);
+}
+
+TEST_F(ExecutorTest, AggregationRejectsUngroupedColumns) {
+    EXPECT_THROW(run("SELECT id, COUNT(*) FROM t"), CompileError);
+    EXPECT_THROW(run("SELECT name FROM t GROUP BY id"), CompileError);
+    EXPECT_THROW(run("SELECT * FROM t GROUP BY id"), CompileError);
+    EXPECT_THROW(run("SELECT SUM(name) FROM t"), CompileError);
+    EXPECT_THROW(run("SELECT AVG(active) FROM t"), CompileError);
+    EXPECT_THROW(run("SELECT COUNT(nope) FROM t"), CompileError);
+    EXPECT_THROW(run("SELECT COUNT(*) FROM t GROUP BY nope"), CompileError);
+    EXPECT_EQ(run("SELECT COUNT(name), COUNT(active) FROM t")[0][0].i, ROWS);
+}
+
+TEST_F(ExecutorTest, ZoneMapsSkipPagesThatCannotMatch) {
+    ASSERT_GT(heap->page_count(), 10u);
+    struct Case { std::string where; uint64_t max_read; };
+    for (const Case& c : std::vector<Case>{
+             {"id >= 4000 AND id < 4100 AND name != 'n1'", 2},
+             {"4100 > id AND id >= 4000", 2},
+             {"score > 1200.5", 2},
+             {"score <= 0.75", 1},
+             {"id = 2500", 1},
+             {"id < 0", 0},
+             {"id > 10 AND id < 5", 0},
+             {"active AND id < 300", 2},
+             {"active = false", heap->page_count()},
+             {"id != 7", heap->page_count()},
+         }) {
+        SCOPED_TRACE(c.where);
+        Statement stmt = parse("SELECT id FROM t WHERE " + c.where);
+        normalize(stmt);
+        auto filter = std::make_shared<ZoneFilter>(*heap->zone_map(), stmt.exprs,
+                                                   conjuncts(stmt.exprs, *std::get<Statement::SelectData>(stmt.data).selection),
+                                                   layout);
+        SeqScan scan(*heap, layout, {0});
+        scan.set_page_filter([&](uint64_t page_id) { return filter->may_match(page_id); });
+        collect_rows(scan);
+        EXPECT_LE(heap->page_count() - scan.pages_skipped(), c.max_read);
+
+        auto want = expected_ids(c.where);
+        EXPECT_EQ(ids_of(run("SELECT id FROM t WHERE " + c.where)), want);
+        auto got = ids_of(collect_rows(*plan_select(stmt, *heap, layout, {}, 4)));
+        std::sort(got.begin(), got.end());
+        EXPECT_EQ(got, want);
+    }
+}
+
+TEST_F(ExecutorTest, BloomFiltersSkipPagesZoneMapsCannot) {
+    // Rows in a scattered order, so every page's zone spans nearly the whole table.
+    std::string shuffled_path = path + ".shuffled";
+    std::filesystem::remove(shuffled_path);
+    {
+        HeapFile shuffled(shuffled_path, TableLayout::Row, layout, bpm);
+        std::vector<std::vector<uint8_t>> batch;
+        for (long long i = 0; i < ROWS; ++i) batch.push_back(layout.encode(make_row(i * 3001 % ROWS)));
+        shuffled.insert_batch(batch);
+        ASSERT_NE(shuffled.bloom_filters(), nullptr);
+        ASSERT_GT(shuffled.page_count(), 4 * BloomFilterMap::GROUP_PAGES);
+
+        struct Case { std::string where; uint64_t max_read; };
+        for (const Case& c : std::vector<Case>{
+                 {"id = 2500", BloomFilterMap::GROUP_PAGES},
+                 {"1234 = id AND active", BloomFilterMap::GROUP_PAGES},
+                 {"score = 625", BloomFilterMap::GROUP_PAGES},
+                 {"score = 312.75 OR id = 3", shuffled.page_count()},
+                 {"name = 'absent'", BloomFilterMap::GROUP_PAGES},
+                 {"name = 'n3'", shuffled.page_count()},
+                 {"id >= 2500", shuffled.page_count()},
+             }) {
+            SCOPED_TRACE(c.where);
+            Statement stmt = parse("SELECT id FROM t WHERE " + c.where);
+            normalize(stmt);
+            auto where = conjuncts(stmt.exprs, *std::get<Statement::SelectData>(stmt.data).selection);
+            BloomFilterProbe probe(*shuffled.bloom_filters(), stmt.exprs, where, layout);
+            SeqScan scan(shuffled, layout, {0});
+            scan.set_page_filter([&](uint64_t page_id) { return probe.may_match(page_id); });
+            collect_rows(scan);
+            EXPECT_LE(shuffled.page_count() - scan.pages_skipped(), c.max_read);
+
+            auto want = expected_ids(c.where);
+            for (size_t threads : {1, 4}) {
+                auto got = ids_of(collect_rows(*plan_select(stmt, shuffled, layout, {}, threads)));
+                std::sort(got.begin(), got.end());
+                EXPECT_EQ(got, want);
+            }
+        }
+    }
+    std::filesystem::remove(shuffled_path);
+    std::filesystem::remove(shuffled_path + ".fsm");
+    std::filesystem::remove(shuffled_path + ".zm");
+    std::filesystem::remove(shuffled_path + ".bf");
+}
+
+TEST(BatchEvaluatorTest, AgreesWithScalarEvaluatorOnPartialSelection) {
+    DataChunk chunk;
+    chunk.init(schema());
+    for (long long i = 0; i < 100; ++i) {
+        auto row = make_row(i);
+        chunk.columns[0].ints[i] = row[0].i;
+        chunk.columns[1].nulls[i] = row[1].kind == Value::Null;
+        chunk.columns[1].reals[i] = row[1].kind == Value::Null ? 0.0 : row[1].f;
+        chunk.columns[2].texts[i] = chunk.strings.add(row[2].s);
+        chunk.columns[3].bools[i] = row[3].b;
+    }
+    chunk.count = 100;
+
+    Statement stmt = parse("SELECT * FROM t WHERE (score > 5 OR name = 'n1') AND NOT active OR id * 3 = 60");
+    Program p = compile_predicate(stmt.exprs, *std::get<Statement::SelectData>(stmt.data).selection, schema());
+    BatchEvaluator batch(p);
+    Evaluator scalar(p);
+
+    std::vector<uint16_t> sel;
+    for (uint16_t r = 0; r < 100; r += 3) sel.push_back(r);
+    std::vector<uint16_t> want;
+    for (uint16_t r : sel) {
+        if (scalar.matches(ChunkRow{&chunk, r})) want.push_back(r);
+    }
+    batch.select(chunk, sel);
+    EXPECT_EQ(sel, want);
+    EXPECT_FALSE(want.empty());
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "execution/chunk_predicate.hpp"
+#include "execution/simd.hpp"
+#include "parser/parser.hpp"
+#include "storage/bloom_filter.hpp"
+
+static const CmpOp ALL_OPS[] = {CmpOp::Eq, CmpOp::Neq, CmpOp::Lt, CmpOp::Lte, CmpOp::Gt, CmpOp::Gte};
+static const size_t LENGTHS[] = {0, 1, 63, 64, 65, 130, 1000, 1024};
+
+template<typename T>
+static bool reference(CmpOp op, T x, T y) {
+    switch (op) {
+        case CmpOp::Eq: return x == y;
+        case CmpOp::Neq: return x != y;
+        case CmpOp::Lt: return x < y;
+        case CmpOp::Lte: return x <= y;
+        case CmpOp::Gt: return x > y;
+        case CmpOp::Gte: return x >= y;
+    }
+    return false;
+}
+
+template<typename T>
+static void check(CmpKernel<T> const_table[6], CmpKernel<T> column_table[6],
+                  const std::vector<T>& a, const std::vector<T>& b, T c, const std::string& isa) {
+    for (size_t n : LENGTHS) {
+        for (CmpOp op : ALL_OPS) {
+            SCOPED_TRACE(isa + " n=" + std::to_string(n) + " op=" + std::to_string(int(op)));
+            std::vector<uint64_t> by_const(BITMAP_WORDS, ~0ull), by_column(BITMAP_WORDS, ~0ull);
+            const_table[int(op)](a.data(), nullptr, c, n, by_const.data());
+            column_table[int(op)](a.data(), b.data(), T{}, n, by_column.data());
+            for (size_t i = 0; i < bitmap_words(n) * 64; ++i) {
+                bool want_const = i < n && reference(op, a[i], c);
+                bool want_column = i < n && reference(op, a[i], b[i]);
+                ASSERT_EQ(bool((by_const[i / 64] >> (i % 64)) & 1), want_const) << "row " << i;
+                ASSERT_EQ(bool((by_column[i / 64] >> (i % 64)) & 1), want_column) << "row " << i;
+            }
+        }
+    }
+}
+
+TEST(SimdTest, EveryKernelSetMatchesScalarSemantics) {
+    std::mt19937_64 rng(42);
+    std::vector<long long> ia(VECTOR_SIZE), ib(VECTOR_SIZE);
+    std::vector<double> fa(VECTOR_SIZE), fb(VECTOR_SIZE);
+    std::vector<uint8_t> ba(VECTOR_SIZE), bb(VECTOR_SIZE);
+    for (size_t i = 0; i < VECTOR_SIZE; ++i) {
+        // Small ranges so equality is common; extremes check signedness.
+        ia[i] = (i % 97 == 0) ? INT64_MIN : (i % 89 == 0) ? INT64_MAX : static_cast<long long>(rng() % 21) - 10;
+        ib[i] = static_cast<long long>(rng() % 21) - 10;
+        fa[i] = double(static_cast<long long>(rng() % 41) - 20) / 4;
+        fb[i] = double(static_cast<long long>(rng() % 41) - 20) / 4;
+        ba[i] = static_cast<uint8_t>(rng() % 3 == 0 ? 200 + rng() % 56 : rng() % 2);
+        bb[i] = static_cast<uint8_t>(rng() % 2);
+    }
+
+    auto sets = supported_simd_kernels();
+    ASSERT_FALSE(sets.empty());
+    EXPECT_STREQ(sets.front()->isa, "scalar");
+    EXPECT_EQ(&simd_kernels(), sets.back());
+    for (const SimdKernels* k : sets) {
+        SimdKernels copy = *k;
+        check<long long>(copy.int_const, copy.int_column, ia, ib, 3, k->isa);
+        check<long long>(copy.int_const, copy.int_column, ia, ib, INT64_MIN, k->isa);
+        check<double>(copy.real_const, copy.real_column, fa, fb, 1.25, k->isa);
+        check<uint8_t>(copy.byte_const, copy.byte_column, ba, bb, 1, k->isa);
+        check<uint8_t>(copy.byte_const, copy.byte_column, ba, bb, 200, k->isa);
+    }
+
+    // Bloom probes: blocks from sparse to dense, each probed with random hashes and
+    // with a hash whose bits were just set.
+    std::vector<uint8_t> block(BloomFilterMap::BLOCK_BYTES);
+    for (int round = 0; round < 2000; ++round) {
+        for (size_t w = 0; w < BloomFilterMap::BLOCK_WORDS; ++w) {
+            uint32_t word = 0;
+            for (int b = 0; b < round % 24; ++b) word |= 1U << (rng() % 32);
+            std::memcpy(block.data() + w * sizeof(word), &word, sizeof(word));
+        }
+        uint64_t hash = rng();
+        for (int present = 0; present < 2; ++present) {
+            if (present) {
+                for (size_t w = 0; w < BloomFilterMap::BLOCK_WORDS; ++w) {
+                    uint32_t word;
+                    std::memcpy(&word, block.data() + w * sizeof(word), sizeof(word));
+                    word |= 1U << ((static_cast<uint32_t>(hash) * BloomFilterMap::SALT[w]) >> 27);
+                    std::memcpy(block.data() + w * sizeof(word), &word, sizeof(word));
+                }
+                ASSERT_TRUE(BloomFilterMap::block_contains(block.data(), hash));
+            }
+            bool expected = BloomFilterMap::block_contains(block.data(), hash);
+            for (const SimdKernels* k : sets) {
+                ASSERT_EQ(k->bloom_contains(block.data(), hash), expected) << k->isa << " round " << round;
+            }
+        }
+    }
+}
+
+static std::vector<ColumnDef> schema() {
+    return {
+        {"id", {DataType::Int, ""}},
+        {"score", {DataType::Real, ""}},
+        {"name", {DataType::Text, ""}},
+        {"active", {DataType::Bool, ""}},
+        {"other", {DataType::Int, ""}},
+    };
+}
+
+static void fill(DataChunk& chunk, size_t rows) {
+    chunk.init(schema());
+    for (size_t i = 0; i < rows; ++i) {
+        chunk.columns[0].ints[i] = static_cast<long long>(i);
+        chunk.columns[0].nulls[i] = i % 11 == 0;
+        chunk.columns[1].reals[i] = double(i) / 8;
+        chunk.columns[1].nulls[i] = i % 5 == 0;
+        chunk.columns[2].texts[i] = chunk.strings.add(std::to_string(i % 3));
+        chunk.columns[3].bools[i] = i % 3 == 0;
+        chunk.columns[3].nulls[i] = i % 13 == 0;
+        chunk.columns[4].ints[i] = static_cast<long long>(rows - i);
+    }
+    chunk.count = rows;
+}
+
+TEST(SimdTest, ChunkPredicateKernelsAgreeWithBytecode) {
+    DataChunk chunk;
+    fill(chunk, 1000);
+    for (const std::string where : {
+             "id < 500",
+             "5 >= id",
+             "score > 20 AND active",
+             "active = FALSE OR id >= other",
+             "(id < 100 OR id > 900) AND (score <= 3.5 OR NOT active)",
+             "score = 12",
+             "name = '1' AND id < 50",
+         }) {
+        SCOPED_TRACE(where);
+        Statement stmt = parse("SELECT * FROM t WHERE " + where);
+        ExprId root = *std::get<Statement::SelectData>(stmt.data).selection;
+        ChunkPredicate pred(stmt.exprs, root, schema());
+        BatchEvaluator reference(pred.program());
+
+        for (size_t stride : {1, 3}) {
+            std::vector<uint16_t> got, want;
+            for (size_t r = 0; r < chunk.count; r += stride) got.push_back(static_cast<uint16_t>(r));
+            want = got;
+            pred.select(chunk, got);
+            reference.select(chunk, want);
+            EXPECT_EQ(got, want);
+        }
+    }
+}
+
+TEST(SimdTest, OnlyKernelShapedPredicatesUseKernels) {
+    auto uses_kernels = [](const std::string& where) {
+        Statement stmt = parse("SELECT * FROM t WHERE " + where);
+        return ChunkPredicate(stmt.exprs, *std::get<Statement::SelectData>(stmt.data).selection, schema())
+            .uses_kernels();
+    };
+    EXPECT_TRUE(uses_kernels("id < 5"));
+    EXPECT_TRUE(uses_kernels("active"));
+    EXPECT_TRUE(uses_kernels("id = other OR (score > 1 AND active)"));
+    EXPECT_FALSE(uses_kernels("name = 'x'"));
+    EXPECT_FALSE(uses_kernels("id + 1 < 5"));
+    EXPECT_FALSE(uses_kernels("id < 2.5"));
+    EXPECT_FALSE(uses_kernels("NOT active"));
+}
@@ -0,0 +1,130 @@
+// Front-end throughput benchmark: statements/second, MB/second and heap
+// allocations per statement for lex() and parse() over representative corpora.
+//
+//   bench_parser [seconds_per_case]
+
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "parser/prepared.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+// ---- Allocation counting ------------------------------------------------------
+
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// ---- Corpora ------------------------------------------------------------------
+
+static std::vector<std::string> point_queries() {
+    std::vector<std::string> out;
+    for (int i = 0; i < 256; ++i) {
+        out.push_back("SELECT id, name, email FROM users WHERE id = " + std::to_string(i * 7919) + " LIMIT 1;");
+    }
+    return out;
+}
+
+static std::vector<std::string> wide_inserts() {
+    std::vector<std::string> out;
+    for (int s = 0; s < 8; ++s) {
+        std::string sql = "INSERT INTO events (id, ts, kind, user_id, amount, label, ok, a, b, c) VALUES ";
+        for (int r = 0; r < 200; ++r) {
+            int id = s * 200 + r;
+            if (r) sql += ", ";
+            sql += "(" + std::to_string(id) + ", " + std::to_string(1700000000 + id) + ", 'click', "
+                 + std::to_string(id % 97) + ", " + std::to_string(id) + ".25, 'it''s " + std::to_string(id)
+                 + "', TRUE, NULL, " + std::to_string(-id) + ", 'x')";
+        }
+        out.push_back(sql);
+    }
+    return out;
+}
+
+static std::vector<std::string> deep_where() {
+    std::vector<std::string> out;
+    for (int s = 0; s < 32; ++s) {
+        std::string where;
+        for (int i = 0; i < 40; ++i) {
+            if (i) where += (i % 3 == 0) ? " OR " : " AND ";
+            where += "(c" + std::to_string(i) + " >= " + std::to_string(s + i)
+                   + " AND NOT (d" + std::to_string(i) + " = 'v" + std::to_string(i) + "'))";
+        }
+        out.push_back("SELECT a, b FROM t WHERE (" + where + ") LIMIT 100");
+    }
+    return out;
+}
+
+// ---- Harness ------------------------------------------------------------------
+
+struct Result {
+    double stmts_per_sec;
+    double mb_per_sec;
+    double allocs_per_stmt;
+};
+
+static Result run(const std::vector<std::string>& corpus, double seconds,
+                  const std::function<void(const std::string&)>& fn) {
+    for (const auto& sql : corpus) fn(sql); // warm caches and thread-local buffers
+
+    using clock = std::chrono::steady_clock;
+    size_t stmts = 0, bytes = 0;
+    size_t allocs_before = g_allocations.load();
+    auto start = clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds) {
+        for (const auto& sql : corpus) {
+            fn(sql);
+            bytes += sql.size();
+        }
+        stmts += corpus.size();
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    }
+    size_t allocs = g_allocations.load() - allocs_before;
+    return Result{stmts / elapsed, bytes / elapsed / (1024.0 * 1024.0), double(allocs) / double(stmts)};
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 0.5;
+
+    struct Corpus { const char* name; std::vector<std::string> sql; };
+    std::vector<Corpus> corpora = {
+        {"point_select", point_queries()},
+        {"wide_insert", wide_inserts()},
+        {"deep_where", deep_where()},
+    };
+
+    std::printf("%-14s %-10s %14s %10s %14s\n", "corpus", "stage", "stmts/s", "MB/s", "allocs/stmt");
+    for (const auto& c : corpora) {
+        std::vector<TokenValue> toks;
+        Result lexed = run(c.sql, seconds, [&](const std::string& sql) { lex(sql, toks); });
+        Result parsed = run(c.sql, seconds, [](const std::string& sql) { parse(sql); });
+        std::printf("%-14s %-10s %14.0f %10.1f %14.2f\n", c.name, "lex", lexed.stmts_per_sec, lexed.mb_per_sec, lexed.allocs_per_stmt);
+        std::printf("%-14s %-10s %14.0f %10.1f %14.2f\n", c.name, "parse", parsed.stmts_per_sec, parsed.mb_per_sec, parsed.allocs_per_stmt);
+    }
+
+    // Same point-query shape through the statement cache: one lookup + bind per call.
+    StatementCache cache;
+    std::vector<std::string> one = {"SELECT id, name, email FROM users WHERE id = ? LIMIT 1;"};
+    long long id = 0;
+    Result prepared = run(one, seconds, [&](const std::string& sql) {
+        PreparedStatement p = cache.prepare(sql);
+        Value v; v.kind = Value::Int; v.i = id++;
+        p.bind(1, v);
+        p.bound_statement();
+    });
+    std::printf("%-14s %-10s %14.0f %10.1f %14.2f\n", "point_select", "prepared", prepared.stmts_per_sec, prepared.mb_per_sec, prepared.allocs_per_stmt);
+    return 0;
+}
@@ -0,0 +1 @@
+CREATE TABLE t (a INT, b INTEGER, c TEXT, d REAL, e FLOAT, f BOOL, g custom_type)
\ No newline at end of file
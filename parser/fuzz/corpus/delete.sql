@@ -0,0 +1 @@
+DELETE FROM t WHERE a != 1 AND (b <= 2 OR c > 3.5)
\ No newline at end of file
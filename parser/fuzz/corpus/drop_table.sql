@@ -0,0 +1 @@
+DROP TABLE IF EXISTS t;
\ No newline at end of file
@@ -0,0 +1 @@
+SELECT * FROM t WHERE ((((((((a))))))))  = -(-(1 / 0)) + 9223372036854775807 * 2
\ No newline at end of file
@@ -0,0 +1 @@
+SELECT name, COUNT(*), sum(score), AVG(score) FROM t WHERE id > 10 GROUP BY name LIMIT 5
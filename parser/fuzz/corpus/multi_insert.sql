@@ -0,0 +1 @@
+INSERT INTO t (a, b) VALUES (1, 'x'), (2, 'it''s'), (-3, NULL), (4.5, TRUE);
\ No newline at end of file
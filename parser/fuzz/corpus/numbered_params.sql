@@ -0,0 +1 @@
+SELECT * FROM t WHERE a = $2 AND b = $1
\ No newline at end of file
@@ -0,0 +1 @@
+SELECT id, name FROM users WHERE id = 42 LIMIT 1;
\ No newline at end of file
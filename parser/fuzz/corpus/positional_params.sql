@@ -0,0 +1 @@
+SELECT * FROM t WHERE a = ? AND b = ? OR c = ?
\ No newline at end of file
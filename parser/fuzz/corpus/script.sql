@@ -0,0 +1,6 @@
+CREATE TABLE t (a INT);
+INSERT INTO t VALUES (1), (2);
+;;
+SELECT * FROM t WHERE a = ';';
+SELECT FROM;
+SELECT * FROM t
\ No newline at end of file
@@ -0,0 +1 @@
+SELECT * FROM t WHERE a = 'unterminated
\ No newline at end of file
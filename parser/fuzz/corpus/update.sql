@@ -0,0 +1 @@
+UPDATE t SET a = a + 1, b = 'z' WHERE NOT (a < 3 OR b = 'q') AND c >= 2 * 3
\ No newline at end of file
@@ -0,0 +1,52 @@
+// libFuzzer harness for the SQL front end.
+//
+// Any input must either parse or fail with ParseError/LexError; every other exception,
+// crash or sanitizer report is a bug. Successful parses are also pushed through
+// binding and normalization, and the input is replayed through ScriptParser.
+
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "parser/prepared.hpp"
+#include "parser/rewrite.hpp"
+#include "parser/script_parser.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+static void exercise_statement(const Statement& parsed) {
+    PreparedStatement p(std::make_shared<const Statement>(parsed));
+    for (size_t i = 1; i <= p.param_count(); ++i) {
+        Value v;
+        v.kind = (i % 2) ? Value::Int : Value::Null;
+        v.i = static_cast<long long>(i);
+        p.bind(i, v);
+    }
+    Statement bound = p.bound_statement();
+    normalize(bound);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view input(reinterpret_cast<const char*>(data), size);
+
+    try {
+        exercise_statement(parse(input));
+    } catch (const ParseError&) {
+    } catch (const LexError&) {
+    }
+
+    std::istringstream in{std::string(input)};
+    ScriptParser script(in, 7, 4096);
+    while (true) {
+        try {
+            auto stmt = script.next();
+            if (!stmt) break;
+            exercise_statement(*stmt);
+        } catch (const ParseError&) {
+        } catch (const LexError&) {
+        }
+    }
+    return 0;
+}
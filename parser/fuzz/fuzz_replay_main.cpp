@@ -0,0 +1,36 @@
+// Stand-in for libFuzzer's main(): runs LLVMFuzzerTestOneInput over every file named on
+// the command line (directories are walked), so the corpus doubles as a regression test
+// on compilers without libFuzzer.
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void run_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+}
+
+int main(int argc, char** argv) {
+    size_t runs = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file()) { run_file(entry.path()); runs++; }
+            }
+        } else {
+            run_file(path);
+            runs++;
+        }
+    }
+    std::printf("replayed %zu inputs\n", runs);
+    return runs > 0 ? 0 : 1;
+}
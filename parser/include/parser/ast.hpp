@@ -1,10 +1,11 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
 #include <optional>
 #include <utility>
-#include <memory>
 
 struct ColumnDef;
 
@@ -16,51 +17,221 @@ struct Value {
     std::string s;
 };
 
+using ExprId = uint32_t;
+
+// A single expression node. Nodes live in a per-statement ExprArena and refer to
+// their children by index, so an expression tree is one contiguous vector that is
+// freed together with its statement. String literals and column names are stored
+// in the arena's string buffer and referenced by StrRef.
 struct Expr {
-    struct Unary { enum Op { Not, Neg }; Op op; std::unique_ptr<Expr> expr; };
+    enum Kind : uint8_t { Literal, Column, UnaryOp, BinaryOp, Param };
+    struct Unary { enum Op : uint8_t { Not, Neg }; };
     struct Binary {
-        enum Op { Or, And, Eq, Neq, Lt, Lte, Gt, Gte, Add, Sub, Mul, Div };
-        std::unique_ptr<Expr> lhs, rhs;
-        Op op;
+        enum Op : uint8_t { Or, And, Eq, Neq, Lt, Lte, Gt, Gte, Add, Sub, Mul, Div };
+    };
+    struct StrRef { uint32_t offset; uint32_t length; };
+
+    Kind kind;
+    uint8_t op;                 // Unary::Op or Binary::Op
+    uint16_t depth;             // height of the subtree rooted here (leaves are 1), saturating
+    Value::Kind literal_kind;   // Literal only
+    union {
+        ExprId child[2];        // UnaryOp: child[0]; BinaryOp: lhs, rhs
+        bool b;
+        long long i;            // Int literal, or 0-based index of a Param
+        double f;
+        StrRef str;             // String literal or Column name
     };
 
-    std::variant<Value, std::string, Unary, Binary> node;
+    Expr() : kind(Literal), op(0), depth(1), literal_kind(Value::Null), i(0) {}
+
+    ExprId lhs() const { return child[0]; }
+    ExprId rhs() const { return child[1]; }
+    Unary::Op unary_op() const { return static_cast<Unary::Op>(op); }
+    Binary::Op binary_op() const { return static_cast<Binary::Op>(op); }
 };
 
+class ExprArena {
+public:
+    ExprId literal(const Value& v) {
+        ExprId id = push(Expr{});
+        set_literal(id, v);
+        return id;
+    }
+
+    ExprId string_literal(std::string_view s) {
+        Expr e;
+        e.kind = Expr::Literal;
+        e.literal_kind = Value::String;
+        e.str = intern(s);
+        return push(e);
+    }
+
+    ExprId column(std::string_view name) {
+        Expr e;
+        e.kind = Expr::Column;
+        e.str = intern(name);
+        return push(e);
+    }
+
+    ExprId param(uint32_t index) {
+        Expr e;
+        e.kind = Expr::Param;
+        e.i = index;
+        return push(e);
+    }
+
+    ExprId unary(Expr::Unary::Op op, ExprId inner) {
+        Expr e;
+        e.kind = Expr::UnaryOp;
+        e.op = op;
+        e.child[0] = inner;
+        e.child[1] = inner;
+        e.depth = parent_depth(nodes_[inner].depth, 0);
+        return push(e);
+    }
+
+    ExprId binary(ExprId lhs, Expr::Binary::Op op, ExprId rhs) {
+        Expr e;
+        e.kind = Expr::BinaryOp;
+        e.op = op;
+        e.child[0] = lhs;
+        e.child[1] = rhs;
+        e.depth = parent_depth(nodes_[lhs].depth, nodes_[rhs].depth);
+        return push(e);
+    }
+
+    // Overwrites node `id` in place with a literal, e.g. to bind a Param.
+    void set_literal(ExprId id, const Value& v) {
+        Expr e;
+        e.kind = Expr::Literal;
+        e.literal_kind = v.kind;
+        switch (v.kind) {
+            case Value::Null: break;
+            case Value::Bool: e.b = v.b; break;
+            case Value::Int: e.i = v.i; break;
+            case Value::Float: e.f = v.f; break;
+            case Value::String: e.str = intern(v.s); break;
+        }
+        nodes_[id] = e;
+    }
+
+    const Expr& operator[](ExprId id) const { return nodes_[id]; }
+    Expr& operator[](ExprId id) { return nodes_[id]; }
+
+    std::string_view str(Expr::StrRef ref) const {
+        return std::string_view(strings_).substr(ref.offset, ref.length);
+    }
+    std::string_view column_name(ExprId id) const { return str(nodes_[id].str); }
+
+    // Materializes a Literal node as a Value.
+    Value value(ExprId id) const {
+        const Expr& e = nodes_[id];
+        Value v;
+        v.kind = e.literal_kind;
+        switch (e.literal_kind) {
+            case Value::Null: break;
+            case Value::Bool: v.b = e.b; break;
+            case Value::Int: v.i = e.i; break;
+            case Value::Float: v.f = e.f; break;
+            case Value::String: v.s = std::string(str(e.str)); break;
+        }
+        return v;
+    }
+
+    size_t size() const { return nodes_.size(); }
+    void reserve(size_t nodes, size_t string_bytes = 0) {
+        nodes_.reserve(nodes);
+        strings_.reserve(string_bytes);
+    }
+
+private:
+    std::vector<Expr> nodes_;
+    std::string strings_;
+
+    ExprId push(const Expr& e) {
+        nodes_.push_back(e);
+        return static_cast<ExprId>(nodes_.size() - 1);
+    }
+
+    static uint16_t parent_depth(uint16_t a, uint16_t b) {
+        uint16_t d = a > b ? a : b;
+        return d == UINT16_MAX ? d : static_cast<uint16_t>(d + 1);
+    }
+
+    Expr::StrRef intern(std::string_view s) {
+        Expr::StrRef ref{static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(s.size())};
+        strings_.append(s);
+        return ref;
+    }
+};
+
+// Page format of a table: slotted row pages, or PAX pages that group each column's
+// values together within the page.
+enum class TableLayout : uint8_t { Row, Pax };
+
+// Access method of an index: an ordered B+tree, or a hash index for equality lookups.
+enum class IndexMethod : uint8_t { BTree, Hash };
+
+// Aggregate function of a SELECT item.
+enum class AggregateFunc : uint8_t { Count, Sum, Min, Max, Avg };
+
 struct Statement {
     
-    enum Kind { CreateTable, DropTable, Insert, Delete, Update, Select } kind;
+    enum Kind { CreateTable, DropTable, CreateIndex, DropIndex, Insert, Delete, Update, Select } kind;
 
     struct CreateTableData {
         std::string name;
         std::vector<ColumnDef> columns;
+        TableLayout layout;     // WITH (layout = row | pax), Row if absent
     };
     struct DropTableData {
         std::string name;
         bool if_exists;
     };
+    struct CreateIndexData {
+        std::string name;
+        std::string table;
+        std::string column;
+        IndexMethod method;     // USING btree | hash, BTree if absent
+    };
+    struct DropIndexData {
+        std::string name;
+        bool if_exists;
+    };
     struct InsertData {
         std::string table;
         std::optional<std::vector<std::string>> columns;
-        std::vector<struct Expr> values;
+        // All VALUES rows, row-major: row r is values[r * row_width, (r + 1) * row_width).
+        std::vector<ExprId> values;
+        size_t row_width;
+
+        size_t row_count() const { return row_width ? values.size() / row_width : 0; }
+        const ExprId* row(size_t r) const { return values.data() + r * row_width; }
     };
     struct DeleteData {
         std::string table;
-        std::optional<struct Expr> selection;
+        std::optional<ExprId> selection;
     };
     struct UpdateData {
         std::string table;
-        std::vector<std::pair<std::string, struct Expr>> assignments;
-        std::optional<struct Expr> selection;
+        std::vector<std::pair<std::string, ExprId>> assignments;
+        std::optional<ExprId> selection;
     };
     struct SelectData {
         std::vector<struct SelectItem> columns;
         std::string table;
-        std::optional<struct Expr> selection;
+        std::optional<ExprId> selection;
+        std::vector<std::string> group_by;      // GROUP BY columns, empty if absent
         std::optional<unsigned long long> limit;
     };
 
-    std::variant<CreateTableData, DropTableData, InsertData, DeleteData, UpdateData, SelectData> data;
+    std::variant<CreateTableData, DropTableData, CreateIndexData, DropIndexData, InsertData, DeleteData, UpdateData, SelectData> data;
+
+    // Owns every Expr referenced by ExprIds in `data`.
+    ExprArena exprs;
+    // Number of `?`/`$n` placeholders; Param nodes use indices [0, param_count).
+    size_t param_count = 0;
 };
 
 struct DataType {
@@ -74,7 +245,8 @@ struct ColumnDef {
 };
 
 struct SelectItem {
-    enum Kind { Wildcard, Column } kind;
-    std::string column;
+    enum Kind { Wildcard, Column, Aggregate } kind;
+    std::string column;         // Column: its name; Aggregate: the argument, empty for COUNT(*)
+    AggregateFunc func{};       // Aggregate only
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "token.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 
@@ -9,4 +10,8 @@ struct LexError : public std::runtime_error {
     LexError(std::string msg, size_t p) : std::runtime_error(std::move(msg)), pos(p) {}
 };
 
-std::vector<TokenValue> lex(const std::string &input);
+// Tokens reference `input` through string_views, so it must outlive them.
+std::vector<TokenValue> lex(std::string_view input);
+
+// Same as above but reuses `out` (cleared first), so a warm buffer lexes without allocating.
+void lex(std::string_view input, std::vector<TokenValue>& out);
@@ -1,9 +1,14 @@
 #pragma once
 #include "parser/ast.hpp"
 #include <stdexcept>
+#include <string_view>
 
 struct ParseError : public std::runtime_error {
     ParseError(std::string msg) : std::runtime_error(std::move(msg)) {}
 };
 
-Statement parse(const std::string &input);
+// Deepest expression tree (and deepest parenthesis/NOT nesting) the parser accepts, so
+// recursive passes over a parsed expression have a bounded stack depth.
+constexpr size_t MAX_EXPR_DEPTH = 2048;
+
+Statement parse(std::string_view input);
@@ -0,0 +1,87 @@
+#pragma once
+#include "parser/ast.hpp"
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A parsed statement with `?`/`$n` placeholders plus the values bound to them.
+//
+// The parsed template is shared (it usually comes from a StatementCache), so preparing
+// the same SQL again costs a cache lookup; only bind() and bound_statement() run per call.
+class PreparedStatement {
+public:
+    explicit PreparedStatement(std::shared_ptr<const Statement> tmpl);
+
+    size_t param_count() const { return template_->param_count; }
+    const Statement& statement_template() const { return *template_; }
+
+    // Binds `value` to placeholder `index` (1-based: `$1`, or the first `?`).
+    // Throws std::out_of_range for an index outside [1, param_count()].
+    void bind(size_t index, Value value);
+    void clear_bindings();
+
+    // Returns a copy of the template with every placeholder replaced by its bound value,
+    // ready to hand to execution. Throws std::logic_error if a placeholder that occurs in
+    // the statement is unbound; indices below the highest `$n` that never occur need not be.
+    Statement bound_statement() const;
+
+private:
+    std::shared_ptr<const Statement> template_;
+    std::vector<std::optional<Value>> bindings_;
+};
+
+// Thread-safe LRU cache of parsed statements keyed by normalized SQL text.
+class StatementCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit StatementCache(size_t capacity = DEFAULT_CAPACITY);
+
+    static StatementCache& get_instance() {
+        static StatementCache instance;
+        return instance;
+    }
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Returns the cached parse of `sql`, parsing and inserting it on a miss.
+    // ParseError/LexError propagate and nothing is cached for invalid SQL.
+    std::shared_ptr<const Statement> get_or_parse(std::string_view sql);
+
+    PreparedStatement prepare(std::string_view sql) { return PreparedStatement(get_or_parse(sql)); }
+
+    void clear();
+
+    struct CacheStats {
+        size_t entries;
+        size_t hits;
+        size_t misses;
+    };
+
+    CacheStats get_stats() const;
+
+    // Collapses whitespace runs outside string literals to one space and strips
+    // surrounding whitespace and trailing semicolons.
+    static std::string normalize(std::string_view sql);
+
+private:
+    using LruList = std::list<std::pair<std::string, std::shared_ptr<const Statement>>>;
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    LruList lru_; // most recently used first
+    std::unordered_map<std::string_view, LruList::iterator> index_; // keys view into lru_ entries
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+inline PreparedStatement prepare(std::string_view sql) {
+    return StatementCache::get_instance().prepare(sql);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "parser/ast.hpp"
+#include <vector>
+
+// Rewrites every expression of `stmt` in place:
+//  - folds constant subexpressions (arithmetic, comparisons, NOT/AND/OR over literals),
+//  - simplifies boolean identities (x AND TRUE, x OR FALSE, NOT NOT x, NOT (a < b), ...),
+//  - puts the column on the left of column-vs-literal comparisons (5 < a  =>  a > 5),
+//  - flattens nested AND/OR chains into one balanced chain with simple
+//    column-vs-literal comparisons first.
+// SQL three-valued logic is preserved. A WHERE clause that folds to TRUE is dropped.
+// Placeholders are left alone, so run this on a bound statement.
+void normalize(Statement& stmt);
+
+// Normalizes one expression and returns the id of its rewritten root. Rewritten nodes
+// are appended to `arena`; nodes they replace are left behind unreferenced.
+ExprId normalize_expr(ExprArena& arena, ExprId root);
+
+// Splits `root` into its top-level AND operands (just `root` if it is not an AND).
+std::vector<ExprId> conjuncts(const ExprArena& arena, ExprId root);
@@ -0,0 +1,54 @@
+#pragma once
+#include "parser/ast.hpp"
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Parses a stream of ';'-separated statements (e.g. a SQL dump) one statement at a time.
+//
+// Input is read in fixed-size chunks and only the statement currently being assembled is
+// buffered, so memory stays bounded by chunk_size + max_statement_size regardless of how
+// large the script is. Semicolons inside '...' string literals do not end a statement.
+class ScriptParser {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t DEFAULT_MAX_STATEMENT_SIZE = 16 * 1024 * 1024;
+
+    explicit ScriptParser(std::istream& in,
+                          size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                          size_t max_statement_size = DEFAULT_MAX_STATEMENT_SIZE);
+
+    // Opens `file_name` for reading; throws std::runtime_error if it cannot be opened.
+    explicit ScriptParser(const std::string& file_name,
+                          size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                          size_t max_statement_size = DEFAULT_MAX_STATEMENT_SIZE);
+
+    ScriptParser(const ScriptParser&) = delete;
+    ScriptParser& operator=(const ScriptParser&) = delete;
+
+    // Returns the next statement, or std::nullopt once the input is exhausted.
+    // Parse errors propagate as ParseError/LexError; statements_parsed() tells which one failed,
+    // and calling next() again resumes after the bad statement.
+    std::optional<Statement> next();
+
+    size_t statements_parsed() const { return statements_parsed_; }
+
+private:
+    std::unique_ptr<std::istream> owned_;
+    std::istream* in_;
+    std::vector<char> chunk_;
+    size_t chunk_pos_ = 0;
+    size_t chunk_len_ = 0;
+    size_t max_statement_size_;
+    std::string pending_;
+    bool in_string_ = false;
+    bool oversized_ = false; // current statement exceeded max_statement_size_ and is being skipped
+    size_t statements_parsed_ = 0;
+
+    bool fill_chunk();
+    void append_pending(const char* begin, const char* end);
+    std::optional<Statement> take_pending();
+};
@@ -1,22 +1,28 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <optional>
-#include <unordered_map>
 
 enum class Token {
     // punctuation
-    LParen, RParen, Comma, Plus,
+    LParen, RParen, Comma, Plus, Minus, Slash,
     Semi, Star, Eq, Neq, Lt, Lte, Gt, Gte, Dot,
 
     // literals
     Ident, String, Int, Float,
 
+    // placeholders: `?` (int_val 0) or `$n` (int_val n)
+    Param,
+
     // keywords
     KwCreate, KwTable, KwDrop, KwIf, KwExists,
     KwInsert, KwInto, KwValues, KwDelete, KwFrom,
     KwWhere, KwUpdate, KwSet, KwSelect,
     KwAnd, KwOr, KwNot,
-    KwNull, KwTrue, KwFalse, KwLimit,
+    KwNull, KwTrue, KwFalse, KwLimit, KwWith,
+    KwIndex, KwOn, KwUsing, KwGroup, KwBy,
 
     // simple types
     KwInt, KwInteger, KwText, KwReal, KwFloat, KwBool,
@@ -24,30 +30,96 @@ enum class Token {
 
 struct TokenValue {
     Token kind;
-    std::string text;   // for Ident, String
-    long long int_val{}; // for Int
-    double float_val{};  // for Float
+    std::string_view text; // slice of the lexed input; for String, the bytes between the quotes
+    long long int_val{};   // for Int
+    double float_val{};    // for Float
+    bool escaped{};        // String contains doubled '' quotes that str() must collapse
+
+    // Materializes the token text, collapsing '' escapes in string literals.
+    std::string str() const {
+        if (!escaped) return std::string(text);
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            out.push_back(text[i]);
+            if (text[i] == '\'') i++;
+        }
+        return out;
+    }
+};
+
+// ---- Keyword recognition ----------------------------------------------------
+//
+// Keywords are found with a perfect hash over case-folded bytes, computed at
+// compile time: hash() mixes the first two bytes, the last byte and the length
+// into a 128-slot table, and the static_assert below fails the build if a new
+// keyword collides (adjust the multipliers in hash() if it does).
+
+namespace keywords {
+
+struct Entry { std::string_view text; Token token; };
+
+inline constexpr Entry ENTRIES[] = {
+    {"CREATE", Token::KwCreate}, {"TABLE", Token::KwTable},
+    {"DROP", Token::KwDrop}, {"IF", Token::KwIf}, {"EXISTS", Token::KwExists},
+    {"INSERT", Token::KwInsert}, {"INTO", Token::KwInto}, {"VALUES", Token::KwValues},
+    {"DELETE", Token::KwDelete}, {"FROM", Token::KwFrom}, {"WHERE", Token::KwWhere},
+    {"UPDATE", Token::KwUpdate}, {"SET", Token::KwSet}, {"SELECT", Token::KwSelect},
+    {"AND", Token::KwAnd}, {"OR", Token::KwOr}, {"NOT", Token::KwNot},
+    {"NULL", Token::KwNull}, {"TRUE", Token::KwTrue}, {"FALSE", Token::KwFalse},
+    {"LIMIT", Token::KwLimit}, {"WITH", Token::KwWith},
+    {"INDEX", Token::KwIndex}, {"ON", Token::KwOn}, {"USING", Token::KwUsing},
+    {"GROUP", Token::KwGroup}, {"BY", Token::KwBy},
+    {"INT", Token::KwInt}, {"INTEGER", Token::KwInteger}, {"TEXT", Token::KwText},
+    {"REAL", Token::KwReal}, {"FLOAT", Token::KwFloat}, {"BOOL", Token::KwBool}
 };
 
-inline std::optional<Token> to_keyword(const std::string &s) {
-    static const std::unordered_map<std::string, Token> kwmap = {
-        {"CREATE", Token::KwCreate}, {"TABLE", Token::KwTable},
-        {"DROP", Token::KwDrop}, {"IF", Token::KwIf}, {"EXISTS", Token::KwExists},
-        {"INSERT", Token::KwInsert}, {"INTO", Token::KwInto}, {"VALUES", Token::KwValues},
-        {"DELETE", Token::KwDelete}, {"FROM", Token::KwFrom}, {"WHERE", Token::KwWhere},
-        {"UPDATE", Token::KwUpdate}, {"SET", Token::KwSet}, {"SELECT", Token::KwSelect},
-        {"AND", Token::KwAnd}, {"OR", Token::KwOr}, {"NOT", Token::KwNot},
-        {"NULL", Token::KwNull}, {"TRUE", Token::KwTrue}, {"FALSE", Token::KwFalse},
-        {"LIMIT", Token::KwLimit},
-        {"INT", Token::KwInt}, {"INTEGER", Token::KwInteger}, {"TEXT", Token::KwText},
-        {"REAL", Token::KwReal}, {"FLOAT", Token::KwFloat}, {"BOOL", Token::KwBool}
-    };
-
-    std::string up;
-    up.reserve(s.size());
-    for (char c : s) up.push_back(::toupper(c));
-
-    auto it = kwmap.find(up);
-    if (it != kwmap.end()) return it->second;
-    return std::nullopt;
+inline constexpr size_t COUNT = sizeof(ENTRIES) / sizeof(ENTRIES[0]);
+inline constexpr size_t TABLE_SIZE = 128;
+inline constexpr uint8_t EMPTY = 0xFF;
+inline constexpr size_t MIN_LEN = 2;
+inline constexpr size_t MAX_LEN = 7;
+
+constexpr unsigned char fold(char c) {
+    return static_cast<unsigned char>((c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c);
+}
+
+// Callers guarantee s.size() >= MIN_LEN.
+constexpr size_t hash(std::string_view s) {
+    return (fold(s[0]) + fold(s[1]) + 7u * fold(s[s.size() - 1]) + 11u * s.size()) & (TABLE_SIZE - 1);
+}
+
+constexpr std::array<uint8_t, TABLE_SIZE> build_table() {
+    std::array<uint8_t, TABLE_SIZE> table{};
+    for (auto& slot : table) slot = EMPTY;
+    for (size_t i = 0; i < COUNT; ++i) table[hash(ENTRIES[i].text)] = static_cast<uint8_t>(i);
+    return table;
+}
+
+inline constexpr std::array<uint8_t, TABLE_SIZE> TABLE = build_table();
+
+constexpr bool is_perfect() {
+    for (size_t i = 0; i < COUNT; ++i) {
+        const auto& text = ENTRIES[i].text;
+        if (text.size() < MIN_LEN || text.size() > MAX_LEN) return false;
+        if (TABLE[hash(text)] != i) return false;
+    }
+    return true;
+}
+
+static_assert(is_perfect(), "keyword hash has a collision or a keyword outside [MIN_LEN, MAX_LEN]");
+
+} // namespace keywords
+
+inline std::optional<Token> to_keyword(std::string_view s) {
+    if (s.size() < keywords::MIN_LEN || s.size() > keywords::MAX_LEN) return std::nullopt;
+    uint8_t idx = keywords::TABLE[keywords::hash(s)];
+    if (idx == keywords::EMPTY) return std::nullopt;
+
+    const auto& entry = keywords::ENTRIES[idx];
+    if (entry.text.size() != s.size()) return std::nullopt;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (keywords::fold(s[i]) != static_cast<unsigned char>(entry.text[i])) return std::nullopt;
+    }
+    return entry.token;
 }
@@ -1,11 +1,19 @@
 #include "parser/lexer.hpp"
 #include <cctype>
+#include <charconv>
 
-static bool is_ident_start(char c) { return std::isalpha(c) || c == '_'; }
-static bool is_ident_continue(char c) { return std::isalnum(c) || c == '_'; }
+static bool is_ident_start(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+static bool is_ident_continue(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
 
-std::vector<TokenValue> lex(const std::string &input) {
+std::vector<TokenValue> lex(std::string_view input) {
     std::vector<TokenValue> tokens;
+    lex(input, tokens);
+    return tokens;
+}
+
+void lex(std::string_view input, std::vector<TokenValue>& tokens) {
+    tokens.clear();
     size_t i = 0;
 
     while (i < input.size()) {
@@ -17,8 +25,21 @@ std::vector<TokenValue> lex(const std::string &input) {
             case ',': tokens.push_back({Token::Comma}); i++; break;
             case ';': tokens.push_back({Token::Semi}); i++; break;
             case '*': tokens.push_back({Token::Star}); i++; break;
+            case '+': tokens.push_back({Token::Plus}); i++; break;
+            case '-': tokens.push_back({Token::Minus}); i++; break;
+            case '/': tokens.push_back({Token::Slash}); i++; break;
             case '.': tokens.push_back({Token::Dot}); i++; break;
             case '=': tokens.push_back({Token::Eq}); i++; break;
+            case '?': tokens.push_back({Token::Param, input.substr(i, 1)}); i++; break;
+            case '$': {
+                size_t start = i++;
+                while (i < input.size() && is_digit(input[i])) i++;
+                long long n{};
+                auto res = std::from_chars(input.data() + start + 1, input.data() + i, n);
+                if (res.ec != std::errc() || n < 1 || n > 65535) throw LexError("Expected parameter number (1-65535) after '$'", start);
+                tokens.push_back({Token::Param, input.substr(start, i - start), n});
+                break;
+            }
             case '!':
                 i++;
                 if (i < input.size() && input[i] == '=') { tokens.push_back({Token::Neq}); i++; }
@@ -36,37 +57,48 @@ std::vector<TokenValue> lex(const std::string &input) {
                 break;
             case '\'' : {
                 i++;
-                std::string s;
+                size_t start = i;
+                bool escaped = false;
                 while (i < input.size()) {
                     if (input[i] == '\'') {
-                        if (i+1 < input.size() && input[i+1] == '\'') { s.push_back('\''); i+=2; }
-                        else { i++; break; }
+                        if (i+1 < input.size() && input[i+1] == '\'') { escaped = true; i+=2; }
+                        else break;
                     } else {
-                        s.push_back(input[i++]);
+                        i++;
                     }
                 }
-                tokens.push_back({Token::String, s});
+                TokenValue tv{Token::String, input.substr(start, i - start)};
+                tv.escaped = escaped;
+                tokens.push_back(tv);
+                if (i < input.size()) i++; // closing quote
                 break;
             }
             default:
-                if (std::isdigit(c)) {
-                    std::string num;
+                if (is_digit(c)) {
+                    size_t start = i;
                     bool is_float = false;
-                    while (i < input.size() && std::isdigit(input[i])) num.push_back(input[i++]);
+                    while (i < input.size() && is_digit(input[i])) i++;
                     if (i < input.size() && input[i] == '.') {
                         is_float = true;
-                        num.push_back('.');
                         i++;
-                        while (i < input.size() && std::isdigit(input[i])) num.push_back(input[i++]);
+                        while (i < input.size() && is_digit(input[i])) i++;
                     }
+                    std::string_view num = input.substr(start, i - start);
                     if (is_float) {
-                        tokens.push_back({Token::Float, num, 0, std::stod(num)});
+                        double f{};
+                        auto res = std::from_chars(num.data(), num.data() + num.size(), f);
+                        if (res.ec != std::errc()) throw LexError("Invalid float literal", start);
+                        tokens.push_back({Token::Float, num, 0, f});
                     } else {
-                        tokens.push_back({Token::Int, num, std::stoll(num)});
+                        long long n{};
+                        auto res = std::from_chars(num.data(), num.data() + num.size(), n);
+                        if (res.ec != std::errc()) throw LexError("Integer literal out of range", start);
+                        tokens.push_back({Token::Int, num, n});
                     }
                 } else if (is_ident_start(c)) {
-                    std::string s;
-                    while (i < input.size() && is_ident_continue(input[i])) s.push_back(input[i++]);
+                    size_t start = i;
+                    while (i < input.size() && is_ident_continue(input[i])) i++;
+                    std::string_view s = input.substr(start, i - start);
                     auto kw = to_keyword(s);
                     if (kw) tokens.push_back({*kw, s});
                     else tokens.push_back({Token::Ident, s});
@@ -75,5 +107,4 @@ std::vector<TokenValue> lex(const std::string &input) {
                 }
         }
     }
-    return tokens;
 }
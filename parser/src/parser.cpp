@@ -1,43 +1,11 @@
 #include "parser/parser.hpp"
 #include "parser/token.hpp"
 #include "parser/lexer.hpp"
-#include <memory>
+#include <algorithm>
+#include <cctype>
 #include <sstream>
 #include <utility>
 
-// ---- Small helpers to construct AST nodes ----------------------------------
-
-static Expr make_ident(std::string s) {
-    Expr e;
-    e.node = std::move(s);
-    return e;
-}
-
-static Expr make_literal(Value v) {
-    Expr e;
-    e.node = std::move(v);
-    return e;
-}
-
-static Expr make_unary(Expr::Unary::Op op, Expr inner) {
-    Expr e;
-    Expr::Unary u;
-    u.op = op;
-    u.expr = std::make_unique<Expr>(std::move(inner));
-    e.node = std::move(u);
-    return e;
-}
-
-static Expr make_binary(Expr left, Expr::Binary::Op op, Expr right) {
-    Expr e;
-    Expr::Binary b;
-    b.op = op;
-    b.lhs = std::make_unique<Expr>(std::move(left));
-    b.rhs = std::make_unique<Expr>(std::move(right));
-    e.node = std::move(b);
-    return e;
-}
-
 // ---- Token name helper (for clearer errors) --------------------------------
 
 static const char* token_name(Token t) {
@@ -46,6 +14,8 @@ static const char* token_name(Token t) {
         case Token::RParen: return "RParen";
         case Token::Comma:  return "Comma";
         case Token::Plus:   return "Plus";
+        case Token::Minus:  return "Minus";
+        case Token::Slash:  return "Slash";
         case Token::Semi:   return "Semi";
         case Token::Star:   return "Star";
         case Token::Eq:     return "Eq";
@@ -59,6 +29,7 @@ static const char* token_name(Token t) {
         case Token::String: return "String";
         case Token::Int:    return "Int";
         case Token::Float:  return "Float";
+        case Token::Param:  return "Param";
         case Token::KwCreate: return "CREATE";
         case Token::KwTable:  return "TABLE";
         case Token::KwDrop:   return "DROP";
@@ -80,6 +51,12 @@ static const char* token_name(Token t) {
         case Token::KwTrue:   return "TRUE";
         case Token::KwFalse:  return "FALSE";
         case Token::KwLimit:  return "LIMIT";
+        case Token::KwWith:   return "WITH";
+        case Token::KwIndex:  return "INDEX";
+        case Token::KwOn:     return "ON";
+        case Token::KwUsing:  return "USING";
+        case Token::KwGroup:  return "GROUP";
+        case Token::KwBy:     return "BY";
         case Token::KwInt:    return "INT";
         case Token::KwInteger:return "INTEGER";
         case Token::KwText:   return "TEXT";
@@ -94,22 +71,29 @@ static const char* token_name(Token t) {
 
 class Parser {
 public:
-    explicit Parser(std::vector<TokenValue> toks) : tokens(std::move(toks)) {}
+    explicit Parser(const std::vector<TokenValue>& toks) : tokens(toks) {
+        // An expression never has more nodes than tokens, so this is the arena's only allocation.
+        arena.reserve(tokens.size());
+    }
 
     Statement parse_statement() {
         const Token* k = peek_kind();
         if (!k) throw err("expected a statement, got <eof>");
 
+        Statement s;
         switch (*k) {
-            case Token::KwCreate: return parse_create_table();
-            case Token::KwDrop:   return parse_drop_table();
-            case Token::KwInsert: return parse_insert();
-            case Token::KwDelete: return parse_delete();
-            case Token::KwUpdate: return parse_update();
-            case Token::KwSelect: return parse_select();
+            case Token::KwCreate: s = parse_create(); break;
+            case Token::KwDrop:   s = parse_drop(); break;
+            case Token::KwInsert: s = parse_insert(); break;
+            case Token::KwDelete: s = parse_delete(); break;
+            case Token::KwUpdate: s = parse_update(); break;
+            case Token::KwSelect: s = parse_select(); break;
             default:
                 throw err("expected a statement, got " + got_here());
         }
+        s.exprs = std::move(arena);
+        s.param_count = param_count;
+        return s;
     }
 
     bool eat(Token t) {
@@ -129,7 +113,7 @@ public:
     std::string expect_ident() {
         if (eof()) throw err("expected identifier, got <eof>");
         const auto& tv = tokens[pos++];
-        if (tv.kind == Token::Ident) return tv.text;
+        if (tv.kind == Token::Ident) return tv.str();
         std::ostringstream oss;
         oss << "expected identifier, got " << token_name(tv.kind);
         throw err(oss.str());
@@ -153,8 +137,13 @@ public:
     }
 
 private:
-    std::vector<TokenValue> tokens;
+    const std::vector<TokenValue>& tokens;
     size_t pos = 0;
+    ExprArena arena;
+    size_t param_count = 0;
+    size_t nesting = 0;
+    bool saw_positional = false; // `?`
+    bool saw_numbered = false;   // `$n`
 
     ParseError err(std::string msg) const { return ParseError(std::move(msg)); }
 
@@ -167,6 +156,16 @@ private:
 
     // ---- Statements ----
 
+    Statement parse_create() {
+        if (pos + 1 < tokens.size() && tokens[pos + 1].kind == Token::KwIndex) return parse_create_index();
+        return parse_create_table();
+    }
+
+    Statement parse_drop() {
+        if (pos + 1 < tokens.size() && tokens[pos + 1].kind == Token::KwIndex) return parse_drop_index();
+        return parse_drop_table();
+    }
+
     // CREATE TABLE name (col type, ...)
     Statement parse_create_table() {
         expect(Token::KwCreate);
@@ -188,11 +187,38 @@ private:
 
         Statement s;
         s.kind = Statement::CreateTable;
-        Statement::CreateTableData d{ std::move(name), std::move(cols) };
+        Statement::CreateTableData d{ std::move(name), std::move(cols), TableLayout::Row };
+        if (eat(Token::KwWith)) parse_table_options(d);
         s.data = std::move(d);
         return s;
     }
 
+    // WITH ( option = value [, option = value]* ); option names and values are case-insensitive.
+    void parse_table_options(Statement::CreateTableData& d) {
+        expect(Token::LParen);
+        while (true) {
+            std::string option = lower(expect_ident());
+            expect(Token::Eq);
+            std::string value = lower(expect_ident());
+            if (option == "layout") {
+                if (value == "row") d.layout = TableLayout::Row;
+                else if (value == "pax") d.layout = TableLayout::Pax;
+                else throw err("unknown layout '" + value + "', expected ROW or PAX");
+            } else {
+                throw err("unknown table option '" + option + "'");
+            }
+
+            if (eat(Token::Comma)) continue;
+            expect(Token::RParen);
+            break;
+        }
+    }
+
+    static std::string lower(std::string s) {
+        for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return s;
+    }
+
     DataType parse_type() {
         const TokenValue* tv = next();
         if (!tv) throw err("expected type, got <eof>");
@@ -211,7 +237,7 @@ private:
                 dt.kind = DataType::Bool; break;
             case Token::Ident:
                 dt.kind = DataType::Custom;
-                dt.custom = tv->text;
+                dt.custom = tv->str();
                 break;
             default: {
                 std::ostringstream oss; oss << "expected type, got " << token_name(tv->kind);
@@ -240,7 +266,54 @@ private:
         return s;
     }
 
-    // INSERT INTO name [(col, ...)] VALUES (expr, ...)
+    // CREATE INDEX name ON table [USING btree | hash] (column)
+    Statement parse_create_index() {
+        expect(Token::KwCreate);
+        expect(Token::KwIndex);
+        std::string name = expect_ident();
+        expect(Token::KwOn);
+        std::string table = expect_ident();
+        IndexMethod method = IndexMethod::BTree;
+        if (eat(Token::KwUsing)) {
+            std::string m = lower(expect_ident());
+            if (m == "btree") method = IndexMethod::BTree;
+            else if (m == "hash") method = IndexMethod::Hash;
+            else throw err("unknown index method '" + m + "', expected BTREE or HASH");
+        }
+        expect(Token::LParen);
+        std::string column = expect_ident();
+        if (peek_kind() && *peek_kind() == Token::Comma) {
+            throw err("multi-column indexes are not supported");
+        }
+        expect(Token::RParen);
+
+        Statement s;
+        s.kind = Statement::CreateIndex;
+        Statement::CreateIndexData d{ std::move(name), std::move(table), std::move(column), method };
+        s.data = std::move(d);
+        return s;
+    }
+
+    // DROP INDEX [IF EXISTS] name
+    Statement parse_drop_index() {
+        expect(Token::KwDrop);
+        expect(Token::KwIndex);
+        bool if_exists = false;
+        if (peek_kind() && *peek_kind() == Token::KwIf) {
+            next(); // IF
+            expect(Token::KwExists);
+            if_exists = true;
+        }
+        std::string name = expect_ident();
+
+        Statement s;
+        s.kind = Statement::DropIndex;
+        Statement::DropIndexData d{ std::move(name), if_exists };
+        s.data = std::move(d);
+        return s;
+    }
+
+    // INSERT INTO name [(col, ...)] VALUES (expr, ...) [, (expr, ...)]*
     Statement parse_insert() {
         expect(Token::KwInsert);
         expect(Token::KwInto);
@@ -259,18 +332,33 @@ private:
         }
 
         expect(Token::KwValues);
-        expect(Token::LParen);
-        std::vector<Expr> values;
+        std::vector<ExprId> values;
+        size_t row_width = 0;
         while (true) {
-            values.push_back(parse_expr());
+            expect(Token::LParen);
+            size_t row_start = values.size();
+            while (true) {
+                values.push_back(parse_expr());
+                if (eat(Token::Comma)) continue;
+                expect(Token::RParen);
+                break;
+            }
+            size_t width = values.size() - row_start;
+            if (row_start == 0) {
+                row_width = width;
+            } else if (width != row_width) {
+                throw err("all VALUES rows must have the same number of expressions");
+            }
             if (eat(Token::Comma)) continue;
-            expect(Token::RParen);
             break;
         }
+        if (columns && columns->size() != row_width) {
+            throw err("VALUES rows have a different number of expressions than the column list");
+        }
 
         Statement s;
         s.kind = Statement::Insert;
-        Statement::InsertData d{ std::move(table), std::move(columns), std::move(values) };
+        Statement::InsertData d{ std::move(table), std::move(columns), std::move(values), row_width };
         s.data = std::move(d);
         return s;
     }
@@ -280,7 +368,7 @@ private:
         expect(Token::KwDelete);
         expect(Token::KwFrom);
         std::string table = expect_ident();
-        std::optional<Expr> selection;
+        std::optional<ExprId> selection;
         if (peek_kind() && *peek_kind() == Token::KwWhere) {
             next(); // WHERE
             selection = parse_expr();
@@ -299,17 +387,17 @@ private:
         std::string table = expect_ident();
         expect(Token::KwSet);
 
-        std::vector<std::pair<std::string, Expr>> assigns;
+        std::vector<std::pair<std::string, ExprId>> assigns;
         while (true) {
             std::string col = expect_ident();
             expect(Token::Eq);
-            Expr rhs = parse_expr();
+            ExprId rhs = parse_expr();
             assigns.emplace_back(std::move(col), std::move(rhs));
             if (eat(Token::Comma)) continue;
             break;
         }
 
-        std::optional<Expr> selection;
+        std::optional<ExprId> selection;
         if (peek_kind() && *peek_kind() == Token::KwWhere) {
             next(); // WHERE
             selection = parse_expr();
@@ -322,7 +410,8 @@ private:
         return s;
     }
 
-    // SELECT ( * | col [, col]* ) FROM name [WHERE expr] [LIMIT n]
+    // SELECT ( * | item [, item]* ) FROM name [WHERE expr] [GROUP BY col [, col]*] [LIMIT n]
+    // where item is a column or an aggregate call (see parse_select_item)
     Statement parse_select() {
         expect(Token::KwSelect);
 
@@ -333,11 +422,7 @@ private:
             items.push_back(std::move(it));
         } else {
             while (true) {
-                std::string ident = expect_ident();
-                SelectItem it;
-                it.kind = SelectItem::Column;
-                it.column = std::move(ident);
-                items.push_back(std::move(it));
+                items.push_back(parse_select_item());
                 if (eat(Token::Comma)) continue;
                 break;
             }
@@ -346,12 +431,22 @@ private:
         expect(Token::KwFrom);
         std::string table = expect_ident();
 
-        std::optional<Expr> selection;
+        std::optional<ExprId> selection;
         if (peek_kind() && *peek_kind() == Token::KwWhere) {
             next();
             selection = parse_expr();
         }
 
+        std::vector<std::string> group_by;
+        if (eat(Token::KwGroup)) {
+            expect(Token::KwBy);
+            while (true) {
+                group_by.push_back(expect_ident());
+                if (eat(Token::Comma)) continue;
+                break;
+            }
+        }
+
         std::optional<unsigned long long> limit;
         if (peek_kind() && *peek_kind() == Token::KwLimit) {
             next(); // LIMIT
@@ -364,37 +459,95 @@ private:
 
         Statement s;
         s.kind = Statement::Select;
-        Statement::SelectData d{ std::move(items), std::move(table), std::move(selection), std::move(limit) };
+        Statement::SelectData d{ std::move(items), std::move(table), std::move(selection), std::move(group_by),
+                                 std::move(limit) };
         s.data = std::move(d);
         return s;
     }
 
+    // A column name, or an aggregate call: COUNT(*), or COUNT/SUM/MIN/MAX/AVG of a column.
+    SelectItem parse_select_item() {
+        SelectItem it;
+        it.column = expect_ident();
+        if (!eat(Token::LParen)) {
+            it.kind = SelectItem::Column;
+            return it;
+        }
+        static constexpr std::pair<std::string_view, AggregateFunc> FUNCS[] = {
+            {"COUNT", AggregateFunc::Count}, {"SUM", AggregateFunc::Sum}, {"MIN", AggregateFunc::Min},
+            {"MAX", AggregateFunc::Max}, {"AVG", AggregateFunc::Avg},
+        };
+        const std::pair<std::string_view, AggregateFunc>* func = nullptr;
+        for (const auto& f : FUNCS) {
+            if (f.first.size() != it.column.size()) continue;
+            bool same = true;
+            for (size_t i = 0; i < it.column.size(); ++i) {
+                same = same && keywords::fold(it.column[i]) == static_cast<unsigned char>(f.first[i]);
+            }
+            if (same) func = &f;
+        }
+        if (!func) throw err("unknown aggregate function '" + it.column + "'");
+
+        it.kind = SelectItem::Aggregate;
+        it.func = func->second;
+        if (eat(Token::Star)) {
+            if (it.func != AggregateFunc::Count) throw err("only COUNT accepts *");
+            it.column.clear();
+        } else {
+            it.column = expect_ident();
+        }
+        expect(Token::RParen);
+        return it;
+    }
+
     // ---- Expressions (Pratt parser) ----------------------------------------
 
-    Expr parse_expr() { return parse_or(); }
+    ExprId parse_expr() {
+        enter_nesting();
+        ExprId e = parse_or();
+        nesting--;
+        return e;
+    }
+
+    // Parentheses and prefix operators recurse; bound that recursion as well as tree depth.
+    void enter_nesting() {
+        if (++nesting > MAX_EXPR_DEPTH) throw err("expression nested too deeply");
+    }
+
+    ExprId make_binary(ExprId lhs, Expr::Binary::Op op, ExprId rhs) {
+        ExprId id = arena.binary(lhs, op, rhs);
+        if (arena[id].depth > MAX_EXPR_DEPTH) throw err("expression nested too deeply");
+        return id;
+    }
 
-    Expr parse_or() {
-        Expr node = parse_and();
+    ExprId make_unary(Expr::Unary::Op op, ExprId inner) {
+        ExprId id = arena.unary(op, inner);
+        if (arena[id].depth > MAX_EXPR_DEPTH) throw err("expression nested too deeply");
+        return id;
+    }
+
+    ExprId parse_or() {
+        ExprId node = parse_and();
         while (peek_kind() && *peek_kind() == Token::KwOr) {
             next(); // OR
-            Expr rhs = parse_and();
-            node = make_binary(std::move(node), Expr::Binary::Or, std::move(rhs));
+            ExprId rhs = parse_and();
+            node = make_binary(node, Expr::Binary::Or, rhs);
         }
         return node;
     }
 
-    Expr parse_and() {
-        Expr node = parse_cmp();
+    ExprId parse_and() {
+        ExprId node = parse_cmp();
         while (peek_kind() && *peek_kind() == Token::KwAnd) {
             next(); // AND
-            Expr rhs = parse_cmp();
-            node = make_binary(std::move(node), Expr::Binary::And, std::move(rhs));
+            ExprId rhs = parse_cmp();
+            node = make_binary(node, Expr::Binary::And, rhs);
         }
         return node;
     }
 
-    Expr parse_cmp() {
-        Expr node = parse_add();
+    ExprId parse_cmp() {
+        ExprId node = parse_add();
         while (true) {
             const Token* k = peek_kind();
             Expr::Binary::Op op;
@@ -409,68 +562,104 @@ private:
             else break;
 
             next(); // consume operator
-            Expr rhs = parse_add();
-            node = make_binary(std::move(node), op, std::move(rhs));
+            ExprId rhs = parse_add();
+            node = make_binary(node, op, rhs);
         }
         return node;
     }
 
-    // Note: arithmetic +,-,*,/ intentionally omitted (like the Rust version).
-    Expr parse_add() {
-        // Would normally handle + and -, but we skip them to match the Rust code.
-        return parse_mul();
+    ExprId parse_add() {
+        ExprId node = parse_mul();
+        while (true) {
+            const Token* k = peek_kind();
+            Expr::Binary::Op op;
+            if (k && *k == Token::Plus) op = Expr::Binary::Add;
+            else if (k && *k == Token::Minus) op = Expr::Binary::Sub;
+            else break;
+
+            next(); // consume operator
+            ExprId rhs = parse_mul();
+            node = make_binary(node, op, rhs);
+        }
+        return node;
     }
 
-    Expr parse_mul() {
-        // Would normally handle * and /, but we skip them to match the Rust code.
-        return parse_unary();
+    ExprId parse_mul() {
+        ExprId node = parse_unary();
+        while (true) {
+            const Token* k = peek_kind();
+            Expr::Binary::Op op;
+            if (k && *k == Token::Star) op = Expr::Binary::Mul;
+            else if (k && *k == Token::Slash) op = Expr::Binary::Div;
+            else break;
+
+            next(); // consume operator
+            ExprId rhs = parse_unary();
+            node = make_binary(node, op, rhs);
+        }
+        return node;
     }
 
-    Expr parse_unary() {
+    ExprId parse_unary() {
         const Token* k = peek_kind();
-        if (k && *k == Token::KwNot) {
+        if (k && (*k == Token::KwNot || *k == Token::Minus)) {
             next();
-            return make_unary(Expr::Unary::Not, parse_unary());
+            auto op = *k == Token::KwNot ? Expr::Unary::Not : Expr::Unary::Neg;
+            enter_nesting();
+            ExprId inner = parse_unary();
+            nesting--;
+            return make_unary(op, inner);
         }
-        // unary minus not supported; negative numbers expected as literals only
         return parse_primary();
     }
 
-    Expr parse_primary() {
+    ExprId parse_primary() {
         const TokenValue* tv = next();
         if (!tv) throw err("unexpected <eof> in expression");
 
         switch (tv->kind) {
             case Token::LParen: {
-                Expr e = parse_expr();
+                ExprId e = parse_expr();
                 expect(Token::RParen);
                 return e;
             }
             case Token::Ident:
-                return make_ident(tv->text);
-            case Token::String: {
-                Value v; v.kind = Value::String; v.s = tv->text;
-                return make_literal(std::move(v));
+                return arena.column(tv->text);
+            case Token::Param: {
+                size_t idx;
+                if (tv->int_val == 0) {
+                    saw_positional = true;
+                    idx = param_count;
+                } else {
+                    saw_numbered = true;
+                    idx = static_cast<size_t>(tv->int_val - 1);
+                }
+                if (saw_positional && saw_numbered) throw err("cannot mix ? and $n placeholders");
+                param_count = std::max(param_count, idx + 1);
+                return arena.param(static_cast<uint32_t>(idx));
             }
+            case Token::String:
+                if (!tv->escaped) return arena.string_literal(tv->text);
+                return arena.string_literal(tv->str());
             case Token::Int: {
                 Value v; v.kind = Value::Int; v.i = tv->int_val;
-                return make_literal(std::move(v));
+                return arena.literal(v);
             }
             case Token::Float: {
                 Value v; v.kind = Value::Float; v.f = tv->float_val;
-                return make_literal(std::move(v));
+                return arena.literal(v);
             }
             case Token::KwNull: {
                 Value v; v.kind = Value::Null;
-                return make_literal(std::move(v));
+                return arena.literal(v);
             }
             case Token::KwTrue: {
                 Value v; v.kind = Value::Bool; v.b = true;
-                return make_literal(std::move(v));
+                return arena.literal(v);
             }
             case Token::KwFalse: {
                 Value v; v.kind = Value::Bool; v.b = false;
-                return make_literal(std::move(v));
+                return arena.literal(v);
             }
             default: {
                 std::ostringstream oss;
@@ -483,9 +672,11 @@ private:
 
 // ---- Top-level parse() -----------------------------------------------------
 
-Statement parse(const std::string &input) {
-    auto toks = lex(input);
-    Parser p(std::move(toks));
+Statement parse(std::string_view input) {
+    // Reused per thread so that steady-state parsing does not reallocate the token buffer.
+    thread_local std::vector<TokenValue> toks;
+    lex(input, toks);
+    Parser p(toks);
     Statement stmt = p.parse_statement();
 
     // trailing semicolons optional; ignore extra semicolons
@@ -0,0 +1,112 @@
+#include "parser/prepared.hpp"
+#include "parser/parser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+// ---- PreparedStatement ------------------------------------------------------
+
+PreparedStatement::PreparedStatement(std::shared_ptr<const Statement> tmpl)
+    : template_(std::move(tmpl)), bindings_(template_->param_count) {}
+
+void PreparedStatement::bind(size_t index, Value value) {
+    if (index < 1 || index > bindings_.size()) {
+        throw std::out_of_range("parameter index " + std::to_string(index) + " out of range");
+    }
+    bindings_[index - 1] = std::move(value);
+}
+
+void PreparedStatement::clear_bindings() {
+    for (auto& b : bindings_) b.reset();
+}
+
+Statement PreparedStatement::bound_statement() const {
+    Statement stmt = *template_;
+    if (stmt.param_count == 0) return stmt;
+
+    // Only placeholders that occur need a value: `$3` alone leaves $1 and $2 unused.
+    size_t n = stmt.exprs.size();
+    for (ExprId id = 0; id < n; ++id) {
+        const Expr& e = stmt.exprs[id];
+        if (e.kind != Expr::Param) continue;
+        const auto& binding = bindings_[static_cast<size_t>(e.i)];
+        if (!binding) {
+            throw std::logic_error("parameter " + std::to_string(e.i + 1) + " is not bound");
+        }
+        stmt.exprs.set_literal(id, *binding);
+    }
+    stmt.param_count = 0;
+    return stmt;
+}
+
+// ---- StatementCache ---------------------------------------------------------
+
+StatementCache::StatementCache(size_t capacity) : capacity_(std::max<size_t>(1, capacity)) {}
+
+std::string StatementCache::normalize(std::string_view sql) {
+    std::string out;
+    out.reserve(sql.size());
+    bool in_string = false;
+    bool pending_space = false;
+    for (char c : sql) {
+        if (in_string) {
+            out.push_back(c);
+            if (c == '\'') in_string = false;
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pending_space = !out.empty();
+            continue;
+        }
+        if (pending_space) {
+            out.push_back(' ');
+            pending_space = false;
+        }
+        out.push_back(c);
+        if (c == '\'') in_string = true;
+    }
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) out.pop_back();
+    return out;
+}
+
+std::shared_ptr<const Statement> StatementCache::get_or_parse(std::string_view sql) {
+    std::string key = normalize(sql);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            hits_++;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+        misses_++;
+    }
+
+    // Parse outside the lock; two threads missing on the same text both parse and one insert wins.
+    auto stmt = std::make_shared<const Statement>(parse(key));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+    lru_.emplace_front(std::move(key), stmt);
+    index_.emplace(lru_.front().first, lru_.begin());
+    if (lru_.size() > capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return stmt;
+}
+
+void StatementCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+}
+
+StatementCache::CacheStats StatementCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return CacheStats{lru_.size(), hits_, misses_};
+}
@@ -0,0 +1,300 @@
+#include "parser/rewrite.hpp"
+#include <algorithm>
+#include <climits>
+#include <optional>
+
+// ---- Literal helpers ---------------------------------------------------------
+
+static bool is_literal(const ExprArena& a, ExprId id) { return a[id].kind == Expr::Literal; }
+
+static bool is_bool_literal(const ExprArena& a, ExprId id, bool v) {
+    const Expr& e = a[id];
+    return e.kind == Expr::Literal && e.literal_kind == Value::Bool && e.b == v;
+}
+
+static bool is_null_literal(const ExprArena& a, ExprId id) {
+    const Expr& e = a[id];
+    return e.kind == Expr::Literal && e.literal_kind == Value::Null;
+}
+
+static bool is_numeric(const Value& v) { return v.kind == Value::Int || v.kind == Value::Float; }
+static double as_double(const Value& v) { return v.kind == Value::Int ? static_cast<double>(v.i) : v.f; }
+
+static Value make_bool(bool b) { Value v; v.kind = Value::Bool; v.b = b; return v; }
+static Value make_null() { Value v; v.kind = Value::Null; return v; }
+
+static bool is_comparison(Expr::Binary::Op op) { return op >= Expr::Binary::Eq && op <= Expr::Binary::Gte; }
+static bool is_arithmetic(Expr::Binary::Op op) { return op >= Expr::Binary::Add; }
+
+// a op b  <=>  b mirror(op) a
+static Expr::Binary::Op mirror(Expr::Binary::Op op) {
+    switch (op) {
+        case Expr::Binary::Lt:  return Expr::Binary::Gt;
+        case Expr::Binary::Lte: return Expr::Binary::Gte;
+        case Expr::Binary::Gt:  return Expr::Binary::Lt;
+        case Expr::Binary::Gte: return Expr::Binary::Lte;
+        default: return op;
+    }
+}
+
+// NOT (a op b)  <=>  a negate(op) b  (also under NULLs: both sides are NULL together)
+static Expr::Binary::Op negate(Expr::Binary::Op op) {
+    switch (op) {
+        case Expr::Binary::Eq:  return Expr::Binary::Neq;
+        case Expr::Binary::Neq: return Expr::Binary::Eq;
+        case Expr::Binary::Lt:  return Expr::Binary::Gte;
+        case Expr::Binary::Lte: return Expr::Binary::Gt;
+        case Expr::Binary::Gt:  return Expr::Binary::Lte;
+        case Expr::Binary::Gte: return Expr::Binary::Lt;
+        default: return op;
+    }
+}
+
+// Three-way compare of two non-null literals; nullopt if the kinds are not comparable.
+static std::optional<int> compare_values(const Value& l, const Value& r) {
+    if (is_numeric(l) && is_numeric(r)) {
+        if (l.kind == Value::Int && r.kind == Value::Int) return (l.i > r.i) - (l.i < r.i);
+        double x = as_double(l), y = as_double(r);
+        return (x > y) - (x < y);
+    }
+    if (l.kind == Value::String && r.kind == Value::String) {
+        int c = l.s.compare(r.s);
+        return (c > 0) - (c < 0);
+    }
+    if (l.kind == Value::Bool && r.kind == Value::Bool) return int(l.b) - int(r.b);
+    return std::nullopt;
+}
+
+static std::optional<Value> fold_binary(Expr::Binary::Op op, const Value& l, const Value& r) {
+    if (l.kind == Value::Null || r.kind == Value::Null) {
+        if (is_comparison(op) || is_arithmetic(op)) return make_null();
+        return std::nullopt; // AND/OR are folded with three-valued logic by the caller
+    }
+    if (is_comparison(op)) {
+        auto c = compare_values(l, r);
+        if (!c) return std::nullopt;
+        switch (op) {
+            case Expr::Binary::Eq:  return make_bool(*c == 0);
+            case Expr::Binary::Neq: return make_bool(*c != 0);
+            case Expr::Binary::Lt:  return make_bool(*c < 0);
+            case Expr::Binary::Lte: return make_bool(*c <= 0);
+            case Expr::Binary::Gt:  return make_bool(*c > 0);
+            case Expr::Binary::Gte: return make_bool(*c >= 0);
+            default: return std::nullopt;
+        }
+    }
+    if (!is_arithmetic(op) || !is_numeric(l) || !is_numeric(r)) return std::nullopt;
+
+    Value out;
+    if (l.kind == Value::Int && r.kind == Value::Int) {
+        out.kind = Value::Int;
+        switch (op) {
+            case Expr::Binary::Add: if (__builtin_add_overflow(l.i, r.i, &out.i)) return std::nullopt; break;
+            case Expr::Binary::Sub: if (__builtin_sub_overflow(l.i, r.i, &out.i)) return std::nullopt; break;
+            case Expr::Binary::Mul: if (__builtin_mul_overflow(l.i, r.i, &out.i)) return std::nullopt; break;
+            case Expr::Binary::Div:
+                // Leave division by zero (and the one overflowing case) for evaluation to report.
+                if (r.i == 0 || (l.i == LLONG_MIN && r.i == -1)) return std::nullopt;
+                out.i = l.i / r.i;
+                break;
+            default: return std::nullopt;
+        }
+        return out;
+    }
+    out.kind = Value::Float;
+    double x = as_double(l), y = as_double(r);
+    switch (op) {
+        case Expr::Binary::Add: out.f = x + y; break;
+        case Expr::Binary::Sub: out.f = x - y; break;
+        case Expr::Binary::Mul: out.f = x * y; break;
+        case Expr::Binary::Div:
+            if (y == 0.0) return std::nullopt;
+            out.f = x / y;
+            break;
+        default: return std::nullopt;
+    }
+    return out;
+}
+
+// Cheap predicates that an index or zone map can use: column <cmp> literal.
+static bool is_simple_predicate(const ExprArena& a, ExprId id) {
+    const Expr& e = a[id];
+    return e.kind == Expr::BinaryOp && is_comparison(e.binary_op())
+        && a[e.lhs()].kind == Expr::Column && is_literal(a, e.rhs());
+}
+
+// ---- Normalizer --------------------------------------------------------------
+
+namespace {
+
+class Normalizer {
+public:
+    explicit Normalizer(ExprArena& arena) : a(arena) {}
+
+    ExprId rewrite(ExprId id) {
+        // Copy: rewriting children appends to the arena and may move its nodes.
+        Expr e = a[id];
+        switch (e.kind) {
+            case Expr::Literal:
+            case Expr::Column:
+            case Expr::Param:
+                return id;
+            case Expr::UnaryOp:
+                return e.unary_op() == Expr::Unary::Not ? rewrite_not(e.lhs()) : rewrite_neg(id, e.lhs());
+            case Expr::BinaryOp: {
+                auto op = e.binary_op();
+                if (op == Expr::Binary::And || op == Expr::Binary::Or) return rewrite_logical(id, op);
+                return rewrite_binary(id, op, rewrite(e.lhs()), rewrite(e.rhs()));
+            }
+        }
+        return id;
+    }
+
+private:
+    ExprArena& a;
+
+    ExprId rewrite_neg(ExprId id, ExprId child) {
+        ExprId inner = rewrite(child);
+        if (is_literal(a, inner)) {
+            Value v = a.value(inner);
+            if (v.kind == Value::Null) return inner;
+            if (v.kind == Value::Float) { v.f = -v.f; return a.literal(v); }
+            if (v.kind == Value::Int && v.i != LLONG_MIN) { v.i = -v.i; return a.literal(v); }
+        }
+        return inner == child ? id : a.unary(Expr::Unary::Neg, inner);
+    }
+
+    ExprId rewrite_not(ExprId child) {
+        // Push NOT down before rewriting the operand so that NOT NOT x, NOT (a < b) and
+        // De Morgan forms all reduce without creating intermediate nodes.
+        Expr c = a[child];
+        if (c.kind == Expr::UnaryOp && c.unary_op() == Expr::Unary::Not) {
+            return rewrite(c.lhs());
+        }
+        if (c.kind == Expr::BinaryOp && is_comparison(c.binary_op())) {
+            return rewrite(a.binary(c.lhs(), negate(c.binary_op()), c.rhs()));
+        }
+        if (c.kind == Expr::BinaryOp && (c.binary_op() == Expr::Binary::And || c.binary_op() == Expr::Binary::Or)) {
+            auto flipped = c.binary_op() == Expr::Binary::And ? Expr::Binary::Or : Expr::Binary::And;
+            ExprId l = a.unary(Expr::Unary::Not, c.lhs());
+            ExprId r = a.unary(Expr::Unary::Not, c.rhs());
+            return rewrite(a.binary(l, flipped, r));
+        }
+
+        ExprId inner = rewrite(child);
+        if (is_null_literal(a, inner)) return inner;
+        if (is_bool_literal(a, inner, true)) return a.literal(make_bool(false));
+        if (is_bool_literal(a, inner, false)) return a.literal(make_bool(true));
+        return a.unary(Expr::Unary::Not, inner);
+    }
+
+    ExprId rewrite_binary(ExprId id, Expr::Binary::Op op, ExprId lhs, ExprId rhs) {
+        if (is_literal(a, lhs) && is_literal(a, rhs)) {
+            if (auto folded = fold_binary(op, a.value(lhs), a.value(rhs))) {
+                return a.literal(*folded);
+            }
+        }
+        if (is_comparison(op) && is_literal(a, lhs) && !is_literal(a, rhs)) {
+            return a.binary(rhs, mirror(op), lhs);
+        }
+        const Expr& e = a[id];
+        if (e.lhs() == lhs && e.rhs() == rhs) return id;
+        return a.binary(lhs, op, rhs);
+    }
+
+    void collect(ExprId id, Expr::Binary::Op op, std::vector<ExprId>& out) const {
+        const Expr& e = a[id];
+        if (e.kind == Expr::BinaryOp && e.binary_op() == op) {
+            collect(e.lhs(), op, out);
+            collect(e.rhs(), op, out);
+        } else {
+            out.push_back(id);
+        }
+    }
+
+    ExprId rewrite_logical(ExprId id, Expr::Binary::Op op) {
+        bool is_and = op == Expr::Binary::And;
+        std::vector<ExprId> operands;
+        collect(id, op, operands);
+
+        std::vector<ExprId> kept;
+        bool saw_null = false;
+        for (ExprId operand : operands) {
+            ExprId r = rewrite(operand);
+            std::vector<ExprId> parts;
+            collect(r, op, parts); // a rewritten operand (e.g. NOT (x OR y)) may itself be a chain
+            for (ExprId p : parts) {
+                if (is_bool_literal(a, p, !is_and)) {
+                    // FALSE AND x  =>  FALSE;  TRUE OR x  =>  TRUE
+                    return a.literal(make_bool(!is_and));
+                }
+                if (is_bool_literal(a, p, is_and)) continue; // TRUE AND x  =>  x
+                if (is_null_literal(a, p)) { saw_null = true; continue; }
+                kept.push_back(p);
+            }
+        }
+        if (saw_null) kept.push_back(a.literal(make_null())); // NULL AND x is FALSE or NULL, never x
+        if (kept.empty()) return a.literal(make_bool(is_and));
+
+        std::stable_partition(kept.begin(), kept.end(),
+                              [this](ExprId p) { return is_simple_predicate(a, p); });
+        return build_balanced(kept, 0, kept.size(), op);
+    }
+
+    // AND/OR are associative, so a balanced tree keeps the same left-to-right evaluation
+    // order as a left-deep chain while bounding depth by log2 of the operand count.
+    ExprId build_balanced(const std::vector<ExprId>& parts, size_t begin, size_t end, Expr::Binary::Op op) {
+        if (end - begin == 1) return parts[begin];
+        size_t mid = begin + (end - begin) / 2;
+        ExprId lhs = build_balanced(parts, begin, mid, op);
+        ExprId rhs = build_balanced(parts, mid, end, op);
+        return a.binary(lhs, op, rhs);
+    }
+};
+
+} // namespace
+
+// ---- Public entry points -----------------------------------------------------
+
+ExprId normalize_expr(ExprArena& arena, ExprId root) {
+    return Normalizer(arena).rewrite(root);
+}
+
+std::vector<ExprId> conjuncts(const ExprArena& arena, ExprId root) {
+    std::vector<ExprId> out;
+    std::vector<ExprId> stack{root};
+    while (!stack.empty()) {
+        ExprId id = stack.back();
+        stack.pop_back();
+        const Expr& e = arena[id];
+        if (e.kind == Expr::BinaryOp && e.binary_op() == Expr::Binary::And) {
+            stack.push_back(e.rhs());
+            stack.push_back(e.lhs());
+        } else {
+            out.push_back(id);
+        }
+    }
+    return out;
+}
+
+static void normalize_selection(ExprArena& arena, std::optional<ExprId>& selection) {
+    if (!selection) return;
+    selection = normalize_expr(arena, *selection);
+    if (is_bool_literal(arena, *selection, true)) selection.reset();
+}
+
+void normalize(Statement& stmt) {
+    ExprArena& arena = stmt.exprs;
+    std::visit([&](auto& d) {
+        using T = std::decay_t<decltype(d)>;
+        if constexpr (std::is_same_v<T, Statement::InsertData>) {
+            for (auto& v : d.values) v = normalize_expr(arena, v);
+        } else if constexpr (std::is_same_v<T, Statement::UpdateData>) {
+            for (auto& assign : d.assignments) assign.second = normalize_expr(arena, assign.second);
+            normalize_selection(arena, d.selection);
+        } else if constexpr (std::is_same_v<T, Statement::DeleteData> ||
+                             std::is_same_v<T, Statement::SelectData>) {
+            normalize_selection(arena, d.selection);
+        }
+    }, stmt.data);
+}
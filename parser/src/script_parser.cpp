@@ -0,0 +1,105 @@
+#include "parser/script_parser.hpp"
+#include "parser/parser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+ScriptParser::ScriptParser(std::istream& in, size_t chunk_size, size_t max_statement_size)
+    : in_(&in), chunk_(std::max<size_t>(1, chunk_size)), max_statement_size_(max_statement_size) {}
+
+ScriptParser::ScriptParser(const std::string& file_name, size_t chunk_size, size_t max_statement_size)
+    : owned_(std::make_unique<std::ifstream>(file_name, std::ios::binary)),
+      in_(owned_.get()),
+      chunk_(std::max<size_t>(1, chunk_size)),
+      max_statement_size_(max_statement_size) {
+    if (!static_cast<std::ifstream*>(owned_.get())->is_open()) {
+        throw std::runtime_error("Cannot open script file: " + file_name);
+    }
+}
+
+bool ScriptParser::fill_chunk() {
+    in_->read(chunk_.data(), static_cast<std::streamsize>(chunk_.size()));
+    chunk_len_ = static_cast<size_t>(in_->gcount());
+    chunk_pos_ = 0;
+    return chunk_len_ > 0;
+}
+
+void ScriptParser::append_pending(const char* begin, const char* end) {
+    if (oversized_) return;
+    if (pending_.size() + static_cast<size_t>(end - begin) > max_statement_size_) {
+        // Drop the statement but keep scanning to its end, so the error is reported once
+        // and the next call resumes with the following statement.
+        oversized_ = true;
+        pending_.clear();
+        return;
+    }
+    pending_.append(begin, end);
+}
+
+std::optional<Statement> ScriptParser::take_pending() {
+    if (oversized_) {
+        oversized_ = false;
+        statements_parsed_++;
+        throw ParseError("statement exceeds maximum script statement size");
+    }
+    bool blank = std::all_of(pending_.begin(), pending_.end(),
+                             [](char c) { return std::isspace(static_cast<unsigned char>(c)); });
+    if (blank) {
+        pending_.clear();
+        return std::nullopt;
+    }
+    statements_parsed_++;
+    try {
+        Statement stmt = parse(pending_);
+        pending_.clear(); // keeps capacity for the next statement
+        return stmt;
+    } catch (...) {
+        pending_.clear(); // so the caller can skip the bad statement and continue
+        throw;
+    }
+}
+
+std::optional<Statement> ScriptParser::next() {
+    while (true) {
+        if (chunk_pos_ == chunk_len_ && !fill_chunk()) {
+            if (in_string_) {
+                in_string_ = false;
+                pending_.clear();
+                oversized_ = false;
+                statements_parsed_++;
+                throw ParseError("unterminated string literal at end of script");
+            }
+            return take_pending();
+        }
+
+        const char* begin = chunk_.data() + chunk_pos_;
+        const char* end = chunk_.data() + chunk_len_;
+        const char* p = begin;
+        while (p != end) {
+            if (in_string_) {
+                // '' escapes need no special casing: they close and immediately reopen the string.
+                p = std::find(p, end, '\'');
+                if (p == end) break;
+                in_string_ = false;
+                ++p;
+                continue;
+            }
+            p = std::find_if(p, end, [](char c) { return c == ';' || c == '\''; });
+            if (p == end) break;
+            if (*p == '\'') {
+                in_string_ = true;
+                ++p;
+                continue;
+            }
+
+            append_pending(begin, p);
+            chunk_pos_ = static_cast<size_t>(p + 1 - chunk_.data());
+            if (auto stmt = take_pending()) {
+                return stmt;
+            }
+            begin = p = chunk_.data() + chunk_pos_;
+        }
+        append_pending(begin, end);
+        chunk_pos_ = chunk_len_;
+    }
+}
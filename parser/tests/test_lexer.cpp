@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include "parser/lexer.hpp"
+
+static std::vector<Token> kinds(const std::vector<TokenValue>& toks) {
+    std::vector<Token> out;
+    for (const auto& t : toks) out.push_back(t.kind);
+    return out;
+}
+
+
+TEST(LexerTest, PunctuationAndOperators) {
+    auto toks = lex("( ) , ; * . = != < <= > >= + - / ?");
+    std::vector<Token> expected = {
+        Token::LParen, Token::RParen, Token::Comma, Token::Semi, Token::Star, Token::Dot,
+        Token::Eq, Token::Neq, Token::Lt, Token::Lte, Token::Gt, Token::Gte,
+        Token::Plus, Token::Minus, Token::Slash, Token::Param,
+    };
+    EXPECT_EQ(kinds(toks), expected);
+}
+
+TEST(LexerTest, KeywordsAreCaseInsensitive) {
+    auto toks = lex("select SeLeCt SELECT integer Integer");
+    EXPECT_EQ(kinds(toks), (std::vector<Token>{
+        Token::KwSelect, Token::KwSelect, Token::KwSelect, Token::KwInteger, Token::KwInteger}));
+    EXPECT_EQ(toks[1].text, "SeLeCt");
+}
+
+TEST(LexerTest, NearKeywordsAreIdentifiers) {
+    for (const char* word : {"selects", "sel", "intege", "integers", "nul", "x", "_if", "tablex"}) {
+        auto toks = lex(word);
+        ASSERT_EQ(toks.size(), 1u) << word;
+        EXPECT_EQ(toks[0].kind, Token::Ident) << word;
+        EXPECT_EQ(toks[0].text, word);
+    }
+}
+
+TEST(LexerTest, EveryKeywordRoundTrips) {
+    for (const auto& entry : keywords::ENTRIES) {
+        EXPECT_EQ(to_keyword(entry.text), entry.token) << entry.text;
+        std::string lower(entry.text);
+        for (auto& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        EXPECT_EQ(to_keyword(lower), entry.token) << lower;
+    }
+}
+
+TEST(LexerTest, Numbers) {
+    auto toks = lex("42 3.25 7.");
+    ASSERT_EQ(toks.size(), 3u);
+    EXPECT_EQ(toks[0].kind, Token::Int);
+    EXPECT_EQ(toks[0].int_val, 42);
+    EXPECT_EQ(toks[1].kind, Token::Float);
+    EXPECT_DOUBLE_EQ(toks[1].float_val, 3.25);
+    EXPECT_EQ(toks[2].kind, Token::Float);
+    EXPECT_DOUBLE_EQ(toks[2].float_val, 7.0);
+}
+
+TEST(LexerTest, IntegerOverflowIsALexError) {
+    EXPECT_THROW(lex("99999999999999999999"), LexError);
+}
+
+TEST(LexerTest, StringsReferenceInputUnlessEscaped) {
+    std::string input = "'plain' 'it''s' ''";
+    auto toks = lex(input);
+    ASSERT_EQ(toks.size(), 3u);
+    EXPECT_FALSE(toks[0].escaped);
+    EXPECT_EQ(toks[0].text.data(), input.data() + 1);
+    EXPECT_EQ(toks[0].str(), "plain");
+    EXPECT_TRUE(toks[1].escaped);
+    EXPECT_EQ(toks[1].str(), "it's");
+    EXPECT_EQ(toks[2].str(), "");
+}
+
+TEST(LexerTest, NumberedParameters) {
+    auto toks = lex("$1 $12");
+    ASSERT_EQ(toks.size(), 2u);
+    EXPECT_EQ(toks[0].kind, Token::Param);
+    EXPECT_EQ(toks[0].int_val, 1);
+    EXPECT_EQ(toks[1].int_val, 12);
+    EXPECT_THROW(lex("$0"), LexError);
+    EXPECT_THROW(lex("$"), LexError);
+}
+
+TEST(LexerTest, UnexpectedCharacterReportsPosition) {
+    try {
+        lex("SELECT #");
+        FAIL() << "expected LexError";
+    } catch (const LexError& e) {
+        EXPECT_EQ(e.pos, 7u);
+    }
+    EXPECT_THROW(lex("a ! b"), LexError);
+}
+
+TEST(LexerTest, ReusedBufferIsCleared) {
+    std::vector<TokenValue> toks;
+    lex("SELECT a FROM t", toks);
+    EXPECT_EQ(toks.size(), 4u);
+    lex("DROP TABLE t", toks);
+    EXPECT_EQ(kinds(toks), (std::vector<Token>{Token::KwDrop, Token::KwTable, Token::Ident}));
+}
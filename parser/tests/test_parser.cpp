@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "parser/parser.hpp"
+#include "parser/lexer.hpp"
+#include "parser/prepared.hpp"
+#include "parser/script_parser.hpp"
+
+
+TEST(ParserTest, CreateTable) {
+    auto s = parse("CREATE TABLE users (id INT, name TEXT, score REAL, active BOOL, tag my_type)");
+    ASSERT_EQ(s.kind, Statement::CreateTable);
+    const auto& d = std::get<Statement::CreateTableData>(s.data);
+    EXPECT_EQ(d.name, "users");
+    ASSERT_EQ(d.columns.size(), 5u);
+    EXPECT_EQ(d.columns[0].name, "id");
+    EXPECT_EQ(d.columns[0].data_type.kind, DataType::Int);
+    EXPECT_EQ(d.columns[1].data_type.kind, DataType::Text);
+    EXPECT_EQ(d.columns[2].data_type.kind, DataType::Real);
+    EXPECT_EQ(d.columns[3].data_type.kind, DataType::Bool);
+    EXPECT_EQ(d.columns[4].data_type.kind, DataType::Custom);
+    EXPECT_EQ(d.columns[4].data_type.custom, "my_type");
+}
+
+TEST(ParserTest, CreateTableLayoutOption) {
+    auto row = parse("CREATE TABLE t (id INT)");
+    EXPECT_EQ(std::get<Statement::CreateTableData>(row.data).layout, TableLayout::Row);
+    auto pax = parse("CREATE TABLE t (id INT, v REAL) with (LAYOUT = Pax)");
+    EXPECT_EQ(std::get<Statement::CreateTableData>(pax.data).layout, TableLayout::Pax);
+    EXPECT_THROW(parse("CREATE TABLE t (id INT) WITH (layout = columns)"), ParseError);
+    EXPECT_THROW(parse("CREATE TABLE t (id INT) WITH (fillfactor = x)"), ParseError);
+    EXPECT_THROW(parse("CREATE TABLE t (id INT) WITH ()"), ParseError);
+}
+
+TEST(ParserTest, DropTable) {
+    auto s = parse("DROP TABLE IF EXISTS users;");
+    ASSERT_EQ(s.kind, Statement::DropTable);
+    const auto& d = std::get<Statement::DropTableData>(s.data);
+    EXPECT_EQ(d.name, "users");
+    EXPECT_TRUE(d.if_exists);
+    EXPECT_FALSE(std::get<Statement::DropTableData>(parse("drop table t").data).if_exists);
+}
+
+TEST(ParserTest, CreateAndDropIndex) {
+    auto s = parse("CREATE INDEX users_id ON users (id)");
+    ASSERT_EQ(s.kind, Statement::CreateIndex);
+    const auto& d = std::get<Statement::CreateIndexData>(s.data);
+    EXPECT_EQ(d.name, "users_id");
+    EXPECT_EQ(d.table, "users");
+    EXPECT_EQ(d.column, "id");
+    EXPECT_EQ(d.method, IndexMethod::BTree);
+    auto hash = parse("CREATE INDEX users_h ON users USING HASH (id)");
+    EXPECT_EQ(std::get<Statement::CreateIndexData>(hash.data).method, IndexMethod::Hash);
+    EXPECT_THROW(parse("CREATE INDEX i ON users USING gist (id)"), ParseError);
+    EXPECT_THROW(parse("CREATE INDEX i ON users (id, name)"), ParseError);
+    EXPECT_THROW(parse("CREATE INDEX i users (id)"), ParseError);
+
+    auto drop = parse("drop index if exists users_id");
+    ASSERT_EQ(drop.kind, Statement::DropIndex);
+    EXPECT_EQ(std::get<Statement::DropIndexData>(drop.data).name, "users_id");
+    EXPECT_TRUE(std::get<Statement::DropIndexData>(drop.data).if_exists);
+    EXPECT_EQ(parse("DROP TABLE index_log").kind, Statement::DropTable);
+}
+
+TEST(ParserTest, MultiRowInsert) {
+    auto s = parse("INSERT INTO t (a, b) VALUES (1, 'x'), (2, 'y''s'), (-3, NULL)");
+    ASSERT_EQ(s.kind, Statement::Insert);
+    const auto& d = std::get<Statement::InsertData>(s.data);
+    EXPECT_EQ(d.table, "t");
+    ASSERT_TRUE(d.columns.has_value());
+    EXPECT_EQ(*d.columns, (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(d.row_width, 2u);
+    ASSERT_EQ(d.row_count(), 3u);
+    EXPECT_EQ(s.exprs.value(d.row(0)[0]).i, 1);
+    EXPECT_EQ(s.exprs.value(d.row(1)[1]).s, "y's");
+    EXPECT_EQ(s.exprs[d.row(2)[0]].kind, Expr::UnaryOp);
+    EXPECT_EQ(s.exprs.value(d.row(2)[1]).kind, Value::Null);
+}
+
+TEST(ParserTest, InsertRowWidthsMustMatch) {
+    EXPECT_THROW(parse("INSERT INTO t VALUES (1), (1, 2)"), ParseError);
+    EXPECT_THROW(parse("INSERT INTO t (a, b) VALUES (1)"), ParseError);
+}
+
+TEST(ParserTest, SelectWithWhereAndLimit) {
+    auto s = parse("SELECT a, b FROM t WHERE a = 1 AND b > 2.5 OR NOT c LIMIT 10");
+    ASSERT_EQ(s.kind, Statement::Select);
+    const auto& d = std::get<Statement::SelectData>(s.data);
+    ASSERT_EQ(d.columns.size(), 2u);
+    EXPECT_EQ(d.columns[0].kind, SelectItem::Column);
+    EXPECT_EQ(d.columns[1].column, "b");
+    EXPECT_EQ(d.table, "t");
+    ASSERT_TRUE(d.limit.has_value());
+    EXPECT_EQ(*d.limit, 10u);
+
+    // OR binds looser than AND: (a = 1 AND b > 2.5) OR (NOT c)
+    ASSERT_TRUE(d.selection.has_value());
+    const auto& root = s.exprs[*d.selection];
+    ASSERT_EQ(root.kind, Expr::BinaryOp);
+    EXPECT_EQ(root.binary_op(), Expr::Binary::Or);
+    EXPECT_EQ(s.exprs[root.lhs()].binary_op(), Expr::Binary::And);
+    EXPECT_EQ(s.exprs[root.rhs()].kind, Expr::UnaryOp);
+    EXPECT_EQ(s.exprs[root.rhs()].unary_op(), Expr::Unary::Not);
+}
+
+TEST(ParserTest, SelectWildcard) {
+    auto s = parse("select * from t");
+    const auto& d = std::get<Statement::SelectData>(s.data);
+    ASSERT_EQ(d.columns.size(), 1u);
+    EXPECT_EQ(d.columns[0].kind, SelectItem::Wildcard);
+    EXPECT_FALSE(d.selection.has_value());
+    EXPECT_FALSE(d.limit.has_value());
+}
+
+TEST(ParserTest, SelectAggregatesWithGroupBy) {
+    auto s = parse("SELECT region, count(*), SUM(amount), Max(at) FROM sales WHERE amount > 0 GROUP BY region, day LIMIT 3");
+    const auto& d = std::get<Statement::SelectData>(s.data);
+    ASSERT_EQ(d.columns.size(), 4u);
+    EXPECT_EQ(d.columns[0].kind, SelectItem::Column);
+    EXPECT_EQ(d.columns[1].kind, SelectItem::Aggregate);
+    EXPECT_EQ(d.columns[1].func, AggregateFunc::Count);
+    EXPECT_EQ(d.columns[1].column, "");
+    EXPECT_EQ(d.columns[2].func, AggregateFunc::Sum);
+    EXPECT_EQ(d.columns[2].column, "amount");
+    EXPECT_EQ(d.columns[3].func, AggregateFunc::Max);
+    EXPECT_EQ(d.group_by, (std::vector<std::string>{"region", "day"}));
+    EXPECT_TRUE(d.selection.has_value());
+    EXPECT_EQ(*d.limit, 3u);
+
+    EXPECT_TRUE(std::get<Statement::SelectData>(parse("SELECT a FROM t").data).group_by.empty());
+    EXPECT_THROW(parse("SELECT median(a) FROM t"), ParseError);
+    EXPECT_THROW(parse("SELECT sum(*) FROM t"), ParseError);
+    EXPECT_THROW(parse("SELECT count(a FROM t"), ParseError);
+    EXPECT_THROW(parse("SELECT a FROM t GROUP a"), ParseError);
+    EXPECT_THROW(parse("SELECT a FROM t GROUP BY"), ParseError);
+}
+
+TEST(ParserTest, ArithmeticPrecedence) {
+    auto s = parse("SELECT * FROM t WHERE a = 1 + 2 * 3");
+    const auto& d = std::get<Statement::SelectData>(s.data);
+    const auto& eq = s.exprs[*d.selection];
+    const auto& add = s.exprs[eq.rhs()];
+    EXPECT_EQ(add.binary_op(), Expr::Binary::Add);
+    EXPECT_EQ(s.exprs[add.rhs()].binary_op(), Expr::Binary::Mul);
+}
+
+TEST(ParserTest, UpdateAndDelete) {
+    auto u = parse("UPDATE t SET a = 1, b = 'z' WHERE id = 7");
+    const auto& ud = std::get<Statement::UpdateData>(u.data);
+    ASSERT_EQ(ud.assignments.size(), 2u);
+    EXPECT_EQ(ud.assignments[1].first, "b");
+    EXPECT_EQ(u.exprs.value(ud.assignments[1].second).s, "z");
+    EXPECT_TRUE(ud.selection.has_value());
+
+    auto del = parse("DELETE FROM t");
+    EXPECT_EQ(del.kind, Statement::Delete);
+    EXPECT_FALSE(std::get<Statement::DeleteData>(del.data).selection.has_value());
+}
+
+TEST(ParserTest, Errors) {
+    EXPECT_THROW(parse(""), ParseError);
+    EXPECT_THROW(parse("SELECT FROM t"), ParseError);
+    EXPECT_THROW(parse("SELECT * FROM t LIMIT -1"), ParseError);
+    EXPECT_THROW(parse("SELECT * FROM t garbage"), ParseError);
+    EXPECT_THROW(parse("CREATE TABLE t (a)"), ParseError);
+    EXPECT_THROW(parse("SELECT * FROM t WHERE (a = 1"), ParseError);
+}
+
+TEST(ParserTest, DeepNestingIsRejectedNotCrashed) {
+    std::string deep = "SELECT * FROM t WHERE " + std::string(100000, '(') + "a" + std::string(100000, ')');
+    EXPECT_THROW(parse(deep), ParseError);
+
+    std::string nots = "SELECT * FROM t WHERE ";
+    for (int i = 0; i < 100000; ++i) nots += "NOT ";
+    EXPECT_THROW(parse(nots + "a"), ParseError);
+
+    std::string chain = "SELECT * FROM t WHERE a";
+    for (int i = 0; i < 100000; ++i) chain += " + 1";
+    EXPECT_THROW(parse(chain), ParseError);
+
+    std::string ok = "SELECT * FROM t WHERE " + std::string(100, '(') + "a" + std::string(100, ')');
+    EXPECT_NO_THROW(parse(ok));
+}
+
+TEST(ParserTest, Placeholders) {
+    auto s = parse("SELECT * FROM t WHERE a = ? AND b = ?");
+    EXPECT_EQ(s.param_count, 2u);
+    auto n = parse("SELECT * FROM t WHERE a = $3");
+    EXPECT_EQ(n.param_count, 3u);
+    EXPECT_THROW(parse("SELECT * FROM t WHERE a = ? AND b = $1"), ParseError);
+}
+
+
+TEST(PreparedStatementTest, BindAndInstantiate) {
+    StatementCache cache;
+    auto p = cache.prepare("SELECT * FROM t WHERE a = $1 AND b = $2");
+    ASSERT_EQ(p.param_count(), 2u);
+    EXPECT_THROW(p.bound_statement(), std::logic_error);
+    EXPECT_THROW(p.bind(3, Value{}), std::out_of_range);
+
+    Value a; a.kind = Value::Int; a.i = 5;
+    Value b; b.kind = Value::String; b.s = "bee";
+    p.bind(1, a);
+    p.bind(2, b);
+    Statement s = p.bound_statement();
+    EXPECT_EQ(s.param_count, 0u);
+    const auto& root = s.exprs[*std::get<Statement::SelectData>(s.data).selection];
+    EXPECT_EQ(s.exprs.value(s.exprs[root.lhs()].rhs()).i, 5);
+    EXPECT_EQ(s.exprs.value(s.exprs[root.rhs()].rhs()).s, "bee");
+
+    // The cached template is untouched by binding.
+    EXPECT_EQ(p.statement_template().param_count, 2u);
+}
+
+TEST(PreparedStatementTest, OnlyPlaceholdersThatOccurMustBeBound) {
+    StatementCache cache;
+    auto p = cache.prepare("SELECT * FROM t WHERE a = $3");
+    ASSERT_EQ(p.param_count(), 3u);
+    EXPECT_THROW(p.bound_statement(), std::logic_error);
+
+    Value v; v.kind = Value::Int; v.i = 7;
+    p.bind(3, v);
+    Statement s = p.bound_statement();
+    const auto& root = s.exprs[*std::get<Statement::SelectData>(s.data).selection];
+    EXPECT_EQ(s.exprs.value(root.rhs()).i, 7);
+}
+
+TEST(PreparedStatementTest, CacheKeysOnNormalizedText) {
+    StatementCache cache(2);
+    auto s1 = cache.get_or_parse("SELECT *  FROM t\n WHERE a = 'x  y';");
+    auto s2 = cache.get_or_parse("SELECT * FROM t WHERE a = 'x  y'");
+    EXPECT_EQ(s1.get(), s2.get());
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(StatementCache::normalize("  a \t b ;; "), "a b");
+    EXPECT_EQ(StatementCache::normalize("'a  ;  b'"), "'a  ;  b'");
+}
+
+TEST(PreparedStatementTest, CacheEvictsLeastRecentlyUsed) {
+    StatementCache cache(2);
+    auto a = cache.get_or_parse("SELECT * FROM a");
+    cache.get_or_parse("SELECT * FROM b");
+    cache.get_or_parse("SELECT * FROM a"); // a is now most recent
+    cache.get_or_parse("SELECT * FROM c"); // evicts b
+    EXPECT_EQ(cache.get_stats().entries, 2u);
+    EXPECT_EQ(cache.get_or_parse("SELECT * FROM a").get(), a.get());
+    size_t misses = cache.get_stats().misses;
+    cache.get_or_parse("SELECT * FROM b");
+    EXPECT_EQ(cache.get_stats().misses, misses + 1);
+    EXPECT_THROW(cache.get_or_parse("SELECT FROM"), ParseError);
+}
+
+
+TEST(ScriptParserTest, SplitsOnTopLevelSemicolons) {
+    std::istringstream in(
+        "CREATE TABLE t (a INT, b TEXT);;\n"
+        "INSERT INTO t VALUES (1, 'semi;colon'), (2, 'it''s;');\n"
+        "  ;  \n"
+        "SELECT * FROM t WHERE b = ';'");
+    // A tiny chunk size forces statements and literals to straddle chunk boundaries.
+    ScriptParser sp(in, 3);
+    std::vector<Statement> stmts;
+    while (auto s = sp.next()) stmts.push_back(std::move(*s));
+    ASSERT_EQ(stmts.size(), 3u);
+    EXPECT_EQ(stmts[0].kind, Statement::CreateTable);
+    EXPECT_EQ(stmts[1].kind, Statement::Insert);
+    const auto& ins = std::get<Statement::InsertData>(stmts[1].data);
+    EXPECT_EQ(stmts[1].exprs.value(ins.row(0)[1]).s, "semi;colon");
+    EXPECT_EQ(stmts[1].exprs.value(ins.row(1)[1]).s, "it's;");
+    EXPECT_EQ(stmts[2].kind, Statement::Select);
+    EXPECT_EQ(sp.statements_parsed(), 3u);
+    EXPECT_FALSE(sp.next().has_value());
+}
+
+TEST(ScriptParserTest, EnforcesStatementSizeLimit) {
+    std::istringstream in("SELECT * FROM a; SELECT * FROM a_table_name_that_is_far_too_long;");
+    ScriptParser sp(in, 4, 20);
+    EXPECT_TRUE(sp.next().has_value());
+    EXPECT_THROW(sp.next(), ParseError);
+}
+
+TEST(ScriptParserTest, UnterminatedStringAtEnd) {
+    std::istringstream in("SELECT * FROM t WHERE a = 'oops");
+    ScriptParser sp(in);
+    EXPECT_THROW(sp.next(), ParseError);
+}
+
+TEST(ScriptParserTest, ReportsWhichStatementFailed) {
+    std::istringstream in("SELECT * FROM a; SELECT FROM; SELECT * FROM c;");
+    ScriptParser sp(in);
+    EXPECT_TRUE(sp.next().has_value());
+    EXPECT_THROW(sp.next(), ParseError);
+    EXPECT_EQ(sp.statements_parsed(), 2u);
+    EXPECT_TRUE(sp.next().has_value());
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "parser/parser.hpp"
+#include "parser/rewrite.hpp"
+
+static const char* op_text(Expr::Binary::Op op) {
+    static const char* names[] = {"OR", "AND", "=", "!=", "<", "<=", ">", ">=", "+", "-", "*", "/"};
+    return names[op];
+}
+
+static std::string show(const ExprArena& a, ExprId id) {
+    const Expr& e = a[id];
+    switch (e.kind) {
+        case Expr::Literal: {
+            Value v = a.value(id);
+            switch (v.kind) {
+                case Value::Null: return "NULL";
+                case Value::Bool: return v.b ? "TRUE" : "FALSE";
+                case Value::Int: return std::to_string(v.i);
+                case Value::Float: return std::to_string(v.f);
+                case Value::String: return "'" + v.s + "'";
+            }
+            return "?";
+        }
+        case Expr::Column: return std::string(a.column_name(id));
+        case Expr::Param: return "$" + std::to_string(e.i + 1);
+        case Expr::UnaryOp:
+            return std::string(e.unary_op() == Expr::Unary::Not ? "NOT " : "-") + show(a, e.lhs());
+        case Expr::BinaryOp:
+            return "(" + show(a, e.lhs()) + " " + op_text(e.binary_op()) + " " + show(a, e.rhs()) + ")";
+    }
+    return "?";
+}
+
+// Normalizes the WHERE clause of a SELECT over `where` and renders it.
+static std::string normalized(const std::string& where) {
+    Statement s = parse("SELECT * FROM t WHERE " + where);
+    normalize(s);
+    const auto& d = std::get<Statement::SelectData>(s.data);
+    return d.selection ? show(s.exprs, *d.selection) : "<none>";
+}
+
+
+TEST(RewriteTest, FoldsConstants) {
+    EXPECT_EQ(normalized("a > 1 + 2"), "(a > 3)");
+    EXPECT_EQ(normalized("a = 2 * 3 - 10 / 2"), "(a = 1)");
+    EXPECT_EQ(normalized("a < 1.5 * 2"), "(a < 3.000000)");
+    EXPECT_EQ(normalized("a = -(2 + 3)"), "(a = -5)");
+    EXPECT_EQ(normalized("a = 1 + NULL"), "(a = NULL)");
+    EXPECT_EQ(normalized("a = 'x' AND 2 > 1"), "(a = 'x')");
+}
+
+TEST(RewriteTest, LeavesFaultingArithmeticForEvaluation) {
+    EXPECT_EQ(normalized("a = 1 / 0"), "(a = (1 / 0))");
+    EXPECT_EQ(normalized("a = 9223372036854775807 + 1"), "(a = (9223372036854775807 + 1))");
+}
+
+TEST(RewriteTest, BooleanIdentities) {
+    EXPECT_EQ(normalized("a > 1 AND TRUE"), "(a > 1)");
+    EXPECT_EQ(normalized("a > 1 OR FALSE"), "(a > 1)");
+    EXPECT_EQ(normalized("x AND FALSE"), "FALSE");
+    EXPECT_EQ(normalized("x OR TRUE"), "<none>");
+    EXPECT_EQ(normalized("NOT NOT x"), "x");
+    EXPECT_EQ(normalized("NOT (a < 3)"), "(a >= 3)");
+    EXPECT_EQ(normalized("NOT (a = 1 OR b = 2)"), "((a != 1) AND (b != 2))");
+    EXPECT_EQ(normalized("1 = 1"), "<none>");
+}
+
+TEST(RewriteTest, ThreeValuedLogic) {
+    EXPECT_EQ(normalized("NULL AND FALSE"), "FALSE");
+    EXPECT_EQ(normalized("NULL OR TRUE"), "<none>");
+    EXPECT_EQ(normalized("x AND NULL"), "(x AND NULL)");
+    EXPECT_EQ(normalized("NOT NULL"), "NULL");
+}
+
+TEST(RewriteTest, ColumnOnTheLeft) {
+    EXPECT_EQ(normalized("5 < a"), "(a > 5)");
+    EXPECT_EQ(normalized("5 >= a"), "(a <= 5)");
+    EXPECT_EQ(normalized("'x' = name"), "(name = 'x')");
+}
+
+TEST(RewriteTest, FlattensChainsSimplePredicatesFirst) {
+    EXPECT_EQ(normalized("x AND (a = 1 AND (b > 2 AND c = 3))"),
+              "(((a = 1) AND (b > 2)) AND ((c = 3) AND x))");
+
+    Statement s = parse("SELECT * FROM t WHERE x AND (a = 1 AND (b > 2 AND c = 3))");
+    normalize(s);
+    auto parts = conjuncts(s.exprs, *std::get<Statement::SelectData>(s.data).selection);
+    ASSERT_EQ(parts.size(), 4u);
+    EXPECT_EQ(show(s.exprs, parts[0]), "(a = 1)");
+    EXPECT_EQ(show(s.exprs, parts[1]), "(b > 2)");
+    EXPECT_EQ(show(s.exprs, parts[2]), "(c = 3)");
+    EXPECT_EQ(show(s.exprs, parts[3]), "x");
+}
+
+TEST(RewriteTest, LongChainsStayShallow) {
+    std::string where = "a = 0";
+    for (int i = 1; i < 1000; ++i) where += " OR a = " + std::to_string(i);
+    Statement s = parse("SELECT * FROM t WHERE " + where);
+    normalize(s);
+    const auto& root = s.exprs[*std::get<Statement::SelectData>(s.data).selection];
+    EXPECT_LE(root.depth, 12);
+}
+
+TEST(RewriteTest, NormalizesUpdateAndInsert) {
+    Statement u = parse("UPDATE t SET a = 1 + 1 WHERE TRUE");
+    normalize(u);
+    const auto& ud = std::get<Statement::UpdateData>(u.data);
+    EXPECT_EQ(show(u.exprs, ud.assignments[0].second), "2");
+    EXPECT_FALSE(ud.selection.has_value());
+
+    Statement i = parse("INSERT INTO t VALUES (-1, 2 * 4)");
+    normalize(i);
+    const auto& id = std::get<Statement::InsertData>(i.data);
+    EXPECT_EQ(show(i.exprs, id.values[0]), "-1");
+    EXPECT_EQ(show(i.exprs, id.values[1]), "8");
+}
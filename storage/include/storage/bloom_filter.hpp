@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "storage/buffer_pool.hpp"
+#include "storage/tuple.hpp"
+
+/**
+ * Blocked Bloom filters over the values of a heap file's INT, REAL and TEXT columns, one
+ * per column for every group of GROUP_PAGES data pages, kept in pages of their own file
+ * and accessed through the buffer pool:
+ *
+ *   page g:   [lsn u64] then, for each filtered column, blocks() blocks of BLOCK_WORDS
+ *             u32: the filters of data pages g * GROUP_PAGES + 1 .. (g + 1) * GROUP_PAGES
+ *
+ * A filter is split into 256-bit blocks. The upper half of a key's hash picks one block
+ * and the lower half, multiplied by eight odd SALT constants, one bit in each of its
+ * eight words, so adding or probing a key touches a single cache line and a probe is a
+ * handful of vector instructions. NULLs are not added: an equality never matches them.
+ *
+ * Filters only gain bits. Removing or overwriting a record leaves its bits set, so a
+ * filter may answer "maybe" for a value no longer present but never "no" for one that
+ * is. insert() takes the map page's write latch only when it sets a new bit.
+ */
+class BloomFilterMap {
+public:
+    static constexpr size_t GROUP_PAGES = 4;
+    static constexpr size_t BLOCK_WORDS = 8;
+    static constexpr size_t BLOCK_BYTES = BLOCK_WORDS * sizeof(uint32_t);
+    static constexpr uint32_t SALT[BLOCK_WORDS] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+    };
+    // Most columns a schema can have for every filter of a group to get a block.
+    static constexpr size_t MAX_COLUMNS = (PAGE_SIZE - PAGE_LSN_SIZE) / BLOCK_BYTES;
+
+    // One value to add: the filter (index among the filtered columns) and its hash.
+    struct Key {
+        uint32_t filter;
+        uint64_t hash;
+    };
+
+    // Throws std::invalid_argument if `schema` has more than MAX_COLUMNS columns.
+    BloomFilterMap(std::string file_name, const TupleLayout& schema, BufferPoolManager& bpm);
+
+    const std::string& file_name() const { return file_name_; }
+    // Index of column `column`'s filter, or -1 if its type is not filtered.
+    int filter_of(size_t column) const { return filter_of_[column]; }
+    // Blocks per filter.
+    size_t blocks() const { return blocks_; }
+
+    // Hashes of values as filters store them; REAL -0.0 hashes like 0.0.
+    static uint64_t hash_int(long long v);
+    static uint64_t hash_real(double v);
+    static uint64_t hash_text(std::string_view v);
+
+    // Block of a filter of `blocks` blocks that `hash` maps to.
+    static size_t block_of(uint64_t hash, size_t blocks) {
+        return static_cast<size_t>(((hash >> 32) * blocks) >> 32);
+    }
+    // Whether every bit of `hash` is set in `block`: the portable probe.
+    static bool block_contains(const uint8_t* block, uint64_t hash) {
+        auto x = static_cast<uint32_t>(hash);
+        for (size_t i = 0; i < BLOCK_WORDS; ++i) {
+            uint32_t word;
+            std::memcpy(&word, block + i * sizeof(word), sizeof(word));
+            if (!(word & (1U << ((x * SALT[i]) >> 27)))) return false;
+        }
+        return true;
+    }
+
+    // Appends the keys of one record's non-NULL filtered values to `out`.
+    void keys(const uint8_t* tuple, std::vector<Key>& out) const;
+    // Adds `keys`, of records on data page `page_id`, to its group's filters.
+    void insert(uint64_t page_id, const std::vector<Key>& keys);
+    // Adds the values of one record on data page `page_id`.
+    void add(uint64_t page_id, const uint8_t* tuple);
+
+    // Calls fn(const uint8_t* filters) with the filters of data page `page_id`'s group
+    // read-latched; filter f starts at filters + f * blocks() * BLOCK_BYTES.
+    template<typename Fn>
+    void read(uint64_t page_id, Fn&& fn) {
+        auto page = bpm_.fetch_page_read(file_name_, group_page(page_id));
+        fn(static_cast<const uint8_t*>(page->data() + PAGE_LSN_SIZE));
+    }
+
+private:
+    std::string file_name_;
+    TupleLayout schema_;
+    BufferPoolManager& bpm_;
+    std::vector<int> filter_of_;
+    size_t filters_ = 0;
+    size_t blocks_;
+
+    static uint64_t group_page(uint64_t page_id) { return page_id == 0 ? 0 : (page_id - 1) / GROUP_PAGES; }
+    // Sets the bits of `keys` in the filters at `filters` (only checks them with
+    // `dry_run`); true if any was clear.
+    bool set_bits(uint8_t* filters, const std::vector<Key>& keys, bool dry_run) const;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "storage/buffer_pool.hpp"
+#include "storage/heap_file.hpp"
+#include "storage/index_entry.hpp"
+
+/**
+ * Disk-resident B+tree from 64-bit integer keys to RIDs, kept in its own file and
+ * accessed through the buffer pool. Page 0 is a header holding the root page id and
+ * the tree height; every other page is a node:
+ *
+ *   [lsn u64][is_leaf u8][reserved u8][count u16][reserved u32][next_leaf u64]
+ *   leaf:     count x [key i64][rid page u64][rid slot u16]
+ *   internal: [child 0 u64] count x [key i64][rid page u64][rid slot u16][child u64]
+ *
+ * A separator in an internal node is the smallest entry of the subtree to its right.
+ * Leaves are linked left to right, so a range scan descends once and then follows
+ * next_leaf.
+ *
+ * Concurrency is latch crabbing on the buffer pool's page latches, always taken top
+ * down and, between leaves, left to right. Readers hold at most a parent and a child
+ * latch. An insert first descends with read latches and write-latches only the leaf;
+ * if the leaf is full it restarts holding write latches from the header down, and
+ * releases the ancestors whenever a node has room to absorb a split from below.
+ * Removal deletes from the leaf only and never merges nodes, so it needs no more than
+ * the leaf latch; space in underfull leaves is reclaimed by rebuilding the index.
+ */
+class BPlusTree {
+public:
+    static constexpr size_t NODE_HEADER_SIZE = 24;
+    static constexpr size_t ENTRY_SIZE = IndexEntry::ENCODED_SIZE;
+    static constexpr size_t LEAF_CAPACITY = (PAGE_SIZE - NODE_HEADER_SIZE) / ENTRY_SIZE;
+    static constexpr size_t INTERNAL_CAPACITY = (PAGE_SIZE - NODE_HEADER_SIZE - 8) / (ENTRY_SIZE + 8);
+    // Percentage of each node bulk_load fills, leaving room for later inserts.
+    static constexpr size_t BULK_FILL_PERCENT = 90;
+
+    explicit BPlusTree(std::string file_name, BufferPoolManager& bpm = BufferPoolManager::get_instance());
+    ~BPlusTree();
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Adds (key, rid); false if that exact entry is already present.
+    bool insert(int64_t key, RID rid);
+    // Removes (key, rid); false if it is not present.
+    bool remove(int64_t key, RID rid);
+    // RIDs of every entry with `key`, in RID order.
+    std::vector<RID> find(int64_t key);
+    // Calls fn for each entry with lo <= key <= hi, in order; fn returns false to stop.
+    void scan(int64_t lo, int64_t hi, const std::function<bool(const IndexEntry&)>& fn);
+
+    // Builds the tree bottom up from entries sorted by (key, rid), filling nodes to
+    // BULK_FILL_PERCENT. Throws std::invalid_argument if the tree is not empty or the
+    // input is not strictly increasing.
+    void bulk_load(const std::vector<IndexEntry>& sorted);
+
+    const std::string& file_name() const { return file_name_; }
+    // Number of levels, 0 for an empty tree.
+    size_t height();
+
+private:
+    static constexpr uint32_t MAGIC = 0x42424453;   // "SDBB"
+    static constexpr size_t MAGIC_OFFSET = PAGE_LSN_SIZE;
+    static constexpr size_t ROOT_OFFSET = PAGE_LSN_SIZE + 8;
+    static constexpr size_t HEIGHT_OFFSET = PAGE_LSN_SIZE + 16;
+    static constexpr size_t PAGE_COUNT_OFFSET = PAGE_LSN_SIZE + 24;
+
+    std::string file_name_;
+    BufferPoolManager& bpm_;
+    std::atomic<uint64_t> page_count_{0};
+
+    // Page id of the leaf that should hold `e` (0 for an empty tree), with its parent,
+    // or the header for a single-leaf tree, still read-latched so the caller can latch
+    // the leaf in either mode before letting go of the path.
+    std::pair<ReadPageHandle, uint64_t> find_leaf(const IndexEntry& e);
+    bool insert_pessimistic(const IndexEntry& e);
+    uint64_t allocate_page();
+    void write_header(WritePageHandle& header, uint64_t root, uint64_t height);
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <set>
+#include <atomic>
+#include <variant>
+#include "third_party/ConcurrentHashMap.h"
+#include "storage/disk.hpp"
+#include "storage/free_frame_list.hpp"
+#include "storage/wal.hpp"
+
+
+// page_id of a frame that holds no page.
+constexpr uint64_t INVALID_PAGE_ID = UINT64_MAX;
+
+struct PageId {
+    std::string file_name;
+    uint64_t page_id;
+
+    bool operator==(const PageId& other) const {
+        return file_name == other.file_name && page_id == other.page_id;
+    }
+
+    bool operator<(const PageId& other) const {
+        if (file_name != other.file_name) {
+            return file_name < other.file_name;
+        }
+        return page_id < other.page_id;
+    }
+};
+
+
+struct PageIdHash {
+    /**
+     * Computes a hash value for a PageId object.
+     *
+     * The hash is generated by combining the hash of the file name
+     * and the hash of the page ID, ensuring that PageId can be used
+     * as a key in hash-based containers such as std::unordered_map
+     * and std::unordered_set. The combination uses a simple XOR and
+     * bit-shift operation to reduce collisions while keeping the
+     * implementation lightweight.
+     */
+    std::size_t operator()(const PageId& pid) const {
+        std::size_t h1 = std::hash<std::string>{}(pid.file_name);
+        std::size_t h2 = std::hash<uint64_t>{}(pid.page_id);
+        return h1 ^ (h2 << 1);
+    }
+};
+
+
+struct Frame {
+    PageId page_id{std::string(), INVALID_PAGE_ID};
+    std::vector<uint8_t> data;
+    std::shared_mutex page_mutex;
+    std::atomic<bool> is_dirty{false};
+    std::atomic<int>  pin_count{0};
+    std::atomic<bool> referenced{false};
+    bool in_use{false};     // holds a page; guarded by buffer_pool_mutex_
+    std::vector<uint8_t> before_image;  // page as the current write latch found it, when logging
+
+    Frame() = default;
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
+};
+
+
+class BufferPoolManager;
+
+template<typename LockType>
+class PageHandle {
+
+private:
+    std::vector<uint8_t>* data_;
+    LockType lock_;
+    PageId page_id_;
+    bool is_dirty_;
+
+    std::function<void(const PageId)> unpin_page_fn_;
+    std::function<void(const PageId&)> mark_page_dirty_fn_;
+
+    void cleanup() {
+        if (!data_) {
+            return;
+        }
+        if (is_dirty_) {
+            mark_page_dirty_fn_(page_id_);
+        }
+        lock_.unlock();
+        unpin_page_fn_(page_id_);
+        data_ = nullptr;
+    }
+
+public:
+
+    PageHandle(std::vector<uint8_t>* data, LockType lock, const PageId& page_id,
+               std::function<void(const PageId)> unpin_page_fn,
+               std::function<void(const PageId&)> mark_page_dirty_fn)
+        : data_(data), lock_(std::move(lock)), page_id_(page_id), is_dirty_(false),
+          unpin_page_fn_(std::move(unpin_page_fn)), mark_page_dirty_fn_(std::move(mark_page_dirty_fn)) {}
+
+
+    PageHandle(PageHandle&& other) noexcept
+        : data_(other.data_), lock_(std::move(other.lock_)), page_id_(other.page_id_), is_dirty_(other.is_dirty_),
+          unpin_page_fn_(std::move(other.unpin_page_fn_)), mark_page_dirty_fn_(std::move(other.mark_page_dirty_fn_)) {
+        other.data_ = nullptr;
+    }
+
+    PageHandle& operator=(PageHandle&& other) noexcept {
+        if (this != &other) {
+            cleanup();
+            data_ = other.data_;
+            lock_ = std::move(other.lock_);
+            page_id_ = other.page_id_;
+            is_dirty_ = other.is_dirty_;
+            unpin_page_fn_ = std::move(other.unpin_page_fn_);
+            mark_page_dirty_fn_ = std::move(other.mark_page_dirty_fn_);
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+
+    PageHandle(const PageHandle&) = delete;
+    PageHandle& operator=(const PageHandle&) = delete;
+
+    ~PageHandle() {
+        cleanup();
+    }
+
+
+    std::vector<uint8_t>& data() { return *data_; }
+    const std::vector<uint8_t>& data() const { return *data_; }
+
+    std::vector<uint8_t>* operator->() { return data_; }
+    const std::vector<uint8_t>* operator->() const { return data_; }
+
+    std::vector<uint8_t>& operator*() { return *data_; }
+    const std::vector<uint8_t>& operator*() const { return *data_; }
+
+    const PageId& page_id() const { return page_id_; }
+    void mark_dirty() { is_dirty_ = true; }
+    bool is_valid() const { return data_ != nullptr; }
+    void release() { cleanup(); }
+};
+
+
+using ReadPageHandle = PageHandle<std::shared_lock<std::shared_mutex>>;
+using WritePageHandle = PageHandle<std::unique_lock<std::shared_mutex>>;
+
+
+class BufferPoolManager {
+
+private:
+
+    static constexpr size_t DEFAULT_BUFFER_POOL_SIZE = 1000;
+    std::vector<std::unique_ptr<Frame>> frames_;
+    size_t pool_size_;
+    ConcurrentHashMap<PageId, size_t, PageIdHash> page_table_;
+    FreeFrameList free_frames_;
+    std::shared_mutex buffer_pool_mutex_;
+    size_t clock_hand_ = 0;
+    LogManager* log_;
+    std::mutex unsynced_mutex_;
+    std::set<std::string> unsynced_files_;   // data files written back since the last sync
+
+    std::optional<size_t> get_free_frame();
+    void return_free_frame(size_t frame_idx);
+    std::optional<size_t> evict_frame();
+
+    void load_page_to_frame(const PageId& page_id, size_t frame_idx);
+    void flush_page(size_t frame_idx);
+
+    using PageHandleVariant = std::variant<ReadPageHandle, WritePageHandle>;
+
+    std::optional<PageHandleVariant> lock_frame(size_t frame_idx, const PageId& pid, bool is_write);
+    PageHandleVariant fetch_page_internal(const std::string& file_name, uint64_t page_id, bool is_write);
+
+    size_t get_frame_index(const PageId& pid) const;
+
+public:
+
+    /*
+    * With a log, every write latch released on a dirtied page appends a PageDiff record
+    * of what changed under it and stamps the page with that record's LSN, and a dirty
+    * frame is only written back once the log is durable up to its page LSN.
+    */
+    explicit BufferPoolManager(size_t pool_size = DEFAULT_BUFFER_POOL_SIZE, LogManager* log = nullptr);
+
+    static BufferPoolManager& get_instance() {
+        static BufferPoolManager instance;
+        return instance;
+    }
+
+    BufferPoolManager(const BufferPoolManager&) = delete;
+    BufferPoolManager& operator=(const BufferPoolManager&) = delete;
+
+    ReadPageHandle fetch_page_read(const std::string& file_name, uint64_t page_id);
+    WritePageHandle fetch_page_write(const std::string& file_name, uint64_t page_id);
+
+    LogManager* log() const { return log_; }
+
+    bool unpin_page(const std::string& file_name, uint64_t page_id, bool is_dirty = false);
+    bool flush_page(const std::string& file_name, uint64_t page_id);
+    void flush_all_pages();
+    // Pages whose frames are dirty, each checked under its frame's shared latch so a
+    // write latch released before the call is always seen; no pool-wide lock is taken.
+    std::vector<PageId> dirty_pages();
+    // fsyncs every data file a frame was written back to (by flush or eviction) since
+    // the last call. A checkpoint calls this before it moves the redo start forward.
+    void sync_written_files();
+    std::vector<std::string> unsynced_files();
+
+    struct PoolStats {
+        size_t total_frames;
+        size_t free_frames;
+        size_t pinned_frames;
+        size_t dirty_frames;
+    };
+
+    PoolStats get_stats() const;
+};
+
+
+inline ReadPageHandle fetch_page_read(const std::string& file_name, uint64_t page_id) {
+    return BufferPoolManager::get_instance().fetch_page_read(file_name, page_id);
+}
+
+inline WritePageHandle fetch_page_write(const std::string& file_name, uint64_t page_id) {
+    return BufferPoolManager::get_instance().fetch_page_write(file_name, page_id);
+}
+
+inline bool flush_page(const std::string& file_name, uint64_t page_id) {
+    return BufferPoolManager::get_instance().flush_page(file_name, page_id);
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "parser/ast.hpp"
+#include "storage/heap_file.hpp"
+#include "storage/tuple.hpp"
+
+// Thrown for DDL on a table that already exists or does not, and for lookups of
+// unknown tables.
+struct CatalogError : public std::runtime_error {
+    CatalogError(std::string msg) : std::runtime_error(std::move(msg)) {}
+};
+
+// Definition of one table. Never changes once created; DROP and re-CREATE make a new one.
+struct TableSchema {
+    uint32_t id;                // unique for the catalog's lifetime, never reused
+    std::string name;
+    TableLayout layout;
+    std::string file_name;      // heap file holding the table's records
+    TupleLayout schema;         // columns and their record encoding
+};
+
+/**
+ * One immutable version of the catalog. A statement binds against a single snapshot,
+ * so DDL running meanwhile never changes the names it resolves, and the schemas it
+ * holds stay alive as long as the snapshot does.
+ */
+class CatalogSnapshot {
+public:
+    // Incremented by every DDL statement.
+    uint64_t version() const { return version_; }
+    size_t table_count() const { return tables_.size(); }
+
+    // nullptr if there is no such table.
+    const TableSchema* find(std::string_view name) const {
+        auto it = tables_.find(name);
+        return it == tables_.end() ? nullptr : it->second.get();
+    }
+    // Throws CatalogError if there is no such table.
+    const TableSchema& table(std::string_view name) const;
+
+    // Calls fn(const TableSchema&) for every table in name order.
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& [name, table] : tables_) fn(*table);
+    }
+
+private:
+    friend class Catalog;
+
+    uint64_t version_ = 0;
+    std::map<std::string, std::shared_ptr<const TableSchema>, std::less<>> tables_;
+};
+
+/**
+ * Table definitions, persisted as records of a heap file (through the buffer pool
+ * like any table) and served from an in-memory snapshot.
+ *
+ * Readers never fetch pages, and lock only once per thread after each DDL statement:
+ * snapshot() hands out the calling thread's cached CatalogSnapshot as long as its
+ * version is current, which costs one atomic load, and otherwise copies the current
+ * one under a mutex held for just that copy. refresh() lets a long-lived reader keep
+ * its snapshot until DDL publishes a new one, at the same cost. DDL is serialized
+ * by one mutex; it writes the catalog file first, then copies the snapshot (the
+ * schemas themselves are shared), applies the change and publishes the copy. Readers
+ * holding an older snapshot keep using it until they refresh.
+ *
+ * A table's records live in `<catalog file>.<table id>`. Dropping a table removes it
+ * from the catalog but leaves that file behind; ids are never reused, so neither is
+ * the file name.
+ */
+class Catalog {
+public:
+    // Opens or creates the catalog stored in `file_name`.
+    explicit Catalog(std::string file_name, BufferPoolManager& bpm = BufferPoolManager::get_instance());
+
+    Catalog(const Catalog&) = delete;
+    Catalog& operator=(const Catalog&) = delete;
+
+    std::shared_ptr<const CatalogSnapshot> snapshot() const;
+    // Replaces `held` (which may be empty) with the current snapshot if it is older.
+    void refresh(std::shared_ptr<const CatalogSnapshot>& held) const {
+        if (held && held->version() == version_.load(std::memory_order_acquire)) return;
+        held = snapshot();
+    }
+
+    // Throws CatalogError if the table exists, and std::invalid_argument for duplicate
+    // or unsupported columns.
+    std::shared_ptr<const TableSchema> create_table(const Statement::CreateTableData& def);
+    // False if the table does not exist and IF EXISTS was given; throws CatalogError
+    // if it does not exist otherwise.
+    bool drop_table(const Statement::DropTableData& def);
+
+private:
+    const uint64_t id_;                             // tells catalogs apart in thread caches
+    HeapFile heap_;
+    std::mutex ddl_mutex_;                          // serializes DDL; guards the members below
+    std::unordered_map<std::string, RID> rids_;     // table name -> its catalog record
+    RID sequence_rid_{0, 0};                        // record holding next_id_
+    uint32_t next_id_ = 1;
+
+    mutable std::mutex snapshot_mutex_;                 // guards current_ and writes to version_
+    std::shared_ptr<const CatalogSnapshot> current_;
+    std::atomic<uint64_t> version_{0};                  // current_->version(), read without the lock
+
+    void publish(std::shared_ptr<CatalogSnapshot> next);
+};
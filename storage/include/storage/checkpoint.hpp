@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "storage/buffer_pool.hpp"
+#include "storage/wal.hpp"
+
+/**
+ * Fuzzy checkpoints over a logging buffer pool. A checkpoint
+ *
+ *   - appends a CheckpointBegin record, whose LSN is where redo will start;
+ *   - snapshots the dirty-page table with BufferPoolManager::dirty_pages();
+ *   - writes those pages back in sorted page order, one frame latch (shared) at a time
+ *     and at most pages_per_second of them per second if that is not 0;
+ *   - fsyncs every data file written back since the previous checkpoint, including by
+ *     eviction (BufferPoolManager::sync_written_files());
+ *   - appends CheckpointEnd and makes the begin LSN the log's last_checkpoint().
+ *
+ * Writers keep running throughout: no pool-wide lock is taken, and a page dirtied again
+ * after the snapshot is simply covered by records after the begin LSN. Every change
+ * logged before the begin LSN was on a page that was dirty at the snapshot (or was
+ * written back by eviction since), so once the checkpoint completes, recovery only
+ * needs the log from its begin LSN on.
+ *
+ * The caller must not hold a page latch while a checkpoint runs in its thread.
+ */
+class Checkpointer {
+public:
+    Checkpointer(BufferPoolManager& bpm, LogManager& log, size_t pages_per_second = 0);
+    // Stops the background thread, if any.
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // Runs one checkpoint in the calling thread and returns its begin LSN.
+    Lsn checkpoint();
+
+    // Runs a checkpoint every `interval` in a background thread until stop().
+    void start(std::chrono::milliseconds interval);
+    // Waits for a running checkpoint to finish and ends the background thread.
+    void stop();
+
+    // Checkpoints completed and pages written by them, for observing progress.
+    uint64_t checkpoints() const { return checkpoints_.load(); }
+    uint64_t pages_written() const { return pages_written_.load(); }
+
+private:
+    BufferPoolManager& bpm_;
+    LogManager& log_;
+    size_t pages_per_second_;
+    std::atomic<uint64_t> checkpoints_{0};
+    std::atomic<uint64_t> pages_written_{0};
+
+    std::thread thread_;
+    std::mutex mutex_;                  // guards stop_ for the background thread's waits
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
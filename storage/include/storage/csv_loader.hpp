@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "storage/heap_file.hpp"
+#include "storage/tuple.hpp"
+
+struct CsvOptions {
+    char delimiter = ',';
+    bool header = false;    // the first record names the columns and is skipped
+    size_t threads = 0;     // 0 uses std::thread::hardware_concurrency()
+    size_t segment_bytes = size_t(4) << 20;     // CSV bytes read per thread at a time
+};
+
+/**
+ * Bulk loads the CSV file at `csv_path` into `heap`, whose records are encoded with
+ * `layout`, and returns the number of rows loaded. Bypasses both the SQL front end and
+ * the buffer pool:
+ *
+ *   - the file is read in segments of options.segment_bytes per thread, and each
+ *     segment is cut at record boundaries into one chunk per thread;
+ *   - threads parse their chunk, encode each record by the column types and pack the
+ *     records into whole pages in private buffers;
+ *   - the chunks' pages are appended in file order with HeapFile::append_pages, one
+ *     sequential write per chunk.
+ *
+ * Records follow RFC 4180: fields are separated by options.delimiter, records end with
+ * LF or CRLF, and quoted fields may contain delimiters, line breaks and "" for a quote.
+ * Every record must have one field per column. An unquoted empty field is NULL; INT and
+ * REAL fields are decimal numbers, BOOL fields are true/false/t/f/1/0 in any case, and
+ * TEXT fields are taken as is. Blank lines are skipped.
+ *
+ * Throws std::invalid_argument, naming the record (counted from 1), for malformed input
+ * or records that do not fit in a page, and std::runtime_error if the file cannot be
+ * read. Segments before the failing one stay loaded.
+ */
+uint64_t load_csv(const std::string& csv_path, HeapFile& heap, const TupleLayout& layout,
+                  const CsvOptions& options = CsvOptions());
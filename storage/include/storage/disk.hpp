@@ -5,5 +5,16 @@
 
 constexpr size_t PAGE_SIZE = 8 * 1024; // 8KB
 
+// Every page type starts with the LSN of the last log record applied to it.
+constexpr size_t PAGE_LSN_OFFSET = 0;
+constexpr size_t PAGE_LSN_SIZE = 8;
+
 std::vector<uint8_t> read_page(const std::string& file_name, uint64_t page_id);
 void write_page(const std::string& file_name, uint64_t page_id, const std::vector<uint8_t>& data);
+// Writes `count` pages stored back to back in `data` to pages first_page.. of the file
+// with one sequential write.
+void write_pages(const std::string& file_name, uint64_t first_page, const uint8_t* data, size_t count);
+// Forces the file's written pages to stable storage.
+void sync_file(const std::string& file_name);
+// Number of whole pages in the file, 0 if it does not exist.
+uint64_t file_pages(const std::string& file_name);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+
+/**
+ * Lock-free stack of free frame indices (a Treiber stack).
+ *
+ * Frames are identified by their index in the pool, so the stack never
+ * allocates: next_[i] holds the index below frame i. The head packs a
+ * 32-bit frame index with a 32-bit tag that is bumped on every successful
+ * push and pop, which makes a pop that raced with a pop/push of the same
+ * index fail its CAS instead of corrupting the list (the ABA problem).
+ */
+class FreeFrameList {
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;
+    std::atomic<uint64_t> head_;
+    std::atomic<size_t> size_{0};
+    size_t capacity_;
+
+    static uint64_t pack(uint32_t tag, uint32_t idx) { return (uint64_t(tag) << 32) | idx; }
+    static uint32_t index_of(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint32_t tag_of(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+public:
+
+    explicit FreeFrameList(size_t capacity)
+        : next_(new std::atomic<uint32_t>[capacity]), head_(pack(0, NIL)), capacity_(capacity) {
+        if (capacity >= NIL) {
+            throw std::invalid_argument("FreeFrameList capacity must fit in 32 bits");
+        }
+        for (size_t i = 0; i < capacity_; ++i) {
+            next_[i].store(NIL, std::memory_order_relaxed);
+        }
+    }
+
+    FreeFrameList(const FreeFrameList&) = delete;
+    FreeFrameList& operator=(const FreeFrameList&) = delete;
+
+    void push(size_t frame_idx) {
+        uint32_t idx = static_cast<uint32_t>(frame_idx);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        do {
+            next_[idx].store(index_of(head), std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, pack(tag_of(head) + 1, idx),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::optional<size_t> pop() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t idx = index_of(head);
+            if (idx == NIL) {
+                return std::nullopt;
+            }
+            /*
+            * next_[idx] may already be stale if another thread popped idx and pushed it
+            * back in between; the tag in head then no longer matches and the CAS retries.
+            */
+            uint32_t next = next_[idx].load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, pack(tag_of(head) + 1, next),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                size_.fetch_sub(1, std::memory_order_relaxed);
+                return idx;
+            }
+        }
+    }
+
+    // Approximate under concurrent push/pop; exact once the list is quiescent.
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return capacity_; }
+};
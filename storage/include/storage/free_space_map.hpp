@@ -0,0 +1,42 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "storage/buffer_pool.hpp"
+
+/**
+ * Free space of the data pages of one heap file, kept in pages of its own file and
+ * accessed through the buffer pool. Each data page gets one byte: its free bytes
+ * divided by BUCKET, so 0 means (nearly) full or never recorded.
+ *
+ *   page 0:      root, [lsn u64] then the largest bucket found in each leaf
+ *   pages 1..:   leaves, [lsn u64] then one bucket per data page, ENTRIES per leaf
+ *
+ * find() reads the root, then only the leaves it says may have room. update() takes
+ * a leaf's read latch to skip unchanged entries and write-latches it (and then the
+ * root) only on a change. The map is a hint: callers verify the space under the data
+ * page's latch and record what they found.
+ */
+class FreeSpaceMap {
+public:
+    static constexpr size_t ENTRIES = PAGE_SIZE - PAGE_LSN_SIZE;
+    static constexpr size_t BUCKET = PAGE_SIZE / 256;
+
+    FreeSpaceMap(std::string file_name, BufferPoolManager& bpm);
+
+    const std::string& file_name() const { return file_name_; }
+
+    // Records that data page `page_id` has `free_bytes` free.
+    void update(uint64_t page_id, size_t free_bytes);
+    // A data page among 1..page_count recorded with at least `need` bytes free,
+    // searching upwards from `from` and wrapping around; nullopt if there is none.
+    std::optional<uint64_t> find(size_t need, uint64_t from, uint64_t page_count);
+
+    static uint8_t bucket(size_t free_bytes) { return static_cast<uint8_t>(std::min<size_t>(free_bytes / BUCKET, 255)); }
+
+private:
+    std::string file_name_;
+    BufferPoolManager& bpm_;
+};
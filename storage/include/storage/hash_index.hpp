@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "storage/buffer_pool.hpp"
+#include "storage/index_entry.hpp"
+
+/**
+ * Disk-resident extendible hash index from 64-bit integer keys to RIDs, for equality
+ * lookups: a probe reads the header, one directory page and then the key's bucket
+ * page. Page 0 is the header, which lists the directory pages; every other page is a
+ * directory page or a bucket:
+ *
+ *   header:    [lsn u64][magic u32][global_depth u32][page_count u64]
+ *              directory page count x [directory page u64]
+ *   directory: [lsn u64] DIRECTORY_PAGE_SLOTS x [bucket page u64]
+ *   bucket:    [lsn u64][local_depth u16][count u16][reserved u32][overflow u64]
+ *              count x [key i64][rid page u64][rid slot u16]
+ *
+ * Directory slot i, on directory page i / DIRECTORY_PAGE_SLOTS, serves keys whose hash
+ * has low bits i. A full bucket splits on the next hash bit, doubling the directory
+ * first if its local depth equals the global depth. Only the bucket's overflow chain
+ * grows instead when every entry in it has the new entry's key, since no split could
+ * separate them, or when the directory is at MAX_GLOBAL_DEPTH.
+ *
+ * Lookups and inserts read-latch the header only long enough to latch the bucket; the
+ * directory pages are only read under the header latch. An insert that finds its
+ * bucket full restarts holding the header write latch, which is the only place pages
+ * are allocated or the directory changes. Removal never merges buckets.
+ */
+class HashIndex {
+public:
+    static constexpr size_t BUCKET_HEADER_SIZE = 24;
+    static constexpr size_t BUCKET_CAPACITY = (PAGE_SIZE - BUCKET_HEADER_SIZE) / IndexEntry::ENCODED_SIZE;
+    static constexpr size_t DIRECTORY_PAGE_SLOTS = (PAGE_SIZE - PAGE_LSN_SIZE) / 8;
+    // The largest directory whose pages the header can list.
+    static constexpr uint32_t MAX_GLOBAL_DEPTH = 19;
+
+    explicit HashIndex(std::string file_name, BufferPoolManager& bpm = BufferPoolManager::get_instance());
+
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+
+    // Adds (key, rid); false if that exact entry is already present.
+    bool insert(int64_t key, RID rid);
+    // Removes (key, rid); false if it is not present.
+    bool remove(int64_t key, RID rid);
+    // RIDs of every entry with `key`, in no particular order.
+    std::vector<RID> find(int64_t key);
+
+    const std::string& file_name() const { return file_name_; }
+    uint32_t global_depth();
+
+private:
+    static constexpr uint32_t MAGIC = 0x49484453;   // "SDHI"
+    static constexpr size_t MAGIC_OFFSET = PAGE_LSN_SIZE;
+    static constexpr size_t DEPTH_OFFSET = PAGE_LSN_SIZE + 4;
+    static constexpr size_t PAGE_COUNT_OFFSET = PAGE_LSN_SIZE + 8;
+    static constexpr size_t DIRECTORY_OFFSET = PAGE_LSN_SIZE + 16;
+
+    std::string file_name_;
+    BufferPoolManager& bpm_;
+
+    static_assert((size_t(1) << MAX_GLOBAL_DEPTH) <=
+                  DIRECTORY_PAGE_SLOTS * ((PAGE_SIZE - DIRECTORY_OFFSET) / 8));
+
+    // Directory lookups and updates, called with the header latched.
+    uint64_t bucket_of(const uint8_t* header, size_t slot);
+    void set_bucket(const uint8_t* header, size_t slot, uint64_t bucket_id);
+    void double_directory(WritePageHandle& header);
+    uint64_t allocate(WritePageHandle& header);
+    // Rewrites the write-latched chain `pages` (head first) to hold exactly `entries`.
+    void refill(std::vector<WritePageHandle>& pages, const std::vector<IndexEntry>& entries,
+                uint16_t local_depth, WritePageHandle& header);
+
+    enum class InsertResult { Inserted, Duplicate, Full };
+    // Inserts into the bucket chain starting at the write-latched `head`, latching the
+    // overflow pages in chain order.
+    InsertResult insert_into_chain(WritePageHandle& head, const IndexEntry& e);
+    bool insert_with_split(const IndexEntry& e);
+};
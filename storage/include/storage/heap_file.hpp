@@ -0,0 +1,203 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "storage/bloom_filter.hpp"
+#include "storage/buffer_pool.hpp"
+#include "storage/free_space_map.hpp"
+#include "storage/pax_page.hpp"
+#include "storage/slotted_page.hpp"
+#include "storage/tuple.hpp"
+#include "storage/zone_map.hpp"
+
+
+struct RID {
+    uint64_t page_id;
+    uint16_t slot;
+
+    bool operator==(const RID& other) const { return page_id == other.page_id && slot == other.slot; }
+    bool operator!=(const RID& other) const { return !(*this == other); }
+    bool operator<(const RID& other) const {
+        return page_id != other.page_id ? page_id < other.page_id : slot < other.slot;
+    }
+};
+
+
+/**
+ * Unordered collection of records stored in the data pages of one file, accessed
+ * through the buffer pool. Page 0 is a header holding the page layout and the number
+ * of data pages; data pages are 1..page_count(). A record is addressed by its RID
+ * (page, slot), so a lookup is one page fetch.
+ *
+ * Data pages are slotted pages (TableLayout::Row) or PAX pages (TableLayout::Pax,
+ * where the slot is the row index). Records are passed in and out in TupleLayout
+ * encoding either way; PAX files need the schema to split them into columns.
+ *
+ * Every write records the page's remaining free space in a FreeSpaceMap kept in
+ * `<file>.fsm`. Each inserting thread is given one of INSERT_TARGETS slots holding the
+ * page it last inserted into; when that page is full it asks the map for another,
+ * searching from its slot's share of the file and passing over pages other slots are
+ * filling, and appends a page of its own if none has room. Concurrent inserters thus
+ * fill different pages, and space freed anywhere is reused. Bulk loads fill whole
+ * pages privately and append them with append_pages.
+ *
+ * A file opened with its schema also keeps a ZoneMap in `<file>.zm` and a BloomFilterMap
+ * in `<file>.bf`, both added to by every insert and update while the data page is still
+ * latched. The header records which of them are current: opening the file without its
+ * schema clears that, and the next open with the schema rebuilds the stale ones from
+ * the data pages.
+ */
+class HeapFile {
+public:
+    static constexpr size_t INSERT_TARGETS = 16;
+
+    // Opens or creates a file of slotted pages.
+    explicit HeapFile(std::string file_name, BufferPoolManager& bpm = BufferPoolManager::get_instance());
+    // Opens or creates a file with the given page layout and keeps its zone map; throws
+    // std::runtime_error if an existing file was created with a different layout.
+    HeapFile(std::string file_name, TableLayout layout, const TupleLayout& schema,
+             BufferPoolManager& bpm = BufferPoolManager::get_instance());
+
+    HeapFile(const HeapFile&) = delete;
+    HeapFile& operator=(const HeapFile&) = delete;
+
+    const std::string& file_name() const { return file_name_; }
+    uint64_t page_count() const { return page_count_.load(std::memory_order_acquire); }
+    TableLayout layout() const { return pax_ ? TableLayout::Pax : TableLayout::Row; }
+    // Geometry of the data pages of a PAX file, nullptr for slotted pages.
+    const PaxGeometry* pax() const { return pax_ ? &*pax_ : nullptr; }
+    FreeSpaceMap& free_space_map() { return fsm_; }
+    // nullptr if the file was opened without its schema, or it has too many columns.
+    ZoneMap* zone_map() { return zones_ ? &*zones_ : nullptr; }
+    // nullptr if the file was opened without its schema, or it has too many columns.
+    BloomFilterMap* bloom_filters() { return blooms_ ? &*blooms_ : nullptr; }
+
+    RID insert(const uint8_t* tuple, size_t size);
+    RID insert(const std::vector<uint8_t>& tuple) { return insert(tuple.data(), tuple.size()); }
+    // Like insert, calling latched(rid) while the new record's page is still
+    // write-latched, so no reader sees the record before latched has run.
+    RID insert(const uint8_t* tuple, size_t size, const std::function<void(RID)>& latched);
+    // Inserts records in order, latching each page once for all records it receives.
+    std::vector<RID> insert_batch(const std::vector<std::vector<uint8_t>>& tuples);
+
+    // Formats `page` (PAGE_SIZE bytes outside the buffer pool) as an empty data page.
+    void init_page(uint8_t* page) const;
+    // Adds a record to a data page held outside the buffer pool, e.g. one being filled
+    // for append_pages; nullopt if it does not fit.
+    std::optional<uint16_t> insert_into(uint8_t* page, const uint8_t* tuple, size_t size) const;
+    // Appends `count` data pages prepared with init_page and insert_into, stored back to
+    // back in `pages`. They are written straight to disk with one sequential write
+    // instead of through the buffer pool, then published in the header. Returns the
+    // page id of the first.
+    uint64_t append_pages(const uint8_t* pages, size_t count);
+
+    bool get(RID rid, std::vector<uint8_t>& out);
+    bool remove(RID rid);
+    // Updates in place when the page has room (compacting it if needed); otherwise the
+    // record moves to another page, inserted there before it is removed here. Returns
+    // the record's current RID, or nullopt if `rid` does not name a live record.
+    std::optional<RID> update(RID rid, const uint8_t* tuple, size_t size);
+
+    // Calls fn(RID, TupleRef) for every live record of one data page, under its read latch.
+    template<typename Fn>
+    void scan_page(uint64_t page_id, Fn&& fn) {
+        scan_page_from(page_id, 0, [&](RID rid, TupleRef t) { fn(rid, t); return true; });
+    }
+
+    // Like scan_page, starting at slot `from`; fn returns false to stop after the current
+    // record. Returns the slot to resume from, or the page's slot count once it has been
+    // read to the end. PAX rows are reassembled into a scratch buffer for fn.
+    template<typename Fn>
+    uint16_t scan_page_from(uint64_t page_id, uint16_t from, Fn&& fn) {
+        auto page = bpm_.fetch_page_read(file_name_, page_id);
+        return scan_records(page_id, page->data(), from, fn);
+    }
+
+    // The record loop of scan_page_from over data page `page_id` already latched by
+    // the caller, e.g. through read_page.
+    template<typename Fn>
+    uint16_t scan_records(uint64_t page_id, const uint8_t* page, uint16_t from, Fn&& fn) const {
+        uint8_t* data = const_cast<uint8_t*>(page);
+        if (pax_) {
+            PaxPage pp(data, *pax_);
+            std::vector<uint8_t> row;
+            uint16_t n = pp.row_count();
+            for (uint16_t s = from; s < n; ++s) {
+                if (pp.get(s, row)) {
+                    if (!fn(RID{page_id, s}, TupleRef{row.data(), static_cast<uint16_t>(row.size())})) return s + 1;
+                }
+            }
+            return n;
+        }
+        SlottedPage sp(data);
+        uint16_t n = sp.slot_count();
+        for (uint16_t s = from; s < n; ++s) {
+            if (auto t = sp.get(s)) {
+                if (!fn(RID{page_id, s}, *t)) return s + 1;
+            }
+        }
+        return n;
+    }
+
+    // Calls fn(const uint8_t* page) with a data page read-latched, for readers that
+    // understand the page format (e.g. columnar scans of PAX pages).
+    template<typename Fn>
+    void read_page(uint64_t page_id, Fn&& fn) {
+        auto page = bpm_.fetch_page_read(file_name_, page_id);
+        fn(static_cast<const uint8_t*>(page->data()));
+    }
+
+    template<typename Fn>
+    void scan(Fn&& fn) {
+        uint64_t n = page_count();
+        for (uint64_t p = 1; p <= n; ++p) {
+            scan_page(p, fn);
+        }
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x48424453;   // "SDBH"
+    static constexpr size_t MAGIC_OFFSET = PAGE_LSN_SIZE;
+    static constexpr size_t LAYOUT_OFFSET = PAGE_LSN_SIZE + 4;
+    static constexpr size_t SYNOPSES_OFFSET = PAGE_LSN_SIZE + 5;  // which synopses are current
+    static constexpr uint8_t ZONES_CURRENT = 1;
+    static constexpr uint8_t BLOOMS_CURRENT = 2;
+    static constexpr size_t PAGE_COUNT_OFFSET = PAGE_LSN_SIZE + 8;
+
+    std::string file_name_;
+    BufferPoolManager& bpm_;
+    std::atomic<uint64_t> page_count_{0};
+    std::mutex extend_mutex_;
+    std::optional<PaxGeometry> pax_;
+    FreeSpaceMap fsm_;
+    std::optional<ZoneMap> zones_;
+    std::optional<BloomFilterMap> blooms_;
+    std::array<std::atomic<uint64_t>, INSERT_TARGETS> targets_{};  // per inserter slot, 0 if none yet
+
+    void open(TableLayout layout);
+    // SYNOPSES_OFFSET flags of the synopses this HeapFile keeps.
+    uint8_t synopses() const;
+    // Adds every record of the data pages to the synopses flagged in `stale`.
+    void rebuild_synopses(uint8_t stale);
+    // Adds the records of data page `page_id`, whose contents are `page`, to the synopses.
+    void summarize(uint64_t page_id, const uint8_t* page, uint8_t which);
+    void check_size(size_t size) const;
+    // Free bytes of a data page as the free-space map counts them, and what a record
+    // of `size` bytes needs of them.
+    size_t free_bytes(const uint8_t* page) const;
+    size_t space_needed(size_t size) const;
+    // A page the free-space map says has `need` bytes free and no other inserter slot
+    // is filling, 0 if there is none.
+    uint64_t find_page(size_t need, size_t slot);
+    // Inserts into the write-latched `page` and records its free space; on success the
+    // page becomes `target`. nullopt if the record does not fit.
+    std::optional<RID> insert_on(WritePageHandle page, const uint8_t* tuple, size_t size,
+                                 const std::function<void(RID)>& latched, std::atomic<uint64_t>& target);
+    // Appends an empty data page and returns it write-latched.
+    WritePageHandle append_page();
+};
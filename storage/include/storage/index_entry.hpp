@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "storage/heap_file.hpp"
+
+// One index entry: a key and the record holding it. Entries are ordered by (key, rid),
+// so a key may appear many times while every entry stays unique.
+struct IndexEntry {
+    int64_t key;
+    RID rid;
+
+    // On-page encoding: [key i64][rid page u64][rid slot u16].
+    static constexpr size_t ENCODED_SIZE = 18;
+
+    bool operator==(const IndexEntry& other) const { return key == other.key && rid == other.rid; }
+    bool operator!=(const IndexEntry& other) const { return !(*this == other); }
+    bool operator<(const IndexEntry& other) const {
+        return key != other.key ? key < other.key : rid < other.rid;
+    }
+
+    void write(uint8_t* p) const {
+        std::memcpy(p, &key, 8);
+        std::memcpy(p + 8, &rid.page_id, 8);
+        std::memcpy(p + 16, &rid.slot, 2);
+    }
+
+    static IndexEntry read(const uint8_t* p) {
+        IndexEntry e;
+        std::memcpy(&e.key, p, 8);
+        std::memcpy(&e.rid.page_id, p + 8, 8);
+        std::memcpy(&e.rid.slot, p + 16, 2);
+        return e;
+    }
+};
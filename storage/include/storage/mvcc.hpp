@@ -0,0 +1,234 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "storage/heap_file.hpp"
+#include "storage/wal.hpp"
+
+// Commit timestamps count up from 1. A version stamped with a transaction id (TXN_BIT
+// set) belongs to a transaction that has not committed yet.
+using Timestamp = uint64_t;
+
+// Thrown when a transaction writes a record that a concurrent transaction has written
+// since its snapshot (first updater wins); the transaction should be aborted.
+struct WriteConflict : public std::runtime_error {
+    WriteConflict(std::string msg) : std::runtime_error(std::move(msg)) {}
+};
+
+// One write in a record's version chain, newest first.
+struct Version {
+    enum Kind : uint8_t { Insert, Delete };
+
+    Kind kind;
+    std::atomic<Timestamp> ts;      // writer's transaction id, then its commit timestamp
+    std::vector<uint8_t> before;    // Delete: the record it removed; Insert: unused
+    std::shared_ptr<Version> next;  // the write before this one
+};
+
+class MvccHeap;
+class TransactionManager;
+
+/**
+ * A snapshot-isolation transaction. It sees every version committed at or before its
+ * start timestamp plus its own writes. Destroying a transaction that is still active
+ * aborts it.
+ */
+class Transaction {
+public:
+    static constexpr Timestamp TXN_BIT = Timestamp(1) << 63;
+
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    Timestamp id() const { return id_; }
+    Timestamp start_ts() const { return start_ts_; }
+    bool active() const { return active_; }
+
+    bool sees(Timestamp ts) const { return ts == id_ || (!(ts & TXN_BIT) && ts <= start_ts_); }
+
+private:
+    friend class TransactionManager;
+    friend class MvccHeap;
+
+    struct Write {
+        MvccHeap* heap;
+        RID rid;
+        std::shared_ptr<Version> version;
+    };
+
+    Transaction(TransactionManager& manager, Timestamp id, Timestamp start_ts)
+        : manager_(manager), id_(id), start_ts_(start_ts) {}
+
+    TransactionManager& manager_;
+    Timestamp id_;
+    Timestamp start_ts_;
+    bool active_ = true;
+    std::vector<Write> writes_;
+};
+
+/**
+ * Hands out snapshots and commit timestamps. Commits are ordered by one mutex: the
+ * committer's versions are stamped with the next timestamp before it becomes the
+ * last committed one, so a snapshot taken afterwards sees all of them and one taken
+ * before sees none.
+ *
+ * Garbage collection drops, from every registered MvccHeap, the versions no active or
+ * future snapshot can need: those older than a version committed at or before the
+ * oldest active start timestamp. Records whose delete every snapshot sees are removed
+ * from the heap then. It runs on demand or in a background thread.
+ *
+ * With a log, every MvccHeap insert logs a TxnInsert record ahead of the page change,
+ * and commit() logs a TxnDelete record per delete followed by a commit record, and
+ * waits for them to be durable before the transaction's writes become visible. An
+ * abort logs an Abort record once its writes are undone. Version chains live only in
+ * memory, so after a restart recover() makes the heaps match the committed state:
+ * inserts of transactions that neither committed nor aborted are removed, and so are
+ * records deleted by committed transactions that garbage collection had not removed.
+ */
+class TransactionManager {
+public:
+    explicit TransactionManager(LogManager* log = nullptr);
+    // Stops the background collector, if any.
+    ~TransactionManager();
+
+    TransactionManager(const TransactionManager&) = delete;
+    TransactionManager& operator=(const TransactionManager&) = delete;
+
+    // Undo pass over the whole log, for a restart after LogManager::recover() has redone
+    // the page changes and before the first begin(). An MvccHeap must be open on this
+    // manager for every file the log's transactions wrote. Logs an Abort for each
+    // transaction it rolls back and returns the number of records removed.
+    size_t recover();
+
+    std::unique_ptr<Transaction> begin();
+    void commit(Transaction& txn);
+    // Undoes the transaction's writes in reverse order.
+    void abort(Transaction& txn);
+
+    Timestamp last_committed() const { return last_committed_.load(std::memory_order_acquire); }
+    // Oldest start timestamp in use; every transaction, present or future, sees the
+    // versions committed at or before it.
+    Timestamp horizon();
+
+    // Returns the number of versions dropped.
+    size_t collect_garbage();
+    // Collects garbage every `interval` in a background thread until stop_gc().
+    void start_gc(std::chrono::milliseconds interval);
+    void stop_gc();
+
+private:
+    friend class MvccHeap;
+
+    LogManager* log_;
+    std::atomic<Timestamp> next_id_{0};
+    std::atomic<Timestamp> last_committed_{0};
+    std::mutex mutex_;                  // guards active_ and orders commits
+    std::multiset<Timestamp> active_;   // start timestamps of active transactions
+
+    std::mutex heaps_mutex_;
+    std::vector<MvccHeap*> heaps_;
+
+    std::thread gc_thread_;
+    std::mutex gc_mutex_;               // guards gc_stop_ for the background thread's waits
+    std::condition_variable gc_wake_;
+    bool gc_stop_ = false;
+
+    void finish(Transaction& txn);
+};
+
+/**
+ * Multi-version access to a HeapFile. The heap holds the newest version of every
+ * record in place; older versions live in memory, in a chain of Version entries per
+ * RID that readers walk back until they reach a write their snapshot sees:
+ *
+ *   - an insert adds the record to the heap and pushes an Insert entry, both under the
+ *     page's write latch, so no reader sees the record without its entry;
+ *   - a delete pushes a Delete entry holding a copy of the record; the record stays
+ *     in the heap until garbage collection finds the delete visible to everyone, so
+ *     its slot (and RID) is not reused while some snapshot may still see it there;
+ *   - an update is a delete of the old record plus an insert of the new one, so the
+ *     record gets a new RID (as HeapFile::update may give it anyway).
+ *
+ * Chains are kept per page in SHARDS hash maps, each behind a shared_mutex taken after
+ * the page latch. Readers hold a page's read latch only while they copy out its visible
+ * records, never while the caller processes them, and writers never wait for readers
+ * beyond that. A write to a record whose newest version the writer's snapshot does not
+ * see throws WriteConflict.
+ *
+ * Plain HeapFile accesses bypass all of this and see the newest versions, committed
+ * or not.
+ */
+class MvccHeap {
+public:
+    MvccHeap(HeapFile& heap, TransactionManager& txns);
+    ~MvccHeap();
+
+    MvccHeap(const MvccHeap&) = delete;
+    MvccHeap& operator=(const MvccHeap&) = delete;
+
+    HeapFile& heap() { return heap_; }
+
+    RID insert(Transaction& txn, const uint8_t* tuple, size_t size);
+    RID insert(Transaction& txn, const std::vector<uint8_t>& tuple) { return insert(txn, tuple.data(), tuple.size()); }
+    // The version of `rid` txn sees; false if it sees none.
+    bool get(const Transaction& txn, RID rid, std::vector<uint8_t>& out);
+    // False if txn sees no record at `rid`.
+    bool remove(Transaction& txn, RID rid);
+    // Returns the new version's RID, or nullopt if txn sees no record at `rid`.
+    std::optional<RID> update(Transaction& txn, RID rid, const uint8_t* tuple, size_t size);
+    std::optional<RID> update(Transaction& txn, RID rid, const std::vector<uint8_t>& tuple) {
+        return update(txn, rid, tuple.data(), tuple.size());
+    }
+
+    // Calls fn(RID, TupleRef) for every record of one data page that txn sees, in slot
+    // order, after the page's latch has been released.
+    void scan_page(const Transaction& txn, uint64_t page_id, const std::function<void(RID, TupleRef)>& fn);
+
+    template<typename Fn>
+    void scan(const Transaction& txn, Fn&& fn) {
+        uint64_t n = heap_.page_count();
+        for (uint64_t p = 1; p <= n; ++p) {
+            scan_page(txn, p, fn);
+        }
+    }
+
+    // Versions currently kept in memory, for observing garbage collection.
+    size_t version_count();
+
+private:
+    friend class TransactionManager;
+
+    static constexpr size_t SHARDS = 16;
+
+    using Chains = std::unordered_map<uint16_t, std::shared_ptr<Version>>;    // slot -> newest write
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<uint64_t, Chains> pages;
+    };
+
+    HeapFile& heap_;
+    TransactionManager& txns_;
+    std::array<Shard, SHARDS> shards_;
+
+    Shard& shard(uint64_t page_id) { return shards_[page_id % SHARDS]; }
+    // Undoes one write of an aborting transaction.
+    void rollback(const Transaction::Write& write);
+    // Drops versions committed at or before `horizon` and everything older.
+    size_t collect_garbage(Timestamp horizon);
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "storage/slotted_page.hpp"
+#include "storage/tuple.hpp"
+
+/**
+ * Geometry of PAX pages for one schema. A PAX page keeps each column's values together
+ * in a "minipage", so a scan that reads two columns touches only their bytes and can
+ * copy them into column vectors wholesale:
+ *
+ *   [lsn u64][row_count u16][text_start u16][live_count u16][reserved u16]
+ *   [deleted bitmap]
+ *   per column: [null bitmap][values: capacity x width, 8-byte aligned]
+ *   ...free...                          <- TEXT bytes, growing down from the page end
+ *
+ * Field widths match TupleLayout (TEXT stores a u16 offset + u16 length into the text
+ * region). Capacity is fixed per schema and reserves TEXT_BUDGET bytes for each TEXT
+ * value; a page also counts as full once its text region runs out.
+ */
+class PaxGeometry {
+public:
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t TEXT_BUDGET = 24;
+    static constexpr size_t MAX_CAPACITY = 4096;
+
+    explicit PaxGeometry(TupleLayout layout);
+
+    const TupleLayout& layout() const { return layout_; }
+    uint16_t capacity() const { return capacity_; }
+    size_t deleted_offset() const { return HEADER_SIZE; }
+    size_t null_offset(size_t col) const { return null_offsets_[col]; }
+    size_t value_offset(size_t col) const { return value_offsets_[col]; }
+    // First byte past the last minipage; the text region may not grow below it.
+    size_t minipages_end() const { return minipages_end_; }
+
+private:
+    TupleLayout layout_;
+    uint16_t capacity_ = 0;
+    std::vector<size_t> null_offsets_;
+    std::vector<size_t> value_offsets_;
+    size_t minipages_end_ = 0;
+
+    size_t place(size_t capacity);
+};
+
+// View over a PAX page. Records go in and out in TupleLayout encoding. Rows are
+// appended and never moved; deleting one only sets its bit in the deleted bitmap.
+class PaxPage {
+public:
+    PaxPage(uint8_t* data, const PaxGeometry& geometry) : data_(data), geo_(geometry) {}
+
+    static void init(uint8_t* data, const PaxGeometry& geometry);
+
+    uint16_t row_count() const { return read16(8); }
+    uint16_t live_count() const { return read16(12); }
+    bool is_live(uint16_t row) const { return row < row_count() && !bit(geo_.deleted_offset(), row); }
+    // Bytes of TEXT a new row could still take, 0 once every row has been used.
+    size_t free_space() const { return row_count() < geo_.capacity() ? text_start() - geo_.minipages_end() : 0; }
+
+    std::optional<uint16_t> insert(const uint8_t* tuple, size_t size);
+    bool get(uint16_t row, std::vector<uint8_t>& out) const;
+    bool remove(uint16_t row);
+    // Rewrites a live row in place; false if its longer TEXT values do not fit.
+    bool update(uint16_t row, const uint8_t* tuple, size_t size);
+
+    bool is_null(uint16_t row, size_t col) const { return bit(geo_.null_offset(col), row); }
+    // Start of column `col`'s minipage: capacity() values of its field width.
+    const uint8_t* values(size_t col) const { return data_ + geo_.value_offset(col); }
+    // Null bitmap of column `col`, one bit per row.
+    const uint8_t* nulls(size_t col) const { return data_ + geo_.null_offset(col); }
+    std::string_view get_text(uint16_t row, size_t col) const;
+
+private:
+    uint8_t* data_;
+    const PaxGeometry& geo_;
+
+    uint16_t read16(size_t off) const { return uint16_t(data_[off] | (data_[off + 1] << 8)); }
+    void write16(size_t off, uint16_t v) { data_[off] = uint8_t(v); data_[off + 1] = uint8_t(v >> 8); }
+    uint16_t text_start() const { return read16(10); }
+
+    bool bit(size_t bitmap, uint16_t row) const { return (data_[bitmap + (row >> 3)] >> (row & 7)) & 1; }
+    void set_bit(size_t bitmap, uint16_t row, bool on) {
+        uint8_t mask = uint8_t(1u << (row & 7));
+        if (on) data_[bitmap + (row >> 3)] |= mask;
+        else data_[bitmap + (row >> 3)] &= uint8_t(~mask);
+    }
+
+    // Writes the fields of `tuple` into row `row`. TEXT values longer than the row's
+    // current ones are placed in the text region, which must have room for them.
+    void write_row(uint16_t row, const uint8_t* tuple, bool reuse_text);
+    size_t text_needed(uint16_t row, const uint8_t* tuple, bool reuse_text) const;
+};
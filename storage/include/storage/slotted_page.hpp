@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "storage/disk.hpp"
+
+struct TupleRef {
+    const uint8_t* data;
+    uint16_t size;
+};
+
+/**
+ * View over a PAGE_SIZE buffer laid out as a slotted page:
+ *
+ *   [lsn u64][slot_count u16][data_start u16][garbage u16][reserved u16]
+ *   [slot 0: offset u16, length u16][slot 1] ...   -> grows up
+ *   ...free space...
+ *   <- grows down                       [tuple n] ... [tuple 1][tuple 0]
+ *
+ * A slot with offset 0 is unused. `garbage` counts bytes of deleted or shrunk tuples
+ * inside the data area; they are reclaimed by compact(), which inserts and updates
+ * run automatically when the contiguous free space is too small.
+ */
+class SlottedPage {
+public:
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t SLOT_SIZE = 4;
+    static constexpr size_t MAX_TUPLE_SIZE = PAGE_SIZE - HEADER_SIZE - SLOT_SIZE;
+
+    explicit SlottedPage(uint8_t* data) : data_(data) {}
+    explicit SlottedPage(std::vector<uint8_t>& page) : data_(page.data()) {}
+
+    // Formats `data` as an empty slotted page (the LSN is preserved).
+    static void init(uint8_t* data);
+
+    uint16_t slot_count() const { return read16(8); }
+
+    // Bytes an insert could use after compaction, not counting a new slot entry.
+    size_t free_space() const;
+
+    std::optional<uint16_t> insert(const uint8_t* tuple, size_t size);
+    std::optional<TupleRef> get(uint16_t slot) const;
+    bool remove(uint16_t slot);
+    // Rewrites the tuple in place; false if it no longer fits on this page (the old
+    // tuple is left untouched in that case).
+    bool update(uint16_t slot, const uint8_t* tuple, size_t size);
+    void compact();
+
+private:
+    uint8_t* data_;
+
+    uint16_t read16(size_t off) const { return uint16_t(data_[off] | (data_[off + 1] << 8)); }
+    void write16(size_t off, uint16_t v) { data_[off] = uint8_t(v); data_[off + 1] = uint8_t(v >> 8); }
+
+    uint16_t data_start() const { return read16(10); }
+    uint16_t garbage() const { return read16(12); }
+    void set_slot_count(uint16_t n) { write16(8, n); }
+    void set_data_start(uint16_t v) { write16(10, v); }
+    void set_garbage(uint16_t v) { write16(12, v); }
+
+    size_t slot_pos(uint16_t slot) const { return HEADER_SIZE + size_t(slot) * SLOT_SIZE; }
+    uint16_t slot_offset(uint16_t slot) const { return read16(slot_pos(slot)); }
+    uint16_t slot_length(uint16_t slot) const { return read16(slot_pos(slot) + 2); }
+    void set_slot(uint16_t slot, uint16_t offset, uint16_t length) {
+        write16(slot_pos(slot), offset);
+        write16(slot_pos(slot) + 2, length);
+    }
+
+    size_t contiguous_free() const { return data_start() - slot_pos(slot_count()); }
+    std::optional<uint16_t> find_free_slot() const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "parser/ast.hpp"
+
+/**
+ * Record encoding derived from a table's column types:
+ *
+ *   [null bitmap: ceil(n / 8) bytes][fixed area][variable area]
+ *
+ * Every column owns a fixed-width field at an offset known from the schema alone (INT
+ * and REAL take 8 bytes, BOOL 1, TEXT a u16 offset + u16 length into the variable
+ * area), so reading one column is O(1) and never touches the others. NULL columns
+ * keep their fixed field, zeroed, and take no variable bytes. A set bitmap bit means
+ * NULL. Values are stored in host byte order.
+ */
+class TupleLayout {
+public:
+    explicit TupleLayout(std::vector<ColumnDef> columns);
+
+    const std::vector<ColumnDef>& columns() const { return columns_; }
+    size_t column_count() const { return columns_.size(); }
+    DataType::Kind type(size_t col) const { return columns_[col].data_type.kind; }
+    std::optional<size_t> column_index(std::string_view name) const;
+    size_t fixed_size() const { return fixed_size_; }
+    // Offset of column `col`'s fixed-width field within a record.
+    size_t field_offset(size_t col) const { return offsets_[col]; }
+    // Width of a column's fixed-width field (0 for Custom).
+    static size_t field_width(DataType::Kind kind);
+
+    // Appends the encoding of values[0, column_count()) to `out`. INT values are
+    // accepted for REAL columns; any other type mismatch throws std::invalid_argument.
+    void encode(const Value* values, std::vector<uint8_t>& out) const;
+    std::vector<uint8_t> encode(const std::vector<Value>& values) const;
+    // Replaces `out` with the decoded columns of one record.
+    void decode(const uint8_t* data, std::vector<Value>& out) const;
+
+    bool is_null(const uint8_t* data, size_t col) const { return (data[col >> 3] >> (col & 7)) & 1; }
+    long long get_int(const uint8_t* data, size_t col) const { return load<long long>(data + offsets_[col]); }
+    double get_real(const uint8_t* data, size_t col) const { return load<double>(data + offsets_[col]); }
+    bool get_bool(const uint8_t* data, size_t col) const { return data[offsets_[col]] != 0; }
+    std::string_view get_text(const uint8_t* data, size_t col) const {
+        const uint8_t* field = data + offsets_[col];
+        return std::string_view(reinterpret_cast<const char*>(data) + load<uint16_t>(field),
+                                load<uint16_t>(field + 2));
+    }
+
+private:
+    std::vector<ColumnDef> columns_;
+    std::vector<uint16_t> offsets_;
+    size_t fixed_size_;
+
+    template<typename T>
+    static T load(const uint8_t* p) { T v; std::memcpy(&v, p, sizeof(T)); return v; }
+};
+
+// Row accessor over an encoded record, usable wherever the executor expects a row
+// (is_null/get_int/get_real/get_text/get_bool by column ordinal).
+struct TupleView {
+    const TupleLayout* layout;
+    const uint8_t* data;
+
+    bool is_null(size_t col) const { return layout->is_null(data, col); }
+    long long get_int(size_t col) const { return layout->get_int(data, col); }
+    double get_real(size_t col) const { return layout->get_real(data, col); }
+    std::string_view get_text(size_t col) const { return layout->get_text(data, col); }
+    bool get_bool(size_t col) const { return layout->get_bool(data, col); }
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include "storage/disk.hpp"
+
+// Log sequence number: the byte offset in the log just past a record's end, so every
+// record has an LSN > 0 and a page LSN of 0 means no logged change was applied.
+using Lsn = uint64_t;
+
+enum class LogRecordType : uint32_t {
+    PageDiff = 1,   // redo image of the bytes a write latch changed on one page
+    Commit = 2,     // payload: the transaction id for an MvccHeap transaction, else empty
+    CheckpointBegin = 3,
+    CheckpointEnd = 4,  // payload: the LSN of the matching CheckpointBegin
+    TxnInsert = 5,  // payload: [txn id u64][page id u64][slot u16][file name length u16][file name]
+    TxnDelete = 6,  // payload: as TxnInsert
+    Abort = 7,      // payload: the transaction id
+};
+
+/**
+ * Sequential write-ahead log. Records are
+ *
+ *   [length u32][checksum u32][type u32][payload]
+ *
+ * where length covers the whole record and the checksum (FNV-1a over type and payload)
+ * lets the reader stop at a torn tail. A PageDiff payload is
+ *
+ *   [file name length u16][file name][page id u64][run count u16]
+ *   run count x [offset u16][length u16][bytes]
+ *
+ * Appends go through an in-memory ring buffer without a global lock: a writer reserves
+ * its byte range with one fetch_add on the end LSN, copies its record in parallel with
+ * other writers, and then publishes it once every earlier record has been published,
+ * so the published prefix is always whole records. A writer whose range would overrun
+ * data not yet written to the file writes the published prefix out itself first.
+ *
+ * flush(lsn) is group commit: the first caller becomes the leader, writes everything
+ * published so far and fsyncs once; callers that queued behind it on flush_mutex_ find
+ * their records already durable and return without another fsync.
+ */
+class LogManager {
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = size_t(1) << 20;
+    static constexpr size_t HEADER_SIZE = 12;
+
+    // Opens or creates the log, dropping any torn or corrupt tail so new records follow
+    // the last valid one. buffer_size must hold the largest record (a full-page diff).
+    explicit LogManager(std::string file_name, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    // Makes everything appended durable.
+    ~LogManager();
+
+    LogManager(const LogManager&) = delete;
+    LogManager& operator=(const LogManager&) = delete;
+
+    Lsn append(LogRecordType type, const uint8_t* payload, size_t size);
+    // Logs the bytes that differ between two images of page `page_id` of `file_name`,
+    // ignoring the page LSN; nullopt (and nothing logged) if they are equal.
+    std::optional<Lsn> log_page_diff(const std::string& file_name, uint64_t page_id,
+                                     const uint8_t* before, const uint8_t* after);
+    // Appends a commit record and returns once it is durable.
+    Lsn commit();
+    // Returns once every record with LSN <= lsn is on stable storage.
+    void flush(Lsn lsn);
+
+    const std::string& file_name() const { return file_name_; }
+    Lsn end_lsn() const { return next_lsn_.load(std::memory_order_acquire); }
+    Lsn durable_lsn() const { return durable_lsn_.load(std::memory_order_acquire); }
+    // Number of fsyncs issued, for observing group commit.
+    uint64_t sync_count() const { return sync_count_.load(); }
+
+    // Calls fn(lsn, type, payload, size) for each durable record ending after `from`,
+    // in log order.
+    void scan(Lsn from, const std::function<void(Lsn, LogRecordType, const uint8_t*, size_t)>& fn);
+
+    // Redo pass: reapplies every PageDiff after `from` to its page on disk unless the
+    // page LSN shows it is already there. Must run before the files it touches are opened
+    // through a buffer pool. Returns the number of records applied.
+    size_t recover(Lsn from);
+    // Redo pass from the begin LSN of the last completed checkpoint.
+    size_t recover() { return recover(last_checkpoint()); }
+
+    // Logs the end of a checkpoint that began at `begin` and, once that is durable,
+    // records `begin` in the master file as the new redo starting point.
+    void complete_checkpoint(Lsn begin);
+    // Begin LSN of the last completed checkpoint, 0 if there is none.
+    Lsn last_checkpoint() const;
+
+private:
+    std::string file_name_;
+    std::string master_file_;           // <log>.master: begin LSN of the last checkpoint
+    int fd_ = -1;
+    size_t capacity_;
+    std::unique_ptr<uint8_t[]> ring_;
+
+    std::atomic<Lsn> next_lsn_{0};      // end of the last reserved record
+    std::atomic<Lsn> published_{0};     // end of the last record copied into the ring, in order
+    std::atomic<Lsn> written_{0};       // end of what has been written to the file
+    std::atomic<Lsn> durable_lsn_{0};   // end of what has been fsynced
+    std::atomic<uint64_t> sync_count_{0};
+    std::mutex flush_mutex_;            // held by whoever writes the ring out
+
+    // Writes the published prefix to the file; with flush_mutex_ held.
+    void write_published();
+    void copy_into_ring(Lsn at, const uint8_t* data, size_t size);
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "storage/buffer_pool.hpp"
+#include "storage/tuple.hpp"
+
+/**
+ * Per-page synopses of the columns of one heap file, kept in pages of its own file and
+ * accessed through the buffer pool. For every data page and column there is a Zone: the
+ * smallest and largest non-NULL value added (INT, REAL and BOOL columns) and whether
+ * any NULL or non-NULL value was added at all.
+ *
+ *   page p:   [lsn u64] then one zone per column for each of data pages p * N + 1 .. (p + 1) * N
+ *
+ * where N is as many data pages as fit.
+ *
+ * Zones only ever widen. Removing or overwriting a record leaves them as they are, so
+ * they always bound the page's live records, and a scan can skip a page whose zone
+ * rules out a predicate. merge() takes the map page's write latch only when a zone
+ * actually widens, which most inserts into a page with similar values do not.
+ */
+class ZoneMap {
+public:
+    struct Zone {
+        int64_t min;            // INT or BOOL value, or the bits of a REAL one; valid if has_values
+        int64_t max;
+        uint8_t has_nulls;
+        uint8_t has_values;
+        uint8_t unused[6];
+
+        double min_real() const { double v; std::memcpy(&v, &min, sizeof(v)); return v; }
+        double max_real() const { double v; std::memcpy(&v, &max, sizeof(v)); return v; }
+    };
+    static_assert(sizeof(Zone) == 24, "zones are stored as they are laid out in memory");
+
+    // Most columns a schema can have for one data page's zones to fit in a map page.
+    static constexpr size_t MAX_COLUMNS = (PAGE_SIZE - PAGE_LSN_SIZE) / sizeof(Zone);
+
+    // Throws std::invalid_argument if `schema` has more than MAX_COLUMNS columns.
+    ZoneMap(std::string file_name, const TupleLayout& schema, BufferPoolManager& bpm);
+
+    const std::string& file_name() const { return file_name_; }
+    size_t column_count() const { return schema_.column_count(); }
+
+    // Zones covering nothing yet, one per column, for widen() and merge().
+    std::vector<Zone> empty() const { return std::vector<Zone>(column_count(), Zone{}); }
+    // Widens `zones` to cover one record in the schema's encoding.
+    void widen(Zone* zones, const uint8_t* tuple) const;
+    // Widens the stored zones of data page `page_id` to cover `zones`.
+    void merge(uint64_t page_id, const Zone* zones);
+    // Widens the stored zones of data page `page_id` to cover one record.
+    void add(uint64_t page_id, const uint8_t* tuple);
+
+    // Copies the zones of data page `page_id` into `out`, one per column.
+    void read(uint64_t page_id, std::vector<Zone>& out);
+
+private:
+    std::string file_name_;
+    TupleLayout schema_;
+    BufferPoolManager& bpm_;
+    size_t per_page_;       // data pages whose zones one map page holds
+
+    // Widens `into` by `from`; true if it changed.
+    bool widen(Zone& into, const Zone& from, DataType::Kind type) const;
+};
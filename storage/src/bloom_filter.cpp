@@ -0,0 +1,104 @@
+#include "storage/bloom_filter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+}
+
+
+BloomFilterMap::BloomFilterMap(std::string file_name, const TupleLayout& schema, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), schema_(schema), bpm_(bpm) {
+    if (schema_.column_count() > MAX_COLUMNS) {
+        throw std::invalid_argument("Bloom filters for '" + file_name_ + "' cannot hold " +
+                                    std::to_string(schema_.column_count()) + " columns");
+    }
+    for (size_t c = 0; c < schema_.column_count(); ++c) {
+        DataType::Kind type = schema_.type(c);
+        bool filtered = type == DataType::Int || type == DataType::Real || type == DataType::Text;
+        filter_of_.push_back(filtered ? static_cast<int>(filters_++) : -1);
+    }
+    blocks_ = (PAGE_SIZE - PAGE_LSN_SIZE) / (std::max<size_t>(filters_, 1) * BLOCK_BYTES);
+}
+
+uint64_t BloomFilterMap::hash_int(long long v) {
+    return mix(static_cast<uint64_t>(v));
+}
+
+uint64_t BloomFilterMap::hash_real(double v) {
+    if (v == 0.0) v = 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return mix(bits ^ 0x9e3779b97f4a7c15ULL);
+}
+
+uint64_t BloomFilterMap::hash_text(std::string_view v) {
+    // FNV-1a, so filters written by one build are read the same way by another.
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (char c : v) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 0x100000001b3ULL;
+    }
+    return mix(h);
+}
+
+void BloomFilterMap::keys(const uint8_t* tuple, std::vector<Key>& out) const {
+    for (size_t c = 0; c < schema_.column_count(); ++c) {
+        if (filter_of_[c] < 0 || schema_.is_null(tuple, c)) continue;
+        uint64_t h = 0;
+        switch (schema_.type(c)) {
+            case DataType::Int: h = hash_int(schema_.get_int(tuple, c)); break;
+            case DataType::Real: h = hash_real(schema_.get_real(tuple, c)); break;
+            case DataType::Text: h = hash_text(schema_.get_text(tuple, c)); break;
+            case DataType::Bool:
+            case DataType::Custom: break;
+        }
+        out.push_back(Key{static_cast<uint32_t>(filter_of_[c]), h});
+    }
+}
+
+bool BloomFilterMap::set_bits(uint8_t* filters, const std::vector<Key>& keys, bool dry_run) const {
+    bool changed = false;
+    for (const Key& key : keys) {
+        uint8_t* block = filters + (key.filter * blocks_ + block_of(key.hash, blocks_)) * BLOCK_BYTES;
+        auto x = static_cast<uint32_t>(key.hash);
+        for (size_t i = 0; i < BLOCK_WORDS; ++i) {
+            uint32_t word;
+            std::memcpy(&word, block + i * sizeof(word), sizeof(word));
+            uint32_t bit = 1U << ((x * SALT[i]) >> 27);
+            if (word & bit) continue;
+            if (dry_run) return true;
+            word |= bit;
+            std::memcpy(block + i * sizeof(word), &word, sizeof(word));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void BloomFilterMap::insert(uint64_t page_id, const std::vector<Key>& keys) {
+    if (page_id == 0 || keys.empty()) return;
+    // Repeated values set no new bits; find that out under a read latch.
+    {
+        auto page = bpm_.fetch_page_read(file_name_, group_page(page_id));
+        if (!set_bits(const_cast<uint8_t*>(page->data()) + PAGE_LSN_SIZE, keys, true)) return;
+    }
+    auto page = bpm_.fetch_page_write(file_name_, group_page(page_id));
+    if (set_bits(page->data() + PAGE_LSN_SIZE, keys, false)) page.mark_dirty();
+}
+
+void BloomFilterMap::add(uint64_t page_id, const uint8_t* tuple) {
+    std::vector<Key> k;
+    keys(tuple, k);
+    insert(page_id, k);
+}
@@ -0,0 +1,433 @@
+#include "storage/btree.hpp"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t IS_LEAF_OFFSET = PAGE_LSN_SIZE;
+constexpr size_t COUNT_OFFSET = PAGE_LSN_SIZE + 2;
+constexpr size_t NEXT_OFFSET = PAGE_LSN_SIZE + 8;
+constexpr size_t HEADER = BPlusTree::NODE_HEADER_SIZE;
+constexpr size_t INTERNAL_STRIDE = BPlusTree::ENTRY_SIZE + 8;
+
+template<typename T>
+T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template<typename T>
+void store(uint8_t* p, T v) {
+    std::memcpy(p, &v, sizeof(T));
+}
+
+// View over one node page; see the layout in btree.hpp.
+class Node {
+public:
+    explicit Node(uint8_t* data) : d_(data) {}
+    explicit Node(const uint8_t* data) : d_(const_cast<uint8_t*>(data)) {}
+
+    static void init(uint8_t* data, bool leaf) {
+        std::memset(data + PAGE_LSN_SIZE, 0, PAGE_SIZE - PAGE_LSN_SIZE);
+        data[IS_LEAF_OFFSET] = leaf ? 1 : 0;
+    }
+
+    bool leaf() const { return d_[IS_LEAF_OFFSET] != 0; }
+    size_t count() const { return load<uint16_t>(d_ + COUNT_OFFSET); }
+    void set_count(size_t n) { store<uint16_t>(d_ + COUNT_OFFSET, static_cast<uint16_t>(n)); }
+    uint64_t next() const { return load<uint64_t>(d_ + NEXT_OFFSET); }
+    void set_next(uint64_t page) { store(d_ + NEXT_OFFSET, page); }
+    size_t capacity() const { return leaf() ? BPlusTree::LEAF_CAPACITY : BPlusTree::INTERNAL_CAPACITY; }
+
+    IndexEntry entry(size_t i) const { return IndexEntry::read(d_ + entry_offset(i)); }
+    void set_entry(size_t i, const IndexEntry& e) { e.write(d_ + entry_offset(i)); }
+
+    // Internal nodes: child i holds the entries in [entry(i - 1), entry(i)).
+    uint64_t child(size_t i) const { return load<uint64_t>(d_ + child_offset(i)); }
+    void set_child(size_t i, uint64_t page) { store(d_ + child_offset(i), page); }
+
+    // Index of the first entry >= e.
+    size_t lower_bound(const IndexEntry& e) const {
+        size_t lo = 0, hi = count();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (entry(mid) < e) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Internal nodes: the child whose range contains e.
+    size_t child_for(const IndexEntry& e) const {
+        size_t lo = 0, hi = count();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (e < entry(mid)) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    void insert_leaf(size_t pos, const IndexEntry& e) {
+        uint8_t* at = d_ + entry_offset(pos);
+        std::memmove(at + BPlusTree::ENTRY_SIZE, at, (count() - pos) * BPlusTree::ENTRY_SIZE);
+        set_entry(pos, e);
+        set_count(count() + 1);
+    }
+
+    void erase_leaf(size_t pos) {
+        uint8_t* at = d_ + entry_offset(pos);
+        std::memmove(at, at + BPlusTree::ENTRY_SIZE, (count() - pos - 1) * BPlusTree::ENTRY_SIZE);
+        set_count(count() - 1);
+    }
+
+    // Internal nodes: inserts separator `e` at `pos` with `right` as the child after it.
+    void insert_internal(size_t pos, const IndexEntry& e, uint64_t right) {
+        uint8_t* at = d_ + entry_offset(pos);
+        std::memmove(at + INTERNAL_STRIDE, at, (count() - pos) * INTERNAL_STRIDE);
+        set_entry(pos, e);
+        set_child(pos + 1, right);
+        set_count(count() + 1);
+    }
+
+    void assign_leaf(const IndexEntry* entries, size_t n) {
+        set_count(n);
+        for (size_t i = 0; i < n; ++i) set_entry(i, entries[i]);
+    }
+
+    // Internal nodes: n separators and the n + 1 children around them.
+    void assign_internal(const IndexEntry* seps, const uint64_t* children, size_t n) {
+        set_count(n);
+        set_child(0, children[0]);
+        for (size_t i = 0; i < n; ++i) {
+            set_entry(i, seps[i]);
+            set_child(i + 1, children[i + 1]);
+        }
+    }
+
+private:
+    uint8_t* d_;
+
+    size_t entry_offset(size_t i) const {
+        return leaf() ? HEADER + i * BPlusTree::ENTRY_SIZE : HEADER + 8 + i * INTERNAL_STRIDE;
+    }
+    static size_t child_offset(size_t i) {
+        return i == 0 ? HEADER : HEADER + 8 + (i - 1) * INTERNAL_STRIDE + BPlusTree::ENTRY_SIZE;
+    }
+};
+
+}
+
+
+BPlusTree::BPlusTree(std::string file_name, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), bpm_(bpm) {
+    auto header = bpm_.fetch_page_write(file_name_, 0);
+    if (load<uint32_t>(header->data() + MAGIC_OFFSET) == MAGIC) {
+        /*
+        * The recorded count lags after a crash: splits below the root allocate without
+        * the header latch. A node's page is logged before the change that links it in,
+        * and recovery writes both back, so the file reaches past every reachable node.
+        */
+        uint64_t pages = file_pages(file_name_);
+        page_count_.store(std::max<uint64_t>(load<uint64_t>(header->data() + PAGE_COUNT_OFFSET),
+                                             pages > 0 ? pages - 1 : 0));
+        return;
+    }
+    store(header->data() + MAGIC_OFFSET, MAGIC);
+    write_header(header, 0, 0);
+}
+
+/*
+* Splits below the root allocate pages without holding the header latch, so the page
+* count is written back here; bulk loads and root changes also record it, and a count
+* left stale by a crash is corrected from the file's length on open.
+*/
+BPlusTree::~BPlusTree() {
+    try {
+        auto header = bpm_.fetch_page_write(file_name_, 0);
+        if (load<uint64_t>(header->data() + PAGE_COUNT_OFFSET) != page_count_.load()) {
+            store(header->data() + PAGE_COUNT_OFFSET, page_count_.load());
+            header.mark_dirty();
+        }
+    } catch (const std::exception&) {
+        // No free frame for the header; destructors must not throw. Once the pages
+        // are written back, the next open recovers the count from the file's length.
+    }
+}
+
+void BPlusTree::write_header(WritePageHandle& header, uint64_t root, uint64_t height) {
+    store(header->data() + ROOT_OFFSET, root);
+    store(header->data() + HEIGHT_OFFSET, height);
+    store(header->data() + PAGE_COUNT_OFFSET, page_count_.load());
+    header.mark_dirty();
+}
+
+uint64_t BPlusTree::allocate_page() {
+    return page_count_.fetch_add(1) + 1;
+}
+
+size_t BPlusTree::height() {
+    auto header = bpm_.fetch_page_read(file_name_, 0);
+    return load<uint64_t>(header->data() + HEIGHT_OFFSET);
+}
+
+
+std::pair<ReadPageHandle, uint64_t> BPlusTree::find_leaf(const IndexEntry& e) {
+    auto parent = bpm_.fetch_page_read(file_name_, 0);
+    uint64_t page_id = load<uint64_t>(parent->data() + ROOT_OFFSET);
+    uint64_t level = load<uint64_t>(parent->data() + HEIGHT_OFFSET);
+    /*
+    * Levels are counted from the root read under the header latch. A root split after
+    * that adds a level above it but never changes the depth of nodes below.
+    */
+    for (; level > 1; --level) {
+        parent = bpm_.fetch_page_read(file_name_, page_id);
+        Node node(parent->data());
+        page_id = node.child(node.child_for(e));
+    }
+    return {std::move(parent), page_id};
+}
+
+bool BPlusTree::insert(int64_t key, RID rid) {
+    IndexEntry e{key, rid};
+    {
+        auto [parent, leaf_id] = find_leaf(e);
+        if (leaf_id != 0) {
+            auto page = bpm_.fetch_page_write(file_name_, leaf_id);
+            parent.release();
+            Node leaf(page->data());
+            size_t pos = leaf.lower_bound(e);
+            if (pos < leaf.count() && leaf.entry(pos) == e) return false;
+            if (leaf.count() < leaf.capacity()) {
+                leaf.insert_leaf(pos, e);
+                page.mark_dirty();
+                return true;
+            }
+        }
+    }
+    return insert_pessimistic(e);
+}
+
+bool BPlusTree::insert_pessimistic(const IndexEntry& e) {
+    /*
+    * path holds write latches from the highest node a split could reach (the header
+    * if the root may split) down to the leaf.
+    */
+    std::vector<WritePageHandle> path;
+    path.push_back(bpm_.fetch_page_write(file_name_, 0));
+    uint64_t page_id = load<uint64_t>(path[0]->data() + ROOT_OFFSET);
+    uint64_t level = load<uint64_t>(path[0]->data() + HEIGHT_OFFSET);
+    if (page_id == 0) {
+        uint64_t root = allocate_page();
+        auto page = bpm_.fetch_page_write(file_name_, root);
+        Node::init(page->data(), true);
+        Node(page->data()).insert_leaf(0, e);
+        page.mark_dirty();
+        write_header(path[0], root, 1);
+        return true;
+    }
+    for (; level > 0; --level) {
+        auto page = bpm_.fetch_page_write(file_name_, page_id);
+        Node node(page->data());
+        if (node.count() < node.capacity()) {
+            path.clear();
+        }
+        path.push_back(std::move(page));
+        if (level > 1) page_id = node.child(node.child_for(e));
+    }
+
+    Node leaf(path.back()->data());
+    size_t pos = leaf.lower_bound(e);
+    if (pos < leaf.count() && leaf.entry(pos) == e) return false;
+    path.back().mark_dirty();
+    if (leaf.count() < leaf.capacity()) {
+        leaf.insert_leaf(pos, e);
+        return true;
+    }
+
+    /*
+    * Split the leaf: the upper half moves to a new right sibling whose first entry
+    * becomes the separator pushed into the parent.
+    */
+    std::vector<IndexEntry> entries;
+    entries.reserve(leaf.count() + 1);
+    for (size_t i = 0; i < leaf.count(); ++i) entries.push_back(leaf.entry(i));
+    entries.insert(entries.begin() + pos, e);
+    size_t left = entries.size() / 2;
+
+    uint64_t right_id = allocate_page();
+    {
+        auto right = bpm_.fetch_page_write(file_name_, right_id);
+        Node::init(right->data(), true);
+        Node rnode(right->data());
+        rnode.assign_leaf(entries.data() + left, entries.size() - left);
+        rnode.set_next(leaf.next());
+        right.mark_dirty();
+    }
+    leaf.assign_leaf(entries.data(), left);
+    leaf.set_next(right_id);
+    IndexEntry sep = entries[left];
+
+    for (size_t i = path.size() - 1; i-- > 0;) {
+        WritePageHandle& handle = path[i];
+        handle.mark_dirty();
+        if (handle.page_id().page_id == 0) {
+            /*
+            * The root split: grow the tree by one level.
+            */
+            uint64_t old_root = load<uint64_t>(handle->data() + ROOT_OFFSET);
+            uint64_t root = allocate_page();
+            auto page = bpm_.fetch_page_write(file_name_, root);
+            Node::init(page->data(), false);
+            uint64_t children[2] = {old_root, right_id};
+            Node(page->data()).assign_internal(&sep, children, 1);
+            page.mark_dirty();
+            write_header(handle, root, load<uint64_t>(handle->data() + HEIGHT_OFFSET) + 1);
+            return true;
+        }
+
+        Node parent(handle->data());
+        size_t at = parent.child_for(sep);
+        if (parent.count() < parent.capacity()) {
+            parent.insert_internal(at, sep, right_id);
+            return true;
+        }
+
+        std::vector<IndexEntry> seps;
+        std::vector<uint64_t> children;
+        seps.reserve(parent.count() + 1);
+        children.reserve(parent.count() + 2);
+        children.push_back(parent.child(0));
+        for (size_t k = 0; k < parent.count(); ++k) {
+            seps.push_back(parent.entry(k));
+            children.push_back(parent.child(k + 1));
+        }
+        seps.insert(seps.begin() + at, sep);
+        children.insert(children.begin() + at + 1, right_id);
+
+        // seps[mid] moves up; its right child becomes the new node's first child.
+        size_t mid = seps.size() / 2;
+        right_id = allocate_page();
+        {
+            auto right = bpm_.fetch_page_write(file_name_, right_id);
+            Node::init(right->data(), false);
+            Node(right->data()).assign_internal(seps.data() + mid + 1, children.data() + mid + 1,
+                                                seps.size() - mid - 1);
+            right.mark_dirty();
+        }
+        parent.assign_internal(seps.data(), children.data(), mid);
+        sep = seps[mid];
+    }
+    return true;
+}
+
+bool BPlusTree::remove(int64_t key, RID rid) {
+    IndexEntry e{key, rid};
+    auto [parent, leaf_id] = find_leaf(e);
+    if (leaf_id == 0) return false;
+    auto page = bpm_.fetch_page_write(file_name_, leaf_id);
+    parent.release();
+    Node leaf(page->data());
+    size_t pos = leaf.lower_bound(e);
+    if (pos >= leaf.count() || leaf.entry(pos) != e) return false;
+    leaf.erase_leaf(pos);
+    page.mark_dirty();
+    return true;
+}
+
+void BPlusTree::scan(int64_t lo, int64_t hi, const std::function<bool(const IndexEntry&)>& fn) {
+    IndexEntry start{lo, RID{0, 0}};
+    auto [parent, leaf_id] = find_leaf(start);
+    if (leaf_id == 0) return;
+    auto page = bpm_.fetch_page_read(file_name_, leaf_id);
+    parent.release();
+
+    size_t pos = Node(page->data()).lower_bound(start);
+    while (true) {
+        Node leaf(page->data());
+        for (; pos < leaf.count(); ++pos) {
+            IndexEntry e = leaf.entry(pos);
+            if (e.key > hi || !fn(e)) return;
+        }
+        uint64_t next = leaf.next();
+        if (next == 0) return;
+        // The next leaf is latched before the current one is released.
+        page = bpm_.fetch_page_read(file_name_, next);
+        pos = 0;
+    }
+}
+
+std::vector<RID> BPlusTree::find(int64_t key) {
+    std::vector<RID> rids;
+    scan(key, key, [&](const IndexEntry& e) {
+        rids.push_back(e.rid);
+        return true;
+    });
+    return rids;
+}
+
+
+void BPlusTree::bulk_load(const std::vector<IndexEntry>& sorted) {
+    auto header = bpm_.fetch_page_write(file_name_, 0);
+    if (load<uint64_t>(header->data() + ROOT_OFFSET) != 0) {
+        throw std::invalid_argument("bulk_load needs an empty index");
+    }
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        if (!(sorted[i - 1] < sorted[i])) {
+            throw std::invalid_argument("bulk_load input is not sorted by (key, rid)");
+        }
+    }
+    if (sorted.empty()) return;
+
+    /*
+    * Leaves first, spread evenly and given consecutive page ids so each can link to
+    * the next; then one internal level at a time over the first entries of the level
+    * below, until a single root remains.
+    */
+    size_t per_leaf = std::max<size_t>(1, LEAF_CAPACITY * BULK_FILL_PERCENT / 100);
+    size_t leaves = (sorted.size() + per_leaf - 1) / per_leaf;
+    uint64_t first_leaf = page_count_.load() + 1;
+    page_count_.fetch_add(leaves);
+
+    std::vector<IndexEntry> firsts;
+    std::vector<uint64_t> pages;
+    for (size_t j = 0; j < leaves; ++j) {
+        size_t begin = j * sorted.size() / leaves;
+        size_t end = (j + 1) * sorted.size() / leaves;
+        uint64_t page_id = first_leaf + j;
+        auto page = bpm_.fetch_page_write(file_name_, page_id);
+        Node::init(page->data(), true);
+        Node leaf(page->data());
+        leaf.assign_leaf(sorted.data() + begin, end - begin);
+        leaf.set_next(j + 1 < leaves ? page_id + 1 : 0);
+        page.mark_dirty();
+        firsts.push_back(sorted[begin]);
+        pages.push_back(page_id);
+    }
+
+    uint64_t height = 1;
+    size_t per_node = std::max<size_t>(2, INTERNAL_CAPACITY * BULK_FILL_PERCENT / 100 + 1);
+    while (pages.size() > 1) {
+        size_t nodes = (pages.size() + per_node - 1) / per_node;
+        std::vector<IndexEntry> up_firsts;
+        std::vector<uint64_t> up_pages;
+        for (size_t j = 0; j < nodes; ++j) {
+            size_t begin = j * pages.size() / nodes;
+            size_t end = (j + 1) * pages.size() / nodes;
+            uint64_t page_id = allocate_page();
+            auto page = bpm_.fetch_page_write(file_name_, page_id);
+            Node::init(page->data(), false);
+            Node(page->data()).assign_internal(firsts.data() + begin + 1, pages.data() + begin, end - begin - 1);
+            page.mark_dirty();
+            up_firsts.push_back(firsts[begin]);
+            up_pages.push_back(page_id);
+        }
+        firsts = std::move(up_firsts);
+        pages = std::move(up_pages);
+        height++;
+    }
+    write_header(header, pages[0], height);
+}
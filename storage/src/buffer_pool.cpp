@@ -1,221 +1,177 @@
-#pragma once
-
-#include <vector>
-#include <string>
-#include <cstdint>
-#include <memory>
-#include <mutex>
-#include <shared_mutex>
-#include <optional>
-#include <atomic>
-#include "third_party/ConcurrentHashMap.h"
-#include "storage/disk.hpp"
-#include <variant>
-
-
-struct PageId {
-    std::string file_name;
-    uint64_t page_id;
-    
-    bool operator==(const PageId& other) const {
-        return file_name == other.file_name && page_id == other.page_id;
-    }
-    
-    bool operator<(const PageId& other) const {
-        if (file_name != other.file_name) {
-            return file_name < other.file_name;
-        }
-        return page_id < other.page_id;
-    }
-};
-
-
-struct PageIdHash {
-    /**
-     * Computes a hash value for a PageId object.
-     *
-     * The hash is generated by combining the hash of the file name
-     * and the hash of the page ID, ensuring that PageId can be used
-     * as a key in hash-based containers such as std::unordered_map
-     * and std::unordered_set. The combination uses a simple XOR and
-     * bit-shift operation to reduce collisions while keeping the
-     * implementation lightweight.
-     */
-    std::size_t operator()(const PageId& pid) const {
-        std::size_t h1 = std::hash<std::string>{}(pid.file_name);
-        std::size_t h2 = std::hash<uint64_t>{}(pid.page_id);
-        return h1 ^ (h2 << 1);
-    }
-};
+#include "storage/buffer_pool.hpp"
+#include <cstring>
+#include <stdexcept>
 
 
-struct Frame {
-    PageId page_id;
-    std::vector<uint8_t> data;
-    std::shared_mutex page_mutex;
-    std::atomic<bool> is_dirty{false};
-    std::atomic<int>  pin_count{0};
-    
-    Frame() = default;
-    Frame(const Frame&) = delete;
-    Frame& operator=(const Frame&) = delete;
-};
+BufferPoolManager::BufferPoolManager(size_t pool_size, LogManager* log)
+    : pool_size_(pool_size), free_frames_(pool_size), log_(log) {
+    frames_.reserve(pool_size_);
+    for (size_t i = 0; i < pool_size_; ++i) {
+        frames_.emplace_back(std::make_unique<Frame>());
+    }
+    for (size_t i = pool_size_; i > 0; --i) {
+        free_frames_.push(i - 1);
+    }
+}
 
+std::optional<size_t> BufferPoolManager::get_free_frame() {
+    return free_frames_.pop();
+}
 
-class BufferPoolManager;
 
-template<typename LockType>
-class PageHandle {
+void BufferPoolManager::return_free_frame(size_t frame_idx) {
+    free_frames_.push(frame_idx);
+}
 
-private:
-    std::vector<uint8_t>* data_;
-    LockType lock_;
-    PageId page_id_;
-    bool is_dirty_;
 
-    std::function<void(const PageId)> unpin_page_fn_;
-    std::function<void(const PageId&)> mark_page_dirty_fn_;
+/*
+* Called with the frame's page_mutex held exclusively. pin_count is incremented rather
+* than set: a thread that looked the frame up under its previous page may have pinned
+* it already and will unpin once it notices the page_id changed.
+*/
+void BufferPoolManager::load_page_to_frame(const PageId& page_id, size_t frame_idx) {
+    auto& frame = frames_[frame_idx];
+    frame->data = read_page(page_id.file_name, page_id.page_id);
+    frame->page_id = page_id;
+    frame->is_dirty.store(false);
+    frame->referenced.store(true);
+    frame->in_use = true;
+    frame->pin_count.fetch_add(1);
+}
 
-    void cleanup() {
-        unpin_page_fn_(page_id_);
-        lock_.unlock();
+void BufferPoolManager::flush_page(size_t frame_idx) {
+    auto& frame = frames_[frame_idx];
+    if (frame->is_dirty.load()) {
+        if (log_) {
+            // Write-ahead: the records that produced this image must be durable first.
+            Lsn lsn;
+            std::memcpy(&lsn, frame->data.data() + PAGE_LSN_OFFSET, sizeof(lsn));
+            log_->flush(lsn);
+        }
+        write_page(frame->page_id.file_name, frame->page_id.page_id, frame->data);
+        frame->is_dirty.store(false);
+        std::lock_guard<std::mutex> lock(unsynced_mutex_);
+        unsynced_files_.insert(frame->page_id.file_name);
     }
+}
 
-public:
 
-    PageHandle(std::vector<uint8_t>* data, LockType lock, const PageId& page_id)
-        : data_(data), lock_(std::move(lock)), page_id_(page_id), is_dirty_(false)  {}
-    
+/*
+* Clock sweep over the frames, called with buffer_pool_mutex_ held exclusively. A frame
+* is a victim once it is unpinned and its reference bit has been cleared by a previous
+* pass. The victim is returned with its page_mutex held exclusively, so a concurrent
+* fetch that already found it in the page table blocks until the new page is in place
+* and then fails the page_id check in lock_frame.
+*/
+std::optional<size_t> BufferPoolManager::evict_frame() {
+    for (size_t step = 0; step < 2 * pool_size_; ++step) {
+        size_t frame_idx = clock_hand_;
+        clock_hand_ = (clock_hand_ + 1) % pool_size_;
 
-    PageHandle(PageHandle&& other) noexcept
-        : data_(other.data_), lock_(std::move(other.lock_)), page_id_(other.page_id_), is_dirty_(other.is_dirty_) {
-        other.data_ = nullptr;
-    }
-    
-    PageHandle& operator=(PageHandle&& other) noexcept {
-        if (this != &other) {
-            cleanup();
-            data_ = other.data_;
-            lock_ = std::move(other.lock_);
-            page_id_ = other.page_id_;
-            is_dirty_ = other.is_dirty_;
-            other.data_ = nullptr;
+        auto& frame = frames_[frame_idx];
+        if (!frame->in_use || frame->pin_count.load() > 0) {
+            continue;
+        }
+        if (frame->referenced.exchange(false)) {
+            continue;
+        }
+        if (!frame->page_mutex.try_lock()) {
+            continue;
+        }
+        if (frame->pin_count.load() > 0) {
+            frame->page_mutex.unlock();
+            continue;
         }
-        return *this;
-    }
 
-    PageHandle(const PageHandle&) = delete;
-    PageHandle& operator=(const PageHandle&) = delete;
-    
-    ~PageHandle() {
-        cleanup();
+        try {
+            flush_page(frame_idx);
+        } catch (...) {
+            // The page stays cached and dirty; only the latch taken above is given back.
+            frame->page_mutex.unlock();
+            throw;
+        }
+        page_table_.remove(frame->page_id);
+        /*
+        * A fetch that found this frame in the page table before the removal is blocked
+        * in lock_frame. If loading the next page fails the frame is freed without a new
+        * page_id, so the old one must not survive to pass that fetch's check.
+        */
+        frame->page_id = PageId{std::string(), INVALID_PAGE_ID};
+        frame->in_use = false;
+        return frame_idx;
     }
-    
-
-    std::vector<uint8_t>& data() { return *data_; }
-    const std::vector<uint8_t>& data() const { return *data_; }
-    
-    std::vector<uint8_t>* operator->() { return data_; }
-    const std::vector<uint8_t>* operator->() const { return data_; }
-    
-    std::vector<uint8_t>& operator*() { return *data_; }
-    const std::vector<uint8_t>& operator*() const { return *data_; }
-    
-    void mark_dirty() { is_dirty_ = true; }
-    bool is_valid() const { return data_ != nullptr; }    
-};
-
-
-using ReadPageHandle = PageHandle<std::shared_lock<std::shared_mutex>>;
-using WritePageHandle = PageHandle<std::unique_lock<std::shared_mutex>>;
-
-
-class BufferPoolManager {
+    return std::nullopt;
+}
 
-private:
 
-    static constexpr size_t DEFAULT_BUFFER_POOL_SIZE = 1000;
-    std::vector<std::unique_ptr<Frame>> frames_;
-    size_t pool_size_;
-    ConcurrentHashMap<PageId, size_t, PageIdHash> page_table_;
-    std::vector<size_t> free_frames_;
-    mutable std::mutex free_frames_mutex_;
-    std::shared_mutex buffer_pool_mutex_;
-    
+std::optional<BufferPoolManager::PageHandleVariant> BufferPoolManager::lock_frame(
+    size_t frame_idx, const PageId& pid, bool is_write) {
 
-    BufferPoolManager(size_t pool_size = DEFAULT_BUFFER_POOL_SIZE) 
-        : pool_size_(pool_size) {
-        frames_.reserve(pool_size_);
-        free_frames_.reserve(pool_size_);
-        for (size_t i = 0; i < pool_size_; ++i) {
-            frames_.emplace_back(std::make_unique<Frame>());
-            free_frames_.push_back(i);
+    auto& frame = frames_[frame_idx];
+    auto unpin = [f = frame.get()](const PageId) { f->pin_count.fetch_sub(1); };
+    auto mark_dirty = [f = frame.get()](const PageId&) { f->is_dirty.store(true); };
+    /*
+    * Runs when a dirtied write handle is released, still under the exclusive latch, so
+    * the before image and the page cannot change underneath it.
+    */
+    auto log_and_mark_dirty = [f = frame.get(), log = log_](const PageId& page) {
+        if (auto lsn = log->log_page_diff(page.file_name, page.page_id, f->before_image.data(), f->data.data())) {
+            std::memcpy(f->data.data() + PAGE_LSN_OFFSET, &*lsn, sizeof(*lsn));
         }
+        f->is_dirty.store(true);
+    };
+    if (is_write) {
+        frame->page_mutex.lock();
+    } else {
+        frame->page_mutex.lock_shared();
     }
 
-    std::optional<size_t> get_free_frame() {
-        std::lock_guard<std::mutex> lock(free_frames_mutex_);
-        if (free_frames_.empty()) {
-            return std::nullopt;
+    if (!(frame->page_id == pid)) {
+        /*
+        * The frame was evicted and reused between the page table lookup and the lock.
+        */
+        if (is_write) {
+            frame->page_mutex.unlock();
+        } else {
+            frame->page_mutex.unlock_shared();
         }
-        size_t frame_idx = free_frames_.back();
-        free_frames_.pop_back();
-        return frame_idx;
+        frame->pin_count.fetch_sub(1);
+        return std::nullopt;
     }
-    
-
-    void return_free_frame(size_t frame_idx) {
-        std::lock_guard<std::mutex> lock(free_frames_mutex_);
-        free_frames_.push_back(frame_idx);
-    }
-    
-
-    void load_page_to_frame(const PageId& page_id, size_t frame_idx) {
-        auto& frame = frames_[frame_idx];
-        frame->data = read_page(page_id.file_name, page_id.page_id);
-        frame->page_id = page_id;
-        frame->is_dirty.store(false);
-        frame->pin_count.store(1);
-    }
-    
-    void flush_page(size_t frame_idx) {
-        auto& frame = frames_[frame_idx];
-        if (frame->is_dirty.load()) {
-            write_page(frame->page_id.file_name, frame->page_id.page_id, frame->data);
-            frame->is_dirty.store(false);
-        }
+    frame->referenced.store(true, std::memory_order_relaxed);
+
+    if (is_write) {
+        if (log_) frame->before_image = frame->data;
+        return PageHandleVariant(WritePageHandle(
+            &frame->data,
+            std::unique_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
+            pid, unpin, log_ ? std::function<void(const PageId&)>(log_and_mark_dirty) : mark_dirty));
     }
+    return PageHandleVariant(ReadPageHandle(
+        &frame->data,
+        std::shared_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
+        pid, unpin, mark_dirty));
+}
 
-    using PageHandleVariant = std::variant<ReadPageHandle, WritePageHandle>;
+BufferPoolManager::PageHandleVariant BufferPoolManager::fetch_page_internal(
+    const std::string& file_name, uint64_t page_id, bool is_write) {
 
-    PageHandleVariant fetch_page_internal(
-        const std::string& file_name, uint64_t page_id, bool is_write) {
-        
-        PageId pid{file_name, page_id};
+    PageId pid{file_name, page_id};
+    while (true) {
         auto frame_idx_opt = page_table_.get(pid);
-        
+
         if (frame_idx_opt) {
             /*
             * Page Already Exists in the Buffer Pool.
             */
             size_t frame_idx = *frame_idx_opt;
-            auto& frame = frames_[frame_idx];
-            frame->pin_count.fetch_add(1);
-            if (is_write) {
-                frame->page_mutex.lock();
-                return PageHandle<std::unique_lock<std::shared_mutex>>(
-                    &frame->data, 
-                    std::unique_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
-                    pid);
-            } else {
-                frame->page_mutex.lock_shared();
-                return PageHandle<std::shared_lock<std::shared_mutex>>(
-                    &frame->data,
-                    std::shared_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
-                    pid);
+            frames_[frame_idx]->pin_count.fetch_add(1);
+            if (auto handle = lock_frame(frame_idx, pid, is_write)) {
+                return std::move(*handle);
             }
+            continue;
         }
-        
+
         std::unique_lock<std::shared_mutex> pool_lock(buffer_pool_mutex_);
         frame_idx_opt = page_table_.get(pid);
         if (frame_idx_opt) {
@@ -226,176 +182,176 @@ private:
             */
             pool_lock.unlock();
             size_t frame_idx = *frame_idx_opt;
-            auto& frame = frames_[frame_idx];
-            frame->pin_count.fetch_add(1);
-            if (is_write) {
-                frame->page_mutex.lock();
-                return PageHandle<std::unique_lock<std::shared_mutex>>(
-                    &frame->data, 
-                    std::unique_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
-                    pid);
-            } else {
-                frame->page_mutex.lock_shared();
-                return PageHandle<std::shared_lock<std::shared_mutex>>(
-                    &frame->data,
-                    std::shared_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
-                    pid);
+            frames_[frame_idx]->pin_count.fetch_add(1);
+            if (auto handle = lock_frame(frame_idx, pid, is_write)) {
+                return std::move(*handle);
             }
-            
-        
+            continue;
         }
-        
+
 
         /*
-        * Thread has to load the page into the buffer pool.
+        * Thread has to load the page into the buffer pool, evicting another page if no frame is free.
         */
-        auto free_frame_idx = get_free_frame();
+        std::optional<size_t> free_frame_idx = get_free_frame();
+        if (free_frame_idx) {
+            frames_[*free_frame_idx]->page_mutex.lock();
+        } else {
+            free_frame_idx = evict_frame();
+        }
         if (!free_frame_idx) {
             throw std::runtime_error("No free frames available in buffer pool");
         }
-        
+
         size_t frame_idx = *free_frame_idx;
-        load_page_to_frame(pid, frame_idx);
-        page_table_.insert(pid, frame_idx);
         auto& frame = frames_[frame_idx];
-        if (is_write) {
-            frame->page_mutex.lock();
-            return PageHandle<std::unique_lock<std::shared_mutex>>(
-                    &frame->data, 
-                    std::unique_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
-                    pid);
-        } else {
-            frame->page_mutex.lock_shared();
-            return PageHandle<std::shared_lock<std::shared_mutex>>(
-                    &frame->data,
-                    std::shared_lock<std::shared_mutex>(frame->page_mutex, std::adopt_lock),
-                    pid);
+        try {
+            load_page_to_frame(pid, frame_idx);
+        } catch (...) {
+            frame->page_mutex.unlock();
+            return_free_frame(frame_idx);
+            throw;
         }
+        page_table_.insert(pid, frame_idx);
+        frame->page_mutex.unlock();
+        pool_lock.unlock();
+        return std::move(*lock_frame(frame_idx, pid, is_write));
     }
-    
+}
 
-    size_t get_frame_index(const PageId& pid) const {
-        auto frame_idx_opt = page_table_.get(pid);
-        if (!frame_idx_opt) {
-            throw std::runtime_error("Page not found in buffer pool");
-        }
-        return *frame_idx_opt;
+
+size_t BufferPoolManager::get_frame_index(const PageId& pid) const {
+    auto frame_idx_opt = page_table_.get(pid);
+    if (!frame_idx_opt) {
+        throw std::runtime_error("Page not found in buffer pool");
     }
+    return *frame_idx_opt;
+}
 
-public:
 
-    static BufferPoolManager& get_instance() {
-        static BufferPoolManager instance;
-        return instance;
-    }
-    
-    BufferPoolManager(const BufferPoolManager&) = delete;
-    BufferPoolManager& operator=(const BufferPoolManager&) = delete;
-    
-    
-    ReadPageHandle fetch_page_read(const std::string& file_name, uint64_t page_id) {
-        auto variant = fetch_page_internal(file_name, page_id, false);
-        return std::get<ReadPageHandle>(std::move(variant));
+ReadPageHandle BufferPoolManager::fetch_page_read(const std::string& file_name, uint64_t page_id) {
+    auto variant = fetch_page_internal(file_name, page_id, false);
+    return std::get<ReadPageHandle>(std::move(variant));
+}
+
+WritePageHandle BufferPoolManager::fetch_page_write(const std::string& file_name, uint64_t page_id) {
+    auto variant = fetch_page_internal(file_name, page_id, true);
+    return std::get<WritePageHandle>(std::move(variant));
+}
+
+
+bool BufferPoolManager::unpin_page(const std::string& file_name, uint64_t page_id, bool is_dirty) {
+    PageId pid{file_name, page_id};
+
+    auto frame_idx_opt = page_table_.get(pid);
+    if (!frame_idx_opt) {
+        return false;
     }
-    
-    WritePageHandle fetch_page_write(const std::string& file_name, uint64_t page_id) {
-        auto variant = fetch_page_internal(file_name, page_id, true);
-        return std::get<WritePageHandle>(std::move(variant));
+
+    size_t frame_idx = *frame_idx_opt;
+    auto& frame = frames_[frame_idx];
+
+    if (is_dirty) {
+        frame->is_dirty.store(true);
     }
-    
-    
-    bool unpin_page(const std::string& file_name, uint64_t page_id, bool is_dirty = false) {
-        PageId pid{file_name, page_id};
-        
-        auto frame_idx_opt = page_table_.get(pid);
-        if (!frame_idx_opt) {
-            return false;
-        }
-        
-        size_t frame_idx = *frame_idx_opt;
-        auto& frame = frames_[frame_idx];
-        
-        if (is_dirty) {
-            frame->is_dirty.store(true);
-        }
-        
-        int old_pin_count = frame->pin_count.fetch_sub(1);
-        return old_pin_count > 0;
+
+    int old_pin_count = frame->pin_count.fetch_sub(1);
+    return old_pin_count > 0;
+}
+
+bool BufferPoolManager::flush_page(const std::string& file_name, uint64_t page_id) {
+    PageId pid{file_name, page_id};
+
+    auto frame_idx_opt = page_table_.get(pid);
+    if (!frame_idx_opt) {
+        return false;
     }
-    
-    bool flush_page(const std::string& file_name, uint64_t page_id) {
-        PageId pid{file_name, page_id};
-        
-        auto frame_idx_opt = page_table_.get(pid);
-        if (!frame_idx_opt) {
-            return false;
-        }
-        
-        size_t frame_idx = *frame_idx_opt;
-        auto& frame = frames_[frame_idx];
-        
-        std::unique_lock<std::shared_mutex> lock(frame->page_mutex);
-        flush_page(frame_idx);
-        return true;
+
+    size_t frame_idx = *frame_idx_opt;
+    auto& frame = frames_[frame_idx];
+
+    // A shared latch is enough to keep writers out while the image is written.
+    std::shared_lock<std::shared_mutex> lock(frame->page_mutex);
+    if (!(frame->page_id == pid)) {
+        return false;
     }
-    
+    flush_page(frame_idx);
+    return true;
+}
 
-    void flush_all_pages() {
-        std::shared_lock<std::shared_mutex> pool_lock(buffer_pool_mutex_);
-        
-        for (size_t i = 0; i < pool_size_; ++i) {
-            auto& frame = frames_[i];
-            if (frame->pin_count.load() > 0) {
-                std::unique_lock<std::shared_mutex> page_lock(frame->page_mutex);
-                flush_page(i);
-            }
+
+/*
+* Flushes every dirty frame, pinned or not. Only the frame latches are taken: holding
+* buffer_pool_mutex_ here could deadlock with a writer that misses while holding a latch.
+*/
+void BufferPoolManager::flush_all_pages() {
+    for (size_t i = 0; i < pool_size_; ++i) {
+        auto& frame = frames_[i];
+        if (frame->is_dirty.load()) {
+            std::shared_lock<std::shared_mutex> page_lock(frame->page_mutex);
+            flush_page(i);
         }
     }
-    
+}
 
-    struct PoolStats {
-        size_t total_frames;
-        size_t free_frames;
-        size_t pinned_frames;
-        size_t dirty_frames;
-    };
-    
-    PoolStats get_stats() const {
-        PoolStats stats;
-        stats.total_frames = pool_size_;
-        
-        {
-            std::lock_guard<std::mutex> lock(free_frames_mutex_);
-            stats.free_frames = free_frames_.size();
-        }
-        
-        stats.pinned_frames = 0;
-        stats.dirty_frames = 0;
-        
-        for (const auto& frame : frames_) {
-            if (frame->pin_count.load() > 0) {
-                stats.pinned_frames++;
-            }
-            if (frame->is_dirty.load()) {
-                stats.dirty_frames++;
-            }
+
+std::vector<PageId> BufferPoolManager::dirty_pages() {
+    std::vector<PageId> pages;
+    for (auto& frame : frames_) {
+        std::shared_lock<std::shared_mutex> page_lock(frame->page_mutex);
+        if (frame->is_dirty.load()) {
+            pages.push_back(frame->page_id);
         }
-        
-        return stats;
     }
-};
+    return pages;
+}
 
 
-inline ReadPageHandle fetch_page_read(const std::string& file_name, uint64_t page_id) {
-    return BufferPoolManager::get_instance().fetch_page_read(file_name, page_id);
+/*
+* The set is taken before syncing, so a write-back that finishes meanwhile lands in the
+* next call's set. If a sync fails, the files not yet synced are put back.
+*/
+void BufferPoolManager::sync_written_files() {
+    std::set<std::string> files;
+    {
+        std::lock_guard<std::mutex> lock(unsynced_mutex_);
+        files.swap(unsynced_files_);
+    }
+    for (auto it = files.begin(); it != files.end(); it = files.erase(it)) {
+        try {
+            sync_file(*it);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(unsynced_mutex_);
+            unsynced_files_.insert(files.begin(), files.end());
+            throw;
+        }
+    }
 }
 
-inline WritePageHandle fetch_page_write(const std::string& file_name, uint64_t page_id) {
-    return BufferPoolManager::get_instance().fetch_page_write(file_name, page_id);
+std::vector<std::string> BufferPoolManager::unsynced_files() {
+    std::lock_guard<std::mutex> lock(unsynced_mutex_);
+    return std::vector<std::string>(unsynced_files_.begin(), unsynced_files_.end());
 }
 
-inline bool flush_page(const std::string& file_name, uint64_t page_id) {
-    return BufferPoolManager::get_instance().flush_page(file_name, page_id);
+
+BufferPoolManager::PoolStats BufferPoolManager::get_stats() const {
+    PoolStats stats;
+    stats.total_frames = pool_size_;
+    stats.free_frames = free_frames_.size();
+
+    stats.pinned_frames = 0;
+    stats.dirty_frames = 0;
+
+    for (const auto& frame : frames_) {
+        if (frame->pin_count.load() > 0) {
+            stats.pinned_frames++;
+        }
+        if (frame->is_dirty.load()) {
+            stats.dirty_frames++;
+        }
+    }
+
+    return stats;
 }
 
 // Example usage:
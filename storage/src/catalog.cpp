@@ -0,0 +1,211 @@
+#include "storage/catalog.hpp"
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+
+namespace {
+
+/*
+* Catalog records start with a kind byte:
+*
+*   Table:    [kind][id u32][layout u8][name][file name][column count u16]
+*             column count x [type u8][name]
+*   Sequence: [kind][next table id u32]
+*
+* where strings are [length u16][bytes]. There is one Sequence record.
+*/
+constexpr uint8_t TABLE_RECORD = 1;
+constexpr uint8_t SEQUENCE_RECORD = 2;
+
+std::atomic<uint64_t> next_catalog_id{1};
+
+template<typename T>
+void put(std::vector<uint8_t>& out, T v) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &v, sizeof(T));
+}
+
+void put_string(std::vector<uint8_t>& out, const std::string& s) {
+    put(out, static_cast<uint16_t>(s.size()));
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+std::vector<uint8_t> encode_sequence(uint32_t next_id) {
+    std::vector<uint8_t> out;
+    put(out, SEQUENCE_RECORD);
+    put(out, next_id);
+    return out;
+}
+
+std::vector<uint8_t> encode_table(const TableSchema& t) {
+    std::vector<uint8_t> out;
+    put(out, TABLE_RECORD);
+    put(out, t.id);
+    put(out, static_cast<uint8_t>(t.layout));
+    put_string(out, t.name);
+    put_string(out, t.file_name);
+    put(out, static_cast<uint16_t>(t.schema.column_count()));
+    for (const ColumnDef& col : t.schema.columns()) {
+        put(out, static_cast<uint8_t>(col.data_type.kind));
+        put_string(out, col.name);
+    }
+    return out;
+}
+
+// Bounds-checked reads from one record; any overrun means the record is corrupt.
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    const std::string& file_name;
+
+    void need(size_t n) {
+        if (static_cast<size_t>(end - p) < n) {
+            throw std::runtime_error("Corrupt catalog record in '" + file_name + "'");
+        }
+    }
+
+    template<typename T>
+    T get() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    std::string get_string() {
+        uint16_t n = get<uint16_t>();
+        need(n);
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+std::shared_ptr<const TableSchema> decode_table(Reader& in) {
+    uint32_t id = in.get<uint32_t>();
+    auto layout = static_cast<TableLayout>(in.get<uint8_t>());
+    std::string name = in.get_string();
+    std::string file_name = in.get_string();
+    uint16_t count = in.get<uint16_t>();
+    std::vector<ColumnDef> columns(count);
+    for (ColumnDef& col : columns) {
+        col.data_type.kind = static_cast<DataType::Kind>(in.get<uint8_t>());
+        col.name = in.get_string();
+    }
+    return std::make_shared<const TableSchema>(
+        TableSchema{id, std::move(name), layout, std::move(file_name), TupleLayout(std::move(columns))});
+}
+
+}
+
+
+const TableSchema& CatalogSnapshot::table(std::string_view name) const {
+    const TableSchema* t = find(name);
+    if (!t) throw CatalogError("Table '" + std::string(name) + "' does not exist");
+    return *t;
+}
+
+
+Catalog::Catalog(std::string file_name, BufferPoolManager& bpm)
+    : id_(next_catalog_id.fetch_add(1)), heap_(std::move(file_name), bpm) {
+    auto initial = std::make_shared<CatalogSnapshot>();
+    bool has_sequence = false;
+    heap_.scan([&](RID rid, TupleRef t) {
+        Reader in{t.data, t.data + t.size, heap_.file_name()};
+        uint8_t kind = in.get<uint8_t>();
+        if (kind == SEQUENCE_RECORD) {
+            next_id_ = in.get<uint32_t>();
+            sequence_rid_ = rid;
+            has_sequence = true;
+        } else if (kind == TABLE_RECORD) {
+            auto table = decode_table(in);
+            rids_[table->name] = rid;
+            initial->tables_[table->name] = std::move(table);
+        } else {
+            throw std::runtime_error("Corrupt catalog record in '" + heap_.file_name() + "'");
+        }
+    });
+    if (!has_sequence) sequence_rid_ = heap_.insert(encode_sequence(next_id_));
+    publish(std::move(initial));
+}
+
+std::shared_ptr<const TableSchema> Catalog::create_table(const Statement::CreateTableData& def) {
+    std::lock_guard<std::mutex> lock(ddl_mutex_);
+    // current_ only changes under ddl_mutex_, so reading it here needs no other lock.
+    auto current = current_;
+    if (current->find(def.name)) {
+        throw CatalogError("Table '" + def.name + "' already exists");
+    }
+    std::unordered_set<std::string_view> names;
+    for (const ColumnDef& col : def.columns) {
+        if (!names.insert(col.name).second) {
+            throw std::invalid_argument("Duplicate column '" + col.name + "' in table '" + def.name + "'");
+        }
+    }
+    auto table = std::make_shared<const TableSchema>(TableSchema{
+        next_id_, def.name, def.layout, heap_.file_name() + "." + std::to_string(next_id_), TupleLayout(def.columns)});
+
+    // Taking the id first means a crash before the table record only wastes it.
+    auto sequence = encode_sequence(next_id_ + 1);
+    sequence_rid_ = *heap_.update(sequence_rid_, sequence.data(), sequence.size());
+    next_id_++;
+    rids_[table->name] = heap_.insert(encode_table(*table));
+
+    auto next = std::make_shared<CatalogSnapshot>(*current);
+    next->tables_[table->name] = table;
+    publish(std::move(next));
+    return table;
+}
+
+bool Catalog::drop_table(const Statement::DropTableData& def) {
+    std::lock_guard<std::mutex> lock(ddl_mutex_);
+    auto rid = rids_.find(def.name);
+    if (rid == rids_.end()) {
+        if (def.if_exists) return false;
+        throw CatalogError("Table '" + def.name + "' does not exist");
+    }
+    heap_.remove(rid->second);
+    rids_.erase(rid);
+
+    auto next = std::make_shared<CatalogSnapshot>(*current_);
+    next->tables_.erase(next->tables_.find(def.name));
+    publish(std::move(next));
+    return true;
+}
+
+std::shared_ptr<const CatalogSnapshot> Catalog::snapshot() const {
+    /*
+    * One cached snapshot per thread. It is current while its version matches version_,
+    * which publish() only advances together with current_ under snapshot_mutex_, so
+    * the fast path is a single atomic load and a reference count increment. The cache
+    * holds a weak_ptr, so it never keeps a snapshot alive once its catalog has moved
+    * on or been destroyed; a current snapshot is always held by current_.
+    */
+    struct Cached {
+        uint64_t catalog = 0;
+        std::weak_ptr<const CatalogSnapshot> snapshot;
+    };
+    thread_local Cached cached;
+    if (cached.catalog == id_) {
+        auto snapshot = cached.snapshot.lock();
+        if (snapshot && snapshot->version() == version_.load(std::memory_order_acquire)) return snapshot;
+    }
+    std::shared_ptr<const CatalogSnapshot> current;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        current = current_;
+    }
+    cached = Cached{id_, current};
+    return current;
+}
+
+void Catalog::publish(std::shared_ptr<CatalogSnapshot> next) {
+    next->version_ = version_.load(std::memory_order_relaxed) + 1;
+    uint64_t version = next->version_;
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    current_ = std::move(next);
+    version_.store(version, std::memory_order_release);
+}
@@ -0,0 +1,76 @@
+#include "storage/checkpoint.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+Checkpointer::Checkpointer(BufferPoolManager& bpm, LogManager& log, size_t pages_per_second)
+    : bpm_(bpm), log_(log), pages_per_second_(pages_per_second) {
+    if (bpm_.log() != &log_) {
+        throw std::invalid_argument("Checkpointer needs the log the buffer pool writes to");
+    }
+}
+
+Checkpointer::~Checkpointer() {
+    stop();
+}
+
+Lsn Checkpointer::checkpoint() {
+    Lsn begin = log_.append(LogRecordType::CheckpointBegin, nullptr, 0);
+    std::vector<PageId> pages = bpm_.dirty_pages();
+    // Sorted, so each file is written in ascending page order.
+    std::sort(pages.begin(), pages.end());
+
+    using Clock = std::chrono::steady_clock;
+    auto next = Clock::now();
+    Clock::duration spacing = Clock::duration::zero();
+    if (pages_per_second_) {
+        spacing = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) /
+                  static_cast<Clock::rep>(pages_per_second_);
+    }
+    for (const PageId& page : pages) {
+        if (pages_per_second_) {
+            std::this_thread::sleep_until(next);
+            next += spacing;
+        }
+        // A page evicted since the snapshot was written back on the way out.
+        if (bpm_.flush_page(page.file_name, page.page_id)) pages_written_.fetch_add(1);
+    }
+
+    // Evictions write back without syncing too, so every file written since the last
+    // checkpoint must be durable before redo stops covering it.
+    bpm_.sync_written_files();
+    log_.complete_checkpoint(begin);
+    checkpoints_.fetch_add(1);
+    return begin;
+}
+
+void Checkpointer::start(std::chrono::milliseconds interval) {
+    if (thread_.joinable()) {
+        throw std::logic_error("Checkpointer is already running");
+    }
+    stop_ = false;
+    thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            auto deadline = std::chrono::steady_clock::now() + interval;
+            while (!stop_ && std::chrono::steady_clock::now() < deadline) {
+                wake_.wait_for(lock, deadline - std::chrono::steady_clock::now());
+            }
+            if (stop_) break;
+            lock.unlock();
+            checkpoint();
+            lock.lock();
+        }
+    });
+}
+
+void Checkpointer::stop() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
@@ -0,0 +1,249 @@
+#include "storage/csv_loader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+// A run of whole records [begin, end) of the segment buffer.
+struct Chunk {
+    size_t begin;
+    size_t end;
+    uint64_t first_record;
+};
+
+// Data pages packed from one chunk, back to back.
+struct PackedPages {
+    std::vector<uint8_t> pages;
+    size_t count = 0;
+    uint64_t rows = 0;
+    std::exception_ptr error;
+};
+
+[[noreturn]] void fail(uint64_t record, const std::string& what) {
+    throw std::invalid_argument("CSV record " + std::to_string(record) + ": " + what);
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+template<typename T>
+bool parse_number(std::string_view text, T& out) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+void convert(std::string_view text, bool quoted, const ColumnDef& col, uint64_t record, Value& v) {
+    if (text.empty() && !quoted) {
+        v.kind = Value::Null;
+        return;
+    }
+    bool ok = true;
+    switch (col.data_type.kind) {
+        case DataType::Int: v.kind = Value::Int; ok = parse_number(text, v.i); break;
+        case DataType::Real: v.kind = Value::Float; ok = parse_number(text, v.f); break;
+        case DataType::Bool:
+            v.kind = Value::Bool;
+            if (iequals(text, "true") || iequals(text, "t") || text == "1") {
+                v.b = true;
+            } else if (iequals(text, "false") || iequals(text, "f") || text == "0") {
+                v.b = false;
+            } else {
+                ok = false;
+            }
+            break;
+        case DataType::Text: v.kind = Value::String; v.s.assign(text); break;
+        case DataType::Custom: ok = false; break;
+    }
+    if (!ok) fail(record, "'" + std::string(text) + "' is not a valid value for column '" + col.name + "'");
+}
+
+/*
+* Parses the records of one chunk and packs them into fresh data pages. The chunk ends
+* just after a record's line break, or at the end of the file.
+*/
+void pack_chunk(const char* data, const Chunk& chunk, char delimiter, bool skip_first,
+                const HeapFile& heap, const TupleLayout& layout, PackedPages& out) {
+    size_t columns = layout.column_count();
+    std::vector<Value> row(columns);
+    std::string unescaped;
+    std::vector<uint8_t> record_bytes;
+    uint8_t* page = nullptr;
+
+    const char* p = data + chunk.begin;
+    const char* end = data + chunk.end;
+    // The header is the first non-blank line, whatever blank lines come before it.
+    bool header_pending = skip_first;
+    for (uint64_t record = chunk.first_record; p < end; ++record) {
+        if (*p == '\n' || (*p == '\r' && p + 1 < end && p[1] == '\n')) {
+            p += *p == '\n' ? 1 : 2;
+            continue;
+        }
+        bool skip = header_pending;
+        header_pending = false;
+        size_t col = 0;
+        while (true) {
+            std::string_view text;
+            bool quoted = p < end && *p == '"';
+            if (quoted) {
+                unescaped.clear();
+                for (++p;; ++p) {
+                    if (p == end) fail(record, "unterminated quoted field");
+                    if (*p == '"') {
+                        if (p + 1 == end || p[1] != '"') break;
+                        ++p;
+                    }
+                    unescaped.push_back(*p);
+                }
+                ++p;
+                if (p < end && *p != delimiter && *p != '\n' && *p != '\r') {
+                    fail(record, "unexpected character after a quoted field");
+                }
+                text = unescaped;
+            } else {
+                const char* start = p;
+                while (p < end && *p != delimiter && *p != '\n') ++p;
+                const char* stop = p;
+                if (stop > start && stop[-1] == '\r' && (p == end || *p == '\n')) --stop;
+                text = std::string_view(start, stop - start);
+                if (text.find('"') != std::string_view::npos) fail(record, "quote inside an unquoted field");
+            }
+            if (!skip && col < columns) convert(text, quoted, layout.columns()[col], record, row[col]);
+            col++;
+            if (p < end && *p == delimiter) {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == '\r') ++p;
+            if (p < end && *p == '\n') ++p;
+            break;
+        }
+        if (skip) continue;
+        if (col != columns) {
+            fail(record, "expected " + std::to_string(columns) + " fields, found " + std::to_string(col));
+        }
+
+        record_bytes.clear();
+        try {
+            layout.encode(row.data(), record_bytes);
+        } catch (const std::invalid_argument& e) {
+            fail(record, e.what());
+        }
+        if (page && heap.insert_into(page, record_bytes.data(), record_bytes.size())) {
+            out.rows++;
+            continue;
+        }
+        out.pages.resize((out.count + 1) * PAGE_SIZE);
+        page = out.pages.data() + out.count * PAGE_SIZE;
+        out.count++;
+        heap.init_page(page);
+        if (!heap.insert_into(page, record_bytes.data(), record_bytes.size())) {
+            fail(record, "record does not fit in a page");
+        }
+        out.rows++;
+    }
+}
+
+}
+
+
+uint64_t load_csv(const std::string& csv_path, HeapFile& heap, const TupleLayout& layout,
+                  const CsvOptions& options) {
+    for (const ColumnDef& col : layout.columns()) {
+        if (col.data_type.kind == DataType::Custom) {
+            throw std::invalid_argument("Column '" + col.name + "' has a type CSV values cannot be converted to");
+        }
+    }
+    std::ifstream in(csv_path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open CSV file '" + csv_path + "'");
+    }
+    size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    size_t segment = std::max<size_t>(options.segment_bytes, 1) * threads;
+
+    /*
+    * `buffer` always starts at a record boundary: whatever follows the last complete
+    * record of a segment is carried over to the front of the next one.
+    */
+    std::string buffer;
+    uint64_t next_record = 1;
+    uint64_t rows = 0;
+    bool eof = false;
+    while (!eof) {
+        size_t carried = buffer.size();
+        buffer.resize(carried + segment);
+        in.read(&buffer[carried], static_cast<std::streamsize>(segment));
+        if (in.bad()) throw std::runtime_error("Error reading CSV file '" + csv_path + "'");
+        buffer.resize(carried + static_cast<size_t>(in.gcount()));
+        eof = in.eof();
+
+        /*
+        * Cut the segment into about `threads` chunks of whole records. Line breaks
+        * inside quoted fields do not end a record; a "" escape toggles the quote state
+        * twice, so counting quotes is enough to tell.
+        */
+        std::vector<Chunk> chunks;
+        size_t n = buffer.size();
+        size_t target = std::max<size_t>(n / threads, 1);
+        size_t start = 0;
+        size_t complete = 0;
+        uint64_t record = next_record;
+        uint64_t first = record;
+        bool quoted = false;
+        for (size_t i = 0; i < n; ++i) {
+            if (buffer[i] == '"') {
+                quoted = !quoted;
+            } else if (buffer[i] == '\n' && !quoted) {
+                record++;
+                complete = i + 1;
+                if (complete - start >= target) {
+                    chunks.push_back(Chunk{start, complete, first});
+                    start = complete;
+                    first = record;
+                }
+            }
+        }
+        if (eof) {
+            if (quoted) fail(record, "unterminated quoted field");
+            complete = n;
+        }
+        if (start < complete) chunks.push_back(Chunk{start, complete, first});
+        next_record = record;
+
+        std::vector<PackedPages> packed(chunks.size());
+        std::vector<std::thread> workers;
+        for (size_t k = 0; k < chunks.size(); ++k) {
+            workers.emplace_back([&, k] {
+                try {
+                    pack_chunk(buffer.data(), chunks[k], options.delimiter,
+                               options.header && chunks[k].first_record == 1, heap, layout, packed[k]);
+                } catch (...) {
+                    packed[k].error = std::current_exception();
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+
+        // Nothing of a segment is written unless all of it parsed.
+        for (const auto& out : packed) {
+            if (out.error) std::rethrow_exception(out.error);
+        }
+        for (const auto& out : packed) {
+            heap.append_pages(out.pages.data(), out.count);
+            rows += out.rows;
+        }
+        buffer.erase(0, complete);
+    }
+    return rows;
+}
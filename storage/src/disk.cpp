@@ -1,7 +1,10 @@
 #include "storage/disk.hpp"
+#include <fcntl.h>
 #include <fstream>
 #include <stdexcept>
 #include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 
 std::vector<uint8_t> read_page(const std::string& file_name, uint64_t page_id) {
@@ -20,7 +23,11 @@ void write_page(const std::string& file_name, uint64_t page_id, const std::vecto
     if (data.size() != PAGE_SIZE) {
         throw std::invalid_argument("Page must be exactly PAGE_SIZE bytes");
     }
-    uint64_t offset = page_id * PAGE_SIZE;
+    write_pages(file_name, page_id, data.data(), 1);
+}
+
+void write_pages(const std::string& file_name, uint64_t first_page, const uint8_t* data, size_t count) {
+    uint64_t offset = first_page * PAGE_SIZE;
     std::fstream file(file_name, std::ios::in | std::ios::out | std::ios::binary);
     if (!file.is_open()) {
         file.open(file_name, std::ios::out | std::ios::binary);
@@ -28,6 +35,27 @@ void write_page(const std::string& file_name, uint64_t page_id, const std::vecto
         file.open(file_name, std::ios::in | std::ios::out | std::ios::binary);
     }
     file.seekp(offset, std::ios::beg);
-    file.write(reinterpret_cast<const char*>(data.data()), PAGE_SIZE);
+    file.write(reinterpret_cast<const char*>(data), count * PAGE_SIZE);
     file.flush();
+    if (!file) {
+        throw std::runtime_error("Cannot write to '" + file_name + "'");
+    }
+}
+
+uint64_t file_pages(const std::string& file_name) {
+    struct stat st;
+    if (::stat(file_name.c_str(), &st) != 0) return 0;
+    return static_cast<uint64_t>(st.st_size) / PAGE_SIZE;
+}
+
+void sync_file(const std::string& file_name) {
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open '" + file_name + "' to sync it");
+    }
+    int rc = ::fsync(fd);
+    ::close(fd);
+    if (rc != 0) {
+        throw std::runtime_error("Cannot sync '" + file_name + "'");
+    }
 }
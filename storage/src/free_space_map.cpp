@@ -0,0 +1,76 @@
+#include "storage/free_space_map.hpp"
+#include <cstring>
+#include <vector>
+
+
+FreeSpaceMap::FreeSpaceMap(std::string file_name, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), bpm_(bpm) {}
+
+void FreeSpaceMap::update(uint64_t page_id, size_t free_bytes) {
+    if (page_id == 0 || page_id > uint64_t(ENTRIES) * ENTRIES) return;
+    uint8_t b = bucket(free_bytes);
+    uint64_t leaf = (page_id - 1) / ENTRIES + 1;
+    size_t at = PAGE_LSN_SIZE + (page_id - 1) % ENTRIES;
+    {
+        auto page = bpm_.fetch_page_read(file_name_, leaf);
+        if (page->data()[at] == b) return;
+    }
+    auto page = bpm_.fetch_page_write(file_name_, leaf);
+    uint8_t* entries = page->data();
+    uint8_t old = entries[at];
+    if (old == b) return;
+    entries[at] = b;
+    page.mark_dirty();
+
+    /*
+    * The root entry of a leaf only changes under the leaf's write latch, so it always
+    * ends up as the leaf's true maximum. Shrinking the entry that held it means
+    * looking at the whole leaf again.
+    */
+    size_t slot = PAGE_LSN_SIZE + (leaf - 1);
+    auto root = bpm_.fetch_page_write(file_name_, 0);
+    uint8_t& max = root->data()[slot];
+    if (b > max) {
+        max = b;
+    } else if (old == max && b < old) {
+        max = *std::max_element(entries + PAGE_LSN_SIZE, entries + PAGE_SIZE);
+    } else {
+        return;
+    }
+    root.mark_dirty();
+}
+
+std::optional<uint64_t> FreeSpaceMap::find(size_t need, uint64_t from, uint64_t page_count) {
+    size_t want = std::max<size_t>(1, (need + BUCKET - 1) / BUCKET);
+    page_count = std::min<uint64_t>(page_count, uint64_t(ENTRIES) * ENTRIES);
+    if (want > 255 || page_count == 0) return std::nullopt;
+    if (from == 0 || from > page_count) from = 1;
+
+    // Copied out so no leaf is latched under the root's latch; update() takes them the other way round.
+    uint64_t leaves = (page_count - 1) / ENTRIES + 1;
+    std::vector<uint8_t> maxima(leaves);
+    {
+        auto root = bpm_.fetch_page_read(file_name_, 0);
+        std::memcpy(maxima.data(), root->data() + PAGE_LSN_SIZE, leaves);
+    }
+
+    // Looks for a page in [lo, hi], reading only the leaves that may have one.
+    auto search = [&](uint64_t lo, uint64_t hi) -> std::optional<uint64_t> {
+        while (lo <= hi) {
+            uint64_t leaf = (lo - 1) / ENTRIES + 1;
+            uint64_t leaf_last = std::min<uint64_t>(hi, leaf * ENTRIES);
+            if (maxima[leaf - 1] >= want) {
+                auto page = bpm_.fetch_page_read(file_name_, leaf);
+                const uint8_t* entries = page->data() + PAGE_LSN_SIZE;
+                uint64_t first = (leaf - 1) * ENTRIES + 1;
+                for (uint64_t p = lo; p <= leaf_last; ++p) {
+                    if (entries[p - first] >= want) return p;
+                }
+            }
+            lo = leaf_last + 1;
+        }
+        return std::nullopt;
+    };
+    if (auto p = search(from, page_count)) return p;
+    return from > 1 ? search(1, from - 1) : std::nullopt;
+}
@@ -0,0 +1,327 @@
+#include "storage/hash_index.hpp"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace {
+
+constexpr size_t LOCAL_DEPTH_OFFSET = PAGE_LSN_SIZE;
+constexpr size_t COUNT_OFFSET = PAGE_LSN_SIZE + 2;
+constexpr size_t OVERFLOW_OFFSET = PAGE_LSN_SIZE + 8;
+
+template<typename T>
+T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template<typename T>
+void store(uint8_t* p, T v) {
+    std::memcpy(p, &v, sizeof(T));
+}
+
+// splitmix64 finalizer: spreads sequential keys over the low bits the directory uses.
+uint64_t hash_key(int64_t key) {
+    uint64_t x = static_cast<uint64_t>(key);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// View over one bucket page; see the layout in hash_index.hpp.
+class Bucket {
+public:
+    explicit Bucket(uint8_t* data) : d_(data) {}
+    explicit Bucket(const uint8_t* data) : d_(const_cast<uint8_t*>(data)) {}
+
+    static void init(uint8_t* data, uint16_t local_depth) {
+        std::memset(data + PAGE_LSN_SIZE, 0, PAGE_SIZE - PAGE_LSN_SIZE);
+        store(data + LOCAL_DEPTH_OFFSET, local_depth);
+    }
+
+    uint16_t local_depth() const { return load<uint16_t>(d_ + LOCAL_DEPTH_OFFSET); }
+    void set_local_depth(uint16_t depth) { store(d_ + LOCAL_DEPTH_OFFSET, depth); }
+    size_t count() const { return load<uint16_t>(d_ + COUNT_OFFSET); }
+    void set_count(size_t n) { store<uint16_t>(d_ + COUNT_OFFSET, static_cast<uint16_t>(n)); }
+    uint64_t overflow() const { return load<uint64_t>(d_ + OVERFLOW_OFFSET); }
+    void set_overflow(uint64_t page) { store(d_ + OVERFLOW_OFFSET, page); }
+    bool full() const { return count() >= HashIndex::BUCKET_CAPACITY; }
+
+    IndexEntry entry(size_t i) const { return IndexEntry::read(slot(i)); }
+
+    std::optional<size_t> position(const IndexEntry& e) const {
+        for (size_t i = 0; i < count(); ++i) {
+            if (entry(i) == e) return i;
+        }
+        return std::nullopt;
+    }
+
+    void append(const IndexEntry& e) {
+        e.write(slot(count()));
+        set_count(count() + 1);
+    }
+
+    // Removes entry i by moving the last entry into its place.
+    void erase(size_t i) {
+        size_t last = count() - 1;
+        if (i != last) std::memcpy(slot(i), slot(last), IndexEntry::ENCODED_SIZE);
+        set_count(last);
+    }
+
+private:
+    uint8_t* d_;
+
+    uint8_t* slot(size_t i) const { return d_ + HashIndex::BUCKET_HEADER_SIZE + i * IndexEntry::ENCODED_SIZE; }
+};
+
+}
+
+
+HashIndex::HashIndex(std::string file_name, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), bpm_(bpm) {
+    auto header = bpm_.fetch_page_write(file_name_, 0);
+    if (load<uint32_t>(header->data() + MAGIC_OFFSET) == MAGIC) return;
+
+    /*
+    * A new index: global depth 0, one directory page (page 1) whose only slot points at
+    * an empty bucket on page 2.
+    */
+    store(header->data() + MAGIC_OFFSET, MAGIC);
+    store<uint32_t>(header->data() + DEPTH_OFFSET, 0);
+    store<uint64_t>(header->data() + PAGE_COUNT_OFFSET, 2);
+    store<uint64_t>(header->data() + DIRECTORY_OFFSET, 1);
+    header.mark_dirty();
+    auto dir = bpm_.fetch_page_write(file_name_, 1);
+    store<uint64_t>(dir->data() + PAGE_LSN_SIZE, 2);
+    dir.mark_dirty();
+    auto bucket = bpm_.fetch_page_write(file_name_, 2);
+    Bucket::init(bucket->data(), 0);
+    bucket.mark_dirty();
+}
+
+uint32_t HashIndex::global_depth() {
+    auto header = bpm_.fetch_page_read(file_name_, 0);
+    return load<uint32_t>(header->data() + DEPTH_OFFSET);
+}
+
+uint64_t HashIndex::bucket_of(const uint8_t* header, size_t slot) {
+    uint64_t dir_id = load<uint64_t>(header + DIRECTORY_OFFSET + slot / DIRECTORY_PAGE_SLOTS * 8);
+    auto dir = bpm_.fetch_page_read(file_name_, dir_id);
+    return load<uint64_t>(dir->data() + PAGE_LSN_SIZE + slot % DIRECTORY_PAGE_SLOTS * 8);
+}
+
+void HashIndex::set_bucket(const uint8_t* header, size_t slot, uint64_t bucket_id) {
+    uint64_t dir_id = load<uint64_t>(header + DIRECTORY_OFFSET + slot / DIRECTORY_PAGE_SLOTS * 8);
+    auto dir = bpm_.fetch_page_write(file_name_, dir_id);
+    store(dir->data() + PAGE_LSN_SIZE + slot % DIRECTORY_PAGE_SLOTS * 8, bucket_id);
+    dir.mark_dirty();
+}
+
+uint64_t HashIndex::allocate(WritePageHandle& header) {
+    uint64_t page_id = load<uint64_t>(header->data() + PAGE_COUNT_OFFSET) + 1;
+    store(header->data() + PAGE_COUNT_OFFSET, page_id);
+    header.mark_dirty();
+    return page_id;
+}
+
+/*
+* Slot s + 2^depth starts out serving the same bucket as slot s. The old slots are read
+* in full first, because the last old directory page may also receive new slots;
+* directory pages are allocated as the new slots reach them.
+*/
+void HashIndex::double_directory(WritePageHandle& header) {
+    uint8_t* d = header->data();
+    uint32_t depth = load<uint32_t>(d + DEPTH_OFFSET);
+    size_t slots = size_t(1) << depth;
+    std::vector<uint64_t> buckets(slots);
+    for (size_t s = 0; s < slots; s += DIRECTORY_PAGE_SLOTS) {
+        auto dir = bpm_.fetch_page_read(file_name_, load<uint64_t>(d + DIRECTORY_OFFSET + s / DIRECTORY_PAGE_SLOTS * 8));
+        size_t n = std::min(DIRECTORY_PAGE_SLOTS, slots - s);
+        std::memcpy(buckets.data() + s, dir->data() + PAGE_LSN_SIZE, n * 8);
+    }
+    for (size_t s = slots; s < 2 * slots;) {
+        uint8_t* entry = d + DIRECTORY_OFFSET + s / DIRECTORY_PAGE_SLOTS * 8;
+        size_t first = s % DIRECTORY_PAGE_SLOTS;
+        if (first == 0) store(entry, allocate(header));
+        auto dir = bpm_.fetch_page_write(file_name_, load<uint64_t>(entry));
+        size_t n = std::min(DIRECTORY_PAGE_SLOTS - first, 2 * slots - s);
+        std::memcpy(dir->data() + PAGE_LSN_SIZE + first * 8, buckets.data() + (s - slots), n * 8);
+        dir.mark_dirty();
+        s += n;
+    }
+    store<uint32_t>(d + DEPTH_OFFSET, depth + 1);
+    header.mark_dirty();
+}
+
+/*
+* Entries are packed from the head on. Pages left empty stay linked and take later
+* inserts; pages are allocated and linked when the entries do not fit.
+*/
+void HashIndex::refill(std::vector<WritePageHandle>& pages, const std::vector<IndexEntry>& entries,
+                       uint16_t local_depth, WritePageHandle& header) {
+    size_t next = 0;
+    for (size_t k = 0; k < pages.size() || next < entries.size(); ++k) {
+        if (k == pages.size()) {
+            uint64_t page_id = allocate(header);
+            Bucket(pages.back()->data()).set_overflow(page_id);
+            pages.push_back(bpm_.fetch_page_write(file_name_, page_id));
+            Bucket::init(pages.back()->data(), local_depth);
+        }
+        Bucket b(pages[k]->data());
+        b.set_local_depth(local_depth);
+        b.set_count(0);
+        for (; next < entries.size() && !b.full(); ++next) b.append(entries[next]);
+        pages[k].mark_dirty();
+    }
+}
+
+HashIndex::InsertResult HashIndex::insert_into_chain(WritePageHandle& head, const IndexEntry& e) {
+    /*
+    * The whole chain is checked for the entry before anything is written, so the
+    * first page with room can only be chosen once every page has been seen.
+    */
+    std::vector<WritePageHandle> overflow;
+    std::optional<size_t> target;   // 0 is the head, k is overflow[k - 1]
+    uint8_t* data = head->data();
+    for (size_t k = 0;; ++k) {
+        Bucket b(data);
+        if (b.position(e)) return InsertResult::Duplicate;
+        if (!target && !b.full()) target = k;
+        uint64_t next = b.overflow();
+        if (next == 0) break;
+        overflow.push_back(bpm_.fetch_page_write(file_name_, next));
+        data = overflow.back()->data();
+    }
+    if (!target) return InsertResult::Full;
+    WritePageHandle& page = *target == 0 ? head : overflow[*target - 1];
+    Bucket(page->data()).append(e);
+    page.mark_dirty();
+    return InsertResult::Inserted;
+}
+
+bool HashIndex::insert(int64_t key, RID rid) {
+    IndexEntry e{key, rid};
+    uint64_t h = hash_key(key);
+    {
+        auto header = bpm_.fetch_page_read(file_name_, 0);
+        uint32_t depth = load<uint32_t>(header->data() + DEPTH_OFFSET);
+        size_t slot = h & ((uint64_t(1) << depth) - 1);
+        auto head = bpm_.fetch_page_write(file_name_, bucket_of(header->data(), slot));
+        header.release();
+        InsertResult r = insert_into_chain(head, e);
+        if (r != InsertResult::Full) return r == InsertResult::Inserted;
+    }
+    return insert_with_split(e);
+}
+
+bool HashIndex::insert_with_split(const IndexEntry& e) {
+    uint64_t h = hash_key(e.key);
+    auto header = bpm_.fetch_page_write(file_name_, 0);
+    uint8_t* d = header->data();
+
+    while (true) {
+        uint32_t depth = load<uint32_t>(d + DEPTH_OFFSET);
+        size_t slot = h & ((uint64_t(1) << depth) - 1);
+        auto head = bpm_.fetch_page_write(file_name_, bucket_of(d, slot));
+        InsertResult r = insert_into_chain(head, e);
+        if (r != InsertResult::Full) return r == InsertResult::Inserted;
+
+        std::vector<WritePageHandle> chain;
+        chain.push_back(std::move(head));
+        std::vector<IndexEntry> entries;
+        bool one_key = true;
+        while (true) {
+            Bucket b(chain.back()->data());
+            for (size_t i = 0; i < b.count(); ++i) {
+                entries.push_back(b.entry(i));
+                one_key = one_key && entries.back().key == e.key;
+            }
+            if (b.overflow() == 0) break;
+            chain.push_back(bpm_.fetch_page_write(file_name_, b.overflow()));
+        }
+
+        Bucket bucket(chain.front()->data());
+        uint16_t local = bucket.local_depth();
+        if (one_key || local >= MAX_GLOBAL_DEPTH) {
+            /*
+            * A split cannot help: link a new overflow page right after the head.
+            */
+            uint64_t page_id = allocate(header);
+            auto page = bpm_.fetch_page_write(file_name_, page_id);
+            Bucket::init(page->data(), local);
+            Bucket added(page->data());
+            added.set_overflow(bucket.overflow());
+            added.append(e);
+            page.mark_dirty();
+            bucket.set_overflow(page_id);
+            chain.front().mark_dirty();
+            return true;
+        }
+
+        if (local == depth) {
+            double_directory(header);
+            depth++;
+        }
+
+        /*
+        * Split on hash bit `local`: entries anywhere in the chain with it set move to a
+        * new bucket, and so do the directory slots that pointed at this bucket with that
+        * bit set, i.e. those congruent to `slot` modulo 2^local.
+        */
+        std::vector<IndexEntry> stay, moved;
+        for (const IndexEntry& x : entries) {
+            ((hash_key(x.key) >> local) & 1 ? moved : stay).push_back(x);
+        }
+        uint64_t image_id = allocate(header);
+        std::vector<WritePageHandle> image;
+        image.push_back(bpm_.fetch_page_write(file_name_, image_id));
+        Bucket::init(image.front()->data(), static_cast<uint16_t>(local + 1));
+        refill(chain, stay, static_cast<uint16_t>(local + 1), header);
+        refill(image, moved, static_cast<uint16_t>(local + 1), header);
+        size_t first = (slot & ((size_t(1) << local) - 1)) | (size_t(1) << local);
+        for (size_t s = first; s < (size_t(1) << depth); s += size_t(1) << (local + 1)) {
+            set_bucket(d, s, image_id);
+        }
+    }
+}
+
+bool HashIndex::remove(int64_t key, RID rid) {
+    IndexEntry e{key, rid};
+    auto header = bpm_.fetch_page_read(file_name_, 0);
+    uint32_t depth = load<uint32_t>(header->data() + DEPTH_OFFSET);
+    size_t slot = hash_key(key) & ((uint64_t(1) << depth) - 1);
+    auto page = bpm_.fetch_page_write(file_name_, bucket_of(header->data(), slot));
+    header.release();
+    while (true) {
+        Bucket b(page->data());
+        if (auto pos = b.position(e)) {
+            b.erase(*pos);
+            page.mark_dirty();
+            return true;
+        }
+        if (b.overflow() == 0) return false;
+        page = bpm_.fetch_page_write(file_name_, b.overflow());
+    }
+}
+
+std::vector<RID> HashIndex::find(int64_t key) {
+    std::vector<RID> rids;
+    auto header = bpm_.fetch_page_read(file_name_, 0);
+    uint32_t depth = load<uint32_t>(header->data() + DEPTH_OFFSET);
+    size_t slot = hash_key(key) & ((uint64_t(1) << depth) - 1);
+    auto page = bpm_.fetch_page_read(file_name_, bucket_of(header->data(), slot));
+    header.release();
+    while (true) {
+        Bucket b(page->data());
+        for (size_t i = 0; i < b.count(); ++i) {
+            IndexEntry x = b.entry(i);
+            if (x.key == key) rids.push_back(x.rid);
+        }
+        if (b.overflow() == 0) return rids;
+        page = bpm_.fetch_page_read(file_name_, b.overflow());
+    }
+}
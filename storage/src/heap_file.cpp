@@ -0,0 +1,351 @@
+#include "storage/heap_file.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+
+namespace {
+
+// Inserter slot of the calling thread: threads are dealt slots round-robin.
+size_t inserter_slot() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t slot = next.fetch_add(1) % HeapFile::INSERT_TARGETS;
+    return slot;
+}
+
+}
+
+
+HeapFile::HeapFile(std::string file_name, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), bpm_(bpm), fsm_(file_name_ + ".fsm", bpm) {
+    open(TableLayout::Row);
+}
+
+HeapFile::HeapFile(std::string file_name, TableLayout layout, const TupleLayout& schema, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), bpm_(bpm), fsm_(file_name_ + ".fsm", bpm) {
+    if (layout == TableLayout::Pax) {
+        pax_.emplace(schema);
+    }
+    if (schema.column_count() <= ZoneMap::MAX_COLUMNS) {
+        zones_.emplace(file_name_ + ".zm", schema, bpm);
+    }
+    if (schema.column_count() <= BloomFilterMap::MAX_COLUMNS) {
+        blooms_.emplace(file_name_ + ".bf", schema, bpm);
+    }
+    open(layout);
+}
+
+void HeapFile::open(TableLayout layout) {
+    auto header = bpm_.fetch_page_write(file_name_, 0);
+    uint32_t magic;
+    std::memcpy(&magic, header->data() + MAGIC_OFFSET, sizeof(magic));
+    if (magic == MAGIC) {
+        if (header->data()[LAYOUT_OFFSET] != static_cast<uint8_t>(layout)) {
+            throw std::runtime_error("Heap file '" + file_name_ + "' was created with a different page layout");
+        }
+        uint64_t count;
+        std::memcpy(&count, header->data() + PAGE_COUNT_OFFSET, sizeof(count));
+        page_count_.store(count);
+        uint8_t current = header->data()[SYNOPSES_OFFSET];
+        if (current == synopses()) return;
+        // Writes made without the schema (or before a synopsis existed) did not maintain
+        // it, so it is rebuilt before it is trusted again.
+        rebuild_synopses(synopses() & ~current);
+        header->data()[SYNOPSES_OFFSET] = synopses();
+        header.mark_dirty();
+        return;
+    }
+    /*
+    * A new (or empty) file: write the header so the page count survives a restart.
+    */
+    uint64_t count = 0;
+    std::memcpy(header->data() + MAGIC_OFFSET, &MAGIC, sizeof(MAGIC));
+    header->data()[LAYOUT_OFFSET] = static_cast<uint8_t>(layout);
+    header->data()[SYNOPSES_OFFSET] = synopses();
+    std::memcpy(header->data() + PAGE_COUNT_OFFSET, &count, sizeof(count));
+    header.mark_dirty();
+}
+
+uint8_t HeapFile::synopses() const {
+    return (zones_ ? ZONES_CURRENT : 0) | (blooms_ ? BLOOMS_CURRENT : 0);
+}
+
+void HeapFile::rebuild_synopses(uint8_t stale) {
+    if (!stale) return;
+    for (uint64_t p = 1; p <= page_count(); ++p) {
+        auto page = bpm_.fetch_page_read(file_name_, p);
+        summarize(p, page->data(), stale);
+    }
+}
+
+void HeapFile::summarize(uint64_t page_id, const uint8_t* page, uint8_t which) {
+    std::vector<ZoneMap::Zone> zones;
+    std::vector<BloomFilterMap::Key> keys;
+    if (which & ZONES_CURRENT) zones = zones_->empty();
+    scan_records(page_id, page, 0, [&](RID, TupleRef t) {
+        if (which & ZONES_CURRENT) zones_->widen(zones.data(), t.data);
+        if (which & BLOOMS_CURRENT) blooms_->keys(t.data, keys);
+        return true;
+    });
+    if (which & ZONES_CURRENT) zones_->merge(page_id, zones.data());
+    if (which & BLOOMS_CURRENT) blooms_->insert(page_id, keys);
+}
+
+void HeapFile::check_size(size_t size) const {
+    if (size > SlottedPage::MAX_TUPLE_SIZE) {
+        throw std::invalid_argument("Record of " + std::to_string(size) + " bytes does not fit in a page");
+    }
+}
+
+size_t HeapFile::free_bytes(const uint8_t* page) const {
+    uint8_t* data = const_cast<uint8_t*>(page);
+    return pax_ ? PaxPage(data, *pax_).free_space() : SlottedPage(data).free_space();
+}
+
+size_t HeapFile::space_needed(size_t size) const {
+    if (pax_) {
+        // A PAX row has its fixed fields reserved already; only its TEXT bytes count.
+        size_t fixed = pax_->layout().fixed_size();
+        return size > fixed ? size - fixed : 0;
+    }
+    return size + SlottedPage::SLOT_SIZE;
+}
+
+void HeapFile::init_page(uint8_t* page) const {
+    if (pax_) {
+        PaxPage::init(page, *pax_);
+    } else {
+        SlottedPage::init(page);
+    }
+}
+
+std::optional<uint16_t> HeapFile::insert_into(uint8_t* page, const uint8_t* tuple, size_t size) const {
+    if (pax_) {
+        return PaxPage(page, *pax_).insert(tuple, size);
+    }
+    return SlottedPage(page).insert(tuple, size);
+}
+
+WritePageHandle HeapFile::append_page() {
+    std::lock_guard<std::mutex> lock(extend_mutex_);
+    uint64_t page_id = page_count_.load() + 1;
+
+    auto page = bpm_.fetch_page_write(file_name_, page_id);
+    init_page(page->data());
+    page.mark_dirty();
+    {
+        auto header = bpm_.fetch_page_write(file_name_, 0);
+        std::memcpy(header->data() + PAGE_COUNT_OFFSET, &page_id, sizeof(page_id));
+        header.mark_dirty();
+    }
+    page_count_.store(page_id, std::memory_order_release);
+    return page;
+}
+
+uint64_t HeapFile::append_pages(const uint8_t* pages, size_t count) {
+    std::lock_guard<std::mutex> lock(extend_mutex_);
+    uint64_t first = page_count_.load() + 1;
+    if (count == 0) return first;
+    /*
+    * Pages past page_count() are never fetched through the buffer pool, so no cached
+    * frame can shadow what is written here. The pages are on disk before the header
+    * and page_count_ make them visible.
+    */
+    write_pages(file_name_, first, pages, count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* page = pages + i * PAGE_SIZE;
+        fsm_.update(first + i, free_bytes(page));
+        summarize(first + i, page, synopses());
+    }
+    if (bpm_.log()) {
+        // Nothing in the log can redo these pages, so they must be durable before the
+        // logged header change that publishes them.
+        sync_file(file_name_);
+    }
+    uint64_t last = first + count - 1;
+    {
+        auto header = bpm_.fetch_page_write(file_name_, 0);
+        std::memcpy(header->data() + PAGE_COUNT_OFFSET, &last, sizeof(last));
+        header.mark_dirty();
+    }
+    page_count_.store(last, std::memory_order_release);
+    return first;
+}
+
+RID HeapFile::insert(const uint8_t* tuple, size_t size) {
+    return insert(tuple, size, nullptr);
+}
+
+RID HeapFile::insert(const uint8_t* tuple, size_t size, const std::function<void(RID)>& latched) {
+    check_size(size);
+    size_t need = space_needed(size);
+    size_t slot = inserter_slot();
+    std::atomic<uint64_t>& target = targets_[slot];
+
+    /*
+    * A full page is recorded as such when an insert fails on it, so the map does not
+    * offer it again; the probes are bounded only against inserters racing for the
+    * same space.
+    */
+    uint64_t page_id = target.load(std::memory_order_relaxed);
+    for (int probe = 0; probe < 4; ++probe) {
+        if (page_id == 0) page_id = find_page(need, slot);
+        if (page_id == 0) break;
+        if (auto rid = insert_on(bpm_.fetch_page_write(file_name_, page_id), tuple, size, latched, target)) {
+            return *rid;
+        }
+        page_id = 0;
+    }
+    if (auto rid = insert_on(append_page(), tuple, size, latched, target)) {
+        return *rid;
+    }
+    throw std::invalid_argument("Record does not fit in an empty page");
+}
+
+uint64_t HeapFile::find_page(size_t need, size_t slot) {
+    uint64_t n = page_count();
+    uint64_t from = 1 + n * slot / INSERT_TARGETS;
+    for (size_t i = 0; i <= INSERT_TARGETS; ++i) {
+        auto found = fsm_.find(need, from, n);
+        if (!found) return 0;
+        bool taken = false;
+        for (size_t other = 0; other < INSERT_TARGETS; ++other) {
+            taken |= other != slot && targets_[other].load(std::memory_order_relaxed) == *found;
+        }
+        if (!taken) return *found;
+        from = *found % n + 1;
+    }
+    return 0;
+}
+
+std::optional<RID> HeapFile::insert_on(WritePageHandle page, const uint8_t* tuple, size_t size,
+                                       const std::function<void(RID)>& latched, std::atomic<uint64_t>& target) {
+    uint64_t page_id = page.page_id().page_id;
+    std::optional<RID> rid;
+    size_t free;
+    {
+        WritePageHandle held = std::move(page);
+        if (auto slot = insert_into(held->data(), tuple, size)) {
+            held.mark_dirty();
+            rid = RID{page_id, *slot};
+            if (zones_) zones_->add(page_id, tuple);
+            if (blooms_) blooms_->add(page_id, tuple);
+            if (latched) latched(*rid);
+        }
+        free = free_bytes(held->data());
+    }
+    // Claimed before the map shows its room, so other inserters pass the page over.
+    if (rid) target.store(page_id, std::memory_order_relaxed);
+    fsm_.update(page_id, free);
+    return rid;
+}
+
+std::vector<RID> HeapFile::insert_batch(const std::vector<std::vector<uint8_t>>& tuples) {
+    for (const auto& t : tuples) {
+        check_size(t.size());
+    }
+    std::vector<RID> rids;
+    rids.reserve(tuples.size());
+
+    size_t next = 0;
+    uint64_t last = page_count();
+    std::optional<WritePageHandle> page;
+    if (last > 0) {
+        page.emplace(bpm_.fetch_page_write(file_name_, last));
+    }
+    while (next < tuples.size()) {
+        bool fresh = !page;
+        if (fresh) {
+            page.emplace(append_page());
+        }
+        uint8_t* data = (*page)->data();
+        uint64_t page_id = page->page_id().page_id;
+        size_t first = next;
+        while (next < tuples.size()) {
+            auto slot = insert_into(data, tuples[next].data(), tuples[next].size());
+            if (!slot) break;
+            rids.push_back(RID{page_id, *slot});
+            next++;
+        }
+        if (next > first) {
+            page->mark_dirty();
+            if (zones_) {
+                auto zones = zones_->empty();
+                for (size_t i = first; i < next; ++i) zones_->widen(zones.data(), tuples[i].data());
+                zones_->merge(page_id, zones.data());
+            }
+            if (blooms_) {
+                std::vector<BloomFilterMap::Key> keys;
+                for (size_t i = first; i < next; ++i) blooms_->keys(tuples[i].data(), keys);
+                blooms_->insert(page_id, keys);
+            }
+        } else if (fresh) {
+            throw std::invalid_argument("Record does not fit in an empty page");
+        }
+        size_t free = free_bytes(data);
+        page.reset();
+        fsm_.update(page_id, free);
+    }
+    return rids;
+}
+
+bool HeapFile::get(RID rid, std::vector<uint8_t>& out) {
+    if (rid.page_id == 0 || rid.page_id > page_count()) return false;
+    auto page = bpm_.fetch_page_read(file_name_, rid.page_id);
+    uint8_t* data = const_cast<uint8_t*>(page->data());
+    if (pax_) {
+        return PaxPage(data, *pax_).get(rid.slot, out);
+    }
+    auto t = SlottedPage(data).get(rid.slot);
+    if (!t) return false;
+    out.assign(t->data, t->data + t->size);
+    return true;
+}
+
+bool HeapFile::remove(RID rid) {
+    if (rid.page_id == 0 || rid.page_id > page_count()) return false;
+    size_t free;
+    {
+        auto page = bpm_.fetch_page_write(file_name_, rid.page_id);
+        bool removed = pax_ ? PaxPage(page->data(), *pax_).remove(rid.slot) : SlottedPage(*page).remove(rid.slot);
+        if (!removed) return false;
+        page.mark_dirty();
+        free = free_bytes(page->data());
+    }
+    fsm_.update(rid.page_id, free);
+    return true;
+}
+
+std::optional<RID> HeapFile::update(RID rid, const uint8_t* tuple, size_t size) {
+    check_size(size);
+    if (rid.page_id == 0 || rid.page_id > page_count()) return std::nullopt;
+    bool in_place;
+    size_t free;
+    {
+        auto page = bpm_.fetch_page_write(file_name_, rid.page_id);
+        if (pax_) {
+            PaxPage pp(page->data(), *pax_);
+            if (!pp.is_live(rid.slot)) return std::nullopt;
+            in_place = pp.update(rid.slot, tuple, size);
+        } else {
+            SlottedPage sp(*page);
+            if (!sp.get(rid.slot)) return std::nullopt;
+            in_place = sp.update(rid.slot, tuple, size);
+        }
+        // Even a failed update may have compacted the page.
+        page.mark_dirty();
+        if (in_place && zones_) zones_->add(rid.page_id, tuple);
+        if (in_place && blooms_) blooms_->add(rid.page_id, tuple);
+        free = free_bytes(page->data());
+    }
+    fsm_.update(rid.page_id, free);
+    if (in_place) return rid;
+    /*
+    * The record moves: the new copy goes in first (with its page's synopses) and the old
+    * slot is freed only then, so the record is never missing from the file, and a failed
+    * insert leaves it where it was.
+    */
+    RID moved = insert(tuple, size);
+    remove(rid);
+    return moved;
+}
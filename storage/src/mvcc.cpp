@@ -0,0 +1,496 @@
+#include "storage/mvcc.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+
+namespace {
+
+template<typename T>
+T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template<typename T>
+void put(std::vector<uint8_t>& out, T v) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &v, sizeof(T));
+}
+
+// TxnInsert and TxnDelete payloads; see wal.hpp.
+Lsn log_write(LogManager& log, LogRecordType type, Timestamp txn, const std::string& file, RID rid) {
+    std::vector<uint8_t> payload;
+    put(payload, txn);
+    put(payload, rid.page_id);
+    put(payload, rid.slot);
+    put(payload, static_cast<uint16_t>(file.size()));
+    payload.insert(payload.end(), file.begin(), file.end());
+    return log.append(type, payload.data(), payload.size());
+}
+
+void check_active(const Transaction& txn) {
+    if (!txn.active()) {
+        throw std::logic_error("Transaction is no longer active");
+    }
+}
+
+/*
+* Walks a record's chain back from its current state in the heap (nullopt if its slot
+* is empty) to the version txn sees. Every write txn does not see is undone on the way:
+* a Delete brings back the record it copied, an Insert empties the slot again.
+*/
+std::optional<TupleRef> resolve(const Transaction& txn, std::optional<TupleRef> current, const Version* v) {
+    // A deleted record stays in place until garbage collection.
+    if (v && v->kind == Version::Delete) current.reset();
+    for (; v && !txn.sees(v->ts.load(std::memory_order_acquire)); v = v->next.get()) {
+        if (v->kind == Version::Delete) {
+            current = TupleRef{v->before.data(), static_cast<uint16_t>(v->before.size())};
+        } else {
+            current.reset();
+        }
+    }
+    return current;
+}
+
+const Version* find_head(const std::unordered_map<uint64_t, std::unordered_map<uint16_t, std::shared_ptr<Version>>>& pages,
+                         RID rid) {
+    auto page = pages.find(rid.page_id);
+    if (page == pages.end()) return nullptr;
+    auto chain = page->second.find(rid.slot);
+    return chain == page->second.end() ? nullptr : chain->second.get();
+}
+
+}
+
+
+Transaction::~Transaction() {
+    if (!active_) return;
+    try {
+        manager_.abort(*this);
+    } catch (...) {
+    }
+}
+
+
+TransactionManager::TransactionManager(LogManager* log) : log_(log) {}
+
+TransactionManager::~TransactionManager() {
+    stop_gc();
+}
+
+std::unique_ptr<Transaction> TransactionManager::begin() {
+    Timestamp id = Transaction::TXN_BIT | next_id_.fetch_add(1);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Timestamp start = last_committed_.load(std::memory_order_relaxed);
+    active_.insert(start);
+    return std::unique_ptr<Transaction>(new Transaction(*this, id, start));
+}
+
+void TransactionManager::commit(Transaction& txn) {
+    check_active(txn);
+    if (log_ && !txn.writes_.empty()) {
+        // Deletes are logged only now, so one undone by update() never reaches the log.
+        for (const auto& w : txn.writes_) {
+            if (w.version->kind == Version::Delete) {
+                log_write(*log_, LogRecordType::TxnDelete, txn.id_, w.heap->heap().file_name(), w.rid);
+            }
+        }
+        log_->flush(log_->append(LogRecordType::Commit, reinterpret_cast<const uint8_t*>(&txn.id_), sizeof(txn.id_)));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!txn.writes_.empty()) {
+            Timestamp ts = last_committed_.load(std::memory_order_relaxed) + 1;
+            for (const auto& w : txn.writes_) {
+                w.version->ts.store(ts, std::memory_order_release);
+            }
+            last_committed_.store(ts, std::memory_order_release);
+        }
+        active_.erase(active_.find(txn.start_ts_));
+    }
+    finish(txn);
+}
+
+void TransactionManager::abort(Transaction& txn) {
+    check_active(txn);
+    for (auto w = txn.writes_.rbegin(); w != txn.writes_.rend(); ++w) {
+        w->heap->rollback(*w);
+    }
+    if (log_ && !txn.writes_.empty()) {
+        log_->append(LogRecordType::Abort, reinterpret_cast<const uint8_t*>(&txn.id_), sizeof(txn.id_));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_.erase(active_.find(txn.start_ts_));
+    }
+    finish(txn);
+}
+
+void TransactionManager::finish(Transaction& txn) {
+    txn.writes_.clear();
+    txn.active_ = false;
+}
+
+/*
+* A transaction's fate is its Commit or Abort record, or the lack of one (a loser).
+* Committed inserts and aborted writes are already right on the pages after redo, so
+* only two kinds of write are undone: a loser's insert and a committed delete. Either
+* is skipped if a later TxnInsert shows the slot was emptied and reused since, by
+* rollback or garbage collection; undoing a write twice is harmless otherwise, which
+* is why committed deletes can simply be reapplied at every restart.
+*/
+size_t TransactionManager::recover() {
+    if (!log_) {
+        throw std::logic_error("Transaction recovery needs a log");
+    }
+    if (next_id_.load() != 0) {
+        throw std::logic_error("Transaction recovery must run before the first transaction");
+    }
+
+    struct Write {
+        Lsn lsn;
+        bool insert;
+        std::string file;
+        RID rid;
+    };
+    enum class Fate { Loser, Committed, Aborted };
+    struct Txn {
+        Fate fate = Fate::Loser;
+        std::vector<Write> writes;
+    };
+    std::map<Timestamp, Txn> txns;
+    std::map<std::pair<std::string, RID>, Lsn> last_insert;
+    log_->scan(0, [&](Lsn lsn, LogRecordType type, const uint8_t* p, size_t size) {
+        if (type == LogRecordType::TxnInsert || type == LogRecordType::TxnDelete) {
+            Write w{lsn, type == LogRecordType::TxnInsert, std::string(), RID{load<uint64_t>(p + 8), load<uint16_t>(p + 16)}};
+            w.file.assign(reinterpret_cast<const char*>(p + 20), load<uint16_t>(p + 18));
+            if (w.insert) last_insert[{w.file, w.rid}] = lsn;
+            txns[load<Timestamp>(p)].writes.push_back(std::move(w));
+        } else if ((type == LogRecordType::Commit || type == LogRecordType::Abort) && size == sizeof(Timestamp)) {
+            auto txn = txns.find(load<Timestamp>(p));
+            if (txn != txns.end()) txn->second.fate = type == LogRecordType::Commit ? Fate::Committed : Fate::Aborted;
+        }
+    });
+
+    std::map<std::string, MvccHeap*> heaps;
+    {
+        std::lock_guard<std::mutex> lock(heaps_mutex_);
+        for (MvccHeap* heap : heaps_) heaps[heap->heap().file_name()] = heap;
+    }
+    for (const auto& [id, txn] : txns) {
+        for (const Write& w : txn.writes) {
+            if (!heaps.count(w.file)) {
+                throw std::runtime_error("Transaction recovery needs an MvccHeap over '" + w.file + "'");
+            }
+        }
+    }
+
+    size_t removed = 0;
+    Timestamp last_id = 0;
+    for (const auto& [id, txn] : txns) {
+        last_id = std::max(last_id, id & ~Transaction::TXN_BIT);
+        if (txn.fate == Fate::Aborted) continue;
+        for (const Write& w : txn.writes) {
+            if (w.insert != (txn.fate == Fate::Loser)) continue;
+            auto reused = last_insert.find({w.file, w.rid});
+            if (reused != last_insert.end() && reused->second > w.lsn) continue;
+            if (heaps.at(w.file)->heap().remove(w.rid)) removed++;
+        }
+        if (txn.fate == Fate::Loser) {
+            log_->append(LogRecordType::Abort, reinterpret_cast<const uint8_t*>(&id), sizeof(id));
+        }
+    }
+    log_->flush(log_->end_lsn());
+    // Ids stay unique across restarts, so a later recovery never mixes up two runs.
+    if (!txns.empty()) next_id_.store(last_id + 1);
+    return removed;
+}
+
+Timestamp TransactionManager::horizon() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_.empty() ? last_committed_.load(std::memory_order_relaxed) : *active_.begin();
+}
+
+size_t TransactionManager::collect_garbage() {
+    Timestamp h = horizon();
+    std::lock_guard<std::mutex> lock(heaps_mutex_);
+    size_t dropped = 0;
+    for (MvccHeap* heap : heaps_) {
+        dropped += heap->collect_garbage(h);
+    }
+    return dropped;
+}
+
+void TransactionManager::start_gc(std::chrono::milliseconds interval) {
+    if (gc_thread_.joinable()) {
+        throw std::logic_error("Garbage collector is already running");
+    }
+    gc_stop_ = false;
+    gc_thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(gc_mutex_);
+        while (!gc_stop_) {
+            auto deadline = std::chrono::steady_clock::now() + interval;
+            while (!gc_stop_ && std::chrono::steady_clock::now() < deadline) {
+                gc_wake_.wait_for(lock, deadline - std::chrono::steady_clock::now());
+            }
+            if (gc_stop_) break;
+            lock.unlock();
+            collect_garbage();
+            lock.lock();
+        }
+    });
+}
+
+void TransactionManager::stop_gc() {
+    if (!gc_thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(gc_mutex_);
+        gc_stop_ = true;
+    }
+    gc_wake_.notify_all();
+    gc_thread_.join();
+}
+
+
+MvccHeap::MvccHeap(HeapFile& heap, TransactionManager& txns) : heap_(heap), txns_(txns) {
+    std::lock_guard<std::mutex> lock(txns_.heaps_mutex_);
+    txns_.heaps_.push_back(this);
+}
+
+MvccHeap::~MvccHeap() {
+    std::lock_guard<std::mutex> lock(txns_.heaps_mutex_);
+    txns_.heaps_.erase(std::find(txns_.heaps_.begin(), txns_.heaps_.end(), this));
+}
+
+RID MvccHeap::insert(Transaction& txn, const uint8_t* tuple, size_t size) {
+    check_active(txn);
+    auto version = std::make_shared<Version>();
+    version->kind = Version::Insert;
+    version->ts.store(txn.id());
+    txn.writes_.reserve(txn.writes_.size() + 1);
+    RID rid = heap_.insert(tuple, size, [&](RID at) {
+        // Logged before the page change, which is logged when the latch is released.
+        if (txns_.log_) log_write(*txns_.log_, LogRecordType::TxnInsert, txn.id(), heap_.file_name(), at);
+        Shard& sh = shard(at.page_id);
+        std::unique_lock<std::shared_mutex> lock(sh.mutex);
+        // A slot is reused once its old chain is collected, or while it is being.
+        auto& head = sh.pages[at.page_id][at.slot];
+        version->next = std::move(head);
+        head = version;
+    });
+    txn.writes_.push_back(Transaction::Write{this, rid, std::move(version)});
+    return rid;
+}
+
+bool MvccHeap::get(const Transaction& txn, RID rid, std::vector<uint8_t>& out) {
+    if (rid.page_id == 0 || rid.page_id > heap_.page_count()) return false;
+    bool found = false;
+    heap_.read_page(rid.page_id, [&](const uint8_t* page) {
+        std::optional<TupleRef> current;
+        heap_.scan_records(rid.page_id, page, rid.slot, [&](RID at, TupleRef t) {
+            if (at == rid) {
+                out.assign(t.data, t.data + t.size);
+                current = TupleRef{out.data(), t.size};
+            }
+            return false;
+        });
+        Shard& sh = shard(rid.page_id);
+        std::shared_lock<std::shared_mutex> lock(sh.mutex);
+        auto v = resolve(txn, current, find_head(sh.pages, rid));
+        if (!v) return;
+        if (v->data != out.data()) out.assign(v->data, v->data + v->size);
+        found = true;
+    });
+    return found;
+}
+
+bool MvccHeap::remove(Transaction& txn, RID rid) {
+    check_active(txn);
+    if (rid.page_id == 0 || rid.page_id > heap_.page_count()) return false;
+    txn.writes_.reserve(txn.writes_.size() + 1);
+    bool removed = false;
+    // The read latch keeps the record in place while its Delete is pushed.
+    heap_.read_page(rid.page_id, [&](const uint8_t* page) {
+        std::vector<uint8_t> record;
+        std::optional<TupleRef> current;
+        heap_.scan_records(rid.page_id, page, rid.slot, [&](RID at, TupleRef t) {
+            if (at == rid) {
+                record.assign(t.data, t.data + t.size);
+                current = TupleRef{record.data(), t.size};
+            }
+            return false;
+        });
+        Shard& sh = shard(rid.page_id);
+        std::unique_lock<std::shared_mutex> lock(sh.mutex);
+        const Version* head = find_head(sh.pages, rid);
+        if (head && !txn.sees(head->ts.load(std::memory_order_acquire))) {
+            throw WriteConflict("Record (" + std::to_string(rid.page_id) + ", " + std::to_string(rid.slot) +
+                                ") was changed by a concurrent transaction");
+        }
+        if (!resolve(txn, current, head)) return;
+
+        auto version = std::make_shared<Version>();
+        version->kind = Version::Delete;
+        version->ts.store(txn.id());
+        version->before = std::move(record);
+        auto& slot = sh.pages[rid.page_id][rid.slot];
+        version->next = std::move(slot);
+        slot = version;
+        txn.writes_.push_back(Transaction::Write{this, rid, std::move(version)});
+        removed = true;
+    });
+    return removed;
+}
+
+std::optional<RID> MvccHeap::update(Transaction& txn, RID rid, const uint8_t* tuple, size_t size) {
+    if (!remove(txn, rid)) return std::nullopt;
+    try {
+        return insert(txn, tuple, size);
+    } catch (...) {
+        // A record too large for a page must not leave the old one deleted.
+        rollback(txn.writes_.back());
+        txn.writes_.pop_back();
+        throw;
+    }
+}
+
+void MvccHeap::scan_page(const Transaction& txn, uint64_t page_id, const std::function<void(RID, TupleRef)>& fn) {
+    struct Row {
+        RID rid;
+        size_t offset;
+        uint16_t size;
+    };
+    std::vector<Row> rows;
+    std::vector<uint8_t> bytes;
+    auto keep = [&](RID rid, TupleRef t) {
+        rows.push_back(Row{rid, bytes.size(), t.size});
+        bytes.insert(bytes.end(), t.data, t.data + t.size);
+    };
+
+    /*
+    * Every record some snapshot sees is still on its page, so only the page's live
+    * records need resolving. With the page latched none can be inserted or removed;
+    * a Delete pushed meanwhile leaves the record as it is for older snapshots.
+    */
+    heap_.read_page(page_id, [&](const uint8_t* page) {
+        Shard& sh = shard(page_id);
+        std::shared_lock<std::shared_mutex> lock(sh.mutex);
+        auto chains = sh.pages.find(page_id);
+        if (chains == sh.pages.end()) {
+            lock.unlock();
+            heap_.scan_records(page_id, page, 0, [&](RID rid, TupleRef t) { keep(rid, t); return true; });
+            return;
+        }
+        heap_.scan_records(page_id, page, 0, [&](RID rid, TupleRef t) {
+            auto chain = chains->second.find(rid.slot);
+            if (chain == chains->second.end()) {
+                keep(rid, t);
+            } else if (auto v = resolve(txn, t, chain->second.get())) {
+                keep(rid, *v);
+            }
+            return true;
+        });
+    });
+
+    for (const Row& row : rows) {
+        fn(row.rid, TupleRef{bytes.data() + row.offset, row.size});
+    }
+}
+
+size_t MvccHeap::version_count() {
+    size_t count = 0;
+    for (Shard& sh : shards_) {
+        std::shared_lock<std::shared_mutex> lock(sh.mutex);
+        for (const auto& [page, chains] : sh.pages) {
+            for (const auto& [slot, head] : chains) {
+                for (const Version* v = head.get(); v; v = v->next.get()) count++;
+            }
+        }
+    }
+    return count;
+}
+
+void MvccHeap::rollback(const Transaction::Write& write) {
+    // Empty the slot before dropping the Insert, so no reader sees the record bare.
+    if (write.version->kind == Version::Insert) heap_.remove(write.rid);
+
+    Shard& sh = shard(write.rid.page_id);
+    std::unique_lock<std::shared_mutex> lock(sh.mutex);
+    auto page = sh.pages.find(write.rid.page_id);
+    auto chain = page->second.find(write.rid.slot);
+    if (chain->second == write.version) {
+        chain->second = write.version->next;
+    } else {
+        Version* v = chain->second.get();
+        while (v->next != write.version) v = v->next.get();
+        v->next = write.version->next;
+    }
+    if (!chain->second) page->second.erase(chain);
+    if (page->second.empty()) sh.pages.erase(page);
+}
+
+size_t MvccHeap::collect_garbage(Timestamp horizon) {
+    auto chain_length = [](const Version* v) {
+        size_t n = 0;
+        for (; v; v = v->next.get()) n++;
+        return n;
+    };
+    size_t dropped = 0;
+    std::vector<std::pair<RID, std::shared_ptr<Version>>> dead;
+    for (size_t i = 0; i < SHARDS; ++i) {
+        Shard& sh = shards_[i];
+        std::unique_lock<std::shared_mutex> lock(sh.mutex);
+        for (auto page = sh.pages.begin(); page != sh.pages.end();) {
+            Chains& chains = page->second;
+            for (auto chain = chains.begin(); chain != chains.end();) {
+                /*
+                * Every snapshot stops at the first version committed at or before the
+                * horizon, so it and everything older can go. If that is the newest
+                * version, the heap holds the record as everyone sees it, except after
+                * a delete: that record is removed first, below.
+                */
+                Version* prev = nullptr;
+                for (Version* v = chain->second.get(); v; prev = v, v = v->next.get()) {
+                    Timestamp ts = v->ts.load(std::memory_order_acquire);
+                    if ((ts & Transaction::TXN_BIT) || ts > horizon) continue;
+                    if (!prev && v->kind == Version::Delete) {
+                        dead.emplace_back(RID{page->first, chain->first}, chain->second);
+                        break;
+                    }
+                    dropped += chain_length(v);
+                    if (prev) {
+                        prev->next.reset();
+                    } else {
+                        chain->second.reset();
+                    }
+                    break;
+                }
+                chain = chain->second ? std::next(chain) : chains.erase(chain);
+            }
+            page = chains.empty() ? sh.pages.erase(page) : std::next(page);
+        }
+    }
+
+    // The page latch comes before the shard lock, so dead records go in a second pass.
+    for (const auto& [rid, version] : dead) {
+        heap_.remove(rid);
+        Shard& sh = shard(rid.page_id);
+        std::unique_lock<std::shared_mutex> lock(sh.mutex);
+        auto page = sh.pages.find(rid.page_id);
+        auto chain = page->second.find(rid.slot);
+        dropped += chain_length(version.get());
+        // An insert may have reused the slot in between.
+        if (chain->second == version) {
+            page->second.erase(chain);
+        } else {
+            Version* v = chain->second.get();
+            while (v->next != version) v = v->next.get();
+            v->next.reset();
+        }
+        if (page->second.empty()) sh.pages.erase(page);
+    }
+    return dropped;
+}
@@ -0,0 +1,154 @@
+#include "storage/pax_page.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+size_t bitmap_bytes(size_t bits) { return (bits + 7) / 8; }
+size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+}
+
+PaxGeometry::PaxGeometry(TupleLayout layout) : layout_(std::move(layout)) {
+    size_t n = layout_.column_count();
+    null_offsets_.resize(n);
+    value_offsets_.resize(n);
+
+    size_t bits_per_row = 1;
+    for (const auto& col : layout_.columns()) {
+        bits_per_row += 1 + 8 * TupleLayout::field_width(col.data_type.kind);
+        if (col.data_type.kind == DataType::Text) bits_per_row += 8 * TEXT_BUDGET;
+    }
+    size_t cap = std::min(MAX_CAPACITY, (PAGE_SIZE - HEADER_SIZE) * 8 / bits_per_row);
+    // The estimate ignores bitmap rounding and alignment padding; back off until it fits.
+    while (cap > 0 && place(cap) > PAGE_SIZE) cap--;
+    if (cap == 0) {
+        throw std::invalid_argument("Too many columns for a PAX page");
+    }
+    place(cap);
+    capacity_ = static_cast<uint16_t>(cap);
+}
+
+size_t PaxGeometry::place(size_t capacity) {
+    size_t off = HEADER_SIZE + bitmap_bytes(capacity);
+    size_t text_columns = 0;
+    for (size_t c = 0; c < layout_.column_count(); ++c) {
+        DataType::Kind kind = layout_.type(c);
+        null_offsets_[c] = off;
+        off = align8(off + bitmap_bytes(capacity));
+        value_offsets_[c] = off;
+        off += capacity * TupleLayout::field_width(kind);
+        if (kind == DataType::Text) text_columns++;
+    }
+    minipages_end_ = off;
+    return off + capacity * text_columns * TEXT_BUDGET;
+}
+
+
+void PaxPage::init(uint8_t* data, const PaxGeometry& geometry) {
+    std::memset(data + PAGE_LSN_SIZE, 0, PAGE_SIZE - PAGE_LSN_SIZE);
+    PaxPage page(data, geometry);
+    page.write16(8, 0);
+    page.write16(10, static_cast<uint16_t>(PAGE_SIZE));
+    page.write16(12, 0);
+}
+
+size_t PaxPage::text_needed(uint16_t row, const uint8_t* tuple, bool reuse_text) const {
+    const TupleLayout& layout = geo_.layout();
+    size_t need = 0;
+    for (size_t c = 0; c < layout.column_count(); ++c) {
+        if (layout.type(c) != DataType::Text || layout.is_null(tuple, c)) continue;
+        size_t len = layout.get_text(tuple, c).size();
+        size_t field = geo_.value_offset(c) + size_t(row) * 4;
+        if (reuse_text && len <= read16(field + 2)) continue;
+        need += len;
+    }
+    return need;
+}
+
+void PaxPage::write_row(uint16_t row, const uint8_t* tuple, bool reuse_text) {
+    const TupleLayout& layout = geo_.layout();
+    for (size_t c = 0; c < layout.column_count(); ++c) {
+        DataType::Kind kind = layout.type(c);
+        bool null = layout.is_null(tuple, c);
+        set_bit(geo_.null_offset(c), row, null);
+
+        size_t width = TupleLayout::field_width(kind);
+        size_t field = geo_.value_offset(c) + size_t(row) * width;
+        if (kind != DataType::Text) {
+            if (null) std::memset(data_ + field, 0, width);
+            else std::memcpy(data_ + field, tuple + layout.field_offset(c), width);
+            continue;
+        }
+
+        std::string_view text = null ? std::string_view() : layout.get_text(tuple, c);
+        uint16_t len = static_cast<uint16_t>(text.size());
+        if (reuse_text && len <= read16(field + 2)) {
+            std::memcpy(data_ + read16(field), text.data(), len);
+        } else {
+            uint16_t start = static_cast<uint16_t>(text_start() - len);
+            std::memcpy(data_ + start, text.data(), len);
+            write16(10, start);
+            write16(field, start);
+        }
+        write16(field + 2, len);
+    }
+}
+
+std::optional<uint16_t> PaxPage::insert(const uint8_t* tuple, size_t) {
+    uint16_t row = row_count();
+    if (row >= geo_.capacity()) return std::nullopt;
+    if (text_start() - geo_.minipages_end() < text_needed(row, tuple, false)) return std::nullopt;
+
+    write_row(row, tuple, false);
+    set_bit(geo_.deleted_offset(), row, false);
+    write16(8, static_cast<uint16_t>(row + 1));
+    write16(12, static_cast<uint16_t>(live_count() + 1));
+    return row;
+}
+
+bool PaxPage::get(uint16_t row, std::vector<uint8_t>& out) const {
+    if (!is_live(row)) return false;
+    const TupleLayout& layout = geo_.layout();
+    out.assign(layout.fixed_size(), 0);
+    for (size_t c = 0; c < layout.column_count(); ++c) {
+        if (is_null(row, c)) {
+            out[c >> 3] |= uint8_t(1u << (c & 7));
+            continue;
+        }
+        DataType::Kind kind = layout.type(c);
+        size_t width = TupleLayout::field_width(kind);
+        const uint8_t* field = data_ + geo_.value_offset(c) + size_t(row) * width;
+        if (kind != DataType::Text) {
+            std::memcpy(out.data() + layout.field_offset(c), field, width);
+            continue;
+        }
+        std::string_view text = get_text(row, c);
+        uint16_t rel = static_cast<uint16_t>(out.size());
+        uint16_t len = static_cast<uint16_t>(text.size());
+        std::memcpy(out.data() + layout.field_offset(c), &rel, 2);
+        std::memcpy(out.data() + layout.field_offset(c) + 2, &len, 2);
+        out.insert(out.end(), text.begin(), text.end());
+    }
+    return true;
+}
+
+bool PaxPage::remove(uint16_t row) {
+    if (!is_live(row)) return false;
+    set_bit(geo_.deleted_offset(), row, true);
+    write16(12, static_cast<uint16_t>(live_count() - 1));
+    return true;
+}
+
+bool PaxPage::update(uint16_t row, const uint8_t* tuple, size_t) {
+    if (!is_live(row)) return false;
+    if (text_start() - geo_.minipages_end() < text_needed(row, tuple, true)) return false;
+    write_row(row, tuple, true);
+    return true;
+}
+
+std::string_view PaxPage::get_text(uint16_t row, size_t col) const {
+    size_t field = geo_.value_offset(col) + size_t(row) * 4;
+    return std::string_view(reinterpret_cast<const char*>(data_) + read16(field), read16(field + 2));
+}
@@ -0,0 +1,102 @@
+#include "storage/slotted_page.hpp"
+#include <algorithm>
+#include <cstring>
+
+void SlottedPage::init(uint8_t* data) {
+    std::memset(data + PAGE_LSN_SIZE, 0, PAGE_SIZE - PAGE_LSN_SIZE);
+    SlottedPage page(data);
+    page.set_slot_count(0);
+    page.set_data_start(static_cast<uint16_t>(PAGE_SIZE));
+    page.set_garbage(0);
+}
+
+size_t SlottedPage::free_space() const {
+    return contiguous_free() + garbage();
+}
+
+std::optional<uint16_t> SlottedPage::find_free_slot() const {
+    uint16_t n = slot_count();
+    for (uint16_t s = 0; s < n; ++s) {
+        if (slot_offset(s) == 0) return s;
+    }
+    return std::nullopt;
+}
+
+std::optional<uint16_t> SlottedPage::insert(const uint8_t* tuple, size_t size) {
+    if (size > MAX_TUPLE_SIZE) return std::nullopt;
+    auto reuse = find_free_slot();
+    size_t need = size + (reuse ? 0 : SLOT_SIZE);
+    if (contiguous_free() < need) {
+        if (free_space() < need) return std::nullopt;
+        compact();
+    }
+
+    uint16_t slot = reuse ? *reuse : slot_count();
+    if (!reuse) set_slot_count(slot + 1);
+    uint16_t offset = static_cast<uint16_t>(data_start() - size);
+    std::memcpy(data_ + offset, tuple, size);
+    set_data_start(offset);
+    set_slot(slot, offset, static_cast<uint16_t>(size));
+    return slot;
+}
+
+std::optional<TupleRef> SlottedPage::get(uint16_t slot) const {
+    if (slot >= slot_count() || slot_offset(slot) == 0) return std::nullopt;
+    return TupleRef{data_ + slot_offset(slot), slot_length(slot)};
+}
+
+bool SlottedPage::remove(uint16_t slot) {
+    if (slot >= slot_count() || slot_offset(slot) == 0) return false;
+    set_garbage(static_cast<uint16_t>(garbage() + slot_length(slot)));
+    set_slot(slot, 0, 0);
+    // Trailing unused slots give their directory space back.
+    uint16_t n = slot_count();
+    while (n > 0 && slot_offset(n - 1) == 0) n--;
+    set_slot_count(n);
+    return true;
+}
+
+bool SlottedPage::update(uint16_t slot, const uint8_t* tuple, size_t size) {
+    if (slot >= slot_count() || slot_offset(slot) == 0) return false;
+    uint16_t old_offset = slot_offset(slot);
+    uint16_t old_length = slot_length(slot);
+
+    if (size <= old_length) {
+        std::memmove(data_ + old_offset, tuple, size);
+        set_slot(slot, old_offset, static_cast<uint16_t>(size));
+        set_garbage(static_cast<uint16_t>(garbage() + old_length - size));
+        return true;
+    }
+    if (free_space() + old_length < size) return false;
+
+    if (contiguous_free() < size) {
+        // Drop the old version first so compaction reclaims its bytes as well.
+        set_slot(slot, 0, 0);
+        set_garbage(static_cast<uint16_t>(garbage() + old_length));
+        compact();
+    } else {
+        set_garbage(static_cast<uint16_t>(garbage() + old_length));
+    }
+    uint16_t offset = static_cast<uint16_t>(data_start() - size);
+    std::memcpy(data_ + offset, tuple, size);
+    set_data_start(offset);
+    set_slot(slot, offset, static_cast<uint16_t>(size));
+    return true;
+}
+
+void SlottedPage::compact() {
+    uint8_t scratch[PAGE_SIZE];
+    uint16_t n = slot_count();
+    size_t end = PAGE_SIZE;
+    for (uint16_t s = 0; s < n; ++s) {
+        uint16_t off = slot_offset(s);
+        if (off == 0) continue;
+        uint16_t len = slot_length(s);
+        end -= len;
+        std::memcpy(scratch + end, data_ + off, len);
+        set_slot(s, static_cast<uint16_t>(end), len);
+    }
+    std::memcpy(data_ + end, scratch + end, PAGE_SIZE - end);
+    set_data_start(static_cast<uint16_t>(end));
+    set_garbage(0);
+}
@@ -0,0 +1,134 @@
+#include "storage/tuple.hpp"
+#include <stdexcept>
+#include "storage/slotted_page.hpp"
+
+namespace {
+
+const char* type_name(DataType::Kind kind) {
+    switch (kind) {
+        case DataType::Int: return "INT";
+        case DataType::Real: return "REAL";
+        case DataType::Text: return "TEXT";
+        case DataType::Bool: return "BOOL";
+        case DataType::Custom: break;
+    }
+    return "custom type";
+}
+
+template<typename T>
+void store(uint8_t* p, T v) { std::memcpy(p, &v, sizeof(T)); }
+
+}
+
+size_t TupleLayout::field_width(DataType::Kind kind) {
+    switch (kind) {
+        case DataType::Int: return sizeof(long long);
+        case DataType::Real: return sizeof(double);
+        case DataType::Text: return 2 * sizeof(uint16_t);
+        case DataType::Bool: return 1;
+        case DataType::Custom: break;
+    }
+    return 0;
+}
+
+TupleLayout::TupleLayout(std::vector<ColumnDef> columns) : columns_(std::move(columns)) {
+    size_t offset = (columns_.size() + 7) / 8;
+    offsets_.reserve(columns_.size());
+    for (const auto& col : columns_) {
+        if (col.data_type.kind == DataType::Custom) {
+            throw std::invalid_argument("Column '" + col.name + "' has unsupported type '" +
+                                        col.data_type.custom + "'");
+        }
+        offsets_.push_back(static_cast<uint16_t>(offset));
+        offset += field_width(col.data_type.kind);
+    }
+    if (offset > SlottedPage::MAX_TUPLE_SIZE) {
+        throw std::invalid_argument("Too many columns for one record");
+    }
+    fixed_size_ = offset;
+}
+
+std::optional<size_t> TupleLayout::column_index(std::string_view name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name == name) return i;
+    }
+    return std::nullopt;
+}
+
+void TupleLayout::encode(const Value* values, std::vector<uint8_t>& out) const {
+    size_t base = out.size();
+    out.resize(base + fixed_size_, 0);
+
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        const Value& v = values[c];
+        DataType::Kind kind = columns_[c].data_type.kind;
+        if (v.kind == Value::Null) {
+            out[base + (c >> 3)] |= uint8_t(1u << (c & 7));
+            continue;
+        }
+
+        size_t field = base + offsets_[c];
+        bool ok = true;
+        switch (kind) {
+            case DataType::Int:
+                ok = v.kind == Value::Int;
+                if (ok) store(&out[field], v.i);
+                break;
+            case DataType::Real:
+                ok = v.kind == Value::Float || v.kind == Value::Int;
+                if (ok) store(&out[field], v.kind == Value::Int ? static_cast<double>(v.i) : v.f);
+                break;
+            case DataType::Bool:
+                ok = v.kind == Value::Bool;
+                if (ok) out[field] = v.b ? 1 : 0;
+                break;
+            case DataType::Text: {
+                ok = v.kind == Value::String;
+                if (!ok) break;
+                size_t rel = out.size() - base;
+                if (rel + v.s.size() > SlottedPage::MAX_TUPLE_SIZE) {
+                    throw std::invalid_argument("Record too large for column '" + columns_[c].name + "'");
+                }
+                store(&out[field], static_cast<uint16_t>(rel));
+                store(&out[field + 2], static_cast<uint16_t>(v.s.size()));
+                out.insert(out.end(), v.s.begin(), v.s.end());
+                break;
+            }
+            case DataType::Custom:
+                ok = false;
+                break;
+        }
+        if (!ok) {
+            out.resize(base);
+            throw std::invalid_argument("Column '" + columns_[c].name + "' expects " + type_name(kind));
+        }
+    }
+}
+
+std::vector<uint8_t> TupleLayout::encode(const std::vector<Value>& values) const {
+    if (values.size() != columns_.size()) {
+        throw std::invalid_argument("Expected " + std::to_string(columns_.size()) + " values, got " +
+                                    std::to_string(values.size()));
+    }
+    std::vector<uint8_t> out;
+    encode(values.data(), out);
+    return out;
+}
+
+void TupleLayout::decode(const uint8_t* data, std::vector<Value>& out) const {
+    out.resize(columns_.size());
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        Value& v = out[c];
+        if (is_null(data, c)) {
+            v.kind = Value::Null;
+            continue;
+        }
+        switch (columns_[c].data_type.kind) {
+            case DataType::Int: v.kind = Value::Int; v.i = get_int(data, c); break;
+            case DataType::Real: v.kind = Value::Float; v.f = get_real(data, c); break;
+            case DataType::Bool: v.kind = Value::Bool; v.b = get_bool(data, c); break;
+            case DataType::Text: v.kind = Value::String; v.s.assign(get_text(data, c)); break;
+            case DataType::Custom: v.kind = Value::Null; break;
+        }
+    }
+}
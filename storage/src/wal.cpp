@@ -0,0 +1,291 @@
+#include "storage/wal.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+// Equal bytes between two changed ones that a diff run absorbs: a run header costs 4
+// bytes, so merging across a gap this short never makes the record larger.
+constexpr size_t RUN_GAP = 4;
+
+template<typename T>
+T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template<typename T>
+void store(uint8_t* p, T v) {
+    std::memcpy(p, &v, sizeof(T));
+}
+
+template<typename T>
+void put(std::vector<uint8_t>& out, T v) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &v, sizeof(T));
+}
+
+uint32_t checksum(uint32_t type, const uint8_t* payload, size_t size) {
+    uint32_t h = 2166136261u;
+    auto mix = [&](uint8_t b) { h = (h ^ b) * 16777619u; };
+    for (int i = 0; i < 4; ++i) mix(uint8_t(type >> (8 * i)));
+    for (size_t i = 0; i < size; ++i) mix(payload[i]);
+    return h;
+}
+
+/*
+* Reads the valid records of `file_name` starting at byte `from` (a record boundary)
+* and returns the end of the last one: a short read, an impossible length or a checksum
+* mismatch ends the log.
+*/
+template<typename Fn>
+Lsn read_records(const std::string& file_name, Lsn from, Fn&& fn) {
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in.is_open()) return from;
+    in.seekg(static_cast<std::streamoff>(from));
+    Lsn pos = from;
+    uint8_t header[LogManager::HEADER_SIZE];
+    std::vector<uint8_t> payload;
+    while (in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        uint32_t length = load<uint32_t>(header);
+        if (length < LogManager::HEADER_SIZE || length > (uint32_t(1) << 30)) break;
+        payload.resize(length - LogManager::HEADER_SIZE);
+        if (!in.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size()))) break;
+        uint32_t type = load<uint32_t>(header + 8);
+        if (checksum(type, payload.data(), payload.size()) != load<uint32_t>(header + 4)) break;
+        pos += length;
+        fn(pos, static_cast<LogRecordType>(type), payload.data(), payload.size());
+    }
+    return pos;
+}
+
+}
+
+
+LogManager::LogManager(std::string file_name, size_t buffer_size)
+    : file_name_(std::move(file_name)), master_file_(file_name_ + ".master"), capacity_(buffer_size) {
+    if (capacity_ < 4 * PAGE_SIZE) {
+        throw std::invalid_argument("Log buffer must hold at least 4 pages");
+    }
+    ring_ = std::make_unique<uint8_t[]>(capacity_);
+    fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open log file '" + file_name_ + "'");
+    }
+    Lsn end = read_records(file_name_, 0, [](Lsn, LogRecordType, const uint8_t*, size_t) {});
+    if (::ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot truncate log file '" + file_name_ + "'");
+    }
+    next_lsn_.store(end);
+    published_.store(end);
+    written_.store(end);
+    durable_lsn_.store(end);
+}
+
+LogManager::~LogManager() {
+    try {
+        flush(end_lsn());
+    } catch (...) {
+    }
+    ::close(fd_);
+}
+
+void LogManager::copy_into_ring(Lsn at, const uint8_t* data, size_t size) {
+    size_t offset = at % capacity_;
+    size_t first = std::min(size, capacity_ - offset);
+    std::memcpy(ring_.get() + offset, data, first);
+    std::memcpy(ring_.get(), data + first, size - first);
+}
+
+Lsn LogManager::append(LogRecordType type, const uint8_t* payload, size_t size) {
+    size_t total = HEADER_SIZE + size;
+    if (total > capacity_) {
+        throw std::invalid_argument("Log record of " + std::to_string(total) + " bytes exceeds the log buffer");
+    }
+    uint8_t header[HEADER_SIZE];
+    store<uint32_t>(header, static_cast<uint32_t>(total));
+    store<uint32_t>(header + 4, checksum(static_cast<uint32_t>(type), payload, size));
+    store<uint32_t>(header + 8, static_cast<uint32_t>(type));
+
+    Lsn start = next_lsn_.fetch_add(total, std::memory_order_acq_rel);
+    Lsn end = start + total;
+    while (end - written_.load(std::memory_order_acquire) > capacity_) {
+        /*
+        * The ring still holds unwritten bytes where this record goes. Whoever holds
+        * flush_mutex_ is writing them out; otherwise do it here.
+        */
+        std::unique_lock<std::mutex> lock(flush_mutex_, std::try_to_lock);
+        if (lock.owns_lock()) {
+            write_published();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    copy_into_ring(start, header, HEADER_SIZE);
+    if (size > 0) copy_into_ring(start + HEADER_SIZE, payload, size);
+
+    // Publish in LSN order, so the published prefix never has a hole.
+    while (published_.load(std::memory_order_acquire) != start) {
+        std::this_thread::yield();
+    }
+    published_.store(end, std::memory_order_release);
+    return end;
+}
+
+std::optional<Lsn> LogManager::log_page_diff(const std::string& file_name, uint64_t page_id,
+                                             const uint8_t* before, const uint8_t* after) {
+    thread_local std::vector<uint8_t> payload;
+    payload.clear();
+    put(payload, static_cast<uint16_t>(file_name.size()));
+    payload.insert(payload.end(), file_name.begin(), file_name.end());
+    put(payload, page_id);
+    size_t runs_at = payload.size();
+    put<uint16_t>(payload, 0);
+
+    uint16_t runs = 0;
+    for (size_t i = PAGE_LSN_SIZE; i < PAGE_SIZE;) {
+        if (before[i] == after[i]) {
+            ++i;
+            continue;
+        }
+        size_t last = i;
+        for (size_t j = i + 1; j < PAGE_SIZE && j - last <= RUN_GAP; ++j) {
+            if (before[j] != after[j]) last = j;
+        }
+        put(payload, static_cast<uint16_t>(i));
+        put(payload, static_cast<uint16_t>(last - i + 1));
+        payload.insert(payload.end(), after + i, after + last + 1);
+        runs++;
+        i = last + 1;
+    }
+    if (runs == 0) return std::nullopt;
+    store(payload.data() + runs_at, runs);
+    return append(LogRecordType::PageDiff, payload.data(), payload.size());
+}
+
+Lsn LogManager::commit() {
+    Lsn lsn = append(LogRecordType::Commit, nullptr, 0);
+    flush(lsn);
+    return lsn;
+}
+
+void LogManager::write_published() {
+    Lsn from = written_.load(std::memory_order_relaxed);
+    Lsn to = published_.load(std::memory_order_acquire);
+    while (from < to) {
+        size_t offset = from % capacity_;
+        size_t n = std::min<size_t>(to - from, capacity_ - offset);
+        ssize_t done = ::pwrite(fd_, ring_.get() + offset, n, static_cast<off_t>(from));
+        if (done <= 0) {
+            throw std::runtime_error("Cannot write log file '" + file_name_ + "'");
+        }
+        from += static_cast<size_t>(done);
+    }
+    written_.store(to, std::memory_order_release);
+}
+
+void LogManager::flush(Lsn lsn) {
+    lsn = std::min(lsn, end_lsn());
+    if (durable_lsn_.load(std::memory_order_acquire) >= lsn) return;
+    // Records below lsn may still be being copied in by their writers.
+    while (published_.load(std::memory_order_acquire) < lsn) {
+        std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(flush_mutex_);
+    if (durable_lsn_.load(std::memory_order_acquire) >= lsn) return;
+    write_published();
+    if (::fsync(fd_) != 0) {
+        throw std::runtime_error("Cannot sync log file '" + file_name_ + "'");
+    }
+    sync_count_.fetch_add(1);
+    durable_lsn_.store(written_.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+void LogManager::scan(Lsn from, const std::function<void(Lsn, LogRecordType, const uint8_t*, size_t)>& fn) {
+    flush(end_lsn());
+    read_records(file_name_, from, fn);
+}
+
+size_t LogManager::recover(Lsn from) {
+    struct Page {
+        std::vector<uint8_t> data;
+        bool changed = false;
+    };
+    std::map<std::pair<std::string, uint64_t>, Page> pages;
+    size_t applied = 0;
+    scan(from, [&](Lsn lsn, LogRecordType type, const uint8_t* p, size_t) {
+        if (type != LogRecordType::PageDiff) return;
+        uint16_t name_size = load<uint16_t>(p);
+        std::string file(reinterpret_cast<const char*>(p + 2), name_size);
+        p += 2 + name_size;
+        uint64_t page_id = load<uint64_t>(p);
+        uint16_t runs = load<uint16_t>(p + 8);
+        p += 10;
+
+        Page& page = pages[{file, page_id}];
+        if (page.data.empty()) page.data = read_page(file, page_id);
+        if (load<Lsn>(page.data.data() + PAGE_LSN_OFFSET) >= lsn) return;
+        for (uint16_t r = 0; r < runs; ++r) {
+            uint16_t offset = load<uint16_t>(p);
+            uint16_t length = load<uint16_t>(p + 2);
+            std::memcpy(page.data.data() + offset, p + 4, length);
+            p += 4 + length;
+        }
+        store(page.data.data() + PAGE_LSN_OFFSET, lsn);
+        page.changed = true;
+        applied++;
+    });
+
+    std::string last_file;
+    for (const auto& [id, page] : pages) {
+        if (!page.changed) continue;
+        write_page(id.first, id.second, page.data);
+        if (id.first != last_file) {
+            if (!last_file.empty()) sync_file(last_file);
+            last_file = id.first;
+        }
+    }
+    if (!last_file.empty()) sync_file(last_file);
+    return applied;
+}
+
+void LogManager::complete_checkpoint(Lsn begin) {
+    uint8_t payload[sizeof(Lsn)];
+    store(payload, begin);
+    flush(append(LogRecordType::CheckpointEnd, payload, sizeof(payload)));
+
+    /*
+    * Replace the master file atomically, so a crash leaves either the previous
+    * checkpoint or this one.
+    */
+    std::string tmp = master_file_ + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(payload), sizeof(payload));
+        if (!out) throw std::runtime_error("Cannot write '" + tmp + "'");
+    }
+    sync_file(tmp);
+    if (std::rename(tmp.c_str(), master_file_.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace '" + master_file_ + "'");
+    }
+}
+
+Lsn LogManager::last_checkpoint() const {
+    std::ifstream in(master_file_, std::ios::binary);
+    uint8_t payload[sizeof(Lsn)];
+    if (!in.read(reinterpret_cast<char*>(payload), sizeof(payload))) return 0;
+    return load<Lsn>(payload);
+}
@@ -0,0 +1,101 @@
+#include "storage/zone_map.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+
+ZoneMap::ZoneMap(std::string file_name, const TupleLayout& schema, BufferPoolManager& bpm)
+    : file_name_(std::move(file_name)), schema_(schema), bpm_(bpm) {
+    if (schema_.column_count() > MAX_COLUMNS) {
+        throw std::invalid_argument("Zone map for '" + file_name_ + "' cannot hold " +
+                                    std::to_string(schema_.column_count()) + " columns");
+    }
+    per_page_ = (PAGE_SIZE - PAGE_LSN_SIZE) / (std::max<size_t>(schema_.column_count(), 1) * sizeof(Zone));
+}
+
+void ZoneMap::widen(Zone* zones, const uint8_t* tuple) const {
+    for (size_t c = 0; c < schema_.column_count(); ++c) {
+        Zone one{};
+        if (schema_.is_null(tuple, c)) {
+            one.has_nulls = 1;
+        } else {
+            one.has_values = 1;
+            switch (schema_.type(c)) {
+                case DataType::Int: one.min = one.max = schema_.get_int(tuple, c); break;
+                case DataType::Real: {
+                    double v = schema_.get_real(tuple, c);
+                    std::memcpy(&one.min, &v, sizeof(v));
+                    one.max = one.min;
+                    break;
+                }
+                case DataType::Bool: one.min = one.max = schema_.get_bool(tuple, c); break;
+                case DataType::Text:
+                case DataType::Custom: break;
+            }
+        }
+        widen(zones[c], one, schema_.type(c));
+    }
+}
+
+bool ZoneMap::widen(Zone& into, const Zone& from, DataType::Kind type) const {
+    bool changed = false;
+    if (from.has_nulls && !into.has_nulls) {
+        into.has_nulls = 1;
+        changed = true;
+    }
+    if (!from.has_values) return changed;
+    if (!into.has_values) {
+        into.has_values = 1;
+        into.min = from.min;
+        into.max = from.max;
+        return true;
+    }
+    if (type == DataType::Real) {
+        if (from.min_real() < into.min_real()) { into.min = from.min; changed = true; }
+        if (from.max_real() > into.max_real()) { into.max = from.max; changed = true; }
+    } else if (type != DataType::Text && type != DataType::Custom) {
+        if (from.min < into.min) { into.min = from.min; changed = true; }
+        if (from.max > into.max) { into.max = from.max; changed = true; }
+    }
+    return changed;
+}
+
+void ZoneMap::merge(uint64_t page_id, const Zone* zones) {
+    if (page_id == 0) return;
+    uint64_t map_page = (page_id - 1) / per_page_;
+    size_t at = PAGE_LSN_SIZE + (page_id - 1) % per_page_ * column_count() * sizeof(Zone);
+    size_t n = column_count();
+
+    // Most merges change nothing; find that out under a read latch.
+    std::vector<Zone> stored(n);
+    {
+        auto page = bpm_.fetch_page_read(file_name_, map_page);
+        std::memcpy(stored.data(), page->data() + at, n * sizeof(Zone));
+    }
+    bool changed = false;
+    for (size_t c = 0; c < n; ++c) changed |= widen(stored[c], zones[c], schema_.type(c));
+    if (!changed) return;
+
+    // Widened again from what is there now: another writer may have widened it meanwhile.
+    auto page = bpm_.fetch_page_write(file_name_, map_page);
+    std::memcpy(stored.data(), page->data() + at, n * sizeof(Zone));
+    changed = false;
+    for (size_t c = 0; c < n; ++c) changed |= widen(stored[c], zones[c], schema_.type(c));
+    if (!changed) return;
+    std::memcpy(page->data() + at, stored.data(), n * sizeof(Zone));
+    page.mark_dirty();
+}
+
+void ZoneMap::add(uint64_t page_id, const uint8_t* tuple) {
+    std::vector<Zone> zones = empty();
+    widen(zones.data(), tuple);
+    merge(page_id, zones.data());
+}
+
+void ZoneMap::read(uint64_t page_id, std::vector<Zone>& out) {
+    out.resize(column_count());
+    if (page_id == 0) return;
+    uint64_t map_page = (page_id - 1) / per_page_;
+    size_t at = PAGE_LSN_SIZE + (page_id - 1) % per_page_ * column_count() * sizeof(Zone);
+    auto page = bpm_.fetch_page_read(file_name_, map_page);
+    std::memcpy(out.data(), page->data() + at, out.size() * sizeof(Zone));
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "storage/btree.hpp"
+#include "storage/wal.hpp"
+
+
+class BPlusTreeTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() /
+                ("btree_" + std::string(name) + "_" + std::to_string(::getpid()) + ".idx")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".log");
+        std::filesystem::remove(path + ".log.master");
+    }
+};
+
+static RID rid_for(int64_t i) { return RID{uint64_t(i / 100 + 1), uint16_t(i % 100)}; }
+
+static std::vector<IndexEntry> scan_all(BPlusTree& tree, int64_t lo, int64_t hi) {
+    std::vector<IndexEntry> out;
+    tree.scan(lo, hi, [&](const IndexEntry& e) {
+        out.push_back(e);
+        return true;
+    });
+    return out;
+}
+
+
+TEST_F(BPlusTreeTest, EmptyTreeFindsNothing) {
+    BufferPoolManager bpm(8);
+    BPlusTree tree(path, bpm);
+    EXPECT_EQ(tree.height(), 0u);
+    EXPECT_TRUE(tree.find(1).empty());
+    EXPECT_TRUE(scan_all(tree, INT64_MIN, INT64_MAX).empty());
+    EXPECT_FALSE(tree.remove(1, RID{1, 0}));
+}
+
+TEST_F(BPlusTreeTest, RandomInsertsSplitAndStaySorted) {
+    constexpr int64_t N = 100000;
+    std::vector<int64_t> keys(N);
+    for (int64_t i = 0; i < N; ++i) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+    BufferPoolManager bpm(64);
+    BPlusTree tree(path, bpm);
+    for (int64_t k : keys) ASSERT_TRUE(tree.insert(k, rid_for(k)));
+    EXPECT_FALSE(tree.insert(keys[0], rid_for(keys[0])));
+    EXPECT_EQ(tree.height(), 2u);
+
+    auto all = scan_all(tree, INT64_MIN, INT64_MAX);
+    ASSERT_EQ(all.size(), size_t(N));
+    for (int64_t i = 0; i < N; ++i) {
+        EXPECT_EQ(all[i].key, i);
+        EXPECT_EQ(all[i].rid, rid_for(i));
+    }
+    EXPECT_EQ(tree.find(4242), std::vector<RID>{rid_for(4242)});
+
+    auto range = scan_all(tree, 500, 1499);
+    ASSERT_EQ(range.size(), 1000u);
+    EXPECT_EQ(range.front().key, 500);
+    EXPECT_EQ(range.back().key, 1499);
+}
+
+TEST_F(BPlusTreeTest, DuplicateKeysAndRemoval) {
+    BufferPoolManager bpm(16);
+    BPlusTree tree(path, bpm);
+    // 1000 RIDs for each of three keys: duplicates span several leaves.
+    for (uint16_t s = 0; s < 1000; ++s) {
+        for (int64_t k : {5, 1, 9}) ASSERT_TRUE(tree.insert(k, RID{uint64_t(k), s}));
+    }
+    auto fives = tree.find(5);
+    ASSERT_EQ(fives.size(), 1000u);
+    EXPECT_TRUE(std::is_sorted(fives.begin(), fives.end()));
+
+    for (uint16_t s = 0; s < 1000; s += 2) ASSERT_TRUE(tree.remove(5, RID{5, s}));
+    EXPECT_FALSE(tree.remove(5, RID{5, 0}));
+    EXPECT_FALSE(tree.remove(6, RID{5, 1}));
+    EXPECT_EQ(tree.find(5).size(), 500u);
+    EXPECT_EQ(tree.find(1).size(), 1000u);
+    EXPECT_EQ(scan_all(tree, 2, 8).size(), 500u);
+    EXPECT_TRUE(scan_all(tree, 6, 8).empty());
+
+    int seen = 0;
+    tree.scan(0, 10, [&](const IndexEntry&) { return ++seen < 10; });
+    EXPECT_EQ(seen, 10);
+}
+
+TEST_F(BPlusTreeTest, BulkLoadThenInsertAndReopen) {
+    constexpr int64_t N = 200000;
+    std::vector<IndexEntry> sorted;
+    for (int64_t i = 0; i < N; ++i) sorted.push_back(IndexEntry{2 * i, rid_for(i)});
+    {
+        BufferPoolManager bpm(32);
+        BPlusTree tree(path, bpm);
+        tree.bulk_load(sorted);
+        EXPECT_GE(tree.height(), 3u);
+        EXPECT_THROW(tree.bulk_load(sorted), std::invalid_argument);
+
+        // Odd keys land between the loaded ones and split the 90%-full leaves.
+        for (int64_t i = 0; i < 5000; ++i) ASSERT_TRUE(tree.insert(2 * i + 1, rid_for(i)));
+        bpm.flush_all_pages();
+    }
+    BufferPoolManager bpm(32);
+    {
+        BPlusTree tree(path, bpm);
+        auto head = scan_all(tree, 0, 9999);
+        ASSERT_EQ(head.size(), 10000u);
+        for (int64_t k = 0; k < 10000; ++k) EXPECT_EQ(head[k].key, k);
+        EXPECT_EQ(scan_all(tree, 10000, INT64_MAX).size(), size_t(N - 5000));
+        EXPECT_EQ(tree.find(2 * (N - 1)), std::vector<RID>{rid_for(N - 1)});
+    }
+
+    BPlusTree unsorted(path + ".2", bpm);
+    std::swap(sorted[10], sorted[11]);
+    EXPECT_THROW(unsorted.bulk_load(sorted), std::invalid_argument);
+    std::filesystem::remove(path + ".2");
+}
+
+TEST_F(BPlusTreeTest, ConcurrentInsertsAndScans) {
+    constexpr int THREADS = 4;
+    constexpr int64_t PER_THREAD = 20000;
+    BufferPoolManager bpm(64);
+    BPlusTree tree(path, bpm);
+    std::atomic<bool> done{false};
+    std::atomic<bool> unsorted{false};
+
+    std::thread reader([&] {
+        while (!done.load()) {
+            int64_t prev = INT64_MIN;
+            tree.scan(INT64_MIN, INT64_MAX, [&](const IndexEntry& e) {
+                if (e.key < prev) unsorted = true;
+                prev = e.key;
+                return true;
+            });
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t) {
+        writers.emplace_back([&, t] {
+            // Interleaved keys make the threads split the same leaves.
+            for (int64_t i = 0; i < PER_THREAD; ++i) tree.insert(i * THREADS + t, rid_for(i));
+        });
+    }
+    for (auto& th : writers) th.join();
+    done = true;
+    reader.join();
+
+    EXPECT_FALSE(unsorted.load());
+    auto all = scan_all(tree, INT64_MIN, INT64_MAX);
+    ASSERT_EQ(all.size(), size_t(THREADS * PER_THREAD));
+    for (size_t i = 0; i < all.size(); ++i) EXPECT_EQ(all[i].key, int64_t(i));
+}
+
+TEST_F(BPlusTreeTest, PagesAllocatedBeforeACrashAreNotReused) {
+    constexpr int64_t N = 20000;
+    std::string log_path = path + ".log";
+    std::string saved = path + ".crash";
+    {
+        LogManager log(log_path);
+        BufferPoolManager bpm(16, &log);
+        BPlusTree tree(path, bpm);
+        for (int64_t k = 0; k < N; ++k) ASSERT_TRUE(tree.insert(k, rid_for(k)));
+        ASSERT_EQ(tree.height(), 2u);
+        log.commit();
+        // Crash here: the files as they are now, before the tree records its page count.
+        std::filesystem::copy_file(path, saved);
+        std::filesystem::copy_file(log_path, saved + ".log");
+    }
+    std::filesystem::rename(saved, path);
+    std::filesystem::rename(saved + ".log", log_path);
+
+    LogManager log(log_path);
+    log.recover();
+    BufferPoolManager bpm(16);
+    BPlusTree tree(path, bpm);
+    for (int64_t k = N; k < 2 * N; ++k) ASSERT_TRUE(tree.insert(k, rid_for(k)));
+    auto all = scan_all(tree, INT64_MIN, INT64_MAX);
+    ASSERT_EQ(all.size(), size_t(2 * N));
+    for (int64_t i = 0; i < 2 * N; ++i) ASSERT_EQ(all[i].key, i);
+}
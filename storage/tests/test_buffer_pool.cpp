@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include <unistd.h>
+#include "storage/buffer_pool.hpp"
+#include "storage/free_frame_list.hpp"
+
+
+class BufferPoolTest : public ::testing::Test {
+protected:
+    std::string temp_file(const std::string& name) {
+        auto tmp = std::filesystem::temp_directory_path();
+        auto pid = std::to_string(::getpid());
+        std::string filename = "bufpool_" + name + "_" + pid + ".bin";
+        auto path = tmp / filename;
+        std::filesystem::remove(path);
+        return path.string();
+    }
+};
+
+
+TEST(FreeFrameListTest, PushPopIsLifo) {
+    FreeFrameList list(4);
+    EXPECT_FALSE(list.pop().has_value());
+    list.push(0);
+    list.push(3);
+    list.push(2);
+    EXPECT_EQ(list.size(), 3u);
+    EXPECT_EQ(list.pop(), std::optional<size_t>(2));
+    EXPECT_EQ(list.pop(), std::optional<size_t>(3));
+    EXPECT_EQ(list.pop(), std::optional<size_t>(0));
+    EXPECT_FALSE(list.pop().has_value());
+    EXPECT_EQ(list.size(), 0u);
+}
+
+TEST(FreeFrameListTest, ConcurrentPopPushKeepsEveryFrameOnce) {
+    constexpr size_t FRAMES = 64;
+    constexpr int THREADS = 8;
+    constexpr int ITERATIONS = 20000;
+    FreeFrameList list(FRAMES);
+    for (size_t i = 0; i < FRAMES; ++i) list.push(i);
+
+    std::vector<std::atomic<int>> owners(FRAMES);
+    std::atomic<bool> double_owned{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                auto idx = list.pop();
+                if (!idx) continue;
+                if (owners[*idx].fetch_add(1) != 0) double_owned = true;
+                owners[*idx].fetch_sub(1);
+                list.push(*idx);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_FALSE(double_owned.load());
+    EXPECT_EQ(list.size(), FRAMES);
+    std::vector<bool> seen(FRAMES, false);
+    while (auto idx = list.pop()) {
+        ASSERT_LT(*idx, FRAMES);
+        EXPECT_FALSE(seen[*idx]);
+        seen[*idx] = true;
+    }
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](bool b) { return b; }));
+}
+
+
+TEST_F(BufferPoolTest, FetchWriteFlushAndReadBack) {
+    auto path = temp_file("rw");
+    BufferPoolManager bpm(8);
+    {
+        auto page = bpm.fetch_page_write(path, 1);
+        ASSERT_EQ(page->size(), PAGE_SIZE);
+        (*page)[0] = 42;
+        page.mark_dirty();
+    }
+    EXPECT_EQ(bpm.get_stats().dirty_frames, 1u);
+    EXPECT_TRUE(bpm.flush_page(path, 1));
+    EXPECT_EQ(read_page(path, 1)[0], 42);
+    {
+        auto page = bpm.fetch_page_read(path, 1);
+        EXPECT_EQ(page.data()[0], 42);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(BufferPoolTest, HandlesUnpinOnDestruction) {
+    auto path = temp_file("unpin");
+    BufferPoolManager bpm(4);
+    {
+        auto a = bpm.fetch_page_read(path, 0);
+        auto b = bpm.fetch_page_read(path, 0);
+        auto stats = bpm.get_stats();
+        EXPECT_EQ(stats.pinned_frames, 1u);
+        EXPECT_EQ(stats.free_frames, 3u);
+        auto moved = std::move(a);
+        EXPECT_FALSE(a.is_valid());
+        EXPECT_TRUE(moved.is_valid());
+    }
+    EXPECT_EQ(bpm.get_stats().pinned_frames, 0u);
+}
+
+TEST_F(BufferPoolTest, ThrowsWhenPoolExhausted) {
+    auto path = temp_file("exhaust");
+    BufferPoolManager bpm(2);
+    auto a = bpm.fetch_page_read(path, 0);
+    auto b = bpm.fetch_page_read(path, 1);
+    EXPECT_EQ(bpm.get_stats().free_frames, 0u);
+    EXPECT_THROW(bpm.fetch_page_read(path, 2), std::runtime_error);
+}
+
+TEST_F(BufferPoolTest, ConcurrentMissesLoadEachPageOnce) {
+    auto path = temp_file("concurrent");
+    constexpr int PAGES = 32;
+    BufferPoolManager bpm(PAGES);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int p = 0; p < PAGES; ++p) {
+                auto page = bpm.fetch_page_read(path, p);
+                EXPECT_EQ(page->size(), PAGE_SIZE);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    auto stats = bpm.get_stats();
+    EXPECT_EQ(stats.free_frames, 0u);
+    EXPECT_EQ(stats.pinned_frames, 0u);
+}
+
+TEST_F(BufferPoolTest, EvictsUnpinnedPagesAndWritesBackDirtyOnes) {
+    auto path = temp_file("evict");
+    BufferPoolManager bpm(3);
+    for (int p = 0; p < 10; ++p) {
+        auto page = bpm.fetch_page_write(path, p);
+        (*page)[0] = static_cast<uint8_t>(p + 1);
+        page.mark_dirty();
+    }
+    EXPECT_EQ(bpm.get_stats().free_frames, 0u);
+    EXPECT_EQ(read_page(path, 0)[0], 1);
+
+    for (int p = 0; p < 10; ++p) {
+        auto page = bpm.fetch_page_read(path, p);
+        EXPECT_EQ(page.data()[0], p + 1);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(BufferPoolTest, FailedEvictionKeepsThePageAndReleasesItsLatch) {
+    auto path = temp_file("evict_fail");
+    auto unwritable = (std::filesystem::temp_directory_path() / "no_such_dir" / "page").string();
+    BufferPoolManager bpm(1);
+    {
+        auto page = bpm.fetch_page_write(unwritable, 0);
+        (*page)[0] = 7;
+        page.mark_dirty();
+    }
+    EXPECT_THROW(bpm.fetch_page_read(path, 0), std::runtime_error);
+    {
+        // Still cached, still dirty, and not left latched by the failed eviction.
+        auto page = bpm.fetch_page_read(unwritable, 0);
+        EXPECT_EQ(page.data()[0], 7);
+    }
+    EXPECT_EQ(bpm.get_stats().dirty_frames, 1u);
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "storage/catalog.hpp"
+
+
+class CatalogTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() /
+                ("catalog_" + std::string(name) + "_" + std::to_string(::getpid()) + ".cat")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".fsm");
+    }
+};
+
+static ColumnDef column(std::string name, DataType::Kind kind) {
+    ColumnDef c;
+    c.name = std::move(name);
+    c.data_type.kind = kind;
+    return c;
+}
+
+static Statement::CreateTableData create(std::string name, std::vector<ColumnDef> columns,
+                                         TableLayout layout = TableLayout::Row) {
+    return Statement::CreateTableData{std::move(name), std::move(columns), layout};
+}
+
+
+TEST_F(CatalogTest, ResolvesTablesAndColumns) {
+    BufferPoolManager bpm(16);
+    Catalog catalog(path, bpm);
+    auto t = catalog.create_table(create("users", {column("id", DataType::Int), column("name", DataType::Text)}));
+    catalog.create_table(create("events", {column("at", DataType::Real)}, TableLayout::Pax));
+
+    auto snap = catalog.snapshot();
+    EXPECT_EQ(snap->table_count(), 2u);
+    const TableSchema& users = snap->table("users");
+    EXPECT_EQ(&users, t.get());
+    EXPECT_EQ(users.schema.column_index("name"), std::optional<size_t>(1));
+    EXPECT_EQ(users.schema.field_offset(1), 1u + 8u);
+    EXPECT_EQ(snap->table("events").layout, TableLayout::Pax);
+    EXPECT_NE(snap->table("events").file_name, users.file_name);
+    EXPECT_EQ(snap->find("missing"), nullptr);
+    EXPECT_THROW(snap->table("missing"), CatalogError);
+
+    std::vector<std::string> names;
+    snap->for_each([&](const TableSchema& s) { names.push_back(s.name); });
+    EXPECT_EQ(names, (std::vector<std::string>{"events", "users"}));
+}
+
+TEST_F(CatalogTest, RejectsConflictingDdl) {
+    BufferPoolManager bpm(16);
+    Catalog catalog(path, bpm);
+    catalog.create_table(create("t", {column("a", DataType::Int)}));
+    EXPECT_THROW(catalog.create_table(create("t", {column("b", DataType::Int)})), CatalogError);
+    EXPECT_THROW(catalog.create_table(create("u", {column("a", DataType::Int), column("a", DataType::Bool)})),
+                 std::invalid_argument);
+    ColumnDef custom = column("c", DataType::Custom);
+    custom.data_type.custom = "blob";
+    EXPECT_THROW(catalog.create_table(create("u", {custom})), std::invalid_argument);
+    EXPECT_EQ(catalog.snapshot()->table_count(), 1u);
+
+    EXPECT_THROW(catalog.drop_table({"u", false}), CatalogError);
+    EXPECT_FALSE(catalog.drop_table({"u", true}));
+    EXPECT_TRUE(catalog.drop_table({"t", false}));
+    EXPECT_EQ(catalog.snapshot()->table_count(), 0u);
+}
+
+TEST_F(CatalogTest, HeldSnapshotsDoNotChangeUntilRefreshed) {
+    BufferPoolManager bpm(16);
+    Catalog catalog(path, bpm);
+    catalog.create_table(create("t", {column("a", DataType::Int)}));
+
+    std::shared_ptr<const CatalogSnapshot> held;
+    catalog.refresh(held);
+    auto before = held;
+    catalog.refresh(held);
+    EXPECT_EQ(held, before);
+
+    catalog.drop_table({"t", false});
+    catalog.create_table(create("t", {column("a", DataType::Text), column("b", DataType::Int)}));
+    // The old schema stays valid through the held snapshot.
+    EXPECT_EQ(held->table("t").schema.column_count(), 1u);
+    catalog.refresh(held);
+    EXPECT_GT(held->version(), before->version());
+    EXPECT_EQ(held->table("t").schema.column_count(), 2u);
+    EXPECT_NE(held->table("t").id, before->table("t").id);
+}
+
+TEST_F(CatalogTest, SnapshotsAreCachedPerThreadAndCatalog) {
+    BufferPoolManager bpm(16);
+    Catalog catalog(path, bpm);
+    Catalog other(path + ".other", bpm);
+    other.create_table(create("o", {column("a", DataType::Int)}));
+
+    auto first = catalog.snapshot();
+    EXPECT_EQ(other.snapshot()->table_count(), 1u);
+    EXPECT_EQ(catalog.snapshot(), first);
+    catalog.create_table(create("t", {column("a", DataType::Int)}));
+    auto second = catalog.snapshot();
+    EXPECT_NE(second, first);
+    EXPECT_EQ(second->table_count(), 1u);
+    EXPECT_EQ(catalog.snapshot(), second);
+
+    // Another thread gets the same current snapshot through its own cache.
+    std::shared_ptr<const CatalogSnapshot> seen;
+    std::thread([&] { seen = catalog.snapshot(); }).join();
+    EXPECT_EQ(seen, second);
+
+    // The cache does not keep a destroyed catalog's snapshot alive.
+    std::weak_ptr<const CatalogSnapshot> last;
+    {
+        Catalog gone(path + ".gone", bpm);
+        gone.create_table(create("g", {column("a", DataType::Int)}));
+        last = gone.snapshot();
+        EXPECT_FALSE(last.expired());
+    }
+    EXPECT_TRUE(last.expired());
+    for (const char* suffix : {".other", ".other.fsm", ".gone", ".gone.fsm"}) {
+        std::filesystem::remove(path + suffix);
+    }
+}
+
+TEST_F(CatalogTest, SurvivesReopen) {
+    uint32_t dropped_id;
+    {
+        BufferPoolManager bpm(16);
+        Catalog catalog(path, bpm);
+        catalog.create_table(create("a", {column("x", DataType::Int), column("y", DataType::Bool)}, TableLayout::Pax));
+        dropped_id = catalog.create_table(create("b", {column("z", DataType::Text)}))->id;
+        catalog.create_table(create("c", {column("w", DataType::Real)}));
+        catalog.drop_table({"b", false});
+        bpm.flush_all_pages();
+    }
+    BufferPoolManager bpm(16);
+    Catalog catalog(path, bpm);
+    auto snap = catalog.snapshot();
+    ASSERT_EQ(snap->table_count(), 2u);
+    const TableSchema& a = snap->table("a");
+    EXPECT_EQ(a.layout, TableLayout::Pax);
+    ASSERT_EQ(a.schema.column_count(), 2u);
+    EXPECT_EQ(a.schema.type(1), DataType::Bool);
+    EXPECT_EQ(snap->table("c").schema.columns()[0].name, "w");
+    EXPECT_EQ(snap->find("b"), nullptr);
+
+    // Ids, and with them file names, are not reused after a restart.
+    auto b = catalog.create_table(create("b", {column("z", DataType::Text)}));
+    EXPECT_GT(b->id, dropped_id);
+}
+
+TEST_F(CatalogTest, ReadersResolveWhileDdlRuns) {
+    BufferPoolManager bpm(16);
+    Catalog catalog(path, bpm);
+    catalog.create_table(create("fixed", {column("k", DataType::Int), column("v", DataType::Text)}));
+
+    std::atomic<bool> done{false};
+    std::atomic<long> lookups{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            std::shared_ptr<const CatalogSnapshot> snap;
+            while (!done.load()) {
+                catalog.refresh(snap);
+                const TableSchema& t = snap->table("fixed");
+                EXPECT_EQ(t.schema.column_index("v"), std::optional<size_t>(1));
+                if (const TableSchema* temp = snap->find("temp")) {
+                    EXPECT_EQ(temp->schema.column_count(), 1u);
+                }
+                lookups++;
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        catalog.create_table(create("temp", {column("x", DataType::Int)}));
+        catalog.drop_table({"temp", false});
+    }
+    done = true;
+    for (auto& t : readers) t.join();
+    EXPECT_GT(lookups.load(), 0);
+    EXPECT_EQ(catalog.snapshot()->table_count(), 1u);
+}
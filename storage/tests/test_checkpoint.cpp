@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "storage/buffer_pool.hpp"
+#include "storage/checkpoint.hpp"
+#include "storage/heap_file.hpp"
+#include "storage/wal.hpp"
+
+
+class CheckpointTest : public ::testing::Test {
+protected:
+    std::string path;
+    std::string log_path;
+
+    void SetUp() override {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        auto base = std::filesystem::temp_directory_path() /
+                    ("checkpoint_" + std::string(name) + "_" + std::to_string(::getpid()));
+        path = base.string() + ".tbl";
+        log_path = base.string() + ".log";
+        remove_files();
+    }
+
+    void TearDown() override {
+        remove_files();
+    }
+
+    void remove_files() {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".fsm");
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(log_path + ".master");
+    }
+};
+
+static std::vector<uint8_t> record(int i) {
+    std::string s = "record " + std::to_string(i) + std::string(i % 50, 'x');
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+// Checks that the file holds record(0), record(1), ... in any order (small records
+// fill gaps left on earlier pages) and returns how many.
+static int count_rows(const std::string& path) {
+    BufferPoolManager bpm(8);
+    HeapFile heap(path, bpm);
+    std::vector<std::vector<uint8_t>> rows, want;
+    heap.scan([&](RID, TupleRef t) { rows.emplace_back(t.data, t.data + t.size); });
+    for (size_t i = 0; i < rows.size(); ++i) want.push_back(record(static_cast<int>(i)));
+    std::sort(rows.begin(), rows.end());
+    std::sort(want.begin(), want.end());
+    EXPECT_EQ(rows, want);
+    return static_cast<int>(rows.size());
+}
+
+
+TEST_F(CheckpointTest, RecoveryStartsAtTheLastCheckpoint) {
+    constexpr int BEFORE = 2000;
+    constexpr int AFTER = 1000;
+    Lsn begin;
+    {
+        LogManager log(log_path);
+        BufferPoolManager bpm(16, &log);
+        Checkpointer checkpointer(bpm, log);
+        HeapFile heap(path, bpm);
+        for (int i = 0; i < BEFORE; ++i) heap.insert(record(i));
+        // A page written back outside a checkpoint is not synced by the write.
+        EXPECT_TRUE(bpm.flush_page(path, 1));
+        EXPECT_EQ(bpm.unsynced_files(), std::vector<std::string>{path});
+        begin = checkpointer.checkpoint();
+        EXPECT_EQ(bpm.get_stats().dirty_frames, 0u);
+        EXPECT_TRUE(bpm.unsynced_files().empty());
+        for (int i = BEFORE; i < BEFORE + AFTER; ++i) heap.insert(record(i));
+        log.commit();
+        // The pool goes away without flushing the pages changed after the checkpoint.
+    }
+
+    LogManager log(log_path);
+    EXPECT_EQ(log.last_checkpoint(), begin);
+    size_t from_checkpoint = log.recover();
+    EXPECT_GT(from_checkpoint, 0u);
+    // Everything before the checkpoint is already on disk.
+    EXPECT_EQ(log.recover(0), 0u);
+    EXPECT_EQ(count_rows(path), BEFORE + AFTER);
+}
+
+TEST_F(CheckpointTest, WritersKeepRunningDuringBackgroundCheckpoints) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 500;
+    constexpr uint64_t PAGES = 64;
+    {
+        LogManager log(log_path);
+        BufferPoolManager bpm(2 * PAGES, &log);
+        Checkpointer checkpointer(bpm, log);
+        checkpointer.start(std::chrono::milliseconds(1));
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    uint64_t p = 1 + (i * THREADS + t) % PAGES;
+                    auto page = bpm.fetch_page_write(path, p);
+                    // Each thread owns bytes [100 + 4t, 104 + 4t) of every page.
+                    std::memcpy(page->data() + 100 + 4 * t, &i, sizeof(i));
+                    page.mark_dirty();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        while (checkpointer.checkpoints() < 2) std::this_thread::yield();
+        checkpointer.stop();
+        EXPECT_GT(checkpointer.pages_written(), 0u);
+        log.commit();
+    }
+
+    LogManager log(log_path);
+    EXPECT_GT(log.last_checkpoint(), 0u);
+    log.recover();
+    for (uint64_t p = 1; p <= PAGES; ++p) {
+        auto page = read_page(path, p);
+        for (int t = 0; t < THREADS; ++t) {
+            int last = 0;   // bytes a thread never wrote stay zero
+            for (int i = 0; i < PER_THREAD; ++i) {
+                if (1 + (i * THREADS + t) % PAGES == p) last = i;
+            }
+            int got;
+            std::memcpy(&got, page.data() + 100 + 4 * t, sizeof(got));
+            EXPECT_EQ(got, last) << "page " << p << " thread " << t;
+        }
+    }
+}
+
+TEST_F(CheckpointTest, WritesAreRateLimited) {
+    constexpr uint64_t PAGES = 20;
+    LogManager log(log_path);
+    BufferPoolManager bpm(PAGES, &log);
+    for (uint64_t p = 1; p <= PAGES; ++p) {
+        auto page = bpm.fetch_page_write(path, p);
+        page->data()[100] = 1;
+        page.mark_dirty();
+    }
+    Checkpointer checkpointer(bpm, log, 200);
+    auto started = std::chrono::steady_clock::now();
+    checkpointer.checkpoint();
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    EXPECT_EQ(checkpointer.pages_written(), PAGES);
+    // 20 pages at 200 a second: the last one goes out 95ms after the first.
+    EXPECT_GE(elapsed, std::chrono::milliseconds(90));
+    EXPECT_EQ(bpm.get_stats().dirty_frames, 0u);
+}
+
+TEST_F(CheckpointTest, RequiresTheBufferPoolsLog) {
+    LogManager log(log_path);
+    BufferPoolManager unlogged(4);
+    EXPECT_THROW(Checkpointer(unlogged, log), std::invalid_argument);
+}
@@ -0,0 +1,608 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "storage/free_space_map.hpp"
+#include "storage/heap_file.hpp"
+#include "storage/pax_page.hpp"
+#include "storage/slotted_page.hpp"
+#include "storage/tuple.hpp"
+
+
+class HeapFileTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() /
+                ("heap_" + std::string(name) + "_" + std::to_string(::getpid()) + ".tbl")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".fsm");
+        std::filesystem::remove(path + ".zm");
+        std::filesystem::remove(path + ".bf");
+    }
+};
+
+static std::vector<uint8_t> bytes(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static std::string str(const TupleRef& t) {
+    return std::string(reinterpret_cast<const char*>(t.data), t.size);
+}
+
+static Value int_value(long long i) { Value v{Value::Int}; v.i = i; return v; }
+static Value text_value(std::string s) { Value v{Value::String}; v.s = std::move(s); return v; }
+static Value null_value() { return Value{Value::Null}; }
+static Value real_value(double f) { Value v{Value::Float}; v.f = f; return v; }
+static Value bool_value(bool b) { Value v{Value::Bool}; v.b = b; return v; }
+
+
+TEST(SlottedPageTest, InsertGetRemoveReusesSlots) {
+    std::vector<uint8_t> buf(PAGE_SIZE, 0);
+    SlottedPage::init(buf.data());
+    SlottedPage page(buf);
+
+    auto a = bytes("alpha"), b = bytes("bravo!"), c = bytes("c");
+    EXPECT_EQ(page.insert(a.data(), a.size()), std::optional<uint16_t>(0));
+    EXPECT_EQ(page.insert(b.data(), b.size()), std::optional<uint16_t>(1));
+    EXPECT_EQ(str(*page.get(1)), "bravo!");
+
+    EXPECT_TRUE(page.remove(0));
+    EXPECT_FALSE(page.get(0).has_value());
+    EXPECT_FALSE(page.remove(0));
+    EXPECT_EQ(page.insert(c.data(), c.size()), std::optional<uint16_t>(0));
+    EXPECT_EQ(str(*page.get(0)), "c");
+    EXPECT_EQ(page.slot_count(), 2u);
+
+    EXPECT_TRUE(page.remove(1));
+    EXPECT_EQ(page.slot_count(), 1u);
+}
+
+TEST(SlottedPageTest, FillsPageAndCompactsOnDemand) {
+    std::vector<uint8_t> buf(PAGE_SIZE, 0);
+    SlottedPage::init(buf.data());
+    SlottedPage page(buf);
+
+    std::vector<uint8_t> rec(100, 7);
+    std::vector<uint16_t> slots;
+    while (auto s = page.insert(rec.data(), rec.size())) slots.push_back(*s);
+    EXPECT_EQ(slots.size(), (PAGE_SIZE - SlottedPage::HEADER_SIZE) / (100 + SlottedPage::SLOT_SIZE));
+
+    // Free every other record: the holes only become usable through compaction.
+    for (size_t i = 0; i < slots.size(); i += 2) page.remove(slots[i]);
+    std::vector<uint8_t> big(150, 9);
+    auto s = page.insert(big.data(), big.size());
+    ASSERT_TRUE(s.has_value());
+    EXPECT_EQ(page.get(*s)->size, 150u);
+    for (size_t i = 1; i < slots.size(); i += 2) {
+        auto t = page.get(slots[i]);
+        ASSERT_TRUE(t.has_value());
+        EXPECT_EQ(t->size, 100u);
+        EXPECT_EQ(t->data[0], 7);
+    }
+}
+
+TEST(SlottedPageTest, UpdateShrinksInPlaceAndGrowsUntilFull) {
+    std::vector<uint8_t> buf(PAGE_SIZE, 0);
+    SlottedPage::init(buf.data());
+    SlottedPage page(buf);
+
+    auto a = bytes("hello world");
+    auto slot = *page.insert(a.data(), a.size());
+    auto shorter = bytes("hi");
+    EXPECT_TRUE(page.update(slot, shorter.data(), shorter.size()));
+    EXPECT_EQ(str(*page.get(slot)), "hi");
+
+    std::vector<uint8_t> large(SlottedPage::MAX_TUPLE_SIZE, 1);
+    EXPECT_TRUE(page.update(slot, large.data(), large.size()));
+    EXPECT_EQ(page.get(slot)->size, SlottedPage::MAX_TUPLE_SIZE);
+
+    auto other = bytes("x");
+    EXPECT_FALSE(page.insert(other.data(), other.size()).has_value());
+    EXPECT_TRUE(page.update(slot, a.data(), a.size()));
+    EXPECT_TRUE(page.insert(other.data(), other.size()).has_value());
+}
+
+
+TEST(TupleLayoutTest, RoundTripsAllTypesAndNulls) {
+    TupleLayout layout({{"id", {DataType::Int}}, {"name", {DataType::Text}},
+                        {"score", {DataType::Real}}, {"active", {DataType::Bool}}});
+    Value score{Value::Float}; score.f = 2.5;
+    Value active{Value::Bool}; active.b = true;
+    auto rec = layout.encode({int_value(42), text_value("ada"), score, active});
+    EXPECT_EQ(rec.size(), layout.fixed_size() + 3);
+
+    TupleView view{&layout, rec.data()};
+    EXPECT_EQ(view.get_int(0), 42);
+    EXPECT_EQ(view.get_text(1), "ada");
+    EXPECT_DOUBLE_EQ(view.get_real(2), 2.5);
+    EXPECT_TRUE(view.get_bool(3));
+
+    auto with_nulls = layout.encode({int_value(-1), null_value(), int_value(3), null_value()});
+    std::vector<Value> out;
+    layout.decode(with_nulls.data(), out);
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_EQ(out[0].i, -1);
+    EXPECT_EQ(out[1].kind, Value::Null);
+    EXPECT_EQ(out[2].kind, Value::Float);
+    EXPECT_DOUBLE_EQ(out[2].f, 3.0);
+    EXPECT_EQ(out[3].kind, Value::Null);
+}
+
+TEST(TupleLayoutTest, RejectsMismatchedValues) {
+    TupleLayout layout({{"id", {DataType::Int}}});
+    EXPECT_THROW(layout.encode({text_value("x")}), std::invalid_argument);
+    EXPECT_THROW(layout.encode({}), std::invalid_argument);
+    EXPECT_THROW(TupleLayout({{"p", {DataType::Custom, "POINT"}}}), std::invalid_argument);
+}
+
+
+TEST(PaxPageTest, StoresColumnsInMinipagesAndRoundTripsRecords) {
+    TupleLayout layout({{"id", {DataType::Int}}, {"name", {DataType::Text}}, {"active", {DataType::Bool}}});
+    PaxGeometry geo(layout);
+    ASSERT_GT(geo.capacity(), 100u);
+    std::vector<uint8_t> buf(PAGE_SIZE, 0);
+    PaxPage::init(buf.data(), geo);
+    PaxPage page(buf.data(), geo);
+
+    Value yes{Value::Bool}; yes.b = true;
+    for (int i = 0; i < 10; ++i) {
+        auto rec = layout.encode({int_value(i), i == 3 ? null_value() : text_value("v" + std::to_string(i)), yes});
+        EXPECT_EQ(page.insert(rec.data(), rec.size()), std::optional<uint16_t>(i));
+    }
+    const long long* ids = reinterpret_cast<const long long*>(page.values(0));
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(ids[i], i);
+    EXPECT_TRUE(page.is_null(3, 1));
+    EXPECT_EQ(page.get_text(4, 1), "v4");
+
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(page.get(4, out));
+    TupleView row{&layout, out.data()};
+    EXPECT_EQ(row.get_int(0), 4);
+    EXPECT_EQ(row.get_text(1), "v4");
+    EXPECT_TRUE(row.get_bool(2));
+
+    auto longer = layout.encode({int_value(40), text_value("a much longer value"), null_value()});
+    EXPECT_TRUE(page.update(4, longer.data(), longer.size()));
+    ASSERT_TRUE(page.get(4, out));
+    EXPECT_EQ(TupleView({&layout, out.data()}).get_text(1), "a much longer value");
+    EXPECT_TRUE(page.is_null(4, 2));
+
+    EXPECT_TRUE(page.remove(4));
+    EXPECT_FALSE(page.get(4, out));
+    EXPECT_FALSE(page.remove(4));
+    EXPECT_EQ(page.row_count(), 10u);
+    EXPECT_EQ(page.live_count(), 9u);
+}
+
+TEST(PaxPageTest, FullOnceCapacityOrTextRegionRunsOut) {
+    TupleLayout layout({{"id", {DataType::Int}}, {"name", {DataType::Text}}});
+    PaxGeometry geo(layout);
+    std::vector<uint8_t> buf(PAGE_SIZE, 0);
+    PaxPage::init(buf.data(), geo);
+    PaxPage page(buf.data(), geo);
+
+    auto small = layout.encode({int_value(1), text_value("x")});
+    size_t rows = 0;
+    while (page.insert(small.data(), small.size())) rows++;
+    EXPECT_EQ(rows, geo.capacity());
+
+    PaxPage::init(buf.data(), geo);
+    auto big = layout.encode({int_value(1), text_value(std::string(500, 'y'))});
+    rows = 0;
+    while (page.insert(big.data(), big.size())) rows++;
+    EXPECT_GT(rows, 0u);
+    EXPECT_LT(rows, geo.capacity());
+    EXPECT_LE(rows * 500, PAGE_SIZE - geo.minipages_end());
+}
+
+
+TEST_F(HeapFileTest, InsertGetUpdateRemove) {
+    BufferPoolManager bpm(16);
+    HeapFile heap(path, bpm);
+    auto a = bytes("first"), b = bytes("second");
+    RID ra = heap.insert(a);
+    RID rb = heap.insert(b);
+    EXPECT_EQ(ra.page_id, 1u);
+    EXPECT_NE(ra, rb);
+
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(heap.get(rb, out));
+    EXPECT_EQ(out, b);
+
+    auto longer = bytes("first, but longer");
+    auto moved = heap.update(ra, longer.data(), longer.size());
+    EXPECT_EQ(moved, std::optional<RID>(ra));
+    ASSERT_TRUE(heap.get(ra, out));
+    EXPECT_EQ(out, longer);
+
+    EXPECT_TRUE(heap.remove(rb));
+    EXPECT_FALSE(heap.get(rb, out));
+    EXPECT_FALSE(heap.remove(rb));
+    EXPECT_FALSE(heap.update(rb, a.data(), a.size()).has_value());
+}
+
+TEST_F(HeapFileTest, UpdateThatOutgrowsPageMovesRecord) {
+    BufferPoolManager bpm(16);
+    HeapFile heap(path, bpm);
+    std::vector<uint8_t> half(PAGE_SIZE / 2 - 64, 1);
+    RID r1 = heap.insert(half);
+    RID r2 = heap.insert(half);
+    ASSERT_EQ(r1.page_id, r2.page_id);
+
+    std::vector<uint8_t> grown(PAGE_SIZE / 2 + 200, 2);
+    auto moved = heap.update(r1, grown.data(), grown.size());
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_NE(moved->page_id, r1.page_id);
+
+    std::vector<uint8_t> out;
+    EXPECT_FALSE(heap.get(r1, out));
+    ASSERT_TRUE(heap.get(*moved, out));
+    EXPECT_EQ(out, grown);
+}
+
+TEST_F(HeapFileTest, FailedMoveLeavesRecordInPlace) {
+    BufferPoolManager bpm(4);
+    HeapFile heap(path, bpm);
+    std::vector<uint8_t> half(PAGE_SIZE / 2 - 64, 1);
+    RID r1 = heap.insert(half);
+    RID r2 = heap.insert(half);
+    ASSERT_EQ(r1.page_id, r2.page_id);
+    bpm.flush_all_pages();
+
+    // With every other frame pinned, the copy has nowhere to go.
+    std::string other = path + ".pins";
+    std::vector<ReadPageHandle> pins;
+    for (uint64_t p = 0; p < 3; ++p) pins.push_back(bpm.fetch_page_read(other, p));
+    std::vector<uint8_t> grown(PAGE_SIZE / 2 + 200, 2);
+    EXPECT_THROW(heap.update(r1, grown.data(), grown.size()), std::runtime_error);
+    pins.clear();
+    std::filesystem::remove(other);
+
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(heap.get(r1, out));
+    EXPECT_EQ(out, half);
+}
+
+TEST_F(HeapFileTest, BatchInsertScanAndReopen) {
+    constexpr int ROWS = 3000;
+    TupleLayout layout({{"id", {DataType::Int}}, {"name", {DataType::Text}}});
+    std::vector<std::vector<uint8_t>> batch;
+    for (int i = 0; i < ROWS; ++i) {
+        batch.push_back(layout.encode({int_value(i), text_value("row" + std::to_string(i))}));
+    }
+
+    {
+        // A pool smaller than the table forces eviction of dirty pages.
+        BufferPoolManager bpm(4);
+        HeapFile heap(path, bpm);
+        auto rids = heap.insert_batch(batch);
+        ASSERT_EQ(rids.size(), size_t(ROWS));
+        EXPECT_GT(heap.page_count(), 4u);
+        for (size_t i = 1; i < rids.size(); ++i) EXPECT_LT(rids[i - 1], rids[i]);
+        bpm.flush_all_pages();
+    }
+
+    BufferPoolManager bpm(4);
+    HeapFile heap(path, bpm);
+    long long sum = 0;
+    int count = 0;
+    heap.scan([&](RID, TupleRef t) {
+        TupleView row{&layout, t.data};
+        EXPECT_EQ(row.get_text(1), "row" + std::to_string(row.get_int(0)));
+        sum += row.get_int(0);
+        count++;
+    });
+    EXPECT_EQ(count, ROWS);
+    EXPECT_EQ(sum, (long long)ROWS * (ROWS - 1) / 2);
+}
+
+TEST_F(HeapFileTest, ConcurrentInsertsKeepEveryRecord) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 2000;
+    BufferPoolManager bpm(8);
+    HeapFile heap(path, bpm);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                heap.insert(bytes(std::to_string(t * PER_THREAD + i)));
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::vector<bool> seen(THREADS * PER_THREAD, false);
+    heap.scan([&](RID, TupleRef t) {
+        int v = std::stoi(str(t));
+        EXPECT_FALSE(seen[v]);
+        seen[v] = true;
+    });
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](bool b) { return b; }));
+}
+
+TEST_F(HeapFileTest, RejectsOversizedRecord) {
+    BufferPoolManager bpm(4);
+    HeapFile heap(path, bpm);
+    std::vector<uint8_t> huge(PAGE_SIZE, 0);
+    EXPECT_THROW(heap.insert(huge), std::invalid_argument);
+}
+
+TEST_F(HeapFileTest, PaxLayoutRoundTripsAndIsCheckedOnReopen) {
+    constexpr int ROWS = 3000;
+    TupleLayout layout({{"id", {DataType::Int}}, {"name", {DataType::Text}}});
+    std::vector<std::vector<uint8_t>> batch;
+    for (int i = 0; i < ROWS; ++i) {
+        batch.push_back(layout.encode({int_value(i), text_value("row" + std::to_string(i))}));
+    }
+    {
+        BufferPoolManager bpm(4);
+        HeapFile heap(path, TableLayout::Pax, layout, bpm);
+        ASSERT_NE(heap.pax(), nullptr);
+        auto rids = heap.insert_batch(batch);
+        ASSERT_EQ(rids.size(), size_t(ROWS));
+        EXPECT_GT(heap.page_count(), 1u);
+
+        EXPECT_TRUE(heap.remove(rids[10]));
+        auto renamed = layout.encode({int_value(11), text_value("renamed to something longer")});
+        EXPECT_EQ(heap.update(rids[11], renamed.data(), renamed.size()), std::optional<RID>(rids[11]));
+        bpm.flush_all_pages();
+    }
+
+    BufferPoolManager bpm(4);
+    EXPECT_THROW(HeapFile(path, bpm), std::runtime_error);
+    HeapFile heap(path, TableLayout::Pax, layout, bpm);
+    int count = 0;
+    heap.scan([&](RID, TupleRef t) {
+        TupleView row{&layout, t.data};
+        long long id = row.get_int(0);
+        EXPECT_NE(id, 10);
+        EXPECT_EQ(row.get_text(1), id == 11 ? "renamed to something longer" : "row" + std::to_string(id));
+        count++;
+    });
+    EXPECT_EQ(count, ROWS - 1);
+}
+
+TEST_F(HeapFileTest, InsertsReuseFreedSpaceOnAnyPage) {
+    std::vector<RID> rids;
+    uint64_t pages;
+    {
+        BufferPoolManager bpm(8);
+        HeapFile heap(path, bpm);
+        std::vector<uint8_t> row(200, 'r');
+        for (int i = 0; i < 400; ++i) rids.push_back(heap.insert(row));
+        pages = heap.page_count();
+        ASSERT_GT(pages, 3u);
+        for (RID rid : rids) {
+            if (rid.page_id == 2) {
+                EXPECT_TRUE(heap.remove(rid));
+            }
+        }
+        bpm.flush_all_pages();
+    }
+
+    // The map is persisted with the file, so a reopened heap finds the room as well.
+    BufferPoolManager bpm(8);
+    HeapFile heap(path, bpm);
+    EXPECT_EQ(heap.free_space_map().find(1000, 1, pages), std::optional<uint64_t>(2));
+    std::vector<uint8_t> big(1000, 'b');
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(heap.insert(big).page_id, 2u);
+    }
+    EXPECT_EQ(heap.page_count(), pages);
+}
+
+TEST(FreeSpaceMapTest, FindsPagesAcrossLeavesAndWrapsAround) {
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("fsm_" + std::to_string(::getpid()) + ".fsm")).string();
+    std::filesystem::remove(path);
+    {
+        BufferPoolManager bpm(8);
+        FreeSpaceMap fsm(path, bpm);
+        uint64_t n = 3 * FreeSpaceMap::ENTRIES;
+        EXPECT_EQ(fsm.find(100, 1, n), std::nullopt);
+
+        uint64_t far = 2 * FreeSpaceMap::ENTRIES + 7;
+        fsm.update(far, 500);
+        fsm.update(5, 100);
+        EXPECT_EQ(fsm.find(400, 1, n), std::optional<uint64_t>(far));
+        EXPECT_EQ(fsm.find(64, 1, n), std::optional<uint64_t>(5));
+        EXPECT_EQ(fsm.find(64, 6, n), std::optional<uint64_t>(far));
+        EXPECT_EQ(fsm.find(64, far + 1, n), std::optional<uint64_t>(5));
+        EXPECT_EQ(fsm.find(400, 1, far - 1), std::nullopt);
+
+        // Shrinking the largest entry of a leaf lowers what the root promises for it.
+        fsm.update(far, 0);
+        EXPECT_EQ(fsm.find(400, 1, n), std::nullopt);
+        EXPECT_EQ(fsm.find(FreeSpaceMap::BUCKET * 256, 1, n), std::nullopt);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(HeapFileTest, ConcurrentInsertersFillDifferentPages) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 400;
+    BufferPoolManager bpm(32);
+    HeapFile heap(path, bpm);
+    std::vector<std::set<uint64_t>> pages(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<uint8_t> row(100, static_cast<uint8_t>('a' + t));
+            for (int i = 0; i < PER_THREAD; ++i) pages[t].insert(heap.insert(row).page_id);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    size_t shared = 0;
+    std::set<uint64_t> all;
+    for (const auto& p : pages) {
+        for (uint64_t page : p) shared += !all.insert(page).second;
+    }
+    // Only a race between two inserters picking the same page at once can share one.
+    EXPECT_LE(shared, size_t(THREADS));
+    EXPECT_EQ(all.size(), heap.page_count());
+}
+
+TEST_F(HeapFileTest, ZoneMapsBoundEveryPageAndSurviveSchemalessWrites) {
+    constexpr int ROWS = 2000;
+    TupleLayout layout({{"id", {DataType::Int}}, {"score", {DataType::Real}}, {"name", {DataType::Text}}});
+    auto row = [&](long long id) {
+        return layout.encode({int_value(id), id % 5 == 0 ? null_value() : real_value(id * 0.5), text_value("r")});
+    };
+    // Checks that each page's zones cover its records; with `exact`, that they are tight.
+    auto check = [&](HeapFile& heap, bool exact) {
+        std::vector<ZoneMap::Zone> zones;
+        for (uint64_t p = 1; p <= heap.page_count(); ++p) {
+            SCOPED_TRACE(p);
+            long long lo = LLONG_MAX, hi = LLONG_MIN;
+            double score = 1e300;
+            bool nulls = false;
+            heap.scan_page(p, [&](RID, TupleRef t) {
+                lo = std::min(lo, layout.get_int(t.data, 0));
+                hi = std::max(hi, layout.get_int(t.data, 0));
+                nulls |= layout.is_null(t.data, 1);
+                if (!layout.is_null(t.data, 1)) score = std::min(score, layout.get_real(t.data, 1));
+            });
+            heap.zone_map()->read(p, zones);
+            ASSERT_TRUE(zones[0].has_values);
+            EXPECT_LE(zones[0].min, lo);
+            EXPECT_GE(zones[0].max, hi);
+            EXPECT_TRUE(zones[1].has_values);
+            EXPECT_LE(zones[1].min_real(), score);
+            if (nulls) {
+                EXPECT_TRUE(zones[1].has_nulls);
+            }
+            EXPECT_TRUE(zones[2].has_values);
+            if (exact) {
+                EXPECT_EQ(bool(zones[1].has_nulls), nulls);
+                EXPECT_EQ(zones[0].min, lo);
+                EXPECT_EQ(zones[0].max, hi);
+            }
+        }
+    };
+
+    RID moved;
+    {
+        BufferPoolManager bpm(16);
+        HeapFile heap(path, TableLayout::Row, layout, bpm);
+        ASSERT_NE(heap.zone_map(), nullptr);
+        std::vector<std::vector<uint8_t>> batch;
+        for (long long i = 0; i < ROWS / 2; ++i) batch.push_back(row(i));
+        heap.insert_batch(batch);
+        for (long long i = ROWS / 2; i < ROWS; ++i) heap.insert(row(i));
+        ASSERT_GT(heap.page_count(), 4u);
+        check(heap, true);
+
+        // Updates widen a page's zones; removals leave them as they were.
+        moved = heap.insert(row(ROWS));
+        auto low = row(-100);
+        ASSERT_EQ(heap.update(moved, low.data(), low.size()), std::optional<RID>(moved));
+        std::vector<ZoneMap::Zone> zones;
+        heap.zone_map()->read(moved.page_id, zones);
+        EXPECT_EQ(zones[0].min, -100);
+        EXPECT_EQ(zones[0].max, ROWS);
+        heap.remove(moved);
+        check(heap, false);
+        bpm.flush_all_pages();
+    }
+    {
+        // Writes without the schema do not maintain the map...
+        BufferPoolManager bpm(16);
+        HeapFile heap(path, bpm);
+        EXPECT_EQ(heap.zone_map(), nullptr);
+        moved = heap.insert(row(5 * ROWS));
+        bpm.flush_all_pages();
+    }
+    // ...so the next open with it rebuilds the map.
+    BufferPoolManager bpm(16);
+    HeapFile heap(path, TableLayout::Row, layout, bpm);
+    std::vector<ZoneMap::Zone> zones;
+    heap.zone_map()->read(moved.page_id, zones);
+    EXPECT_EQ(zones[0].max, 5 * ROWS);
+    check(heap, false);
+}
+
+TEST_F(HeapFileTest, BloomFiltersHoldEveryValueAndSurviveSchemalessWrites) {
+    constexpr int ROWS = 2000;
+    TupleLayout layout({{"id", {DataType::Int}}, {"score", {DataType::Real}}, {"name", {DataType::Text}},
+                        {"flag", {DataType::Bool}}});
+    auto row = [&](long long id) {
+        return layout.encode({int_value(id), id % 5 == 0 ? null_value() : real_value(id * 0.5),
+                              text_value("r" + std::to_string(id)), bool_value(id % 2 == 0)});
+    };
+    auto contains = [](BloomFilterMap& blooms, uint64_t page_id, size_t column, uint64_t hash) {
+        bool found = false;
+        blooms.read(page_id, [&](const uint8_t* filters) {
+            size_t block = blooms.filter_of(column) * blooms.blocks() + BloomFilterMap::block_of(hash, blooms.blocks());
+            found = BloomFilterMap::block_contains(filters + block * BloomFilterMap::BLOCK_BYTES, hash);
+        });
+        return found;
+    };
+    // Checks that each page's filters hold its records' values and rule out most others.
+    auto check = [&](HeapFile& heap) {
+        BloomFilterMap& blooms = *heap.bloom_filters();
+        size_t maybes = 0;
+        for (uint64_t p = 1; p <= heap.page_count(); ++p) {
+            SCOPED_TRACE(p);
+            heap.scan_page(p, [&](RID, TupleRef t) {
+                EXPECT_TRUE(contains(blooms, p, 0, BloomFilterMap::hash_int(layout.get_int(t.data, 0))));
+                if (!layout.is_null(t.data, 1)) {
+                    EXPECT_TRUE(contains(blooms, p, 1, BloomFilterMap::hash_real(layout.get_real(t.data, 1))));
+                }
+                EXPECT_TRUE(contains(blooms, p, 2, BloomFilterMap::hash_text(layout.get_text(t.data, 2))));
+            });
+            for (long long absent = 10 * ROWS; absent < 10 * ROWS + 100; ++absent) {
+                maybes += contains(blooms, p, 0, BloomFilterMap::hash_int(absent));
+            }
+        }
+        EXPECT_LT(maybes, heap.page_count() * 100 / 20);
+    };
+
+    RID moved;
+    {
+        BufferPoolManager bpm(16);
+        HeapFile heap(path, TableLayout::Row, layout, bpm);
+        ASSERT_NE(heap.bloom_filters(), nullptr);
+        EXPECT_EQ(heap.bloom_filters()->filter_of(3), -1);
+        EXPECT_EQ(BloomFilterMap::hash_real(-0.0), BloomFilterMap::hash_real(0.0));
+        std::vector<std::vector<uint8_t>> batch;
+        for (long long i = 0; i < ROWS / 2; ++i) batch.push_back(row(i));
+        heap.insert_batch(batch);
+        for (long long i = ROWS / 2; i < ROWS; ++i) heap.insert(row(i));
+        ASSERT_GE(heap.page_count(), 2 * BloomFilterMap::GROUP_PAGES);
+
+        // An update in place adds the new values; the old ones stay.
+        moved = heap.insert(row(ROWS));
+        auto other = row(-100);
+        ASSERT_EQ(heap.update(moved, other.data(), other.size()), std::optional<RID>(moved));
+        EXPECT_TRUE(contains(*heap.bloom_filters(), moved.page_id, 0, BloomFilterMap::hash_int(-100)));
+        EXPECT_TRUE(contains(*heap.bloom_filters(), moved.page_id, 0, BloomFilterMap::hash_int(ROWS)));
+        check(heap);
+        bpm.flush_all_pages();
+    }
+    {
+        // Writes without the schema do not maintain the filters...
+        BufferPoolManager bpm(16);
+        HeapFile heap(path, bpm);
+        EXPECT_EQ(heap.bloom_filters(), nullptr);
+        moved = heap.insert(row(5 * ROWS));
+        bpm.flush_all_pages();
+    }
+    // ...so the next open with it rebuilds them.
+    BufferPoolManager bpm(16);
+    HeapFile heap(path, TableLayout::Row, layout, bpm);
+    EXPECT_TRUE(contains(*heap.bloom_filters(), moved.page_id, 2, BloomFilterMap::hash_text("r" + std::to_string(5 * ROWS))));
+    check(heap);
+}
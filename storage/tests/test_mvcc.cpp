@@ -0,0 +1,381 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "storage/heap_file.hpp"
+#include "storage/mvcc.hpp"
+#include "storage/wal.hpp"
+
+
+class MvccTest : public ::testing::Test {
+protected:
+    std::string path;
+    BufferPoolManager bpm{64};
+
+    void SetUp() override {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() /
+                ("mvcc_" + std::string(name) + "_" + std::to_string(::getpid()) + ".tbl")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".fsm");
+        std::filesystem::remove(path + ".log");
+        std::filesystem::remove(path + ".log.master");
+    }
+};
+
+static std::vector<uint8_t> text(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static std::map<RID, std::string> snapshot(MvccHeap& table, const Transaction& txn) {
+    std::map<RID, std::string> rows;
+    table.scan(txn, [&](RID rid, TupleRef t) {
+        rows[rid] = std::string(reinterpret_cast<const char*>(t.data), t.size);
+    });
+    return rows;
+}
+
+
+TEST_F(MvccTest, SnapshotsSeeOnlyWhatCommittedBeforeThem) {
+    HeapFile heap(path, bpm);
+    TransactionManager txns;
+    MvccHeap table(heap, txns);
+
+    auto writer = txns.begin();
+    auto early = txns.begin();
+    RID rid = table.insert(*writer, text("alpha"));
+    std::vector<uint8_t> out;
+    EXPECT_TRUE(table.get(*writer, rid, out));
+    EXPECT_FALSE(table.get(*early, rid, out));
+    EXPECT_TRUE(snapshot(table, *early).empty());
+
+    txns.commit(*writer);
+    auto late = txns.begin();
+    EXPECT_FALSE(table.get(*early, rid, out));
+    ASSERT_TRUE(table.get(*late, rid, out));
+    EXPECT_EQ(out, text("alpha"));
+    EXPECT_EQ(snapshot(table, *late).size(), 1u);
+}
+
+TEST_F(MvccTest, OlderSnapshotsKeepReadingReplacedVersions) {
+    HeapFile heap(path, bpm);
+    TransactionManager txns;
+    MvccHeap table(heap, txns);
+
+    std::vector<RID> rids;
+    {
+        auto load = txns.begin();
+        for (int i = 0; i < 1000; ++i) rids.push_back(table.insert(*load, text("v0 " + std::to_string(i))));
+        txns.commit(*load);
+    }
+    EXPECT_EQ(txns.collect_garbage(), 1000u);
+    EXPECT_EQ(table.version_count(), 0u);
+
+    auto reader = txns.begin();
+    auto before = snapshot(table, *reader);
+    ASSERT_EQ(before.size(), 1000u);
+
+    auto writer = txns.begin();
+    for (int i = 0; i < 1000; i += 2) {
+        ASSERT_TRUE(table.update(*writer, rids[i], text("v1 " + std::to_string(i))));
+    }
+    for (int i = 1; i < 1000; i += 4) {
+        ASSERT_TRUE(table.remove(*writer, rids[i]));
+    }
+    EXPECT_FALSE(table.remove(*writer, rids[1]));
+    txns.commit(*writer);
+
+    // Collection keeps everything the open reader may still need.
+    txns.collect_garbage();
+    EXPECT_EQ(snapshot(table, *reader), before);
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(table.get(*reader, rids[1], out));
+    EXPECT_EQ(out, text("v0 1"));
+
+    auto after = txns.begin();
+    auto now = snapshot(table, *after);
+    EXPECT_EQ(now.size(), 750u);
+    EXPECT_FALSE(table.get(*after, rids[0], out));
+    EXPECT_FALSE(table.get(*after, rids[1], out));
+    size_t updated = 0;
+    for (const auto& [rid, row] : now) updated += row.rfind("v1 ", 0) == 0;
+    EXPECT_EQ(updated, 500u);
+
+    txns.commit(*reader);
+    txns.commit(*after);
+    txns.collect_garbage();
+    EXPECT_EQ(table.version_count(), 0u);
+    auto last = txns.begin();
+    EXPECT_EQ(snapshot(table, *last), now);
+}
+
+TEST_F(MvccTest, AbortRestoresThePreviousState) {
+    HeapFile heap(path, bpm);
+    TransactionManager txns;
+    MvccHeap table(heap, txns);
+
+    RID kept;
+    {
+        auto setup = txns.begin();
+        kept = table.insert(*setup, text("kept"));
+        table.insert(*setup, text("other"));
+        txns.commit(*setup);
+    }
+    txns.collect_garbage();
+    auto reader = txns.begin();
+    auto before = snapshot(table, *reader);
+    {
+        auto txn = txns.begin();
+        table.insert(*txn, text("new"));
+        auto moved = table.update(*txn, kept, text("changed"));
+        ASSERT_TRUE(moved);
+        ASSERT_TRUE(table.remove(*txn, *moved));
+        EXPECT_EQ(snapshot(table, *txn).size(), 2u);
+        // Going out of scope aborts it.
+    }
+    EXPECT_EQ(table.version_count(), 0u);
+    EXPECT_EQ(snapshot(table, *reader), before);
+    size_t raw = 0;
+    heap.scan([&](RID, TupleRef) { raw++; });
+    EXPECT_EQ(raw, 2u);
+}
+
+TEST_F(MvccTest, RecoveryKeepsOnlyCommittedWrites) {
+    std::string log_path = path + ".log";
+    std::string saved = path + ".crash";
+    // Runs `work` against the table, then crashes with every page on disk while the
+    // transaction it returns, if any, is still active.
+    using Work = std::function<std::unique_ptr<Transaction>(TransactionManager&, MvccHeap&)>;
+    auto run = [&](const Work& work) {
+        {
+            LogManager log(log_path);
+            BufferPoolManager pool(16, &log);
+            HeapFile heap(path, pool);
+            TransactionManager txns(&log);
+            MvccHeap table(heap, txns);
+            txns.recover();
+            auto in_flight = work(txns, table);
+            pool.flush_all_pages();
+            std::filesystem::copy_file(path, saved);
+            std::filesystem::copy_file(log_path, saved + ".log");
+        }
+        std::filesystem::rename(saved, path);
+        std::filesystem::rename(saved + ".log", log_path);
+        LogManager(log_path).recover();
+    };
+    auto restart = [&](size_t undone) {
+        LogManager log(log_path);
+        BufferPoolManager pool(16, &log);
+        HeapFile heap(path, pool);
+        TransactionManager txns(&log);
+        MvccHeap table(heap, txns);
+        EXPECT_EQ(txns.recover(), undone);
+        std::multiset<std::string> rows;
+        heap.scan([&](RID, TupleRef t) { rows.emplace(reinterpret_cast<const char*>(t.data), t.size); });
+        pool.flush_all_pages();
+        return rows;
+    };
+
+    run([&](TransactionManager& txns, MvccHeap& table) -> std::unique_ptr<Transaction> {
+        auto load = txns.begin();
+        table.insert(*load, text("kept"));
+        RID deleted = table.insert(*load, text("deleted"));
+        RID updated = table.insert(*load, text("old"));
+        txns.commit(*load);
+
+        auto change = txns.begin();
+        EXPECT_TRUE(table.remove(*change, deleted));
+        EXPECT_TRUE(table.update(*change, updated, text("new")));
+        txns.commit(*change);
+        auto aborted = txns.begin();
+        table.insert(*aborted, text("aborted"));
+        txns.abort(*aborted);
+        auto in_flight = txns.begin();
+        table.insert(*in_flight, text("in flight"));
+        // The heap holds the deleted versions and the uncommitted insert at the crash.
+        size_t raw = 0;
+        table.heap().scan([&](RID, TupleRef) { raw++; });
+        EXPECT_EQ(raw, 5u);
+        return in_flight;
+    });
+    // "deleted", "old" and "in flight" go.
+    EXPECT_EQ(restart(3), (std::multiset<std::string>{"kept", "new"}));
+
+    // The rolled-back transaction is not undone again, and ids do not repeat.
+    run([&](TransactionManager& txns, MvccHeap& table) -> std::unique_ptr<Transaction> {
+        auto txn = txns.begin();
+        EXPECT_EQ(txn->id(), Transaction::TXN_BIT | 4);
+        table.insert(*txn, text("later"));
+        txns.commit(*txn);
+        return nullptr;
+    });
+    EXPECT_EQ(restart(0), (std::multiset<std::string>{"kept", "new", "later"}));
+}
+
+TEST_F(MvccTest, FirstUpdaterWins) {
+    HeapFile heap(path, bpm);
+    TransactionManager txns;
+    MvccHeap table(heap, txns);
+
+    RID rid;
+    {
+        auto setup = txns.begin();
+        rid = table.insert(*setup, text("row"));
+        txns.commit(*setup);
+    }
+    auto first = txns.begin();
+    auto second = txns.begin();
+    ASSERT_TRUE(table.update(*first, rid, text("first")));
+    EXPECT_THROW(table.remove(*second, rid), WriteConflict);
+    txns.commit(*first);
+    // Still a conflict: the change committed after second's snapshot.
+    EXPECT_THROW(table.update(*second, rid, text("second")), WriteConflict);
+    txns.abort(*second);
+    EXPECT_THROW(txns.commit(*second), std::logic_error);
+}
+
+TEST_F(MvccTest, DeletedRecordsLeaveTheHeapOnceNoSnapshotNeedsThem) {
+    HeapFile heap(path, bpm);
+    TransactionManager txns;
+    MvccHeap table(heap, txns);
+    auto raw_count = [&] {
+        size_t n = 0;
+        heap.scan([&](RID, TupleRef) { n++; });
+        return n;
+    };
+
+    RID rid;
+    {
+        auto setup = txns.begin();
+        rid = table.insert(*setup, text("old"));
+        table.insert(*setup, text("other"));
+        txns.commit(*setup);
+    }
+    auto reader = txns.begin();
+    {
+        auto txn = txns.begin();
+        ASSERT_TRUE(table.remove(*txn, rid));
+        txns.commit(*txn);
+    }
+    txns.collect_garbage();
+    EXPECT_EQ(raw_count(), 2u);
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(table.get(*reader, rid, out));
+    EXPECT_EQ(out, text("old"));
+    {
+        // The slot stays taken while the reader may look at it.
+        auto txn = txns.begin();
+        EXPECT_NE(table.insert(*txn, text("new")), rid);
+        txns.commit(*txn);
+    }
+
+    txns.commit(*reader);
+    txns.collect_garbage();
+    EXPECT_EQ(table.version_count(), 0u);
+    EXPECT_EQ(raw_count(), 2u);
+    auto now = txns.begin();
+    EXPECT_FALSE(table.get(*now, rid, out));
+    EXPECT_EQ(table.insert(*now, text("newer")), rid);
+}
+
+TEST_F(MvccTest, ConcurrentTransfersKeepEverySnapshotConsistent) {
+    constexpr int ACCOUNTS = 64;
+    constexpr int WRITERS = 4;
+    constexpr int READERS = 2;
+    constexpr int TRANSFERS = 300;
+    constexpr int64_t START = 1000;
+
+    HeapFile heap(path, bpm);
+    TransactionManager txns;
+    MvccHeap table(heap, txns);
+    auto encode = [](int account, int64_t balance) {
+        std::vector<uint8_t> row(12);
+        std::memcpy(row.data(), &account, 4);
+        std::memcpy(row.data() + 4, &balance, 8);
+        return row;
+    };
+    {
+        auto setup = txns.begin();
+        for (int a = 0; a < ACCOUNTS; ++a) table.insert(*setup, encode(a, START));
+        txns.commit(*setup);
+    }
+    txns.start_gc(std::chrono::milliseconds(1));
+
+    std::atomic<int> writers_left{WRITERS};
+    std::atomic<int> conflicts{0};
+    std::vector<std::thread> threads;
+    for (int w = 0; w < WRITERS; ++w) {
+        threads.emplace_back([&, w] {
+            for (int i = 0; i < TRANSFERS; ++i) {
+                int from = (i * 7 + w) % ACCOUNTS;
+                int to = (i * 13 + w * 5 + 1) % ACCOUNTS;
+                if (from == to) continue;
+                while (true) {
+                    auto txn = txns.begin();
+                    std::map<int, std::pair<RID, int64_t>> accounts;
+                    table.scan(*txn, [&](RID rid, TupleRef t) {
+                        int a;
+                        int64_t b;
+                        std::memcpy(&a, t.data, 4);
+                        std::memcpy(&b, t.data + 4, 8);
+                        accounts[a] = {rid, b};
+                    });
+                    try {
+                        EXPECT_TRUE(table.update(*txn, accounts[from].first, encode(from, accounts[from].second - 1)));
+                        EXPECT_TRUE(table.update(*txn, accounts[to].first, encode(to, accounts[to].second + 1)));
+                        txns.commit(*txn);
+                        break;
+                    } catch (const WriteConflict&) {
+                        conflicts++;
+                    }
+                }
+            }
+            writers_left--;
+        });
+    }
+    std::atomic<int> scans{0};
+    for (int r = 0; r < READERS; ++r) {
+        threads.emplace_back([&] {
+            while (writers_left.load() > 0) {
+                auto txn = txns.begin();
+                int64_t total = 0;
+                int rows = 0;
+                table.scan(*txn, [&](RID, TupleRef t) {
+                    int64_t b;
+                    std::memcpy(&b, t.data + 4, 8);
+                    total += b;
+                    rows++;
+                });
+                ASSERT_EQ(rows, ACCOUNTS);
+                ASSERT_EQ(total, START * ACCOUNTS);
+                scans++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    txns.stop_gc();
+
+    EXPECT_GT(scans.load(), 0);
+    txns.collect_garbage();
+    EXPECT_EQ(table.version_count(), 0u);
+    auto txn = txns.begin();
+    int64_t total = 0;
+    table.scan(*txn, [&](RID, TupleRef t) {
+        int64_t b;
+        std::memcpy(&b, t.data + 4, 8);
+        total += b;
+    });
+    EXPECT_EQ(total, START * ACCOUNTS);
+}